@@ -0,0 +1,257 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCBitstreamCommon.h"
+#include "PCCHighLevelSyntax.h"
+#include "PCCBitstream.h"
+#include "PCCBitstreamReader.h"
+#include <program_options_lite.h>
+#include <chrono>
+#include <functional>
+
+using namespace std;
+using namespace pcc;
+
+//---------------------------------------------------------------------------
+// :: Command line / config parsing
+
+bool parseParameters( int          argc,
+                      char*        argv[],
+                      std::string& compressedStreamPath,
+                      size_t&      patchCount,
+                      size_t&      iterationCount ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+
+  // The definition of the program/config options, along with default values.
+  //
+  // NB: when updating the following tables:
+  //      (a) please keep to 80-columns for easier reading at a glance,
+  //      (b) do not vertically align values -- it breaks quickly
+  //
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+    ( "help", print_help, false,"This help text" )
+    ( "compressedStreamPath",
+      compressedStreamPath,
+      compressedStreamPath,
+      "Optional V3C bitstream parsed in addition to the synthetic patches" )
+    ( "patchCount",
+      patchCount,
+      patchCount,
+      "Number of synthetic patch data units written and read" )
+    ( "iterationCount",
+      iterationCount,
+      iterationCount,
+      "Number of times the patches and the bitstream are processed" )
+    ;
+  opts.addOptions();
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+
+  if ( print_help ) {
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+
+  printf( "parseParameters : \n" );
+  printf( "  compressedStreamPath = %s \n", compressedStreamPath.c_str() );
+  printf( "  patchCount           = %zu \n", patchCount );
+  printf( "  iterationCount       = %zu \n", iterationCount );
+  if ( err.is_errored ) { return false; }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Throughput measurement
+
+struct BitstreamThroughput {
+  std::chrono::duration<double> time{0.0};
+  size_t                        elementCount = 0;
+  size_t                        byteCount    = 0;
+
+  void print( const char* name ) const {
+    const double seconds = ( std::max )( time.count(), 1e-9 );
+    printf( "  %-16s: %10.3f s %10.3f Melements/s %10.3f MB/s \n", name, time.count(), elementCount / seconds / 1e6,
+            byteCount / seconds / 1e6 );
+  }
+};
+
+// Syntax elements of a patch data unit: 2D position and size, 3D offsets, orientation, level of detail and point
+// local reconstruction, with the descriptors the atlas tile data uses for them.
+struct SyntheticPatch {
+  uint32_t pos2dX;
+  uint32_t pos2dY;
+  int32_t  deltaSize2dX;
+  int32_t  deltaSize2dY;
+  uint32_t offset3dU;
+  uint32_t offset3dV;
+  uint32_t offset3dD;
+  uint32_t orientation;
+  bool     lodEnabled;
+  uint32_t lodScaleX;
+  int32_t  plrMode;
+  float    scale;
+};
+static const size_t g_syntheticPatchElementCount = 12;
+
+static void writePatch( PCCBitstream& bitstream, const SyntheticPatch& patch ) {
+  bitstream.writeUvlc( patch.pos2dX );        // ue(v)
+  bitstream.writeUvlc( patch.pos2dY );        // ue(v)
+  bitstream.writeSvlc( patch.deltaSize2dX );  // se(v)
+  bitstream.writeSvlc( patch.deltaSize2dY );  // se(v)
+  bitstream.write( patch.offset3dU, 10 );     // u(v)
+  bitstream.write( patch.offset3dV, 10 );     // u(v)
+  bitstream.write( patch.offset3dD, 7 );      // u(v)
+  bitstream.write( patch.orientation, 3 );    // u(v)
+  bitstream.write( patch.lodEnabled, 1 );     // u(1)
+  bitstream.writeUvlc( patch.lodScaleX );     // ue(v)
+  bitstream.writeSvlc( patch.plrMode );       // se(v)
+  bitstream.writeFloat( patch.scale );        // fl(32)
+}
+
+static bool readPatch( PCCBitstream& bitstream, const SyntheticPatch& patch ) {
+  bool match = bitstream.readUvlc() == patch.pos2dX;
+  match &= bitstream.readUvlc() == patch.pos2dY;
+  match &= bitstream.readSvlc() == patch.deltaSize2dX;
+  match &= bitstream.readSvlc() == patch.deltaSize2dY;
+  match &= bitstream.read( 10 ) == patch.offset3dU;
+  match &= bitstream.read( 10 ) == patch.offset3dV;
+  match &= bitstream.read( 7 ) == patch.offset3dD;
+  match &= bitstream.read( 3 ) == patch.orientation;
+  match &= ( bitstream.read( 1 ) != 0 ) == patch.lodEnabled;
+  match &= bitstream.readUvlc() == patch.lodScaleX;
+  match &= bitstream.readSvlc() == patch.plrMode;
+  match &= bitstream.readFloat() == patch.scale;
+  return match;
+}
+
+static bool parseBitstream( const std::string& compressedStreamPath, size_t& byteCount ) {
+  PCCBitstream     bitstream;
+  PCCBitstreamStat bitstreamStat;
+  if ( !bitstream.initialize( compressedStreamPath ) ) { return false; }
+  byteCount = bitstream.capacity();
+  bitstreamStat.setHeader( bitstream.size() );
+  SampleStreamV3CUnit ssvu;
+  pcc::PCCBitstreamReader::read( bitstream, ssvu );
+  while ( ssvu.getV3CUnitCount() > 0 ) {
+    PCCBitstreamReader bitstreamReader;
+    PCCHighLevelSyntax context;
+    context.setBitstreamStat( bitstreamStat );
+    if ( bitstreamReader.decode( ssvu, context ) == 0 ) { break; }
+  }
+  return true;
+}
+
+int benchmark( const std::string& compressedStreamPath, const size_t patchCount, const size_t iterationCount ) {
+  BitstreamThroughput writePatches;
+  BitstreamThroughput readPatches;
+  BitstreamThroughput parse;
+  // Times fct and adds the elements and bytes it processed to the throughput.
+  auto measure = [&]( BitstreamThroughput& throughput, const size_t elementCount, const std::function<bool()>& fct ) {
+    auto start = std::chrono::steady_clock::now();
+    if ( !fct() ) { return false; }
+    throughput.time += std::chrono::steady_clock::now() - start;
+    throughput.elementCount += elementCount;
+    return true;
+  };
+  std::vector<SyntheticPatch> patches( patchCount );
+  uint32_t                    seed = 1;
+  auto                        rand = [&]( const uint32_t range ) {
+    seed = seed * 1103515245 + 12345;
+    return ( seed >> 8 ) % range;
+  };
+  for ( auto& patch : patches ) {
+    patch.pos2dX       = rand( 128 );
+    patch.pos2dY       = rand( 1024 );
+    patch.deltaSize2dX = int32_t( rand( 64 ) ) - 32;
+    patch.deltaSize2dY = int32_t( rand( 64 ) ) - 32;
+    patch.offset3dU    = rand( 1024 );
+    patch.offset3dV    = rand( 1024 );
+    patch.offset3dD    = rand( 128 );
+    patch.orientation  = rand( 8 );
+    patch.lodEnabled   = rand( 2 ) != 0;
+    patch.lodScaleX    = rand( 4 );
+    patch.plrMode      = int32_t( rand( 16 ) ) - 8;
+    patch.scale        = float( rand( 1000 ) ) / 100.f;
+  }
+  for ( size_t iteration = 0; iteration < iterationCount; iteration++ ) {
+    PCCBitstream bitstream;
+    bitstream.initialize( 4096 );
+    const size_t elementCount = patchCount * g_syntheticPatchElementCount;
+    measure( writePatches, elementCount, [&] {
+      for ( const auto& patch : patches ) { writePatch( bitstream, patch ); }
+      return true;
+    } );
+    writePatches.byteCount += bitstream.size();
+    readPatches.byteCount += bitstream.size();
+    bitstream.beginning();
+    if ( !measure( readPatches, elementCount, [&] {
+           bool match = true;
+           for ( const auto& patch : patches ) { match &= readPatch( bitstream, patch ); }
+           return match;
+         } ) ) {
+      std::cout << "Error: the patches read differ from the patches written" << std::endl;
+      return -1;
+    }
+    if ( !compressedStreamPath.empty() ) {
+      size_t byteCount = 0;
+      if ( !measure( parse, 0, [&] { return parseBitstream( compressedStreamPath, byteCount ); } ) ) {
+        std::cout << "Error: can't parse " << compressedStreamPath << std::endl;
+        return -1;
+      }
+      parse.byteCount += byteCount;
+    }
+  }
+  printf( "Throughput: \n" );
+  writePatches.print( "write patches" );
+  readPatches.print( "read patches" );
+  if ( !compressedStreamPath.empty() ) { parse.print( "parse bitstream" ); }
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppBitstreamBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl
+            << std::endl;
+  std::string compressedStreamPath;
+  size_t      patchCount     = 1000000;
+  size_t      iterationCount = 1;
+  if ( !parseParameters( argc, argv, compressedStreamPath, patchCount, iterationCount ) ) { return -1; }
+  return benchmark( compressedStreamPath, patchCount, iterationCount );
+}
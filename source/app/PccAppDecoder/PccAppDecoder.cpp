@@ -44,6 +44,7 @@
 #include "PCCBitstream.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCBitstreamReader.h"
+#include "PCCBitstreamIndex.h"
 #include "PCCDecoderParameters.h"
 #include "PCCMetricsParameters.h"
 #include "PCCConformanceParameters.h"
@@ -159,6 +160,27 @@ bool parseParameters( int                       argc,
       decoderParams.keepIntermediateFiles_,
       decoderParams.keepIntermediateFiles_,
       "Keep intermediate files: RGB, YUV and bin")
+    ( "streamingDecode",
+      decoderParams.streamingDecode_,
+      decoderParams.streamingDecode_,
+      "Reconstruct and output each frame while the videos are being decoded by the application decoders, the "
+      "library decoders decode the videos GOF by GOF")
+    ( "streamingFrameCount",
+      decoderParams.streamingFrameCount_,
+      decoderParams.streamingFrameCount_,
+      "Number of frames the video decoders can run ahead of the reconstruction in streaming mode")
+    ( "bitstreamIndexPath",
+      decoderParams.bitstreamIndexPath_,
+      decoderParams.bitstreamIndexPath_,
+      "Index of the V3C units of the compressed bitstream, created if it does not exist")
+    ( "startGofIndex",
+      decoderParams.startGofIndex_,
+      decoderParams.startGofIndex_,
+      "First GOF to decode")
+    ( "gofCount",
+      decoderParams.gofCount_,
+      decoderParams.gofCount_,
+      "Number of GOFs to decode (0: all the GOFs from startGofIndex)")
 	  ( "shvcLayerIndex",
 	    decoderParams.shvcLayerIndex_,
 	    decoderParams.shvcLayerIndex_,
@@ -275,6 +297,39 @@ bool parseParameters( int                       argc,
   return !err.is_errored;
 }
 
+// Reads the index of the V3C units of the compressed bitstream or builds it: the sample stream headers are scanned and
+// the atlas data of each GOF is parsed to count its frames.
+bool loadBitstreamIndex( const PCCDecoderParameters& decoderParams, PCCBitstreamIndex& index, PCCLogger& logger ) {
+  const auto& indexPath = decoderParams.bitstreamIndexPath_;
+  if ( !indexPath.empty() && index.read( indexPath ) ) { return true; }
+  if ( !index.build( decoderParams.compressedStreamPath_ ) ) {
+    std::cerr << "Can't index the V3C units of " << decoderParams.compressedStreamPath_ << std::endl;
+    return false;
+  }
+  for ( size_t gofIndex = 0; gofIndex < index.getGofCount(); gofIndex++ ) {
+    SampleStreamV3CUnit ssvu;
+    PCCBitstreamStat    bitstreamStat;
+    PCCContext          context;
+    PCCBitstreamReader  bitstreamReader;
+#ifdef BITSTREAM_TRACE
+    bitstreamReader.setLogger( logger );
+#endif
+    context.setBitstreamStat( bitstreamStat );
+    if ( !index.load( decoderParams.compressedStreamPath_, gofIndex, 1, ssvu, true ) ) { return false; }
+    bitstreamReader.decode( ssvu, context );
+    size_t frameCount = 0;
+    auto&  atlList    = context.getAtlasTileLayerList();
+    for ( size_t i = 0; i < atlList.size(); i++ ) {
+      frameCount = ( std::max )( frameCount, context.calculateAFOCval( atlList, i ) + 1 );
+    }
+    index.setFrameCount( gofIndex, frameCount );
+  }
+  if ( !indexPath.empty() && !index.write( indexPath ) ) {
+    std::cerr << "Can't write the bitstream index " << indexPath << std::endl;
+  }
+  return true;
+}
+
 int decompressVideo( PCCDecoderParameters&       decoderParams,
                      const PCCMetricsParameters& metricsParams,
                      PCCConformanceParameters&   conformanceParams,
@@ -287,23 +342,48 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
   bitstream.setLogger( logger );
   bitstream.setTrace( true );
 #endif
-  if ( !bitstream.initialize( decoderParams.compressedStreamPath_ ) ) { return -1; }
-  bitstream.computeMD5();
-  bitstreamStat.setHeader( bitstream.size() );
-  size_t         frameNumber = decoderParams.startFrameNumber_;
+  size_t              frameNumber = decoderParams.startFrameNumber_;
+  size_t              frameIndex  = 0;
+  size_t              frameCount  = 0;
+  SampleStreamV3CUnit ssvu;
+  if ( !decoderParams.bitstreamIndexPath_.empty() || decoderParams.startGofIndex_ > 0 || decoderParams.gofCount_ > 0 ) {
+    // only the V3C units of the requested GOFs are read from the bitstream
+    PCCBitstreamIndex index;
+    if ( !loadBitstreamIndex( decoderParams, index, logger ) ) { return -1; }
+    size_t gofIndex = decoderParams.startGofIndex_;
+    size_t gofCount = decoderParams.gofCount_;
+    if ( gofIndex >= index.getGofCount() ) {
+      printf( "startGofIndex %zu is not in the bitstream (%zu GOFs) \n", gofIndex, index.getGofCount() );
+      return -1;
+    }
+    if ( gofCount == 0 || gofIndex + gofCount > index.getGofCount() ) { gofCount = index.getGofCount() - gofIndex; }
+    if ( !index.load( decoderParams.compressedStreamPath_, gofIndex, gofCount, ssvu ) ) { return -1; }
+    bitstreamStat.incrHeader( index.getHeaderSize( gofIndex, gofCount ) );
+    frameIndex = index.getFirstFrameIndex( gofIndex );
+    frameCount = index.getFirstFrameIndex( gofIndex + gofCount ) - frameIndex;
+    frameNumber += frameIndex;
+    printf( "Decode GOFs %zu to %zu: frames %zu to %zu \n", gofIndex, gofIndex + gofCount - 1, frameNumber,
+            frameNumber + frameCount - 1 );
+  } else {
+    if ( !bitstream.initialize( decoderParams.compressedStreamPath_ ) ) { return -1; }
+    bitstream.computeMD5();
+    bitstreamStat.setHeader( bitstream.size() );
+    size_t headerSize = pcc::PCCBitstreamReader::read( bitstream, ssvu );
+    bitstreamStat.incrHeader( headerSize );
+  }
   PCCMetrics     metrics;
   PCCChecksum    checksum;
   PCCConformance conformance;
   metrics.setParameters( metricsParams );
   checksum.setParameters( metricsParams );
-  if ( metricsParams.computeChecksum_ ) { checksum.read( decoderParams.compressedStreamPath_ ); }
+  if ( metricsParams.computeChecksum_ ) {
+    checksum.read( decoderParams.compressedStreamPath_ );
+    if ( frameCount > 0 ) { checksum.selectFrames( frameIndex, frameCount ); }
+  }
   PCCDecoder decoder;
   decoder.setLogger( logger );
   decoder.setParameters( decoderParams );
 
-  SampleStreamV3CUnit ssvu;
-  size_t              headerSize = pcc::PCCBitstreamReader::read( bitstream, ssvu );
-  bitstreamStat.incrHeader( headerSize );
   bool bMoreData = true;
   while ( bMoreData ) {
     PCCGroupOfFrames reconstructs;
@@ -331,7 +411,26 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
       // first allocating the structures, frames will be added as the V3C
       // units are being decoded ???
       context.setAtlasIndex( atlId );
-      int retDecoding = decoder.decode( context, reconstructs, atlId );
+      int    retDecoding        = 0;
+      size_t writtenFrameNumber = frameNumber;
+      if ( decoderParams.streamingDecode_ ) {
+        // the frames are written as soon as they are reconstructed and only kept for the checksum and the metrics
+        bool keepFrames = metricsParams.computeChecksum_ || metricsParams.computeMetrics_;
+        retDecoding     = decoder.decode(
+            context,
+            [&]( size_t frameIndex, PCCPointSet3& reconstruct ) {
+              if ( !decoderParams.reconstructedDataPath_.empty() ) {
+                char fileName[4096];
+                sprintf( fileName, decoderParams.reconstructedDataPath_.c_str(), frameNumber + frameIndex );
+                reconstruct.write( fileName, true );
+                writtenFrameNumber = frameNumber + frameIndex + 1;
+              }
+              if ( keepFrames ) { reconstructs.getFrames().push_back( reconstruct ); }
+            },
+            atlId );
+      } else {
+        retDecoding = decoder.decode( context, reconstructs, atlId );
+      }
       clock.stop();
       if ( retDecoding != 0 ) { return retDecoding; }
       if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
@@ -360,7 +459,9 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
       }
 #endif
 
-      if ( !decoderParams.reconstructedDataPath_.empty() ) {
+      if ( decoderParams.streamingDecode_ ) {
+        frameNumber = decoderParams.reconstructedDataPath_.empty() ? frameNumber + context.size() : writtenFrameNumber;
+      } else if ( !decoderParams.reconstructedDataPath_.empty() ) {
         reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber, decoderParams.nbThread_ );
       } else {
         frameNumber += reconstructs.getFrameCount();
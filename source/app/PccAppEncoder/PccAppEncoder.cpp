@@ -46,7 +46,9 @@
 #include "PCCEncoderParameters.h"
 #include "PCCBitstreamWriter.h"
 #include "PCCMetricsParameters.h"
+#include "PCCQueue.h"
 #include <program_options_lite.h>
+#include <thread>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
@@ -598,6 +600,18 @@ bool parseParameters( int                   argc,
       encoderParams.keepIntermediateFiles_,
       encoderParams.keepIntermediateFiles_,
       "Keep intermediate files: RGB, YUV and bin" )
+    ( "pipelinedGofs",
+      encoderParams.pipelinedGofs_,
+      encoderParams.pipelinedGofs_,
+      "Overlap the loading of GOF N+1, the encoding of GOF N and the metrics/reconstruction writing of GOF N-1" )
+    ( "pipelineMaxMemory",
+      encoderParams.pipelineMaxMemory_,
+      encoderParams.pipelineMaxMemory_,
+      "Memory ceiling in MB of the point clouds in flight in pipelinedGofs mode (0: unlimited)" )
+    ( "videoEncoderInstances",
+      encoderParams.videoEncoderInstances_,
+      encoderParams.videoEncoderInstances_,
+      "Maximum number of independent video streams encoded concurrently by the application video codecs" )
     ( "absoluteD1",
       encoderParams.absoluteD1_,
       encoderParams.absoluteD1_,
@@ -737,7 +751,8 @@ bool parseParameters( int                   argc,
       encoderParams.attributeBGFill_,
       encoderParams.attributeBGFill_,
       "Selects the background filling operation for attribute only (0: patch-edge extension, "
-      "1(default): smoothed push-pull algorithm), 2: harmonic background filling " )
+      "1(default): smoothed push-pull algorithm), 2: harmonic background filling, 3: none, "
+      "4: harmonic background filling solved by multigrid " )
 
     // lossy-raw-points patch
     ( "lossyRawPointsPatch",
@@ -1012,6 +1027,242 @@ bool parseParameters( int                   argc,
   return true;
 }
 
+void evaluateGroupOfFrames( const PCCEncoderParameters& encoderParams,
+                            const PCCMetricsParameters& metricsParams,
+                            PCCMetrics&                 metrics,
+                            PCCChecksum&                checksum,
+                            PCCGroupOfFrames&           sources,
+                            PCCGroupOfFrames&           reconstructs,
+                            const size_t                startFrameNumber,
+                            const size_t                endFrameNumber ) {
+  PCCGroupOfFrames normals;
+  if ( metricsParams.computeMetrics_ ) {
+    bool bRunMetric = true;
+    if ( !metricsParams.normalDataPath_.empty() ) {
+      if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
+                          true ) ) {
+        bRunMetric = false;
+      }
+    }
+    if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
+  }
+  if ( metricsParams.computeChecksum_ ) {
+    if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
+      checksum.computeSource( sources );
+      checksum.computeReordered( reconstructs );
+    }
+    checksum.computeReconstructed( reconstructs );
+  }
+  normals.clear();
+}
+
+int writeBitstream( const PCCEncoderParameters& encoderParams,
+                    const PCCMetricsParameters& metricsParams,
+                    PCCLogger&                  logger,
+                    PCCMetrics&                 metrics,
+                    PCCChecksum&                checksum,
+                    PCCBitstreamStat&           bitstreamStat,
+                    SampleStreamV3CUnit&        ssvu ) {
+  PCCBitstream bitstream;
+#if defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
+  bitstream.setLogger( logger );
+  bitstream.setTrace( true );
+#endif
+
+  bitstreamStat.setHeader( bitstream.size() );
+  PCCBitstreamWriter bitstreamWriter;
+  size_t headerSize = bitstreamWriter.write( ssvu, bitstream, encoderParams.forcedSsvhUnitSizePrecisionBytes_ );
+  bitstreamStat.incrHeader( headerSize );
+  bitstream.write( encoderParams.compressedStreamPath_ );
+  bitstreamStat.trace();
+  std::cout << "Total bitstream size " << bitstream.size() << " B" << std::endl;
+  bitstream.computeMD5();
+
+  if ( metricsParams.computeMetrics_ ) { metrics.display(); }
+  bool checksumEqual = true;
+  if ( metricsParams.computeChecksum_ ) {
+    if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
+      checksumEqual = checksum.compareSrcRec();
+    }
+    checksum.write( encoderParams.compressedStreamPath_ );
+  }
+  return checksumEqual ? 0 : -1;
+}
+
+// Memory budget of the point clouds in flight in the GOF pipeline. The size of
+// a GOF is only known once it has been encoded: as soon as its sources are
+// loaded, its footprint is estimated as twice the size of the sources (the
+// reconstruction holds about as many points), then replaced by the measured
+// size after the encoding. The latest estimate or measure is used as the
+// expected size of the next GOF to load. Only the first GOF, loaded when
+// nothing else is in flight, is admitted without estimate. Once stopped, no
+// GOF is admitted anymore.
+class PCCPipelineMemory {
+ public:
+  PCCPipelineMemory( size_t maxMemory ) :
+      maxMemory_( maxMemory ), usedMemory_( 0 ), expectedMemory_( 0 ), stopped_( false ) {}
+
+  // Waits until the memory of a new GOF fits in the ceiling and reserves it.
+  // A GOF is always accepted when nothing else is in flight. Returns false if
+  // the pipeline has been stopped.
+  bool acquire( size_t& reserved ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    released_.wait( lock, [&] {
+      return stopped_ || maxMemory_ == 0 || usedMemory_ == 0 || usedMemory_ + expectedMemory_ <= maxMemory_;
+    } );
+    if ( stopped_ ) { return false; }
+    usedMemory_ += expectedMemory_;
+    reserved = expectedMemory_;
+    return true;
+  }
+  void stop() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    stopped_ = true;
+    released_.notify_all();
+  }
+  void update( size_t reserved, size_t used ) {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    usedMemory_     = usedMemory_ - reserved + used;
+    expectedMemory_ = used;
+    released_.notify_all();
+  }
+  void release( size_t used ) {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    usedMemory_ -= used;
+    released_.notify_all();
+  }
+
+ private:
+  size_t                  maxMemory_;
+  size_t                  usedMemory_;
+  size_t                  expectedMemory_;
+  bool                    stopped_;
+  std::mutex              mutex_;
+  std::condition_variable released_;
+};
+
+struct PCCPipelineGof {
+  size_t           contextIndex_     = 0;
+  size_t           startFrameNumber_ = 0;
+  size_t           endFrameNumber_   = 0;
+  size_t           memorySize_       = 0;
+  int              ret_              = 0;
+  PCCGroupOfFrames sources_;
+  PCCGroupOfFrames reconstructs_;
+};
+
+// Pipelined encoding of the groups of frames: a loader thread reads the point
+// clouds of GOF N+1 while the calling thread encodes GOF N and an evaluation
+// thread computes the metrics/checksums and writes the reconstructions of
+// GOF N-1. The GOFs are encoded in order by a single PCCEncoder, so the
+// bitstream is identical to the one produced by compressVideo().
+int compressVideoPipelined( const PCCEncoderParameters& encoderParams,
+                            const PCCMetricsParameters& metricsParams,
+                            StopwatchUserTime&          clock ) {
+  const size_t startFrameNumber0  = encoderParams.startFrameNumber_;
+  const size_t endFrameNumber0    = encoderParams.startFrameNumber_ + encoderParams.frameCount_;
+  const size_t groupOfFramesSize0 = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesSize_ );
+
+  PCCLogger logger;
+  logger.initilalize( removeFileExtension( encoderParams.compressedStreamPath_ ), true );
+  PCCEncoder          encoder;
+  PCCMetrics          metrics;
+  PCCChecksum         checksum;
+  PCCBitstreamStat    bitstreamStat;
+  SampleStreamV3CUnit ssvu;
+  encoder.setLogger( logger );
+  encoder.setParameters( encoderParams );
+  metrics.setParameters( metricsParams );
+  checksum.setParameters( metricsParams );
+
+  PCCPipelineMemory                        memory( encoderParams.pipelineMaxMemory_ * 1024 * 1024 );
+  PCCQueue<std::unique_ptr<PCCPipelineGof>> loadedGofs( 1 );
+  PCCQueue<std::unique_ptr<PCCPipelineGof>> encodedGofs( 1 );
+  int                                      loadRet = 0;
+  clock.start();
+
+  std::thread loader( [&] {
+    size_t startFrameNumber = startFrameNumber0;
+    size_t endFrameNumber1  = endFrameNumber0;
+    size_t contextIndex     = 0;
+    while ( startFrameNumber < endFrameNumber1 ) {
+      std::unique_ptr<PCCPipelineGof> gof( new PCCPipelineGof );
+      gof->contextIndex_     = contextIndex;
+      gof->startFrameNumber_ = startFrameNumber;
+      gof->endFrameNumber_   = min( startFrameNumber + groupOfFramesSize0, endFrameNumber1 );
+      if ( !memory.acquire( gof->memorySize_ ) ) { break; }
+      if ( !gof->sources_.load( encoderParams.uncompressedDataPath_, gof->startFrameNumber_, gof->endFrameNumber_,
+                                encoderParams.colorTransform_, false, encoderParams.nbThread_ ) ) {
+        memory.release( gof->memorySize_ );
+        loadRet = -1;
+        break;
+      }
+      const size_t memorySize = 2 * gof->sources_.getMemorySize();
+      memory.update( gof->memorySize_, memorySize );
+      gof->memorySize_ = memorySize;
+      if ( gof->sources_.getFrameCount() < gof->endFrameNumber_ - gof->startFrameNumber_ ) {
+        gof->endFrameNumber_ = gof->startFrameNumber_ + gof->sources_.getFrameCount();
+        endFrameNumber1      = gof->endFrameNumber_;
+      }
+      startFrameNumber = gof->endFrameNumber_;
+      contextIndex++;
+      if ( !loadedGofs.push( std::move( gof ) ) ) { break; }
+    }
+    loadedGofs.close();
+  } );
+
+  size_t reconstructedFrameNumber = encoderParams.startFrameNumber_;
+  std::thread evaluator( [&] {
+    std::unique_ptr<PCCPipelineGof> gof;
+    while ( encodedGofs.pop( gof ) ) {
+      evaluateGroupOfFrames( encoderParams, metricsParams, metrics, checksum, gof->sources_, gof->reconstructs_,
+                             gof->startFrameNumber_, gof->endFrameNumber_ );
+      if ( gof->ret_ == 0 && !encoderParams.reconstructedDataPath_.empty() ) {
+        gof->reconstructs_.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      }
+      memory.release( gof->memorySize_ );
+      gof.reset();
+    }
+  } );
+
+  int                             ret = 0;
+  std::unique_ptr<PCCPipelineGof> gof;
+  while ( loadedGofs.pop( gof ) ) {
+    PCCContext context;
+    context.setBitstreamStat( bitstreamStat );
+    context.addV3CParameterSet( gof->contextIndex_ );
+    context.setActiveVpsId( gof->contextIndex_ );
+    std::cout << "Compressing " << gof->contextIndex_ << " frames " << gof->startFrameNumber_ << " -> "
+              << gof->endFrameNumber_ << "..." << std::endl;
+    ret = encoder.encode( gof->sources_, context, gof->reconstructs_ );
+    PCCBitstreamWriter bitstreamWriter;
+#ifdef BITSTREAM_TRACE
+    bitstreamWriter.setLogger( logger );
+#endif
+    ret |= bitstreamWriter.encode( context, ssvu );
+    const size_t memorySize = gof->sources_.getMemorySize() + gof->reconstructs_.getMemorySize();
+    memory.update( gof->memorySize_, memorySize );
+    gof->memorySize_ = memorySize;
+    gof->ret_        = ret;
+    encodedGofs.push( std::move( gof ) );
+    // As in compressVideo(), a failing GOF is still evaluated but the
+    // following GOFs are not encoded.
+    if ( ret != 0 ) { break; }
+  }
+  // Releases the loader if it waits for memory, so that it doesn't load
+  // another GOF after an error.
+  memory.stop();
+  loadedGofs.close();
+  while ( loadedGofs.pop( gof ) ) { memory.release( gof->memorySize_ ); }
+  encodedGofs.close();
+  loader.join();
+  evaluator.join();
+  clock.stop();
+  if ( loadRet != 0 ) { return loadRet; }
+  if ( ret != 0 ) { return ret; }
+  return writeBitstream( encoderParams, metricsParams, logger, metrics, checksum, bitstreamStat, ssvu );
+}
+
 int compressVideo( const PCCEncoderParameters& encoderParams,
                    const PCCMetricsParameters& metricsParams,
                    StopwatchUserTime&          clock ) {
@@ -1062,59 +1313,18 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
 #endif
     ret |= bitstreamWriter.encode( context, ssvu );
     clock.stop();
-    PCCGroupOfFrames normals;
-    if ( metricsParams.computeMetrics_ ) {
-      bool bRunMetric = true;
-      if ( !metricsParams.normalDataPath_.empty() ) {
-        if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
-                            true ) ) {
-          bRunMetric = false;
-        }
-      }
-      if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
-    }
-    if ( metricsParams.computeChecksum_ ) {
-      if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
-        checksum.computeSource( sources );
-        checksum.computeReordered( reconstructs );
-      }
-      checksum.computeReconstructed( reconstructs );
-    }
+    evaluateGroupOfFrames( encoderParams, metricsParams, metrics, checksum, sources, reconstructs, startFrameNumber,
+                           endFrameNumber );
     if ( ret != 0 ) { return ret; }
     if ( !encoderParams.reconstructedDataPath_.empty() ) {
       reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
     }
-    normals.clear();
     sources.clear();
     reconstructs.clear();
     startFrameNumber = endFrameNumber;
     contextIndex++;
   }
-
-  PCCBitstream bitstream;
-#if defined( BITSTREAM_TRACE ) || defined( CONFORMANCE_TRACE )
-  bitstream.setLogger( logger );
-  bitstream.setTrace( true );
-#endif
-
-  bitstreamStat.setHeader( bitstream.size() );
-  PCCBitstreamWriter bitstreamWriter;
-  size_t headerSize = bitstreamWriter.write( ssvu, bitstream, encoderParams.forcedSsvhUnitSizePrecisionBytes_ );
-  bitstreamStat.incrHeader( headerSize );
-  bitstream.write( encoderParams.compressedStreamPath_ );
-  bitstreamStat.trace();
-  std::cout << "Total bitstream size " << bitstream.size() << " B" << std::endl;
-  bitstream.computeMD5();
-
-  if ( metricsParams.computeMetrics_ ) { metrics.display(); }
-  bool checksumEqual = true;
-  if ( metricsParams.computeChecksum_ ) {
-    if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
-      checksumEqual = checksum.compareSrcRec();
-    }
-    checksum.write( encoderParams.compressedStreamPath_ );
-  }
-  return checksumEqual ? 0 : -1;
+  return writeBitstream( encoderParams, metricsParams, logger, metrics, checksum, bitstreamStat, ssvu );
 }
 
 int main( int argc, char* argv[] ) {
@@ -1134,7 +1344,8 @@ int main( int argc, char* argv[] ) {
   pcc::chrono::StopwatchUserTime                    clockUser;
 
   clockWall.start();
-  int ret = compressVideo( encoderParams, metricsParams, clockUser );
+  int ret = encoderParams.pipelinedGofs_ ? compressVideoPipelined( encoderParams, metricsParams, clockUser )
+                                         : compressVideo( encoderParams, metricsParams, clockUser );
   clockWall.stop();
 
   using namespace std::chrono;
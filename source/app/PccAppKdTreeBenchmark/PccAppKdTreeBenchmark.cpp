@@ -0,0 +1,255 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+#include "PCCKdTree.h"
+#include <program_options_lite.h>
+#include <chrono>
+#include <functional>
+
+using namespace std;
+using namespace pcc;
+
+//---------------------------------------------------------------------------
+// :: Command line / config parsing
+
+bool parseParameters( int          argc,
+                      char*        argv[],
+                      std::string& srcPlyPath,
+                      size_t&      startFrame,
+                      size_t&      numFrames,
+                      size_t&      nnCount,
+                      size_t&      iterationCount ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+
+  // The definition of the program/config options, along with default values.
+  //
+  // NB: when updating the following tables:
+  //      (a) please keep to 80-columns for easier reading at a glance,
+  //      (b) do not vertically align values -- it breaks quickly
+  //
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+    ( "help", print_help, false,"This help text" )
+    ( "srcPlyPath",
+      srcPlyPath,
+      srcPlyPath,
+      "Input pointclouds. Multi-frame sequences may be represented by %04i" )
+    ( "startFrameNumber",
+      startFrame,
+      startFrame,
+      "First frame number in sequence" )
+    ( "frameCount",
+      numFrames,
+      numFrames,
+      "Number of frames" )
+    ( "nnCount",
+      nnCount,
+      nnCount,
+      "Number of nearest neighbors of the k-nn queries" )
+    ( "iterationCount",
+      iterationCount,
+      iterationCount,
+      "Number of times the queries of each frame are run" )
+    ;
+  opts.addOptions();
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+
+  if ( argc == 1 || print_help || srcPlyPath.empty() || nnCount == 0 ) {
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+
+  printf( "parseParameters : \n" );
+  printf( "  srcPlyPath     = %s \n", srcPlyPath.c_str() );
+  printf( "  startFrame     = %zu \n", startFrame );
+  printf( "  frameCount     = %zu \n", numFrames );
+  printf( "  nnCount        = %zu \n", nnCount );
+  printf( "  iterationCount = %zu \n", iterationCount );
+  if ( err.is_errored ) { return false; }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Throughput measurement
+
+struct NNThroughput {
+  std::chrono::duration<double> time{0.0};
+  size_t                        queryCount    = 0;
+  size_t                        mismatchCount = 0;
+
+  void print( const char* name ) const {
+    const double seconds = ( std::max )( time.count(), 1e-9 );
+    printf( "  %-24s: %10.3f s %10.3f Mqueries/s %8zu mismatches \n", name, time.count(), queryCount / seconds / 1e6,
+            mismatchCount );
+  }
+};
+
+// Runs the queries of all the points of queries against kdtree, one point at a time, with a new result for each
+// query as the callers of the single point interface do.
+static void searchPoints( const PCCKdTree&                  kdtree,
+                          const PCCPointSet3&               queries,
+                          const size_t                      nnCount,
+                          std::vector<std::vector<size_t>>& indices ) {
+  for ( size_t i = 0; i < queries.getPointCount(); i++ ) {
+    PCCNNResult result;
+    kdtree.search( queries[i], nnCount, result );
+    indices[i].assign( result.indices(), result.indices() + result.count() );
+  }
+}
+
+// Runs the same queries through the batch interface.
+static void searchBatches( const PCCKdTree&                  kdtree,
+                           const PCCPointSet3&               queries,
+                           const size_t                      nnCount,
+                           std::vector<std::vector<size_t>>& indices ) {
+  const size_t     batchSize  = 256;
+  const size_t     pointCount = queries.getPointCount();
+  PCCNNBatchResult result;
+  for ( size_t start = 0; start < pointCount; start += batchSize ) {
+    const size_t end = ( std::min )( start + batchSize, pointCount );
+    kdtree.search( queries, start, end, nnCount, result );
+    for ( size_t i = start; i < end; i++ ) {
+      indices[i].assign( result.indices( i - start ), result.indices( i - start ) + result.count( i - start ) );
+    }
+  }
+}
+
+static double getDistance2( const PCCPoint3D& point0, const PCCPoint3D& point1 ) {
+  double distance2 = 0.0;
+  for ( size_t c = 0; c < 3; c++ ) {
+    const double diff = static_cast<double>( point0[c] ) - static_cast<double>( point1[c] );
+    distance2 += diff * diff;
+  }
+  return distance2;
+}
+
+// Compares the neighbor distances rather than the indices: points at the same distance may be reported in any order.
+static size_t countMismatches( const PCCPointSet3&                     reference,
+                               const PCCPointSet3&                     queries,
+                               const std::vector<std::vector<size_t>>& indices0,
+                               const std::vector<std::vector<size_t>>& indices1 ) {
+  size_t mismatchCount = 0;
+  for ( size_t i = 0; i < queries.getPointCount(); i++ ) {
+    bool match = indices0[i].size() == indices1[i].size();
+    for ( size_t j = 0; match && j < indices0[i].size(); j++ ) {
+      match = getDistance2( reference[indices0[i][j]], queries[i] ) ==
+              getDistance2( reference[indices1[i][j]], queries[i] );
+    }
+    mismatchCount += match ? 0 : 1;
+  }
+  return mismatchCount;
+}
+
+int benchmark( const std::string& srcPlyPath,
+               const size_t       startFrameNumber,
+               const size_t       frameCount,
+               const size_t       nnCount,
+               const size_t       iterationCount ) {
+  NNThroughput buildTree;
+  NNThroughput buildIndexedTree;
+  NNThroughput nn1Tree;
+  NNThroughput nn1IndexedTree;
+  NNThroughput knnPoints;
+  NNThroughput knnBatches;
+  // Times fct and adds the query count to the throughput.
+  auto measure = [&]( NNThroughput& throughput, const size_t queryCount, const std::function<void()>& fct ) {
+    auto start = std::chrono::steady_clock::now();
+    fct();
+    throughput.time += std::chrono::steady_clock::now() - start;
+    throughput.queryCount += queryCount;
+  };
+  PCCPointSet3 previous;
+  for ( size_t frameNumber = startFrameNumber; frameNumber < startFrameNumber + frameCount; frameNumber++ ) {
+    char         fileName[4096];
+    PCCPointSet3 current;
+    sprintf( fileName, srcPlyPath.c_str(), frameNumber );
+    if ( !current.read( fileName, true ) ) {
+      std::cout << "Error: can't read " << fileName << std::endl;
+      return -1;
+    }
+    // The nearest neighbor queries search the points of the frame in itself and, as the temporal prediction
+    // does, in the previous frame.
+    const size_t pointCount = current.getPointCount();
+    for ( size_t iteration = 0; iteration < iterationCount; iteration++ ) {
+      PCCKdTree                        tree;
+      PCCKdTree                        indexedTree;
+      std::vector<std::vector<size_t>> indices0;
+      std::vector<std::vector<size_t>> indices1;
+      measure( buildTree, pointCount, [&] { tree.init( current, false ); } );
+      measure( buildIndexedTree, pointCount, [&] { indexedTree.init( current, true ); } );
+      for ( const auto& queries : {&current, &previous} ) {
+        const size_t queryCount = queries->getPointCount();
+        indices0.resize( queryCount );
+        indices1.resize( queryCount );
+        measure( nn1Tree, queryCount, [&] { searchPoints( tree, *queries, 1, indices0 ); } );
+        measure( nn1IndexedTree, queryCount, [&] { searchPoints( indexedTree, *queries, 1, indices1 ); } );
+        nn1IndexedTree.mismatchCount += countMismatches( current, *queries, indices0, indices1 );
+        measure( knnPoints, queryCount, [&] { searchPoints( tree, *queries, nnCount, indices0 ); } );
+        measure( knnBatches, queryCount, [&] { searchBatches( indexedTree, *queries, nnCount, indices1 ); } );
+        knnBatches.mismatchCount += countMismatches( current, *queries, indices0, indices1 );
+      }
+    }
+    previous = current;
+  }
+  printf( "Throughput: \n" );
+  buildTree.print( "build tree" );
+  buildIndexedTree.print( "build indexed tree" );
+  nn1Tree.print( "1-nn tree" );
+  nn1IndexedTree.print( "1-nn indexed tree" );
+  knnPoints.print( "k-nn single queries" );
+  knnBatches.print( "k-nn batch queries" );
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppKdTreeBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl << std::endl;
+  std::string srcPlyPath;
+  size_t      startFrameNumber = 0;
+  size_t      frameCount       = 1;
+  size_t      nnCount          = 16;
+  size_t      iterationCount   = 1;
+  if ( !parseParameters( argc, argv, srcPlyPath, startFrameNumber, frameCount, nnCount, iterationCount ) ) {
+    return -1;
+  }
+  return benchmark( srcPlyPath, startFrameNumber, frameCount, nnCount, iterationCount );
+}
@@ -0,0 +1,372 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCCommon.h"
+#include "PCCImage.h"
+#include "PCCPadding.h"
+#include <program_options_lite.h>
+#include <chrono>
+#include <limits>
+#include <random>
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
+
+using namespace std;
+using namespace pcc;
+
+//---------------------------------------------------------------------------
+// :: Command line / config parsing
+
+bool parseParameters( int     argc,
+                      char*   argv[],
+                      size_t& width,
+                      size_t& height,
+                      size_t& blockSize,
+                      size_t& nbThread,
+                      size_t& iterationCount ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+
+  // The definition of the program/config options, along with default values.
+  //
+  // NB: when updating the following tables:
+  //      (a) please keep to 80-columns for easier reading at a glance,
+  //      (b) do not vertically align values -- it breaks quickly
+  //
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+    ( "help", print_help, false,"This help text" )
+    ( "width",
+      width,
+      width,
+      "Width of the synthetic attribute images (even)" )
+    ( "height",
+      height,
+      height,
+      "Height of the synthetic attribute images (even)" )
+    ( "blockSize",
+      blockSize,
+      blockSize,
+      "Size of the empty, full and partial blocks of the occupancy maps" )
+    ( "nbThread",
+      nbThread,
+      nbThread,
+      "Number of threads of the padding benchmark" )
+    ( "iterationCount",
+      iterationCount,
+      iterationCount,
+      "Number of times each image is padded" )
+    ;
+  opts.addOptions();
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+
+  if ( print_help || width < 2 || height < 2 || ( width % 2 ) != 0 || ( height % 2 ) != 0 || blockSize == 0 ) {
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+
+  printf( "parseParameters : \n" );
+  printf( "  width          = %zu \n", width );
+  printf( "  height         = %zu \n", height );
+  printf( "  blockSize      = %zu \n", blockSize );
+  printf( "  nbThread       = %zu \n", nbThread );
+  printf( "  iterationCount = %zu \n", iterationCount );
+  if ( err.is_errored ) { return false; }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Synthetic images
+
+// Splits the map in blocks that are empty, fully occupied or partially occupied. The first block is always empty and
+// the second one fully occupied.
+static void generateOccupancyMap( const size_t           width,
+                                  const size_t           height,
+                                  const size_t           blockSize,
+                                  std::mt19937&          generator,
+                                  std::vector<uint32_t>& occupancyMap ) {
+  occupancyMap.assign( width * height, 0 );
+  size_t blockIndex = 0;
+  for ( size_t y0 = 0; y0 < height; y0 += blockSize ) {
+    for ( size_t x0 = 0; x0 < width; x0 += blockSize, blockIndex++ ) {
+      const size_t mode = blockIndex < 2 ? blockIndex : generator() % 3;
+      for ( size_t y = y0; y < ( std::min )( y0 + blockSize, height ); y++ ) {
+        for ( size_t x = x0; x < ( std::min )( x0 + blockSize, width ); x++ ) {
+          occupancyMap[y * width + x] = mode == 0 ? 0 : mode == 1 ? 1 : ( generator() % 3 ) != 0 ? 1 : 0;
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+static void generateImage( const size_t    width,
+                           const size_t    height,
+                           PCCCOLORFORMAT  format,
+                           std::mt19937&   generator,
+                           PCCImage<T, 3>& image ) {
+  image.resize( width, height, format );
+  for ( size_t c = 0; c < 3; c++ ) {
+    for ( auto& value : image.getChannel( c ) ) { value = static_cast<T>( generator() ); }
+  }
+}
+
+// Generates the occupancy map and the image of a configuration, seeded by the sample size and the color format.
+template <typename T>
+static void generate( const size_t           width,
+                      const size_t           height,
+                      const size_t           blockSize,
+                      const PCCCOLORFORMAT   format,
+                      std::vector<uint32_t>& occupancyMap,
+                      PCCImage<T, 3>&        image ) {
+  std::mt19937 generator( static_cast<uint32_t>( sizeof( T ) * 16 + format ) );
+  generateOccupancyMap( width, height, blockSize, generator, occupancyMap );
+  generateImage( width, height, format, generator, image );
+}
+
+// Pads the image with the kernel selected by the attributeBGFill value of the encoder.
+template <typename T>
+static void pad( const size_t attributeBGFill, const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image ) {
+  switch ( attributeBGFill ) {
+    case 1: dilateSmoothedPushPull( occupancyMap, image ); break;
+    case 2: dilateHarmonicBackgroundFill( occupancyMap, image ); break;
+    case 4: dilateMultigridBackgroundFill( occupancyMap, image ); break;
+  }
+}
+
+//---------------------------------------------------------------------------
+// :: Golden images
+
+// MD5 of the three planes of the 200x136 synthetic images (blockSize 16) padded by the serial kernels of PCCEncoder
+// that PCCPadding replaced.
+struct GoldenImage {
+  const char*    name;
+  size_t         sampleSize;
+  PCCCOLORFORMAT format;
+  size_t         attributeBGFill;
+  const char*    md5[3];
+};
+
+static const size_t      g_goldenWidth     = 200;
+static const size_t      g_goldenHeight    = 136;
+static const size_t      g_goldenBlockSize = 16;
+static const GoldenImage g_goldenImages[]  = {
+    {"8-bit 4:4:4 push-pull", 1, YUV444, 1,
+     {"ad8a6a66affd6269e9b9f72c3a1da758", "fa02c88d7424ae0c6db9d1283b317648", "04753c221856f275c58a6a2f1abfbad5"}},
+    {"8-bit 4:4:4 harmonic", 1, YUV444, 2,
+     {"693b1541f276bc61bb62578095660545", "bdd4f25bba3f4b045c39b14a8f792ee6", "ee93e518890036883db0b854387067d6"}},
+    {"16-bit 4:4:4 push-pull", 2, YUV444, 1,
+     {"d3614a1e50b3de518a89776e3f3e7d81", "a6a67f56bea5d42e9522d1d4eeb0df82", "c29f16ea6a2929128df2ea2d8f24b427"}},
+    {"16-bit 4:4:4 harmonic", 2, YUV444, 2,
+     {"39fc5dde8c71af63a28ed67555e4c4b5", "6a976b754241f975d26a986ae745847f", "bb797fad5e5c3493b3fb663ce4d1b625"}},
+    {"8-bit 4:2:0 push-pull", 1, YUV420, 1,
+     {"86f34d763f31a40af67b226c64968dc7", "321d7aa226a4488421c70b482555ba50", "16a577ff3fd488716ad897d69b426965"}},
+    {"8-bit 4:2:0 harmonic", 1, YUV420, 2,
+     {"9a5b9baaa63e8570c56508b7753b2a0e", "48a3726bece858ab96796bbf7c5785df", "87f118c1f51984ee2a1d8a4e99fa46b5"}},
+    {"16-bit 4:2:0 push-pull", 2, YUV420, 1,
+     {"41c2c5d8a049e913cc992f7c63c79075", "e07a4e7350faa646ed46d0d2a8c47b4a", "b89fa8241d02609f271804a38934f7bf"}},
+    {"16-bit 4:2:0 harmonic", 2, YUV420, 2,
+     {"12e6d346b4dbbd0a326984d51bef6693", "87eac8f09e96c582ad48e0774b5bcdfb", "c43d8cef7634dddbf57ba951790501de"}}};
+
+template <typename T>
+static bool checkGoldenImage( const GoldenImage& golden ) {
+  std::vector<uint32_t> occupancyMap;
+  PCCImage<T, 3>        image;
+  generate( g_goldenWidth, g_goldenHeight, g_goldenBlockSize, golden.format, occupancyMap, image );
+  pad( golden.attributeBGFill, occupancyMap, image );
+  bool same = true;
+  for ( size_t c = 0; c < 3; c++ ) {
+    const auto md5 = image.computeMD5( c );
+    if ( md5 != golden.md5[c] ) {
+      printf( "  %-24s: plane %zu MD5 %s instead of %s \n", golden.name, c, md5.c_str(), golden.md5[c] );
+      same = false;
+    }
+  }
+  return same;
+}
+
+static size_t checkGoldenImages() {
+  size_t mismatchCount = 0;
+  for ( const auto& golden : g_goldenImages ) {
+    const bool same =
+        golden.sampleSize == 1 ? checkGoldenImage<uint8_t>( golden ) : checkGoldenImage<uint16_t>( golden );
+    mismatchCount += same ? 0 : 1;
+  }
+  printf( "golden images: %zu images %zu mismatches \n",
+          sizeof( g_goldenImages ) / sizeof( g_goldenImages[0] ), mismatchCount );
+  return mismatchCount;
+}
+
+//---------------------------------------------------------------------------
+// :: Multigrid harmonic filling
+
+// dilateMultigridBackgroundFill solves the system of dilateHarmonicBackgroundFill until convergence, so its padded
+// values are checked against the harmonic ones of the golden configuration with a tolerance, given as a fraction of
+// the sample range.
+struct MultigridImage {
+  const char*    name;
+  size_t         sampleSize;
+  PCCCOLORFORMAT format;
+};
+
+static const double         g_multigridMaxDifference     = 0.02;
+static const double         g_multigridMaxMeanDifference = 0.002;
+static const MultigridImage g_multigridImages[]          = {{"8-bit 4:4:4 multigrid", 1, YUV444},
+                                                           {"16-bit 4:4:4 multigrid", 2, YUV444},
+                                                           {"8-bit 4:2:0 multigrid", 1, YUV420},
+                                                           {"16-bit 4:2:0 multigrid", 2, YUV420}};
+
+template <typename T>
+static bool checkMultigridImage( const MultigridImage& multigrid ) {
+  std::vector<uint32_t> occupancyMap;
+  PCCImage<T, 3>        harmonic;
+  generate( g_goldenWidth, g_goldenHeight, g_goldenBlockSize, multigrid.format, occupancyMap, harmonic );
+  PCCImage<T, 3> image = harmonic;
+  pad( 2, occupancyMap, harmonic );
+  pad( 4, occupancyMap, image );
+  double maxDifference = 0;
+  double sumDifference = 0;
+  size_t count         = 0;
+  for ( size_t y = 0; y < g_goldenHeight; y++ ) {
+    for ( size_t x = 0; x < g_goldenWidth; x++ ) {
+      if ( occupancyMap[y * g_goldenWidth + x] == 0 ) {
+        for ( size_t c = 0; c < 3; c++ ) {
+          const double difference = std::abs( double( image.getValue( c, x, y ) ) - harmonic.getValue( c, x, y ) );
+          maxDifference           = ( std::max )( maxDifference, difference );
+          sumDifference += difference;
+          count++;
+        }
+      }
+    }
+  }
+  const double range          = ( std::numeric_limits<T>::max )();
+  const double meanDifference = sumDifference / ( std::max )( count, size_t( 1 ) );
+  printf( "  %-24s: max difference %8.3f mean difference %8.3f \n", multigrid.name, maxDifference, meanDifference );
+  return maxDifference <= g_multigridMaxDifference * range && meanDifference <= g_multigridMaxMeanDifference * range;
+}
+
+static size_t checkMultigridImages() {
+  size_t mismatchCount = 0;
+  for ( const auto& multigrid : g_multigridImages ) {
+    const bool within = multigrid.sampleSize == 1 ? checkMultigridImage<uint8_t>( multigrid )
+                                                  : checkMultigridImage<uint16_t>( multigrid );
+    mismatchCount += within ? 0 : 1;
+  }
+  printf( "multigrid images: %zu images %zu mismatches \n",
+          sizeof( g_multigridImages ) / sizeof( g_multigridImages[0] ), mismatchCount );
+  return mismatchCount;
+}
+
+//---------------------------------------------------------------------------
+// :: Throughput measurement
+
+template <typename T>
+static void measure( const size_t         width,
+                     const size_t         height,
+                     const size_t         blockSize,
+                     const PCCCOLORFORMAT format,
+                     const size_t         attributeBGFill,
+                     const size_t         iterationCount,
+                     const char*          name ) {
+  std::vector<uint32_t>         occupancyMap;
+  PCCImage<T, 3>                source;
+  std::chrono::duration<double> time{0.0};
+  generate( width, height, blockSize, format, occupancyMap, source );
+  for ( size_t iteration = 0; iteration < iterationCount; iteration++ ) {
+    PCCImage<T, 3> image = source;
+    auto           start = std::chrono::steady_clock::now();
+    pad( attributeBGFill, occupancyMap, image );
+    time += std::chrono::steady_clock::now() - start;
+  }
+  const double seconds = ( std::max )( time.count(), 1e-9 );
+  printf( "  %-24s: %10.3f s %10.3f Mpixels/s \n", name, time.count(),
+          static_cast<double>( width * height * iterationCount ) / seconds / 1e6 );
+}
+
+int benchmark( const size_t width,
+               const size_t height,
+               const size_t blockSize,
+               const size_t nbThread,
+               const size_t iterationCount ) {
+  size_t mismatchCount = 0;
+  // the kernels run in the arena of their caller, as in PCCEncoder
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( nbThread ) );
+  limited.execute( [&] {
+#endif
+    mismatchCount = checkGoldenImages() + checkMultigridImages();
+    printf( "throughput: %zux%zu images \n", width, height );
+    for ( const auto& golden : g_goldenImages ) {
+      if ( golden.sampleSize == 1 ) {
+        measure<uint8_t>( width, height, blockSize, golden.format, golden.attributeBGFill, iterationCount,
+                          golden.name );
+      } else {
+        measure<uint16_t>( width, height, blockSize, golden.format, golden.attributeBGFill, iterationCount,
+                           golden.name );
+      }
+    }
+    for ( const auto& multigrid : g_multigridImages ) {
+      if ( multigrid.sampleSize == 1 ) {
+        measure<uint8_t>( width, height, blockSize, multigrid.format, 4, iterationCount, multigrid.name );
+      } else {
+        measure<uint16_t>( width, height, blockSize, multigrid.format, 4, iterationCount, multigrid.name );
+      }
+    }
+#if defined( ENABLE_TBB )
+  } );
+#endif
+  if ( mismatchCount != 0 ) {
+    std::cout << "Error: " << mismatchCount << " padded images differ from the golden or harmonic images" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppPaddingBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl << std::endl;
+  size_t width          = 640;
+  size_t height         = 640;
+  size_t blockSize      = 16;
+  size_t nbThread       = 4;
+  size_t iterationCount = 1;
+  if ( !parseParameters( argc, argv, width, height, blockSize, nbThread, iterationCount ) ) { return -1; }
+  return benchmark( width, height, blockSize, nbThread, iterationCount );
+}
@@ -0,0 +1,192 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+#include <program_options_lite.h>
+#include <chrono>
+#include <functional>
+
+using namespace std;
+using namespace pcc;
+
+//---------------------------------------------------------------------------
+// :: Command line / config parsing
+
+bool parseParameters( int          argc,
+                      char*        argv[],
+                      std::string& srcPlyPath,
+                      std::string& dstPlyPath,
+                      size_t&      startFrame,
+                      size_t&      numFrames,
+                      size_t&      iterationCount ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+
+  // The definition of the program/config options, along with default values.
+  //
+  // NB: when updating the following tables:
+  //      (a) please keep to 80-columns for easier reading at a glance,
+  //      (b) do not vertically align values -- it breaks quickly
+  //
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+    ( "help", print_help, false,"This help text" )
+    ( "srcPlyPath",
+      srcPlyPath,
+      srcPlyPath,
+      "Input pointclouds. Multi-frame sequences may be represented by %04i" )
+    ( "dstPlyPath",
+      dstPlyPath,
+      dstPlyPath,
+      "Temporary output pointcloud, overwritten by each write" )
+    ( "startFrameNumber",
+      startFrame,
+      startFrame,
+      "First frame number in sequence" )
+    ( "frameCount",
+      numFrames,
+      numFrames,
+      "Number of frames" )
+    ( "iterationCount",
+      iterationCount,
+      iterationCount,
+      "Number of times each frame is read and written" )
+    ;
+  opts.addOptions();
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+
+  if ( argc == 1 || print_help || srcPlyPath.empty() ) {
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+  if ( dstPlyPath.empty() ) { dstPlyPath = "PccAppPlyBenchmark_tmp.ply"; }
+
+  printf( "parseParameters : \n" );
+  printf( "  srcPlyPath     = %s \n", srcPlyPath.c_str() );
+  printf( "  dstPlyPath     = %s \n", dstPlyPath.c_str() );
+  printf( "  startFrame     = %zu \n", startFrame );
+  printf( "  frameCount     = %zu \n", numFrames );
+  printf( "  iterationCount = %zu \n", iterationCount );
+  if ( err.is_errored ) { return false; }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: Throughput measurement
+
+struct PlyThroughput {
+  std::chrono::duration<double> time{0.0};
+  size_t                        pointCount = 0;
+  size_t                        byteCount  = 0;
+
+  void print( const char* name ) const {
+    const double seconds = ( std::max )( time.count(), 1e-9 );
+    printf( "  %-16s: %10.3f s %10.3f Mpoints/s %10.3f MB/s \n", name, time.count(), pointCount / seconds / 1e6,
+            byteCount / seconds / 1e6 );
+  }
+};
+
+static size_t getFileSize( const std::string& fileName ) {
+  std::ifstream file( fileName, std::ios::binary | std::ios::ate );
+  return file.is_open() ? static_cast<size_t>( file.tellg() ) : 0;
+}
+
+int benchmark( const std::string& srcPlyPath,
+               const std::string& dstPlyPath,
+               const size_t       startFrameNumber,
+               const size_t       frameCount,
+               const size_t       iterationCount ) {
+  PlyThroughput readSource;
+  PlyThroughput writeBinary;
+  PlyThroughput readBinary;
+  PlyThroughput writeAscii;
+  PlyThroughput readAscii;
+  // Times fct, then adds the point count and the size of fileName to the throughput.
+  auto measure = [&]( PlyThroughput& throughput, const std::string& fileName, const PCCPointSet3& pointSet,
+                      const std::function<bool()>& fct ) {
+    auto start = std::chrono::steady_clock::now();
+    if ( !fct() ) {
+      std::cout << "Error: can't process " << fileName << std::endl;
+      return false;
+    }
+    throughput.time += std::chrono::steady_clock::now() - start;
+    throughput.pointCount += pointSet.getPointCount();
+    throughput.byteCount += getFileSize( fileName );
+    return true;
+  };
+  for ( size_t frameNumber = startFrameNumber; frameNumber < startFrameNumber + frameCount; frameNumber++ ) {
+    char fileName[4096];
+    sprintf( fileName, srcPlyPath.c_str(), frameNumber );
+    for ( size_t iteration = 0; iteration < iterationCount; iteration++ ) {
+      PCCPointSet3 source;
+      PCCPointSet3 binary;
+      PCCPointSet3 ascii;
+      if ( !measure( readSource, fileName, source, [&] { return source.read( fileName, true ); } ) ||
+           !measure( writeBinary, dstPlyPath, source, [&] { return source.write( dstPlyPath, false ); } ) ||
+           !measure( readBinary, dstPlyPath, binary, [&] { return binary.read( dstPlyPath, true ); } ) ||
+           !measure( writeAscii, dstPlyPath, source, [&] { return source.write( dstPlyPath, true ); } ) ||
+           !measure( readAscii, dstPlyPath, ascii, [&] { return ascii.read( dstPlyPath, true ); } ) ) {
+        return -1;
+      }
+    }
+  }
+  removeFile( dstPlyPath );
+  printf( "Throughput: \n" );
+  readSource.print( "read source" );
+  writeBinary.print( "write binary" );
+  readBinary.print( "read binary" );
+  writeAscii.print( "write ascii" );
+  readAscii.print( "read ascii" );
+  return 0;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppPlyBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl << std::endl;
+  std::string srcPlyPath;
+  std::string dstPlyPath;
+  size_t      startFrameNumber = 0;
+  size_t      frameCount       = 1;
+  size_t      iterationCount   = 1;
+  if ( !parseParameters( argc, argv, srcPlyPath, dstPlyPath, startFrameNumber, frameCount, iterationCount ) ) {
+    return -1;
+  }
+  return benchmark( srcPlyPath, dstPlyPath, startFrameNumber, frameCount, iterationCount );
+}
@@ -161,6 +161,7 @@ class PCCBitstream {
   bool initialize( std::vector<uint8_t>& data );
   bool initialize( const PCCBitstream& bitstream );
   bool initialize( const std::string& compressedStreamPath );
+  bool initialize( std::ifstream& fin, uint64_t startByte, uint64_t bitstreamSize );
   void initialize( uint64_t capacity ) { data_.resize( capacity, 0 ); }
   void clear() {
     data_.clear();
@@ -192,19 +193,34 @@ class PCCBitstream {
 
   inline std::string readString() {
     while ( !byteAligned() ) { read( 1 ); }
+#ifdef BITSTREAM_TRACE
     std::string str;
     char        element = read( 8 );
     while ( element != 0x00 ) {
       str.push_back( element );
       element = read( 8 );
     }
+#else
+    const uint8_t* begin = data_.data() + ( std::min )( position_.bytes_, data_.size() );
+    const uint8_t* end   = data_.data() + data_.size();
+    const uint8_t* last  = static_cast<const uint8_t*>( memchr( begin, 0x00, end - begin ) );
+    std::string    str( reinterpret_cast<const char*>( begin ), ( last != nullptr ? last : end ) - begin );
+    position_.bytes_ += str.size() + 1;
+#endif
     return str;
   }
 
   inline void writeString( std::string str ) {
     while ( !byteAligned() ) { write( 0, 1 ); }
+#ifdef BITSTREAM_TRACE
     for ( auto& element : str ) { write( element, 8 ); }
     write( 0, 8 );
+#else
+    if ( position_.bytes_ + str.size() + 16 >= data_.size() ) { realloc( str.size() ); }
+    memcpy( data_.data() + position_.bytes_, str.data(), str.size() );
+    position_.bytes_ += str.size();
+    write( 0, 8 );
+#endif
   }
 
   inline uint32_t peekByteAt( uint64_t peekPos ) { return data_[peekPos]; }
@@ -268,13 +284,10 @@ class PCCBitstream {
     bool     traceStartingValue = trace_;
     trace_                      = false;
 #endif
-    uint32_t length = 1, temp = ++code;
-    while ( 1 != temp ) {
-      temp >>= 1;
-      length += 2;
-    }
-    write( 0, length >> 1 );
-    write( code, ( length + 1 ) >> 1 );
+    // code + 1 is written on 2 * floorLog2( code + 1 ) + 1 bits, the leading zeros then the value.
+    const uint32_t prefix = static_cast<uint32_t>( floorLog2( ++code ) );
+    write( 0, prefix, position_ );
+    write( code, prefix + 1, position_ );
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", orgCode );
@@ -286,17 +299,17 @@ class PCCBitstream {
     bool traceStartingValue = trace_;
     trace_                  = false;
 #endif
-    uint32_t value = 0, code = 0, length = 0;
-    code = read( 1 );
-    if ( 0 == code ) {
-      length = 0;
-      while ( !( code & 1 ) ) {
-        code = read( 1 );
-        length++;
-      }
-      value = read( length );
-      value += ( 1 << length ) - 1;
+    // The leading zeros are counted on the next 32 bits at once.
+    uint32_t length = 0, bits = peek( 32, position_ );
+    while ( bits == 0 && moreData() ) {
+      length += 32;
+      skip( 32, position_ );
+      bits = peek( 32, position_ );
     }
+    if ( bits != 0 ) { length += 31 - floorLog2( bits ); }
+    skip( length + 1, position_ );
+    uint32_t value = read( length, position_ );
+    value += ( 1 << length ) - 1;
 #ifdef BITSTREAM_TRACE
     trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", value );
@@ -349,31 +362,75 @@ class PCCBitstream {
 #endif
  private:
   inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
-  inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
-    uint32_t value = 0;
-    for ( size_t i = 0; i < bits; i++ ) {
-      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
+  // The bits are read and written a word at a time: the bytes holding the bits following pos are gathered in a
+  // 64-bit register, most significant byte first. The bytes past the end of data_ read as zero.
+  static inline uint64_t swapBytes( const uint64_t word ) {
+#if defined( __GNUC__ )
+    return __builtin_bswap64( word );
+#elif defined( _MSC_VER )
+    return _byteswap_uint64( word );
+#else
+    uint64_t swapped = 0;
+    for ( size_t i = 0; i < 8; i++ ) { swapped |= ( ( word >> ( 8 * i ) ) & 0xff ) << ( 56 - 8 * i ); }
+    return swapped;
+#endif
+  }
+
+  // The bitstream is big-endian: the words are swapped on little-endian hosts.
+  static inline uint64_t loadWord( const uint8_t* data ) {
+    uint64_t word;
+    memcpy( &word, data, sizeof( uint64_t ) );
+    return isLittleEndian() ? swapBytes( word ) : word;
+  }
+
+  static inline void storeWord( uint8_t* data, const uint64_t word ) {
+    const uint64_t value = isLittleEndian() ? swapBytes( word ) : word;
+    memcpy( data, &value, sizeof( uint64_t ) );
+  }
+
+  static inline bool isLittleEndian() {
+    const uint16_t value = 1;
+    uint8_t        byte;
+    memcpy( &byte, &value, 1 );
+    return byte == 1;
+  }
+
+  inline uint32_t peek( uint32_t bits, const PCCBistreamPosition& pos ) const {
+    if ( bits == 0 ) { return 0; }
+    if ( pos.bytes_ + 8 <= data_.size() ) {
+      return static_cast<uint32_t>( ( loadWord( data_.data() + pos.bytes_ ) << pos.bits_ ) >> ( 64 - bits ) );
     }
+    const size_t count     = ( pos.bits_ + bits + 7 ) >> 3;
+    const size_t available = pos.bytes_ < data_.size() ? ( std::min )( count, data_.size() - pos.bytes_ ) : 0;
+    uint64_t     word      = 0;
+    for ( size_t i = 0; i < available; i++ ) { word = ( word << 8 ) | data_[pos.bytes_ + i]; }
+    word <<= 8 * ( count - available );
+    return static_cast<uint32_t>( ( word >> ( 8 * count - pos.bits_ - bits ) ) & ( ( uint64_t( 1 ) << bits ) - 1 ) );
+  }
+
+  static inline void skip( uint32_t bits, PCCBistreamPosition& pos ) {
+    const uint64_t offset = pos.bits_ + static_cast<uint64_t>( bits );
+    pos.bytes_ += offset >> 3;
+    pos.bits_ = static_cast<uint8_t>( offset & 7 );
+  }
+
+  inline uint32_t read( uint32_t bits, PCCBistreamPosition& pos ) {
+    const uint32_t value = peek( bits, pos );
+    skip( bits, pos );
     return value;
   }
 
-  inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
+  inline void write( uint32_t value, uint32_t bits, PCCBistreamPosition& pos ) {
     if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
-    for ( size_t i = 0; i < bits; i++ ) {
-      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
+    if ( bits == 0 ) { return; }
+    const uint64_t word = ( value & ( ( uint64_t( 1 ) << bits ) - 1 ) ) << ( 64 - pos.bits_ - bits );
+    if ( pos.bytes_ + 8 <= data_.size() ) {
+      storeWord( data_.data() + pos.bytes_, loadWord( data_.data() + pos.bytes_ ) | word );
+    } else {
+      const size_t count = ( pos.bits_ + bits + 7 ) >> 3;
+      for ( size_t i = 0; i < count; i++ ) { data_[pos.bytes_ + i] |= static_cast<uint8_t>( word >> ( 56 - 8 * i ) ); }
     }
+    skip( bits, pos );
   }
 
   std::vector<uint8_t> data_;
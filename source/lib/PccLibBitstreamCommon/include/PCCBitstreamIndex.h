@@ -0,0 +1,92 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCC_BITSTREAM_BITSTREAMINDEX_H
+#define PCC_BITSTREAM_BITSTREAMINDEX_H
+
+#include "PCCBitstreamCommon.h"
+#include "PCCSampleStreamV3CUnit.h"
+
+namespace pcc {
+
+// Byte locations of the V3C units of a sample stream V3C bitstream (annex C), grouped by GOF. Each GOF starts with a
+// V3C parameter set unit. The index is built by scanning the sample stream headers without reading the V3C unit
+// payloads and can be stored in a side file, so that a GOF range can be loaded without parsing the preceding ones.
+class PCCBitstreamIndex {
+ public:
+  struct Unit {
+    V3CUnitType type_;
+    uint64_t    position_;  // first byte of the V3C unit in the bitstream
+    uint64_t    size_;
+  };
+  struct Gof {
+    size_t firstUnit_;
+    size_t unitCount_;
+    size_t frameCount_;  // 0 if unknown
+  };
+
+  PCCBitstreamIndex();
+  ~PCCBitstreamIndex();
+
+  bool build( const std::string& compressedStreamPath );
+  bool read( const std::string& indexPath );
+  bool write( const std::string& indexPath ) const;
+
+  // Loads the V3C units of the GOFs [gofIndex, gofIndex + gofCount), or only their VPS and AD units.
+  bool load( const std::string&   compressedStreamPath,
+             size_t               gofIndex,
+             size_t               gofCount,
+             SampleStreamV3CUnit& ssvu,
+             bool                 atlasOnly = false ) const;
+
+  size_t      getGofCount() const { return gofs_.size(); }
+  const Gof&  getGof( size_t index ) const { return gofs_[index]; }
+  size_t      getUnitCount() const { return units_.size(); }
+  const Unit& getUnit( size_t index ) const { return units_[index]; }
+  uint64_t    getStreamSize() const { return streamSize_; }
+  uint32_t    getSsvhUnitSizePrecisionBytesMinus1() const { return ssvhUnitSizePrecisionBytesMinus1_; }
+  size_t      getFirstFrameIndex( size_t gofIndex ) const;
+  size_t      getHeaderSize( size_t gofIndex, size_t gofCount ) const;
+  void        setFrameCount( size_t gofIndex, size_t frameCount ) { gofs_[gofIndex].frameCount_ = frameCount; }
+
+ private:
+  void createGofs();
+
+  std::vector<Unit> units_;
+  std::vector<Gof>  gofs_;
+  uint64_t          streamSize_;
+  uint32_t          ssvhUnitSizePrecisionBytesMinus1_;
+};
+
+};  // namespace pcc
+
+#endif  //~PCC_BITSTREAM_BITSTREAMINDEX_H
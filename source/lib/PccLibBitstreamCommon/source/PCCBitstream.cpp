@@ -77,6 +77,15 @@ bool PCCBitstream::initialize( const std::string& compressedStreamPath ) {
   return true;
 }
 
+bool PCCBitstream::initialize( std::ifstream& fin, uint64_t startByte, uint64_t bitstreamSize ) {
+  position_.bytes_ = 0;
+  position_.bits_  = 0;
+  initialize( bitstreamSize );
+  fin.seekg( startByte, std::ios::beg );
+  fin.read( reinterpret_cast<char*>( data_.data() ), bitstreamSize );
+  return static_cast<bool>( fin );
+}
+
 bool PCCBitstream::write( const std::string& compressedStreamPath ) {
   std::ofstream fout( compressedStreamPath, std::ios::binary );
   if ( !fout.is_open() ) { return false; }
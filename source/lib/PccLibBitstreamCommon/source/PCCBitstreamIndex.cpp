@@ -0,0 +1,155 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCBitstreamCommon.h"
+#include "PCCBitstream.h"
+#include "PCCBitstreamIndex.h"
+
+using namespace pcc;
+
+PCCBitstreamIndex::PCCBitstreamIndex() : streamSize_( 0 ), ssvhUnitSizePrecisionBytesMinus1_( 0 ) {}
+PCCBitstreamIndex::~PCCBitstreamIndex() = default;
+
+bool PCCBitstreamIndex::build( const std::string& compressedStreamPath ) {
+  units_.clear();
+  gofs_.clear();
+  std::ifstream fin( compressedStreamPath, std::ios::binary );
+  if ( !fin.is_open() ) { return false; }
+  fin.seekg( 0, std::ios::end );
+  streamSize_ = fin.tellg();
+  fin.seekg( 0, std::ios::beg );
+
+  // C.2.1 Sample stream V3C header
+  uint8_t header = 0;
+  if ( !fin.read( reinterpret_cast<char*>( &header ), 1 ) ) { return false; }
+  ssvhUnitSizePrecisionBytesMinus1_ = header >> 5;
+  const uint64_t precision          = ssvhUnitSizePrecisionBytesMinus1_ + 1;
+
+  // C.2.2 Sample stream V3C units: only the unit sizes and the first byte of the V3C unit headers are read
+  uint64_t position = 1;
+  while ( position < streamSize_ ) {
+    uint8_t bytes[9];
+    if ( position + precision + 1 > streamSize_ ) { return false; }
+    fin.seekg( position, std::ios::beg );
+    if ( !fin.read( reinterpret_cast<char*>( bytes ), precision + 1 ) ) { return false; }
+    Unit unit;
+    unit.size_ = 0;
+    for ( size_t i = 0; i < precision; i++ ) { unit.size_ = ( unit.size_ << 8 ) | bytes[i]; }
+    unit.type_     = static_cast<V3CUnitType>( bytes[precision] >> 3 );
+    unit.position_ = position + precision;
+    if ( unit.size_ == 0 || unit.position_ + unit.size_ > streamSize_ ) { return false; }
+    units_.push_back( unit );
+    position = unit.position_ + unit.size_;
+  }
+  createGofs();
+  return true;
+}
+
+bool PCCBitstreamIndex::read( const std::string& indexPath ) {
+  units_.clear();
+  gofs_.clear();
+  std::ifstream fin( indexPath, std::ios::in );
+  if ( !fin.is_open() ) { return false; }
+  size_t unitCount = 0;
+  fin >> ssvhUnitSizePrecisionBytesMinus1_ >> streamSize_ >> unitCount;
+  units_.resize( unitCount );
+  for ( auto& unit : units_ ) {
+    uint32_t type = 0;
+    fin >> type >> unit.position_ >> unit.size_;
+    unit.type_ = static_cast<V3CUnitType>( type );
+  }
+  createGofs();
+  for ( auto& gof : gofs_ ) { fin >> gof.frameCount_; }
+  if ( !fin ) {
+    units_.clear();
+    gofs_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool PCCBitstreamIndex::write( const std::string& indexPath ) const {
+  std::ofstream fout( indexPath, std::ios::out );
+  if ( !fout.is_open() ) { return false; }
+  fout << ssvhUnitSizePrecisionBytesMinus1_ << " " << streamSize_ << " " << units_.size() << std::endl;
+  for ( const auto& unit : units_ ) {
+    fout << static_cast<uint32_t>( unit.type_ ) << " " << unit.position_ << " " << unit.size_ << std::endl;
+  }
+  for ( const auto& gof : gofs_ ) { fout << gof.frameCount_ << std::endl; }
+  return static_cast<bool>( fout );
+}
+
+bool PCCBitstreamIndex::load( const std::string&   compressedStreamPath,
+                              size_t               gofIndex,
+                              size_t               gofCount,
+                              SampleStreamV3CUnit& ssvu,
+                              bool                 atlasOnly ) const {
+  if ( gofCount == 0 || gofIndex + gofCount > gofs_.size() ) { return false; }
+  std::ifstream fin( compressedStreamPath, std::ios::binary );
+  if ( !fin.is_open() ) { return false; }
+  fin.seekg( 0, std::ios::end );
+  if ( static_cast<uint64_t>( fin.tellg() ) != streamSize_ ) {
+    std::cerr << "The bitstream index does not match " << compressedStreamPath << std::endl;
+    return false;
+  }
+  ssvu.setSsvhUnitSizePrecisionBytesMinus1( ssvhUnitSizePrecisionBytesMinus1_ );
+  const auto& lastGof = gofs_[gofIndex + gofCount - 1];
+  for ( size_t i = gofs_[gofIndex].firstUnit_; i < lastGof.firstUnit_ + lastGof.unitCount_; i++ ) {
+    const auto& unit = units_[i];
+    if ( atlasOnly && unit.type_ != V3C_VPS && unit.type_ != V3C_AD ) { continue; }
+    auto& v3cUnit = ssvu.addV3CUnit();
+    v3cUnit.setSize( unit.size_ );
+    v3cUnit.setType( unit.type_ );
+    if ( !v3cUnit.getBitstream().initialize( fin, unit.position_, unit.size_ ) ) { return false; }
+  }
+  return true;
+}
+
+size_t PCCBitstreamIndex::getFirstFrameIndex( size_t gofIndex ) const {
+  size_t frameIndex = 0;
+  for ( size_t i = 0; i < gofIndex; i++ ) { frameIndex += gofs_[i].frameCount_; }
+  return frameIndex;
+}
+
+size_t PCCBitstreamIndex::getHeaderSize( size_t gofIndex, size_t gofCount ) const {
+  size_t unitCount = 0;
+  for ( size_t i = gofIndex; i < gofIndex + gofCount; i++ ) { unitCount += gofs_[i].unitCount_; }
+  return ( gofIndex == 0 ? 1 : 0 ) + unitCount * ( ssvhUnitSizePrecisionBytesMinus1_ + 1 );
+}
+
+void PCCBitstreamIndex::createGofs() {
+  gofs_.clear();
+  for ( size_t i = 0; i < units_.size(); i++ ) {
+    if ( gofs_.empty() || units_[i].type_ == V3C_VPS ) { gofs_.push_back( { i, 0, 0 } ); }
+    gofs_.back().unitCount_++;
+  }
+}
@@ -31,6 +31,15 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include "PCCInternalColorConverter.h"
+#include <functional>
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#endif
 
 using namespace pcc;
 
@@ -336,8 +345,355 @@ static std::vector<Filter420to444> g_filter420to444 = {
      {{-1.0, +5.0, -12.0, +24.0, -49.0, +161.0, +161.0, -49.0, +24.0, -12.0, +5.0, -1.0}, +128.0, 8.0},
      {{-2.0, +5.0, -10.0, +20.0, -43.0, +230.0, +75.0, -29.0, +14.0, -7.0, +3.0, 0.0}, +128.0, 8.0}}};
 
+// Vector types of the row kernels: AVX2 when the compiler targets it, SSE2 on any other x86-64 target
+// and the scalar loops otherwise.
+#if defined( __AVX2__ )
+#define PCC_COLOR_CONVERTER_SIMD
+typedef __m256d   PCCDoubles;
+typedef __m256    PCCFloats;
+static const int  g_doubleLanes = 4;
+static const int  g_floatLanes  = 8;
+static inline PCCDoubles loadDoubles( const float* src ) { return _mm256_cvtps_pd( _mm_loadu_ps( src ) ); }
+static inline void       storeDoubles( float* dst, const PCCDoubles v ) { _mm_storeu_ps( dst, _mm256_cvtpd_ps( v ) ); }
+static inline PCCDoubles setDoubles( const double v ) { return _mm256_set1_pd( v ); }
+static inline PCCDoubles addDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm256_add_pd( a, b ); }
+static inline PCCDoubles mulDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm256_mul_pd( a, b ); }
+static inline PCCDoubles minDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm256_min_pd( a, b ); }
+static inline PCCDoubles maxDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm256_max_pd( a, b ); }
+static inline PCCFloats  loadFloats( const float* src ) { return _mm256_loadu_ps( src ); }
+static inline void       storeFloats( float* dst, const PCCFloats v ) { _mm256_storeu_ps( dst, v ); }
+static inline PCCFloats  setFloats( const float v ) { return _mm256_set1_ps( v ); }
+static inline PCCFloats  addFloats( const PCCFloats a, const PCCFloats b ) { return _mm256_add_ps( a, b ); }
+static inline PCCFloats  mulFloats( const PCCFloats a, const PCCFloats b ) { return _mm256_mul_ps( a, b ); }
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#define PCC_COLOR_CONVERTER_SIMD
+typedef __m128d  PCCDoubles;
+typedef __m128   PCCFloats;
+static const int g_doubleLanes = 2;
+static const int g_floatLanes  = 4;
+static inline PCCDoubles loadDoubles( const float* src ) {
+  return _mm_cvtps_pd( _mm_castpd_ps( _mm_load_sd( reinterpret_cast<const double*>( src ) ) ) );
+}
+static inline void storeDoubles( float* dst, const PCCDoubles v ) {
+  _mm_store_sd( reinterpret_cast<double*>( dst ), _mm_castps_pd( _mm_cvtpd_ps( v ) ) );
+}
+static inline PCCDoubles setDoubles( const double v ) { return _mm_set1_pd( v ); }
+static inline PCCDoubles addDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm_add_pd( a, b ); }
+static inline PCCDoubles mulDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm_mul_pd( a, b ); }
+static inline PCCDoubles minDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm_min_pd( a, b ); }
+static inline PCCDoubles maxDoubles( const PCCDoubles a, const PCCDoubles b ) { return _mm_max_pd( a, b ); }
+static inline PCCFloats  loadFloats( const float* src ) { return _mm_loadu_ps( src ); }
+static inline void       storeFloats( float* dst, const PCCFloats v ) { _mm_storeu_ps( dst, v ); }
+static inline PCCFloats  setFloats( const float v ) { return _mm_set1_ps( v ); }
+static inline PCCFloats  addFloats( const PCCFloats a, const PCCFloats b ) { return _mm_add_ps( a, b ); }
+static inline PCCFloats  mulFloats( const PCCFloats a, const PCCFloats b ) { return _mm_mul_ps( a, b ); }
+#endif
+
+// Row kernels of the conversion engine. Each kernel evaluates the operations of the per-sample formulas
+// in the same order and precision, so the SIMD paths and the scalar fallback give identical values.
+static void filterRowsDouble( const float* const* rows,
+                              const double*       coefficients,
+                              const int           tapCount,
+                              const double        scale,
+                              const int           count,
+                              float*              dst ) {
+  int j = 0;
+#if defined( PCC_COLOR_CONVERTER_SIMD )
+  for ( ; j + g_doubleLanes <= count; j += g_doubleLanes ) {
+    PCCDoubles value = setDoubles( 0.0 );
+    for ( int k = 0; k < tapCount; k++ ) {
+      value = addDoubles( value, mulDoubles( setDoubles( coefficients[k] ), loadDoubles( rows[k] + j ) ) );
+    }
+    storeDoubles( dst + j, mulDoubles( addDoubles( value, setDoubles( 0.0 ) ), setDoubles( scale ) ) );
+  }
+#endif
+  for ( ; j < count; j++ ) {
+    double value = 0;
+    for ( int k = 0; k < tapCount; k++ ) { value += coefficients[k] * (double)rows[k][j]; }
+    dst[j] = (float)( ( value + 0.0 ) * scale );
+  }
+}
+
+static void filterRowsFloat( const float* const* rows,
+                             const float*        coefficients,
+                             const int           tapCount,
+                             const float         scale,
+                             const int           count,
+                             float*              dst ) {
+  int j = 0;
+#if defined( PCC_COLOR_CONVERTER_SIMD )
+  for ( ; j + g_floatLanes <= count; j += g_floatLanes ) {
+    PCCFloats value = setFloats( 0.f );
+    for ( int k = 0; k < tapCount; k++ ) {
+      value = addFloats( value, mulFloats( setFloats( coefficients[k] ), loadFloats( rows[k] + j ) ) );
+    }
+    storeFloats( dst + j, mulFloats( addFloats( value, setFloats( 0.f ) ), setFloats( scale ) ) );
+  }
+#endif
+  for ( ; j < count; j++ ) {
+    float value = 0;
+    for ( int k = 0; k < tapCount; k++ ) { value += coefficients[k] * rows[k][j]; }
+    dst[j] = ( value + 0.f ) * scale;
+  }
+}
+
+#if defined( PCC_COLOR_CONVERTER_SIMD )
+// a * x + b * y + c * z evaluated left to right, then clamped to [low, high]. A subtraction of a product
+// is computed as the addition of the product with the negated coefficient, which rounds identically.
+static inline PCCDoubles combineDoubles( const double     a,
+                                         const PCCDoubles x,
+                                         const double     b,
+                                         const PCCDoubles y,
+                                         const double     c,
+                                         const PCCDoubles z,
+                                         const double     low,
+                                         const double     high ) {
+  PCCDoubles value = addDoubles( mulDoubles( setDoubles( a ), x ), mulDoubles( setDoubles( b ), y ) );
+  value            = addDoubles( value, mulDoubles( setDoubles( c ), z ) );
+  return maxDoubles( minDoubles( value, setDoubles( high ) ), setDoubles( low ) );
+}
+#endif
+
+static void convertRGBToYUV( const float* R,
+                             const float* G,
+                             const float* B,
+                             const int    count,
+                             float*       Y,
+                             float*       U,
+                             float*       V ) {
+  int i = 0;
+#if defined( PCC_COLOR_CONVERTER_SIMD )
+  for ( ; i + g_doubleLanes <= count; i += g_doubleLanes ) {
+    const PCCDoubles r = loadDoubles( R + i ), g = loadDoubles( G + i ), b = loadDoubles( B + i );
+    storeDoubles( Y + i, combineDoubles( 0.212600, r, 0.715200, g, 0.072200, b, 0.0, 1.0 ) );
+    storeDoubles( U + i, combineDoubles( -0.114572, r, -0.385428, g, 0.500000, b, -0.5, 0.5 ) );
+    storeDoubles( V + i, combineDoubles( 0.500000, r, -0.454153, g, -0.045847, b, -0.5, 0.5 ) );
+  }
+#endif
+  for ( ; i < count; i++ ) {
+    Y[i] = (float)( ( std::min )( ( std::max )( 0.212600 * R[i] + 0.715200 * G[i] + 0.072200 * B[i], 0.0 ), 1.0 ) );
+    U[i] = (float)( ( std::min )( ( std::max )( -0.114572 * R[i] - 0.385428 * G[i] + 0.500000 * B[i], -0.5 ), 0.5 ) );
+    V[i] = (float)( ( std::min )( ( std::max )( 0.500000 * R[i] - 0.454153 * G[i] - 0.045847 * B[i], -0.5 ), 0.5 ) );
+  }
+}
+
+static void convertYUVToRGB( const float* Y,
+                             const float* U,
+                             const float* V,
+                             const int    count,
+                             float*       R,
+                             float*       G,
+                             float*       B ) {
+  int i = 0;
+#if defined( PCC_COLOR_CONVERTER_SIMD )
+  for ( ; i + g_doubleLanes <= count; i += g_doubleLanes ) {
+    const PCCDoubles y = loadDoubles( Y + i ), u = loadDoubles( U + i ), v = loadDoubles( V + i );
+    const PCCDoubles r = addDoubles( y, mulDoubles( setDoubles( 1.57480 ), v ) );
+    const PCCDoubles b = addDoubles( y, mulDoubles( setDoubles( 1.85563 ), u ) );
+    storeDoubles( R + i, maxDoubles( minDoubles( r, setDoubles( 1.0 ) ), setDoubles( 0.0 ) ) );
+    storeDoubles( G + i, combineDoubles( 1.0, y, -0.18733, u, -0.46813, v, 0.0, 1.0 ) );
+    storeDoubles( B + i, maxDoubles( minDoubles( b, setDoubles( 1.0 ) ), setDoubles( 0.0 ) ) );
+  }
+#endif
+  for ( ; i < count; i++ ) {
+    R[i] = (float)( ( std::min )( ( std::max )( Y[i] + 1.57480 * V[i], 0.0 ), 1.0 ) );
+    G[i] = (float)( ( std::min )( ( std::max )( Y[i] - 0.18733 * U[i] - 0.46813 * V[i], 0.0 ), 1.0 ) );
+    B[i] = (float)( ( std::min )( ( std::max )( Y[i] + 1.85563 * U[i], 0.0 ), 1.0 ) );
+  }
+}
+
+// Ring of float rows produced on demand. A filter window reads consecutive rows, so a ring holding as
+// many rows as the longest filter keeps the whole window resident.
+class PCCRowCache {
+ public:
+  PCCRowCache( const int width, const int height, const int rowCount, std::function<void( int, float* )> produce ) :
+      width_( width ),
+      height_( height ),
+      lastRow_( -1 ),
+      rows_( rowCount, -1 ),
+      data_( (size_t)width * rowCount ),
+      produce_( produce ) {}
+
+  const float* get( int row ) {
+    row          = ( std::min )( ( std::max )( row, 0 ), height_ - 1 );
+    size_t slot  = (size_t)row % rows_.size();
+    float* data  = data_.data() + slot * width_;
+    if ( rows_[slot] != row ) {
+      produce_( row, data );
+      rows_[slot] = row;
+      lastRow_    = ( std::max )( lastRow_, row );
+    }
+    return data;
+  }
+  int getLastRow() const { return lastRow_; }
+
+ private:
+  int                                 width_;
+  int                                 height_;
+  int                                 lastRow_;
+  std::vector<int>                    rows_;
+  std::vector<float>                  data_;
+  std::function<void( int, float* )> produce_;
+};
+
+// 4:4:4 to 4:2:0 filtering of the two chroma planes, one output row at a time. The source rows are
+// requested in raster order and only their horizontally filtered halves are kept.
+class PCCChromaDownsampler {
+ public:
+  PCCChromaDownsampler( const Filter444to420&                       filter,
+                        const int                                   width,
+                        const int                                   height,
+                        std::function<void( int, float*, float* )> produce ) :
+      width_( width ),
+      height_( height ),
+      widthOut_( width / 2 ),
+      horizontal_( filter.horizontal_.data_.begin(), filter.horizontal_.data_.end() ),
+      vertical_( filter.vertical_.data_.begin(), filter.vertical_.data_.end() ),
+      horizontalScale_( 1.0f / ( (float)( 1 << ( (int)filter.horizontal_.shift_ ) ) ) ),
+      verticalScale_( 1.0f / ( (float)( 1 << ( (int)filter.vertical_.shift_ ) ) ) ),
+      u_( width ),
+      v_( width ),
+      even_( widthOut_ + horizontal_.size() / 2 + 1 ),
+      odd_( widthOut_ + horizontal_.size() / 2 + 1 ),
+      output_( 2 * widthOut_ ),
+      horizontalRows_( horizontal_.size() ),
+      verticalRows_( vertical_.size() ),
+      produce_( produce ),
+      rows_( 2 * widthOut_, height, (int)vertical_.size(), [this]( int row, float* dst ) { filterRow( row, dst ); } ) {}
+
+  // Returns the U row followed by the V row of the output row.
+  const float* getRow( const int row ) {
+    const int position = int( vertical_.size() - 1 ) >> 1;
+    for ( size_t k = 0; k < vertical_.size(); k++ ) { verticalRows_[k] = rows_.get( 2 * row + (int)k - position ); }
+    filterRowsDouble( verticalRows_.data(), vertical_.data(), (int)vertical_.size(), verticalScale_, 2 * widthOut_,
+                      output_.data() );
+    return output_.data();
+  }
+
+  // Produces the source rows the chroma filter did not reach.
+  void flush() {
+    for ( int row = rows_.getLastRow() + 1; row < height_; row++ ) { rows_.get( row ); }
+  }
+
+ private:
+  void filterRow( const int row, float* dst ) {
+    produce_( row, u_.data(), v_.data() );
+    filterHorizontal( u_.data(), dst );
+    filterHorizontal( v_.data(), dst + widthOut_ );
+  }
+
+  void filterHorizontal( const float* src, float* dst ) {
+    const int taps     = (int)horizontal_.size();
+    const int position = ( taps - 1 ) >> 1;
+    for ( int n = 0; n < (int)even_.size(); n++ ) {
+      even_[n] = src[( std::min )( ( std::max )( 2 * n - position, 0 ), width_ - 1 )];
+      odd_[n]  = src[( std::min )( ( std::max )( 2 * n + 1 - position, 0 ), width_ - 1 )];
+    }
+    for ( int k = 0; k < taps; k++ ) { horizontalRows_[k] = ( ( k & 1 ) ? odd_ : even_ ).data() + ( k >> 1 ); }
+    filterRowsDouble( horizontalRows_.data(), horizontal_.data(), taps, horizontalScale_, widthOut_, dst );
+  }
+
+  int                                         width_;
+  int                                         height_;
+  int                                         widthOut_;
+  std::vector<double>                         horizontal_;
+  std::vector<double>                         vertical_;
+  double                                      horizontalScale_;
+  double                                      verticalScale_;
+  std::vector<float>                          u_;
+  std::vector<float>                          v_;
+  std::vector<float>                          even_;
+  std::vector<float>                          odd_;
+  std::vector<float>                          output_;
+  std::vector<const float*>                   horizontalRows_;
+  std::vector<const float*>                   verticalRows_;
+  std::function<void( int, float*, float* )> produce_;
+  PCCRowCache                                 rows_;
+};
+
+// 4:2:0 to 4:4:4 filtering of one plane, one output row at a time. The source rows are requested in
+// raster order and converted on the fly, the output row holds one extra copy of its last sample.
+class PCCChromaUpsampler {
+ public:
+  PCCChromaUpsampler( const Filter420to444&               filter,
+                      const int                           width,
+                      const int                           height,
+                      std::function<void( int, float* )> produce ) :
+      width_( width ),
+      filters_{filter.vertical0_.data_, filter.vertical1_.data_, filter.horizontal0_.data_, filter.horizontal1_.data_},
+      scales_{1.0f / ( (float)( 1 << ( (int)filter.vertical0_.shift_ ) ) ),
+              1.0f / ( (float)( 1 << ( (int)filter.vertical1_.shift_ ) ) ),
+              1.0f / ( (float)( 1 << ( (int)filter.horizontal0_.shift_ ) ) ),
+              1.0f / ( (float)( 1 << ( (int)filter.horizontal1_.shift_ ) ) )},
+      padding_( int( ( std::max )( filters_[2].size(), filters_[3].size() ) + 1 ) >> 1 ),
+      temp_( width ),
+      padded_( width + 2 * padding_ + 2 ),
+      even_( width ),
+      odd_( width ),
+      output_( 2 * width + 1 ),
+      sources_( ( std::max )( ( std::max )( filters_[0].size(), filters_[1].size() ),
+                              ( std::max )( filters_[2].size(), filters_[3].size() ) ) ),
+      rows_( width, height, int( ( std::max )( filters_[0].size(), filters_[1].size() ) ), produce ) {}
+
+  const float* getRow( const int row ) {
+    filterVertical( row & 1, ( row >> 1 ) + ( row & 1 ) );
+    for ( int m = 0; m < (int)padded_.size(); m++ ) {
+      padded_[m] = temp_[( std::min )( ( std::max )( m - padding_, 0 ), width_ - 1 )];
+    }
+    filterHorizontal( 0, even_.data() );
+    filterHorizontal( 1, odd_.data() );
+    for ( int j = 0; j < width_; j++ ) {
+      output_[2 * j]     = even_[j];
+      output_[2 * j + 1] = odd_[j];
+    }
+    output_[2 * width_] = output_[2 * width_ - 1];
+    return output_.data();
+  }
+
+ private:
+  void filterVertical( const int phase, const int row ) {
+    const std::vector<float>& filter   = filters_[phase];
+    const int                 position = int( filter.size() + 1 ) >> 1;
+    for ( size_t k = 0; k < filter.size(); k++ ) { sources_[k] = rows_.get( row + (int)k - position ); }
+    filterRowsFloat( sources_.data(), filter.data(), (int)filter.size(), scales_[phase], width_, temp_.data() );
+  }
+
+  void filterHorizontal( const int phase, float* dst ) {
+    const std::vector<float>& filter   = filters_[2 + phase];
+    const int                 position = int( filter.size() + 1 ) >> 1;
+    for ( size_t k = 0; k < filter.size(); k++ ) {
+      sources_[k] = padded_.data() + padding_ + phase + (int)k - position;
+    }
+    filterRowsFloat( sources_.data(), filter.data(), (int)filter.size(), scales_[2 + phase], width_, dst );
+  }
+
+  int                       width_;
+  std::vector<float>        filters_[4];
+  float                     scales_[4];
+  int                       padding_;
+  std::vector<float>        temp_;
+  std::vector<float>        padded_;
+  std::vector<float>        even_;
+  std::vector<float>        odd_;
+  std::vector<float>        output_;
+  std::vector<const float*> sources_;
+  PCCRowCache               rows_;
+};
+
+// The frames of a video are independent and are converted concurrently by at most nbThread threads.
+static void convertFrames( const size_t                              frameCount,
+                           const size_t                              nbThread,
+                           const std::function<void( const size_t )>& convertFrame ) {
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( nbThread ) );
+  limited.execute( [&] { tbb::parallel_for( size_t( 0 ), frameCount, convertFrame ); } );
+#else
+  for ( size_t i = 0; i < frameCount; i++ ) { convertFrame( i ); }
+#endif
+}
+
 template <typename T>
-PCCInternalColorConverter<T>::PCCInternalColorConverter() {}
+PCCInternalColorConverter<T>::PCCInternalColorConverter( size_t nbThread ) : nbThread_( nbThread ) {}
 
 template <typename T>
 PCCInternalColorConverter<T>::~PCCInternalColorConverter() {}
@@ -398,9 +754,8 @@ void PCCInternalColorConverter<T>::convertRGB44ToYUV420( PCCVideo<T, 3>& videoSr
                                                          size_t          nbyte,
                                                          size_t          filter ) {
   videoDst.resize( videoSrc.getFrameCount() );
-  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
-    convertRGB44ToYUV420( videoSrc[i], videoDst[i], nbyte, filter );
-  }
+  convertFrames( videoSrc.getFrameCount(), nbThread_,
+                 [&]( const size_t i ) { convertRGB44ToYUV420( videoSrc[i], videoDst[i], nbyte, filter ); } );
 }
 
 template <typename T>
@@ -411,16 +766,25 @@ void PCCInternalColorConverter<T>::convertRGB44ToYUV420( PCCImage<T, 3>& imageSr
   int width  = (int)imageSrc.getWidth();
   int height = (int)imageSrc.getHeight();
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV420 );
-  std::vector<float> RGB444[3], YUV444[3], YUV420[3];
-  RGBtoFloatRGB( imageSrc[0], RGB444[0], nbyte );
-  RGBtoFloatRGB( imageSrc[1], RGB444[1], nbyte );
-  RGBtoFloatRGB( imageSrc[2], RGB444[2], nbyte );
-  convertRGBToYUV( RGB444[0], RGB444[1], RGB444[2], YUV444[0], YUV444[1], YUV444[2] );
-  downsampling( YUV444[1], YUV420[1], width, height, nbyte == 1 ? 255 : 1023, filter );
-  downsampling( YUV444[2], YUV420[2], width, height, nbyte == 1 ? 255 : 1023, filter );
-  floatYUVToYUV( YUV444[0], imageDst[0], 0, nbyte );
-  floatYUVToYUV( YUV420[1], imageDst[1], 1, nbyte );
-  floatYUVToYUV( YUV420[2], imageDst[2], 1, nbyte );
+  int widthChroma  = width / 2;
+  int heightChroma = height / 2;
+  imageDst[1].resize( widthChroma * heightChroma );
+  imageDst[2].resize( widthChroma * heightChroma );
+  if ( width == 0 || height == 0 ) { return; }
+  std::vector<float>   RGB444( 3 * width ), Y444( width );
+  PCCChromaDownsampler downsampler( g_filter444to420[filter], width, height, [&]( int row, float* U, float* V ) {
+    for ( size_t c = 0; c < 3; c++ ) {
+      RGBtoFloatRGB( imageSrc[c].data() + row * width, width, &RGB444[c * width], nbyte );
+    }
+    convertRGBToYUV( &RGB444[0], &RGB444[width], &RGB444[2 * width], width, Y444.data(), U, V );
+    floatYUVToYUV( Y444.data(), width, imageDst[0].data() + row * width, 0, nbyte );
+  } );
+  for ( int i = 0; i < heightChroma; i++ ) {
+    const float* UV420 = downsampler.getRow( i );
+    floatYUVToYUV( UV420, widthChroma, imageDst[1].data() + i * widthChroma, 1, nbyte );
+    floatYUVToYUV( UV420 + widthChroma, widthChroma, imageDst[2].data() + i * widthChroma, 1, nbyte );
+  }
+  downsampler.flush();
 }
 
 template <typename T>
@@ -429,9 +793,8 @@ void PCCInternalColorConverter<T>::convertRGB44ToYUV444( PCCVideo<T, 3>& videoSr
                                                          size_t          nbyte,
                                                          size_t          filter ) {
   videoDst.resize( videoSrc.getFrameCount() );
-  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
-    convertRGB44ToYUV444( videoSrc[i], videoDst[i], nbyte, filter );
-  }
+  convertFrames( videoSrc.getFrameCount(), nbThread_,
+                 [&]( const size_t i ) { convertRGB44ToYUV444( videoSrc[i], videoDst[i], nbyte, filter ); } );
 }
 
 template <typename T>
@@ -442,14 +805,17 @@ void PCCInternalColorConverter<T>::convertRGB44ToYUV444( PCCImage<T, 3>& imageSr
   int width  = (int)imageSrc.getWidth();
   int height = (int)imageSrc.getHeight();
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV444 );
-  std::vector<float> RGB444[3], YUV444[3];
-  RGBtoFloatRGB( imageSrc[0], RGB444[0], nbyte );
-  RGBtoFloatRGB( imageSrc[1], RGB444[1], nbyte );
-  RGBtoFloatRGB( imageSrc[2], RGB444[2], nbyte );
-  convertRGBToYUV( RGB444[0], RGB444[1], RGB444[2], YUV444[0], YUV444[1], YUV444[2] );
-  floatYUVToYUV( YUV444[0], imageDst[0], 0, nbyte );
-  floatYUVToYUV( YUV444[1], imageDst[1], 1, nbyte );
-  floatYUVToYUV( YUV444[2], imageDst[2], 1, nbyte );
+  std::vector<float> RGB444( 3 * width ), YUV444( 3 * width );
+  for ( int row = 0; row < height; row++ ) {
+    for ( size_t c = 0; c < 3; c++ ) {
+      RGBtoFloatRGB( imageSrc[c].data() + row * width, width, &RGB444[c * width], nbyte );
+    }
+    convertRGBToYUV( &RGB444[0], &RGB444[width], &RGB444[2 * width], width, &YUV444[0], &YUV444[width],
+                     &YUV444[2 * width] );
+    for ( size_t c = 0; c < 3; c++ ) {
+      floatYUVToYUV( &YUV444[c * width], width, imageDst[c].data() + row * width, c > 0, nbyte );
+    }
+  }
 }
 
 template <typename T>
@@ -458,9 +824,8 @@ void PCCInternalColorConverter<T>::convertYUV420ToYUV444( PCCVideo<T, 3>& videoS
                                                           size_t          nbyte,
                                                           size_t          filter ) {
   videoDst.resize( videoSrc.getFrameCount() );
-  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
-    convertYUV420ToYUV444( videoSrc[i], videoDst[i], nbyte, filter );
-  }
+  convertFrames( videoSrc.getFrameCount(), nbThread_,
+                 [&]( const size_t i ) { convertYUV420ToYUV444( videoSrc[i], videoDst[i], nbyte, filter ); } );
 }
 
 template <typename T>
@@ -471,17 +836,23 @@ void PCCInternalColorConverter<T>::convertYUV420ToYUV444( PCCImage<T, 3>& imageS
   int width  = (int)imageSrc.getWidth();
   int height = (int)imageSrc.getHeight();
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::YUV444 );
-  size_t             widthChroma  = width / 2;
-  size_t             heightChroma = height / 2;
-  std::vector<float> YUV444[3], YUV420[3];
-  YUVtoFloatYUV( imageSrc[0], YUV420[0], 0, nbyte );
-  YUVtoFloatYUV( imageSrc[1], YUV420[1], 1, nbyte );
-  YUVtoFloatYUV( imageSrc[2], YUV420[2], 1, nbyte );
-  upsampling( YUV420[1], YUV444[1], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  upsampling( YUV420[2], YUV444[2], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  floatYUVToYUV( YUV420[0], imageDst[0], 0, 2 );
-  floatYUVToYUV( YUV444[1], imageDst[1], 1, 2 );
-  floatYUVToYUV( YUV444[2], imageDst[2], 1, 2 );
+  int                widthChroma  = width / 2;
+  int                heightChroma = height / 2;
+  std::vector<float> Y420( width );
+  for ( int row = 0; row < height; row++ ) {
+    YUVtoFloatYUV( imageSrc[0].data() + row * width, width, Y420.data(), 0, nbyte );
+    floatYUVToYUV( Y420.data(), width, imageDst[0].data() + row * width, 0, 2 );
+  }
+  for ( size_t c = 1; c < 3; c++ ) {
+    imageDst[c].resize( 4 * widthChroma * heightChroma );
+    if ( widthChroma == 0 ) { continue; }
+    PCCChromaUpsampler upsampler( g_filter420to444[filter], widthChroma, heightChroma, [&]( int row, float* dst ) {
+      YUVtoFloatYUV( imageSrc[c].data() + row * widthChroma, widthChroma, dst, 1, nbyte );
+    } );
+    for ( int row = 0; row < 2 * heightChroma; row++ ) {
+      floatYUVToYUV( upsampler.getRow( row ), 2 * widthChroma, imageDst[c].data() + row * 2 * widthChroma, 1, 2 );
+    }
+  }
 }
 
 template <typename T>
@@ -490,9 +861,8 @@ void PCCInternalColorConverter<T>::convertYUV420ToRGB444( PCCVideo<T, 3>& videoS
                                                           size_t          nbyte,
                                                           size_t          filter ) {
   videoDst.resize( videoSrc.getFrameCount() );
-  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
-    convertYUV420ToRGB444( videoSrc[i], videoDst[i], nbyte, filter );
-  }
+  convertFrames( videoSrc.getFrameCount(), nbThread_,
+                 [&]( const size_t i ) { convertYUV420ToRGB444( videoSrc[i], videoDst[i], nbyte, filter ); } );
 }
 
 template <typename T>
@@ -505,18 +875,28 @@ void PCCInternalColorConverter<T>::convertYUV420ToRGB444( PCCImage<T, 3>& imageS
   int width  = (int)imageSrc.getWidth();
   int height = (int)imageSrc.getHeight();
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::RGB444 );
-  size_t             widthChroma  = width / 2;
-  size_t             heightChroma = height / 2;
-  std::vector<float> YUV444[3], YUV420[3], RGB444[3];
-  YUVtoFloatYUV( imageSrc[0], YUV420[0], 0, nbyte );
-  YUVtoFloatYUV( imageSrc[1], YUV420[1], 1, nbyte );
-  YUVtoFloatYUV( imageSrc[2], YUV420[2], 1, nbyte );
-  upsampling( YUV420[1], YUV444[1], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  upsampling( YUV420[2], YUV444[2], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-  convertYUVToRGB( YUV420[0], YUV444[1], YUV444[2], RGB444[0], RGB444[1], RGB444[2] );
-  floatRGBToRGB( RGB444[0], imageDst[0], nbyte );
-  floatRGBToRGB( RGB444[1], imageDst[1], nbyte );
-  floatRGBToRGB( RGB444[2], imageDst[2], nbyte );
+  int widthChroma  = width / 2;
+  int heightChroma = height / 2;
+  if ( widthChroma == 0 || heightChroma == 0 ) { return; }
+  std::vector<float> Y444( width ), RGB444( 3 * width );
+  PCCChromaUpsampler upsamplerU( g_filter420to444[filter], widthChroma, heightChroma, [&]( int row, float* dst ) {
+    YUVtoFloatYUV( imageSrc[1].data() + row * widthChroma, widthChroma, dst, 1, nbyte );
+  } );
+  PCCChromaUpsampler upsamplerV( g_filter420to444[filter], widthChroma, heightChroma, [&]( int row, float* dst ) {
+    YUVtoFloatYUV( imageSrc[2].data() + row * widthChroma, widthChroma, dst, 1, nbyte );
+  } );
+  const float *U444 = nullptr, *V444 = nullptr;
+  for ( int row = 0; row < height; row++ ) {
+    if ( row < 2 * heightChroma ) {
+      U444 = upsamplerU.getRow( row );
+      V444 = upsamplerV.getRow( row );
+    }
+    YUVtoFloatYUV( imageSrc[0].data() + row * width, width, Y444.data(), 0, nbyte );
+    convertYUVToRGB( Y444.data(), U444, V444, width, &RGB444[0], &RGB444[width], &RGB444[2 * width] );
+    for ( size_t c = 0; c < 3; c++ ) {
+      floatRGBToRGB( &RGB444[c * width], width, imageDst[c].data() + row * width, nbyte );
+    }
+  }
 }
 
 template <typename T>
@@ -525,9 +905,8 @@ void PCCInternalColorConverter<T>::convertYUV444ToRGB444( PCCVideo<T, 3>& videoS
                                                           size_t          nbyte,
                                                           size_t          filter ) {
   videoDst.resize( videoSrc.getFrameCount() );
-  for ( size_t i = 0; i < videoSrc.getFrameCount(); i++ ) {
-    convertYUV444ToRGB444( videoSrc[i], videoDst[i], nbyte, filter );
-  }
+  convertFrames( videoSrc.getFrameCount(), nbThread_,
+                 [&]( const size_t i ) { convertYUV444ToRGB444( videoSrc[i], videoDst[i], nbyte, filter ); } );
 }
 
 template <typename T>
@@ -540,183 +919,92 @@ void PCCInternalColorConverter<T>::convertYUV444ToRGB444( PCCImage<T, 3>& imageS
   int width  = (int)imageSrc.getWidth();
   int height = (int)imageSrc.getHeight();
   imageDst.resize( width, height, pcc::PCCCOLORFORMAT::RGB444 );
-  std::vector<float> YUV444[3], RGB444[3];
-  YUVtoFloatYUV( imageSrc[0], YUV444[0], 0, nbyte );
-  YUVtoFloatYUV( imageSrc[1], YUV444[1], 1, nbyte );
-  YUVtoFloatYUV( imageSrc[2], YUV444[2], 1, nbyte );
-  convertYUVToRGB( YUV444[0], YUV444[1], YUV444[2], RGB444[0], RGB444[1], RGB444[2] );
-  floatRGBToRGB( RGB444[0], imageDst[0], nbyte );
-  floatRGBToRGB( RGB444[1], imageDst[1], nbyte );
-  floatRGBToRGB( RGB444[2], imageDst[2], nbyte );
+  std::vector<float> YUV444( 3 * width ), RGB444( 3 * width );
+  for ( int row = 0; row < height; row++ ) {
+    for ( size_t c = 0; c < 3; c++ ) {
+      YUVtoFloatYUV( imageSrc[c].data() + row * width, width, &YUV444[c * width], c > 0, nbyte );
+    }
+    convertYUVToRGB( &YUV444[0], &YUV444[width], &YUV444[2 * width], width, &RGB444[0], &RGB444[width],
+                     &RGB444[2 * width] );
+    for ( size_t c = 0; c < 3; c++ ) {
+      floatRGBToRGB( &RGB444[c * width], width, imageDst[c].data() + row * width, nbyte );
+    }
+  }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::RGBtoFloatRGB( const std::vector<T>& src,
-                                                  std::vector<float>&   dst,
-                                                  const size_t          nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
+void PCCInternalColorConverter<T>::RGBtoFloatRGB( const T*     src,
+                                                  const int    count,
+                                                  float*       dst,
+                                                  const size_t nbyte ) const {
   float offset = nbyte == 1 ? 255.f : 1023.f;
-  for ( size_t i = 0; i < count; i++ ) { dst[i] = (float)src[i] / offset; }
+  for ( int i = 0; i < count; i++ ) { dst[i] = (float)src[i] / offset; }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::convertRGBToYUV( const std::vector<float>& R,
-                                                    const std::vector<float>& G,
-                                                    const std::vector<float>& B,
-                                                    std::vector<float>&       Y,
-                                                    std::vector<float>&       U,
-                                                    std::vector<float>&       V ) const {
-  size_t count = R.size();
-  Y.resize( count );
-  U.resize( count );
-  V.resize( count );
-  for ( size_t i = 0; i < count; i++ ) {
-    Y[i] = (float)( (double)clamp( 0.212600 * R[i] + 0.715200 * G[i] + 0.072200 * B[i], 0.0, 1.0 ) );
-    U[i] = (float)( (double)clamp( -0.114572 * R[i] - 0.385428 * G[i] + 0.500000 * B[i], -0.5, 0.5 ) );
-    V[i] = (float)( (double)clamp( 0.500000 * R[i] - 0.454153 * G[i] - 0.045847 * B[i], -0.5, 0.5 ) );
-  }
-}
-
-template <typename T>
-void PCCInternalColorConverter<T>::floatYUVToYUV( const std::vector<float>& src,
-                                                  std::vector<T>&           dst,
-                                                  const bool                chroma,
-                                                  const size_t              nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
+void PCCInternalColorConverter<T>::floatYUVToYUV( const float* src,
+                                                  const int    count,
+                                                  T*           dst,
+                                                  const bool   chroma,
+                                                  const size_t nbyte ) const {
   double offset = chroma ? nbyte == 1 ? 128. : 32768. : 0;
   double scale  = nbyte == 1 ? 255. : 65535.;
-  for ( size_t i = 0; i < count; i++ ) {
+  for ( int i = 0; i < count; i++ ) {
     dst[i] = static_cast<T>( fClip( std::round( (float)( scale * (double)src[i] + offset ) ), 0.f, (float)scale ) );
   }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::YUVtoFloatYUV( const std::vector<T>& src,
-                                                  std::vector<float>&   dst,
-                                                  const bool            chroma,
-                                                  const size_t          nbBytes ) const {
-  size_t count = src.size();
-  dst.resize( count );
+void PCCInternalColorConverter<T>::YUVtoFloatYUV( const T*     src,
+                                                  const int    count,
+                                                  float*       dst,
+                                                  const bool   chroma,
+                                                  const size_t nbBytes ) const {
   float    minV   = chroma ? -0.5f : 0.f;
   float    maxV   = chroma ? 0.5f : 1.f;
   uint16_t offset = chroma ? nbBytes == 1 ? 128 : 512 : 0;
   double   scale  = nbBytes == 1 ? 255. : 1023.;
   double   weight = 1.0 / scale;
-  for ( size_t i = 0; i < count; i++ ) {
-    dst[i] = clamp( (float)( weight * (double)( src[i] - offset ) ), minV, maxV );
-  }
-}
-
-template <typename T>
-void PCCInternalColorConverter<T>::convertYUVToRGB( const std::vector<float>& Y,
-                                                    const std::vector<float>& U,
-                                                    const std::vector<float>& V,
-                                                    std::vector<float>&       R,
-                                                    std::vector<float>&       G,
-                                                    std::vector<float>&       B ) const {
-  size_t count = Y.size();
-  R.resize( count );
-  G.resize( count );
-  B.resize( count );
-  for ( size_t i = 0; i < count; i++ ) {
-    R[i] = (float)( (double)clamp( Y[i] + 1.57480 * V[i], 0.0, 1.0 ) );
-    G[i] = (float)( (double)clamp( Y[i] - 0.18733 * U[i] - 0.46813 * V[i], 0.0, 1.0 ) );
-    B[i] = (float)( (double)clamp( Y[i] + 1.85563 * U[i], 0.0, 1.0 ) );
-  }
+  for ( int i = 0; i < count; i++ ) { dst[i] = clamp( (float)( weight * (double)( src[i] - offset ) ), minV, maxV ); }
 }
 
 template <typename T>
-void PCCInternalColorConverter<T>::floatRGBToRGB( const std::vector<float>& src,
-                                                  std::vector<T>&           dst,
-                                                  const size_t              nbyte ) const {
-  size_t count = src.size();
-  dst.resize( count );
+void PCCInternalColorConverter<T>::floatRGBToRGB( const float* src,
+                                                  const int    count,
+                                                  T*           dst,
+                                                  const size_t nbyte ) const {
   float scale = nbyte == 1 ? 255.f : 1023.f;
-  for ( size_t i = 0; i < count; i++ ) {
+  for ( int i = 0; i < count; i++ ) {
     dst[i] = static_cast<T>( clamp( (T)std::round( scale * src[i] ), (T)0, (T)scale ) );
   }
 }
 
-template <typename T>
-void PCCInternalColorConverter<T>::downsampling( const std::vector<float>& chroma_in,
-                                                 std::vector<float>&       chroma_out,
-                                                 const int                 widthIn,
-                                                 const int                 heightIn,
-                                                 const int                 maxValue,
-                                                 const size_t              filter ) const {
-  int                widthOut  = widthIn / 2;
-  int                heightOut = heightIn / 2;
-  std::vector<float> temp;
-  chroma_out.resize( widthOut * heightOut );
-  temp.resize( widthOut * heightIn );
-  for ( int i = 0; i < heightIn; i++ ) {
-    for ( int j = 0; j < widthOut; j++ ) {
-      temp[i * widthOut + j] =
-          downsamplingHorizontal( g_filter444to420[filter], chroma_in, widthIn, heightIn, i, j * 2 );
-    }
-  }
-  for ( int i = 0; i < heightOut; i++ ) {
-    for ( int j = 0; j < widthOut; j++ ) {
-      chroma_out[i * widthOut + j] =
-          downsamplingVertical( g_filter444to420[filter], temp, widthOut, heightIn, 2 * i, j );
-    }
-  }
-}
-
-template <typename T>
-void PCCInternalColorConverter<T>::upsampling( const std::vector<float>& chromaIn,
-                                               std::vector<float>&       chromaOut,
-                                               const int                 widthIn,
-                                               const int                 heightIn,
-                                               const int                 maxValue,
-                                               const size_t              filter ) const {
-  int                widthOut = widthIn * 2, heightOut = heightIn * 2;
-  std::vector<float> temp;
-  chromaOut.resize( widthOut * heightOut );
-  temp.resize( widthIn * heightOut );
-  for ( int i = 0; i < heightIn; i++ ) {
-    for ( int j = 0; j < widthIn; j++ ) {
-      temp[( 2 * i ) * widthIn + j] =
-          upsamplingVertical0( g_filter420to444[filter], chromaIn, widthIn, heightIn, i + 0, j );
-      temp[( 2 * i + 1 ) * widthIn + j] =
-          upsamplingVertical1( g_filter420to444[filter], chromaIn, widthIn, heightIn, i + 1, j );
-    }
-  }
-  for ( int i = 0; i < heightOut; i++ ) {
-    for ( int j = 0; j < widthIn; j++ ) {
-      chromaOut[i * widthOut + j * 2] =
-          upsamplingHorizontal0( g_filter420to444[filter], temp, widthIn, heightOut, i, j + 0 );
-      chromaOut[i * widthOut + j * 2 + 1] =
-          upsamplingHorizontal1( g_filter420to444[filter], temp, widthIn, heightOut, i, j + 1 );
-    }
-  }
-}
-
 template <typename T>
 void PCCInternalColorConverter<T>::upsample( PCCVideo<T, 3>& video, size_t rate, size_t nbyte, size_t filter ) {
-  for ( auto& image : video ) { upsample( image, rate, nbyte, filter ); }
+  convertFrames( video.getFrameCount(), nbThread_,
+                 [&]( const size_t i ) { upsample( video[i], rate, nbyte, filter ); } );
 }
 
 template <typename T>
 void PCCInternalColorConverter<T>::upsample( PCCImage<T, 3>& image, size_t rate, size_t nbyte, size_t filter ) {
   for ( size_t i = rate; i > 1; i /= 2 ) {
-    int                width        = (int)image.getWidth();
-    int                height       = (int)image.getHeight();
-    int                widthChroma  = image.getColorFormat() == YUV420 ? width / 2 : width;
-    int                heightChroma = image.getColorFormat() == YUV420 ? height / 2 : height;
-    std::vector<float> src[3], up[3];
-    YUVtoFloatYUV( image[0], src[0], 0, nbyte );
-    YUVtoFloatYUV( image[1], src[1], 1, nbyte );
-    YUVtoFloatYUV( image[2], src[2], 1, nbyte );
-    upsampling( src[0], up[0], width, height, nbyte == 1 ? 255 : 1023, filter );
-    upsampling( src[1], up[1], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
-    upsampling( src[2], up[2], widthChroma, heightChroma, nbyte == 1 ? 255 : 1023, filter );
+    int            width  = (int)image.getWidth();
+    int            height = (int)image.getHeight();
+    std::vector<T> up[3];
+    for ( size_t c = 0; c < 3; c++ ) {
+      int planeWidth  = c > 0 && image.getColorFormat() == YUV420 ? width / 2 : width;
+      int planeHeight = c > 0 && image.getColorFormat() == YUV420 ? height / 2 : height;
+      up[c].resize( 4 * planeWidth * planeHeight );
+      if ( planeWidth == 0 ) { continue; }
+      PCCChromaUpsampler upsampler( g_filter420to444[filter], planeWidth, planeHeight, [&]( int row, float* dst ) {
+        YUVtoFloatYUV( image[c].data() + row * planeWidth, planeWidth, dst, c > 0, nbyte );
+      } );
+      for ( int row = 0; row < 2 * planeHeight; row++ ) {
+        floatYUVToYUV( upsampler.getRow( row ), 2 * planeWidth, up[c].data() + row * 2 * planeWidth, c > 0, nbyte );
+      }
+    }
     image.resize( width * 2, height * 2, image.getColorFormat() );
-    floatYUVToYUV( up[0], image[0], 0, nbyte );
-    floatYUVToYUV( up[1], image[1], 1, nbyte );
-    floatYUVToYUV( up[2], image[2], 1, nbyte );
+    for ( size_t c = 0; c < 3; c++ ) { image[c].swap( up[c] ); }
   }
 }
 
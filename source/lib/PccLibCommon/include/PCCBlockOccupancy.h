@@ -0,0 +1,91 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCBlockOccupancy_h
+#define PCCBlockOccupancy_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Block occupancy of a packing canvas, one bit per block in 64-bit words. The blocks are indexed as in a
+// std::vector<bool>, x + stride * y, so a row of blocks is a contiguous run of bits and the fit tests can compare up
+// to 64 blocks at once with getBits().
+class PCCBlockOccupancy {
+ public:
+  class Reference {
+   public:
+    Reference( uint64_t& word, const uint64_t mask ) : word_( word ), mask_( mask ) {}
+    operator bool() const { return ( word_ & mask_ ) != 0; }
+    Reference& operator=( const bool value ) {
+      word_ = value ? ( word_ | mask_ ) : ( word_ & ~mask_ );
+      return *this;
+    }
+    Reference& operator=( const Reference& rhs ) { return *this = static_cast<bool>( rhs ); }
+
+   private:
+    uint64_t& word_;
+    uint64_t  mask_;
+  };
+
+  PCCBlockOccupancy() : size_( 0 ) {}
+  ~PCCBlockOccupancy() = default;
+
+  // The bits past size() are kept to zero, and one extra word is allocated so that getBits() can always read the
+  // word following the one of pos.
+  void resize( const size_t size, const bool value = false ) {
+    for ( size_t i = size; i < size_; i++ ) { ( *this )[i] = false; }
+    words_.resize( size / 64 + 2, 0 );
+    if ( value ) {
+      for ( size_t i = size_; i < size; i++ ) { ( *this )[i] = true; }
+    }
+    size_ = size;
+  }
+  size_t    size() const { return size_; }
+  bool      operator[]( const size_t pos ) const { return ( ( words_[pos >> 6] >> ( pos & 63 ) ) & 1 ) != 0; }
+  Reference operator[]( const size_t pos ) { return Reference( words_[pos >> 6], uint64_t( 1 ) << ( pos & 63 ) ); }
+
+  // Returns the count (<= 64) bits starting at pos, the bit of pos being the least significant one.
+  uint64_t getBits( const size_t pos, const size_t count ) const {
+    const size_t shift = pos & 63;
+    uint64_t     bits  = words_[pos >> 6] >> shift;
+    if ( shift != 0 ) { bits |= words_[( pos >> 6 ) + 1] << ( 64 - shift ); }
+    return count < 64 ? bits & ( ( uint64_t( 1 ) << count ) - 1 ) : bits;
+  }
+
+ private:
+  size_t                size_;
+  std::vector<uint64_t> words_;
+};
+
+}  // namespace pcc
+#endif /* PCCBlockOccupancy_h */
@@ -38,6 +38,7 @@
 #include "PCCMath.h"
 #include "PCCVideo.h"
 #include "PCCContext.h"
+#include "PCCVoxelGrid.h"
 
 namespace pcc {
 class PCCPatch;
@@ -238,20 +239,23 @@ class PCCCodec {
                          const int               threshold,
                          const bool              projectionMode );
 
-  std::vector<PCCPoint3D> generatePoints( const GeneratePointCloudParameters&  params,
-                                          PCCFrameContext&                     tile,
-                                          const std::vector<PCCVideoGeometry>& videoMultiple,
-                                          const size_t                         videoFrameIndex,
-                                          const size_t                         patchIndex,
-                                          const size_t                         u,
-                                          const size_t                         v,
-                                          const size_t                         x,
-                                          const size_t                         y,
-                                          const bool                           interpolate = 0,
-                                          const bool                           filling     = 0,
-                                          const size_t                         minD1       = 0,
-                                          const size_t                         neighbor    = 0 );
-  void                    generateAfti( PCCContext& context, size_t frameIndex, AtlasFrameTileInformationRbsp& afti );
+  // Generates the points of the pixel (x,y) in createdPoints, which is cleared first and can be reused by the
+  // caller from one pixel to the next.
+  void generatePoints( const GeneratePointCloudParameters&  params,
+                       PCCFrameContext&                     tile,
+                       const std::vector<PCCVideoGeometry>& videoMultiple,
+                       const size_t                         videoFrameIndex,
+                       const size_t                         patchIndex,
+                       const size_t                         u,
+                       const size_t                         v,
+                       const size_t                         x,
+                       const size_t                         y,
+                       std::vector<PCCPoint3D>&             createdPoints,
+                       const bool                           interpolate = 0,
+                       const bool                           filling     = 0,
+                       const size_t                         minD1       = 0,
+                       const size_t                         neighbor    = 0 );
+  void generateAfti( PCCContext& context, size_t frameIndex, AtlasFrameTileInformationRbsp& afti );
 
   inline double entropy( std::vector<uint8_t>& Data, int N ) {
     std::vector<size_t> count;
@@ -306,10 +310,11 @@ class PCCCodec {
                                        size_t                                 tileId,
                                        size_t                                 patchIndex,
                                        std::vector<std::vector<PatchParams>>& tilePatchParams );
-  void atlasBlockToPatchByteString( std::vector<uint8_t>& stringByte, std::vector<std::vector<int64_t>> atlasB2p );
-  void tileBlockToPatchByteString( std::vector<uint8_t>&                          stringByte,
-                                   size_t                                         tileID,
-                                   std::vector<std::vector<std::vector<int64_t>>> tileB2p );
+  void atlasBlockToPatchByteString( std::vector<uint8_t>&                    stringByte,
+                                    const std::vector<std::vector<int64_t>>& atlasB2p );
+  void tileBlockToPatchByteString( std::vector<uint8_t>&                                 stringByte,
+                                   size_t                                                tileID,
+                                   const std::vector<std::vector<std::vector<int64_t>>>& tileB2p );
   void getHashPatchParams( PCCContext&                            context,
                            size_t                                 frameIndex,
                            size_t                                 tileIndex,
@@ -344,18 +349,20 @@ class PCCCodec {
                          const std::vector<uint32_t>&       partition,
                          const GeneratePointCloudParameters params );
 
-  void smoothPointCloudGrid( PCCPointSet3&                       reconstruct,
-                             const std::vector<uint32_t>&        partition,
-                             const GeneratePointCloudParameters& params,
-                             uint16_t                            gridWidth,
-                             std::vector<int>&                   cellIndex );
+  void smoothPointCloudGrid( PCCPointSet3&                         reconstruct,
+                             const std::vector<uint32_t>&          partition,
+                             const GeneratePointCloudParameters&   params,
+                             const PCCVoxelGrid&                   grid,
+                             const std::vector<uint16_t>&          gridCount,
+                             const std::vector<PCCVector3<float>>& gridCenter,
+                             const std::vector<uint8_t>&           gridDoSmooth );
 
   void addGridCentroid( PCCPoint3D&                     point,
                         uint32_t                        patchIdx,
                         std::vector<uint16_t>&          count,
                         std::vector<PCCVector3<float>>& center,
                         std::vector<uint32_t>&          partition,
-                        std::vector<bool>&              doSmooth,
+                        std::vector<uint8_t>&           doSmooth,
                         uint8_t                         gridSize,
                         uint16_t                        gridWidth,
                         int                             cellId );
@@ -366,38 +373,42 @@ class PCCCodec {
                              std::vector<uint16_t>&                  colorGridCount,
                              std::vector<PCCVector3<float>>&         colorCenter,
                              std::vector<std::pair<size_t, size_t>>& colorPartition,
-                             std::vector<bool>&                      colorDoSmooth,
+                             std::vector<uint8_t>&                   colorDoSmooth,
                              uint8_t                                 colorGrid,
-                             std::vector<std::vector<uint16_t>>&     colorLum,
+                             std::vector<uint16_t>&                  colorLum,
                              const GeneratePointCloudParameters&     params,
                              int                                     cellId );
 
-  bool gridFilteringColor( PCCPoint3D&                         curPos,
-                           PCCVector3D&                        colorCentroid,
-                           int&                                colorCount,
-                           std::vector<uint16_t>&              colorGridCount,
-                           std::vector<PCCVector3<float>>&     colorCenterGrid,
-                           std::vector<bool>&                  colorDoSmooth,
-                           uint8_t                             gridSize,
-                           PCCVector3D&                        curPosColor,
-                           const GeneratePointCloudParameters& params,
-                           std::vector<int>&                   cellIndex );
-
-  void smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
-                                const GeneratePointCloudParameters& params,
-                                std::vector<int>&                   cellIndex );
-
-  bool gridFiltering( const std::vector<uint32_t>&    partition,
-                      PCCPointSet3&                   pointCloud,
-                      PCCPoint3D&                     curPoint,
-                      PCCVector3D&                    centroid,
-                      int&                            count,
-                      std::vector<uint16_t>&          gridCount,
-                      std::vector<PCCVector3<float>>& center,
-                      std::vector<bool>&              doSmooth,
-                      uint8_t                         gridSize,
-                      uint16_t                        gridWidth,
-                      std::vector<int>&               cellIndex );
+  bool gridFilteringColor( PCCPoint3D&                           curPos,
+                           PCCVector3D&                          colorCentroid,
+                           int&                                  colorCount,
+                           const std::vector<uint16_t>&          colorGridCount,
+                           const std::vector<PCCVector3<float>>& colorCenterGrid,
+                           const std::vector<uint8_t>&           colorDoSmooth,
+                           const std::vector<uint8_t>&           colorVariation,
+                           uint8_t                               gridSize,
+                           PCCVector3D&                          curPosColor,
+                           const GeneratePointCloudParameters&   params,
+                           const PCCVoxelGrid&                   grid );
+
+  void smoothPointCloudColorLC( PCCPointSet3&                         reconstruct,
+                                const GeneratePointCloudParameters&   params,
+                                const PCCVoxelGrid&                   grid,
+                                const std::vector<uint16_t>&          colorGridCount,
+                                const std::vector<PCCVector3<float>>& colorGridCenter,
+                                const std::vector<uint8_t>&           colorGridDoSmooth,
+                                const std::vector<uint8_t>&           colorGridVariation );
+
+  bool gridFiltering( const std::vector<uint32_t>&          partition,
+                      PCCPointSet3&                         pointCloud,
+                      PCCPoint3D&                           curPoint,
+                      PCCVector3D&                          centroid,
+                      int&                                  count,
+                      const std::vector<uint16_t>&          gridCount,
+                      const std::vector<PCCVector3<float>>& center,
+                      const std::vector<uint8_t>&           doSmooth,
+                      uint8_t                               gridSize,
+                      const PCCVoxelGrid&                   grid );
 
   void identifyBoundaryPoints( const std::vector<uint32_t>& occupancyMap,
                                const size_t                 x,
@@ -411,15 +422,6 @@ class PCCCodec {
 #ifdef CODEC_TRACE
   void printChecksum( PCCPointSet3& ePointcloud, std::string eString );
 #endif
-  std::vector<uint16_t>                  geoSmoothingCount_;
-  std::vector<PCCVector3<float>>         geoSmoothingCenter_;
-  std::vector<bool>                      geoSmoothingDoSmooth_;
-  std::vector<uint32_t>                  geoSmoothingPartition_;
-  std::vector<uint16_t>                  colorSmoothingCount_;
-  std::vector<PCCVector3<float>>         colorSmoothingCenter_;
-  std::vector<bool>                      colorSmoothingDoSmooth_;
-  std::vector<std::pair<size_t, size_t>> colorSmoothingPartition_;
-  std::vector<std::vector<uint16_t>>     colorSmoothingLum_;
 };
 
 };  // namespace pcc
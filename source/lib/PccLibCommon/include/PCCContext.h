@@ -38,6 +38,7 @@
 #include "PCCVideo.h"
 #include "PCCBitstreamCommon.h"
 #include "PCCHighLevelSyntax.h"
+#include "PCCMotionEstimationData.h"
 #include <map>
 
 namespace pcc {
@@ -93,6 +94,7 @@ class PCCAtlasContext {
     return attrFrames_[attrIdx][partIdx][index];
   }
   PCCVideoAttribute& getVideoAuxAttribute( size_t attrIdx, size_t partIdx ) { return attrAuxFrames_[attrIdx][partIdx]; }
+  PCCMotionEstimationData& getMotionEstimationData() { return motionEstimationData_; }
 
   // GPA related functions
   std::vector<SubContext>& getSubContexts() { return subContexts_; }
@@ -117,6 +119,7 @@ class PCCAtlasContext {
   std::vector<std::vector<std::vector<std::vector<size_t>>>> attrWidth_;
   std::vector<std::vector<std::vector<std::vector<size_t>>>> attrHeight_;
   std::vector<std::vector<PCCVideoAttribute>>                attrAuxFrames_;
+  PCCMotionEstimationData                                    motionEstimationData_;
   std::vector<SubContext>                                    subContexts_;
   std::vector<unionPatch>                                    unionPatch_;
 };
@@ -162,6 +165,8 @@ class PCCContext : public PCCHighLevelSyntax {
     return atlasContexts_[atlId].getVideoAuxAttribute( attrIdx, partIdx );
   }
   PCCVideoAttribute& getVideoRawPointsAttribute() { return atlasContexts_[atlasIndex_].getVideoAuxAttribute( 0, 0 ); }
+  // motion estimation side information of the video encoders
+  PCCMotionEstimationData& getMotionEstimationData() { return atlasContexts_[atlasIndex_].getMotionEstimationData(); }
 
   // fame context related functions
   std::vector<PCCAtlasFrameContext>::iterator begin() { return atlasContexts_[atlasIndex_].getFrameContexts().begin(); }
@@ -192,9 +197,9 @@ class PCCContext : public PCCHighLevelSyntax {
   float              getModelScale() { return modelScale_; }
   void               setModelScale( float value ) { modelScale_ = value; }
 
-  std::vector<uint8_t> computeMD5( uint8_t* byteString, size_t size );
-  uint16_t             computeCRC( uint8_t* byteString, size_t size );
-  uint32_t             computeCheckSum( uint8_t* byteString, size_t size );
+  std::vector<uint8_t> computeMD5( const uint8_t* byteString, size_t size );
+  uint16_t             computeCRC( const uint8_t* byteString, size_t size );
+  uint32_t             computeCheckSum( const uint8_t* byteString, size_t size );
 
  private:
   PCCVector3<float>            modelOrigin_;
@@ -47,6 +47,7 @@ class PCCGroupOfFrames {
   void                clear() { frames_.clear(); }
   size_t              getFrameCount() const { return frames_.size(); }
   void                setFrameCount( size_t n ) { frames_.resize( n ); }
+  size_t              getMemorySize() const;
   const PCCPointSet3& operator[]( const size_t index ) const {
     assert( index < frames_.size() );
     return frames_[index];
@@ -0,0 +1,77 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCHash_h
+#define PCCHash_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// CRC of the decoded atlas information hash SEI: the bits of the byte string followed by 16 zero bits are shifted
+// through a 16-bit register initialized to 0xFFFF with the polynomial 0x1021. The byte string is streamed eight bytes
+// at a time through slicing tables, the register being kept in its equivalent non-augmented form.
+class PCCCrc16 {
+ public:
+  PCCCrc16();
+  void     update( const uint8_t* data, size_t size );
+  uint16_t finalize() const { return crc_; }
+
+ private:
+  uint16_t crc_;
+};
+
+// checksum of the decoded atlas information hash SEI, the byte mask depending on the position in the byte string
+class PCCCheckSum {
+ public:
+  PCCCheckSum() : checkSum_( 0 ), position_( 0 ) {}
+  void     update( const uint8_t* data, size_t size );
+  uint32_t finalize() const { return checkSum_; }
+
+ private:
+  uint32_t checkSum_;
+  uint32_t position_;
+};
+
+// hash of a byte string of the decoded atlas information hash SEI, of the hash type of the SEI: MD5 (0), CRC (1) or
+// checksum (2)
+struct PCCHashDigest {
+  void compute( size_t hashType, const uint8_t* data, size_t size );
+
+  std::vector<uint8_t> md5_;
+  uint16_t             crc_      = 0;
+  uint32_t             checkSum_ = 0;
+};
+
+}  // namespace pcc
+
+#endif /* PCCHash_h */
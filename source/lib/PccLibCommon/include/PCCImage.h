@@ -65,6 +65,10 @@ class PCCImage {
   void clear() {
     for ( auto& channel : channels_ ) { channel.clear(); }
   }
+  // frees the pixel buffers but keeps the size and the format of the image
+  void release() {
+    for ( auto& channel : channels_ ) { std::vector<T>().swap( channel ); }
+  }
   size_t                getWidth() const { return width_; }
   size_t                getHeight() const { return height_; }
   PCCCOLORFORMAT        getColorFormat() const { return format_; }
@@ -123,7 +127,7 @@ class PCCImage {
         }
       } else {
         for ( size_t v = 0; v < height[c]; ++v, src += stride[c], dst += width[c] ) {
-          for ( size_t u = 0; u < width[c]; ++u ) { dst[u] = (T)src[u]; }
+          std::copy( src, src + width[c], dst );
         }
       }
     }
@@ -166,12 +170,10 @@ class PCCImage {
         }
       } else {
         for ( size_t v = 0; v < heightSrc[c]; ++v, src += width[c], dst += stride[c] ) {
-          for ( size_t u = 0; u < width[c]; ++u ) { dst[u] = (Pel)src[u]; }
+          std::copy( src, src + width[c], dst );
         }
       }
-      for ( size_t v = heightSrc[c]; v < heightDst[c]; ++v, dst += stride[c] ) {
-        for ( size_t u = 0; u < width[c]; ++u ) { dst[u] = 0; }
-      }
+      for ( size_t v = heightSrc[c]; v < heightDst[c]; ++v, dst += stride[c] ) { std::fill( dst, dst + width[c], 0 ); }
     }
   }
 
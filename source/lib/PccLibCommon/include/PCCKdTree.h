@@ -82,21 +82,71 @@ class PCCNNResult {
   std::vector<double> dist_;
 };
 
+// Results of a batch of nearest neighbor queries: each query owns a fixed number of slots, so the storage is
+// allocated once for the whole batch and reused from one batch to the next.
+class PCCNNBatchResult {
+ public:
+  PCCNNBatchResult() : capacity_( 0 ) {}
+  ~PCCNNBatchResult() = default;
+  inline void resize( const size_t queryCount, const size_t capacity ) {
+    capacity_ = capacity;
+    counts_.resize( queryCount );
+    indices_.resize( queryCount * capacity );
+    dist_.resize( queryCount * capacity );
+  }
+  inline size_t  size() const { return counts_.size(); }
+  inline size_t  capacity() const { return capacity_; }
+  inline size_t  count( size_t query ) const { return counts_[query]; }
+  inline size_t& count( size_t query ) { return counts_[query]; }
+  inline size_t  indices( size_t query, size_t index ) const { return indices_[query * capacity_ + index]; }
+  inline double  dist( size_t query, size_t index ) const { return dist_[query * capacity_ + index]; }
+  inline size_t* indices( size_t query ) { return indices_.data() + query * capacity_; }
+  inline double* dist( size_t query ) { return dist_.data() + query * capacity_; }
+
+ private:
+  size_t              capacity_;
+  std::vector<size_t> counts_;
+  std::vector<size_t> indices_;
+  std::vector<double> dist_;
+};
+
 class PCCKdTree {
  public:
   PCCKdTree();
-  PCCKdTree( const PCCPointSet3& pointCloud );
+  PCCKdTree( const PCCPointSet3& pointCloud, const bool useVoxelIndex = false );
   ~PCCKdTree();
-  void init( const PCCPointSet3& pointCloud );
+  // useVoxelIndex builds the voxel index that answers the 1-nn searches of points of the cloud: only worth its
+  // memory and build time for trees searched with num_results == 1 on queries that often match a point.
+  void init( const PCCPointSet3& pointCloud, const bool useVoxelIndex = false );
   void search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const;
+  void search( const PCCPointSet3& pointCloud,
+               const size_t        start,
+               const size_t        end,
+               const size_t        num_results,
+               PCCNNBatchResult&   results ) const;
+  void search( const PCCPointSet3&        pointCloud,
+               const std::vector<size_t>& pointIndices,
+               const size_t               start,
+               const size_t               end,
+               const size_t               num_results,
+               PCCNNBatchResult&          results ) const;
   void searchRadius( const PCCPoint3D& point,
                      const size_t      num_results,
                      const double      radius,
                      PCCNNResult&      results ) const;
 
  private:
-  void  clear();
-  void* kdtree_;
+  void     clear();
+  void     buildVoxelIndex( const PCCPointSet3& pointCloud );
+  uint32_t findVoxel( const PCCPoint3D& point ) const;
+  size_t   searchPoint( const PCCPoint3D& point, const size_t num_results, size_t* indices, double* dist ) const;
+
+  // Open addressing hash table of the voxel positions of the points: voxelIndexes_ stores the index of the point of
+  // each voxel, or g_undefined_index when several points share the voxel.
+  void*                 kdtree_;
+  std::vector<uint64_t> voxelKeys_;
+  std::vector<uint32_t> voxelIndexes_;
+  uint64_t              voxelMask_;
 };
 
 }  // namespace pcc
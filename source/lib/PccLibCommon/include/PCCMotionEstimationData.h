@@ -0,0 +1,122 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCMotionEstimationData_h
+#define PCCMotionEstimationData_h
+
+#include "PCCCommon.h"
+#include "PCCBlockOccupancy.h"
+
+namespace pcc {
+
+struct PCCMotionEstimationPatch {
+  int32_t projectionIndex_;
+  int32_t u0_;
+  int32_t v0_;
+  int32_t sizeU0_;
+  int32_t sizeV0_;
+  int32_t d1_;
+  int32_t u1_;
+  int32_t v1_;
+};
+
+// Side information of the PCC-aware motion estimation of one atlas frame: the occupancy map, one bit per
+// occupancy precision block, the block to patch map and the patch table.
+class PCCMotionEstimationFrame {
+ public:
+  PCCMotionEstimationFrame() : width_( 0 ), height_( 0 ), occupancyResolution_( 0 ), occupancyPrecision_( 0 ) {}
+  ~PCCMotionEstimationFrame() = default;
+
+  void init( const size_t width,
+             const size_t height,
+             const size_t occupancyResolution,
+             const size_t occupancyPrecision ) {
+    width_               = width;
+    height_              = height;
+    occupancyResolution_ = occupancyResolution;
+    occupancyPrecision_  = occupancyPrecision;
+    occupancy_.resize( 0 );
+    occupancy_.resize( getOccupancyWidth() * getOccupancyHeight() );
+    blockToPatch_.assign( ( width / occupancyResolution ) * ( height / occupancyResolution ), 0 );
+    patches_.clear();
+  }
+  size_t getWidth() const { return width_; }
+  size_t getHeight() const { return height_; }
+  size_t getOccupancyResolution() const { return occupancyResolution_; }
+  size_t getOccupancyWidth() const { return ( width_ + occupancyPrecision_ - 1 ) / occupancyPrecision_; }
+  size_t getOccupancyHeight() const { return ( height_ + occupancyPrecision_ - 1 ) / occupancyPrecision_; }
+  void   setOccupancy( const size_t u, const size_t v, const bool value ) {
+    occupancy_[u + v * getOccupancyWidth()] = value;
+  }
+  bool isOccupied( const size_t x, const size_t y ) const {
+    return occupancy_[x / occupancyPrecision_ + ( y / occupancyPrecision_ ) * getOccupancyWidth()];
+  }
+  std::vector<uint32_t>&                       getBlockToPatch() { return blockToPatch_; }
+  const std::vector<uint32_t>&                 getBlockToPatch() const { return blockToPatch_; }
+  std::vector<PCCMotionEstimationPatch>&       getPatches() { return patches_; }
+  const std::vector<PCCMotionEstimationPatch>& getPatches() const { return patches_; }
+
+ private:
+  size_t                                width_;
+  size_t                                height_;
+  size_t                                occupancyResolution_;
+  size_t                                occupancyPrecision_;
+  PCCBlockOccupancy                     occupancy_;
+  std::vector<uint32_t>                 blockToPatch_;
+  std::vector<PCCMotionEstimationPatch> patches_;
+};
+
+// Motion estimation side information of the frames of a GOF. The video encoders linked as libraries read it
+// directly, the side files of the encoder applications are written from it by write().
+class PCCMotionEstimationData {
+ public:
+  PCCMotionEstimationData() {}
+  ~PCCMotionEstimationData() = default;
+
+  void                            clear() { frames_.clear(); }
+  void                            resize( const size_t frameCount ) { frames_.resize( frameCount ); }
+  size_t                          getFrameCount() const { return frames_.size(); }
+  PCCMotionEstimationFrame&       operator[]( const size_t index ) { return frames_[index]; }
+  const PCCMotionEstimationFrame& operator[]( const size_t index ) const { return frames_[index]; }
+
+  // Writes the occupancy, block to patch and patch info files in the layout parsed by the PCC-aware HM: one
+  // uint32_t per pixel, one size_t per block and a size_t patch table, with one write per frame and file.
+  bool write( const std::string& occupancyMapFileName,
+              const std::string& blockToPatchFileName,
+              const std::string& patchInfoFileName ) const;
+
+ private:
+  std::vector<PCCMotionEstimationFrame> frames_;
+};
+
+}  // namespace pcc
+#endif /* PCCMotionEstimationData_h */
@@ -0,0 +1,132 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCNeighborGraph_h
+#define PCCNeighborGraph_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Neighbors of one node of a PCCNeighborGraph, usable in range-based for loops.
+class PCCNeighborRange {
+ public:
+  PCCNeighborRange( const uint32_t* begin, const uint32_t* end ) : begin_( begin ), end_( end ) {}
+  ~PCCNeighborRange() = default;
+  const uint32_t* begin() const { return begin_; }
+  const uint32_t* end() const { return end_; }
+  size_t          size() const { return end_ - begin_; }
+  bool            empty() const { return begin_ == end_; }
+  uint32_t        operator[]( const size_t index ) const { return begin_[index]; }
+
+ private:
+  const uint32_t* begin_;
+  const uint32_t* end_;
+};
+
+// Compressed sparse row neighbor graph: the neighbors of all the nodes, and optionally their squared distances, are
+// stored in one array. Each node owns a row of fixed capacity, filled concurrently, of which the first
+// getNeighborCount( i ) entries are used.
+class PCCNeighborGraph {
+ public:
+  PCCNeighborGraph() : maxNeighborCount_( 0 ) {}
+  ~PCCNeighborGraph() = default;
+
+  void clear() {
+    maxNeighborCount_ = 0;
+    offsets_.clear();
+    counts_.clear();
+    neighbors_.clear();
+    distances_.clear();
+    offsets_.shrink_to_fit();
+    counts_.shrink_to_fit();
+    neighbors_.shrink_to_fit();
+    distances_.shrink_to_fit();
+  }
+
+  // rows of maxNeighborCount entries, as produced by the k nearest neighbor searches
+  void resize( const size_t nodeCount, const size_t maxNeighborCount, const bool useDistances ) {
+    maxNeighborCount_ = maxNeighborCount;
+    offsets_.resize( nodeCount + 1 );
+    for ( size_t i = 0; i <= nodeCount; i++ ) { offsets_[i] = i * maxNeighborCount; }
+    allocate( useDistances );
+  }
+
+  // rows of variable capacities, as produced by the radius searches
+  void resize( const std::vector<uint32_t>& capacities, const bool useDistances ) {
+    maxNeighborCount_ = 0;
+    offsets_.resize( capacities.size() + 1 );
+    offsets_[0] = 0;
+    for ( size_t i = 0; i < capacities.size(); i++ ) {
+      offsets_[i + 1]   = offsets_[i] + capacities[i];
+      maxNeighborCount_ = ( std::max )( maxNeighborCount_, static_cast<size_t>( capacities[i] ) );
+    }
+    allocate( useDistances );
+  }
+
+  size_t size() const { return counts_.size(); }
+  bool   empty() const { return counts_.empty(); }
+  bool   hasDistances() const { return distances_.size() == neighbors_.size(); }
+  size_t getMaxNeighborCount() const { return maxNeighborCount_; }
+  size_t getCapacity( const size_t i ) const { return offsets_[i + 1] - offsets_[i]; }
+  size_t getNeighborCount( const size_t i ) const { return counts_[i]; }
+  void   setNeighborCount( const size_t i, const size_t count ) {
+    assert( count <= getCapacity( i ) );
+    counts_[i] = static_cast<uint32_t>( count );
+  }
+  uint32_t*       getNeighbors( const size_t i ) { return neighbors_.data() + offsets_[i]; }
+  const uint32_t* getNeighbors( const size_t i ) const { return neighbors_.data() + offsets_[i]; }
+  float*          getDistances( const size_t i ) { return distances_.data() + offsets_[i]; }
+  const float*    getDistances( const size_t i ) const { return distances_.data() + offsets_[i]; }
+  PCCNeighborRange operator[]( const size_t i ) const {
+    const uint32_t* neighbors = getNeighbors( i );
+    return PCCNeighborRange( neighbors, neighbors + counts_[i] );
+  }
+
+ private:
+  void allocate( const bool useDistances ) {
+    const size_t nodeCount = offsets_.size() - 1;
+    counts_.assign( nodeCount, 0 );
+    neighbors_.resize( offsets_[nodeCount] );
+    distances_.resize( useDistances ? offsets_[nodeCount] : 0 );
+  }
+
+  size_t                maxNeighborCount_;
+  std::vector<size_t>   offsets_;
+  std::vector<uint32_t> counts_;
+  std::vector<uint32_t> neighbors_;
+  std::vector<float>    distances_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCNeighborGraph_h */
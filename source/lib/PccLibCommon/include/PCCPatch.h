@@ -36,6 +36,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCBlockOccupancy.h"
 
 namespace pcc {
 
@@ -141,10 +142,16 @@ class PCCPatch {
   void setNormalAxis( size_t value ) { normalAxis_ = value; }
   void setTangentAxis( size_t value ) { tangentAxis_ = value; }
   void setBitangentAxis( size_t value ) { bitangentAxis_ = value; }
-  void setOccupancy( const std::vector<bool>& occupancy ) { occupancy_ = occupancy; }
+  void setOccupancy( const std::vector<bool>& occupancy ) {
+    occupancy_ = occupancy;
+    canvasMask_.clear();
+  }
   void setDepth( size_t i, const std::vector<int16_t>& depth ) { depth_[i] = depth; }
   void setDepth( size_t i, size_t j, int16_t value ) { depth_[i][j] = value; }
-  void setOccupancy( size_t i, bool value ) { occupancy_[i] = value; }
+  void setOccupancy( size_t i, bool value ) {
+    occupancy_[i] = value;
+    canvasMask_.clear();
+  }
   void setDepth0PccIdx( size_t i, int64_t value ) { depth0PCidx_[i] = value; }
   void setDepthEOM( size_t i, int16_t value ) { depthEOM_[i] = value; }
   void setAxisOfAdditionalPlane( size_t value ) { axisOfAdditionalPlane_ = value; }
@@ -168,10 +175,16 @@ class PCCPatch {
   void setPatchSize2DYInPixel( size_t value ) { size2DYInPixel_ = value; }
 
   void allocDepth( size_t i, size_t size, int16_t value ) { depth_[i].resize( size, value ); }
-  void allocOccupancy( size_t size, bool value ) { occupancy_.resize( size, value ); }
+  void allocOccupancy( size_t size, bool value ) {
+    occupancy_.resize( size, value );
+    canvasMask_.clear();
+  }
   void allocDepth0PccIdx( size_t size, int64_t value ) { depth0PCidx_.resize( size, value ); }
   void allocDepthEOM( size_t size, int16_t value ) { depthEOM_.resize( size, value ); }
-  void clearOccupancy() { occupancy_.clear(); }
+  void clearOccupancy() {
+    occupancy_.clear();
+    canvasMask_.clear();
+  }
   void clearDepth( size_t i ) { depth_[i].clear(); }
 
   inline double generateNormalCoordinate( const uint16_t depth ) const {
@@ -216,12 +229,12 @@ class PCCPatch {
                                  size_t       canvasHeightBlk,
                                  const Tile   tile = Tile() ) const;
 
-  bool checkFitPatchCanvas( std::vector<bool> canvas,
-                            size_t            canvasStrideBlk,
-                            size_t            canvasHeightBlk,
-                            bool              bPrecedence,
-                            int               safeguard = 0,
-                            const Tile        tile      = Tile() );
+  bool checkFitPatchCanvas( const PCCBlockOccupancy& canvas,
+                            size_t                   canvasStrideBlk,
+                            size_t                   canvasHeightBlk,
+                            bool                     bPrecedence,
+                            int                      safeguard = 0,
+                            const Tile               tile      = Tile() );
 
   bool        smallerRefFirst( const PCCPatch& rhs );
   bool        gt( const PCCPatch& rhs );
@@ -271,11 +284,11 @@ class PCCPatch {
                                     size_t       canvasStrideBlk,
                                     size_t       canvasHeightBlk ) const;
 
-  bool checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                  size_t            canvasStrideBlk,
-                                  size_t            canvasHeightBlk,
-                                  bool              bPrecedence,
-                                  int               safeguard = 0 );
+  bool checkFitPatchCanvasForGPA( const PCCBlockOccupancy& canvas,
+                                  size_t                   canvasStrideBlk,
+                                  size_t                   canvasHeightBlk,
+                                  bool                     bPrecedence,
+                                  int                      safeguard = 0 );
 
   void     allocOneLayerData();
   uint8_t& getPointLocalReconstructionLevel() { return pointLocalReconstructionLevel_; }
@@ -350,6 +363,19 @@ class PCCPatch {
                   std::vector<PCCPatch>& patches );
 
  private:
+  bool checkFitCanvas( const PCCBlockOccupancy& canvas,
+                       size_t                   canvasStrideBlk,
+                       size_t                   canvasHeightBlk,
+                       bool                     bPrecedence,
+                       int                      safeguard,
+                       const Tile&              tile,
+                       size_t                   u0,
+                       size_t                   v0,
+                       size_t                   sizeU0,
+                       size_t                   sizeV0,
+                       size_t                   patchOrientation );
+  void updateCanvasMask( size_t sizeU0, size_t sizeV0, size_t patchOrientation, bool bPrecedence, size_t safeguard );
+
   size_t                  index_;          // patch index
   size_t                  originalIndex_;  // patch original index
   size_t                  frameIndex_;     // Frame index
@@ -406,6 +432,10 @@ class PCCPatch {
   std::vector<int16_t>    depthMap_;            // Depth map
   std::vector<uint8_t>    occupancyMap_;        // Occupancy map
   std::vector<PCCPoint3D> borderPoints_;        // 3D points created from borders of the patch
+  std::vector<uint64_t>   canvasMask_;          // Canvas blocks a placement must find free, see checkFitCanvas()
+  std::array<size_t, 5>   canvasMaskKey_;       // Size, orientation, precedence and safeguard of canvasMask_
+  size_t                  canvasMaskWidth_;     // Width of canvasMask_ in blocks
+  size_t                  canvasMaskHeight_;    // Height of canvasMask_ in blocks
 };
 
 class PatchBlockFiltering {
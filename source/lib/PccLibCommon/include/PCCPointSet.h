@@ -39,9 +39,17 @@
 
 namespace pcc {
 
+class PCCKdTree;
+
 class PCCPointSet3 {
  public:
-  PCCPointSet3() : withNormals_( false ), withColors_( false ), withReflectances_( false ) {}
+  PCCPointSet3() :
+      withNormals_( false ),
+      withColors_( false ),
+      withReflectances_( false ),
+      withBoundaryPointTypes_( false ),
+      withPointPatchIndexes_( false ),
+      withParentPointIndex_( false ) {}
   PCCPointSet3( const PCCPointSet3& ) = default;
   PCCPointSet3& operator=( const PCCPointSet3& rhs ) = default;
   ~PCCPointSet3()                                    = default;
@@ -54,37 +62,34 @@ class PCCPointSet3 {
     assert( index < positions_.size() );
     return positions_[index];
   }
+  // The result has the columns of both point sets, the values missing in one of them being default-initialized.
   size_t appendPointSet( PCCPointSet3& pointSet ) {
-    std::vector<PCCPoint3D>::iterator                itPositions;
-    std::vector<PCCColor3B>::iterator                itColors;
-    std::vector<PCCColor16bit>::iterator             itColors16bit;
-    std::vector<uint16_t>::iterator                  itReflectances;
-    std::vector<uint16_t>::iterator                  itBoundaryPointTypes;
-    std::vector<std::pair<size_t, size_t>>::iterator itPointPatchIndexes;
-    std::vector<uint8_t>::iterator                   itTypes;
-    std::vector<PCCNormal3D>::iterator               itNormals;
-
-    itPositions          = positions_.end();
-    itColors             = colors_.end();
-    itColors16bit        = colors16bit_.end();
-    itReflectances       = reflectances_.end();
-    itBoundaryPointTypes = boundaryPointTypes_.end();
-    itPointPatchIndexes  = pointPatchIndexes_.end();
-    itTypes              = types_.end();
-    itNormals            = normals_.end();
-
-    positions_.insert( itPositions, pointSet.getPositions().begin(), pointSet.getPositions().end() );
-    colors_.insert( itColors, pointSet.getColor().begin(), pointSet.getColor().end() );
-    colors16bit_.insert( itColors16bit, pointSet.getColor16bit().begin(), pointSet.getColor16bit().end() );
-    reflectances_.insert( itReflectances, pointSet.getReflectances().begin(), pointSet.getReflectances().end() );
-    boundaryPointTypes_.insert( itBoundaryPointTypes, pointSet.getBoundaryPointTypes().begin(),
-                                pointSet.getBoundaryPointTypes().end() );
-    pointPatchIndexes_.insert( itPointPatchIndexes, pointSet.getPointPatchIndexes().begin(),
-                               pointSet.getPointPatchIndexes().end() );
-    types_.insert( itTypes, pointSet.getTypes().begin(), pointSet.getTypes().end() );
-    normals_.insert( itNormals, pointSet.getNormals().begin(), pointSet.getNormals().end() );
-
-    resize( getPointCount() );
+    const size_t pointCount = getPointCount();
+    const size_t addedCount = pointSet.getPointCount();
+    withColors_ |= pointSet.withColors_;
+    withReflectances_ |= pointSet.withReflectances_;
+    withNormals_ |= pointSet.withNormals_;
+    withBoundaryPointTypes_ |= pointSet.withBoundaryPointTypes_;
+    withPointPatchIndexes_ |= pointSet.withPointPatchIndexes_;
+    withParentPointIndex_ |= pointSet.withParentPointIndex_;
+    reserve( pointCount + addedCount );
+    positions_.insert( positions_.end(), pointSet.positions_.begin(), pointSet.positions_.end() );
+    if ( hasColors() ) {
+      appendColumn( colors_, pointSet.colors_, pointCount, addedCount );
+      appendColumn( colors16bit_, pointSet.colors16bit_, pointCount, addedCount );
+    }
+    if ( hasReflectances() ) { appendColumn( reflectances_, pointSet.reflectances_, pointCount, addedCount ); }
+    if ( PCC_SAVE_POINT_TYPE ) { appendColumn( types_, pointSet.types_, pointCount, addedCount ); }
+    if ( hasNormals() ) { appendColumn( normals_, pointSet.normals_, pointCount, addedCount ); }
+    if ( hasBoundaryPointTypes() ) {
+      appendColumn( boundaryPointTypes_, pointSet.boundaryPointTypes_, pointCount, addedCount );
+    }
+    if ( hasPointPatchIndexes() ) {
+      appendColumn( pointPatchIndexes_, pointSet.pointPatchIndexes_, pointCount, addedCount );
+    }
+    if ( hasParentPointIndex() ) {
+      appendColumn( parentPointIndex_, pointSet.parentPointIndex_, pointCount, addedCount );
+    }
     return positions_.size();
   }
   std::vector<uint16_t>& getBoundaryPointTypes() { return boundaryPointTypes_; }
@@ -166,36 +171,35 @@ class PCCPointSet3 {
   }
 
   uint16_t getBoundaryPointType( const size_t index ) const {
-    assert( index < boundaryPointTypes_.size() );
+    assert( index < boundaryPointTypes_.size() && withBoundaryPointTypes_ );
     return boundaryPointTypes_[index];
   }
   uint16_t& getBoundaryPointType( const size_t index ) {
-    assert( index < boundaryPointTypes_.size() );
+    assert( index < boundaryPointTypes_.size() && withBoundaryPointTypes_ );
     return boundaryPointTypes_[index];
   }
   void setBoundaryPointType( const size_t index, const uint16_t BoundaryPointType ) {
-    assert( index < boundaryPointTypes_.size() );
+    assert( index < boundaryPointTypes_.size() && withBoundaryPointTypes_ );
     boundaryPointTypes_[index] = BoundaryPointType;
   }
-  std::vector<std::pair<size_t, size_t>>& getPointPatchIndexes() { return pointPatchIndexes_; }
-  std::pair<size_t, size_t>               getPointPatchIndex( const size_t index ) const {
-    assert( index < pointPatchIndexes_.size() );
-    return pointPatchIndexes_[index];
-  }
-  std::pair<size_t, size_t>& getPointPatchIndex( const size_t index ) {
-    assert( index < pointPatchIndexes_.size() );
+  std::vector<std::pair<uint32_t, uint32_t>>& getPointPatchIndexes() { return pointPatchIndexes_; }
+  std::pair<size_t, size_t>                   getPointPatchIndex( const size_t index ) const {
+    assert( index < pointPatchIndexes_.size() && withPointPatchIndexes_ );
     return pointPatchIndexes_[index];
   }
   void setPointPatchIndex( const size_t index, const uint32_t tileIndex, const uint32_t patchIndex ) {
-    assert( index < pointPatchIndexes_.size() );
+    assert( index < pointPatchIndexes_.size() && withPointPatchIndexes_ );
     pointPatchIndexes_[index].first  = tileIndex;
     pointPatchIndexes_[index].second = patchIndex;
   }
-  std::vector<uint64_t>& getParentPointIndex() { return parentPointIndex_; }
-  uint64_t&              getParentPointIndex( const size_t index ) { return parentPointIndex_[index]; }
-  void                   setParentPointIndex( const size_t index, const uint64_t parentIndex ) {
-    assert( index < parentPointIndex_.size() );
-    parentPointIndex_[index] = parentIndex;
+  std::vector<uint32_t>& getParentPointIndex() { return parentPointIndex_; }
+  uint32_t&              getParentPointIndex( const size_t index ) {
+    assert( index < parentPointIndex_.size() && withParentPointIndex_ );
+    return parentPointIndex_[index];
+  }
+  void setParentPointIndex( const size_t index, const size_t parentIndex ) {
+    assert( index < parentPointIndex_.size() && withParentPointIndex_ );
+    parentPointIndex_[index] = static_cast<uint32_t>( parentIndex );
   }
   uint16_t getReflectance( const size_t index ) const {
     assert( index < reflectances_.size() && withReflectances_ );
@@ -264,6 +268,38 @@ class PCCPointSet3 {
     withNormals_ = false;
     normals_.resize( 0 );
   }
+  // The boundary point types, the point patch indexes and the parent point indexes are only allocated for the point
+  // sets that use them.
+  bool hasBoundaryPointTypes() const { return withBoundaryPointTypes_; }
+  void addBoundaryPointTypes() {
+    withBoundaryPointTypes_ = true;
+    resize( getPointCount() );
+  }
+  void removeBoundaryPointTypes() {
+    withBoundaryPointTypes_ = false;
+    boundaryPointTypes_.clear();
+    boundaryPointTypes_.shrink_to_fit();
+  }
+  bool hasPointPatchIndexes() const { return withPointPatchIndexes_; }
+  void addPointPatchIndexes() {
+    withPointPatchIndexes_ = true;
+    resize( getPointCount() );
+  }
+  void removePointPatchIndexes() {
+    withPointPatchIndexes_ = false;
+    pointPatchIndexes_.clear();
+    pointPatchIndexes_.shrink_to_fit();
+  }
+  bool hasParentPointIndex() const { return withParentPointIndex_; }
+  void addParentPointIndex() {
+    withParentPointIndex_ = true;
+    resize( getPointCount() );
+  }
+  void removeParentPointIndex() {
+    withParentPointIndex_ = false;
+    parentPointIndex_.clear();
+    parentPointIndex_.shrink_to_fit();
+  }
   void setNormal( size_t idx, PCCNormal3D value ) {
     if ( idx > normals_.size() ) exit( -1 );
     normals_[idx] = value;
@@ -365,6 +401,14 @@ class PCCPointSet3 {
   bool transferColorWeight( PCCPointSet3& target, const double bestColorSearchStep = 0.1 );
 
   size_t getPointCount() const { return positions_.size(); }
+  size_t getMemorySize() const {
+    return positions_.capacity() * sizeof( PCCPoint3D ) + colors_.capacity() * sizeof( PCCColor3B ) +
+           colors16bit_.capacity() * sizeof( PCCColor16bit ) + reflectances_.capacity() * sizeof( uint16_t ) +
+           boundaryPointTypes_.capacity() * sizeof( uint16_t ) +
+           pointPatchIndexes_.capacity() * sizeof( std::pair<uint32_t, uint32_t> ) +
+           parentPointIndex_.capacity() * sizeof( uint32_t ) + types_.capacity() * sizeof( uint8_t ) +
+           normals_.capacity() * sizeof( PCCNormal3D );
+  }
   void   resize( const size_t size ) {
     positions_.resize( size );
     if ( hasColors() ) {
@@ -374,9 +418,9 @@ class PCCPointSet3 {
     if ( hasReflectances() ) { reflectances_.resize( size ); }
     if ( PCC_SAVE_POINT_TYPE ) { types_.resize( size ); }
     if ( hasNormals() ) { normals_.resize( size ); }
-    boundaryPointTypes_.resize( size );
-    pointPatchIndexes_.resize( size );
-    parentPointIndex_.resize( size );
+    if ( hasBoundaryPointTypes() ) { boundaryPointTypes_.resize( size ); }
+    if ( hasPointPatchIndexes() ) { pointPatchIndexes_.resize( size ); }
+    if ( hasParentPointIndex() ) { parentPointIndex_.resize( size ); }
   }
   void reserve( const size_t size ) {
     positions_.reserve( size );
@@ -386,9 +430,10 @@ class PCCPointSet3 {
     }
     if ( hasReflectances() ) { reflectances_.reserve( size ); }
     if ( PCC_SAVE_POINT_TYPE ) { types_.reserve( size ); }
-    boundaryPointTypes_.reserve( size );
-    pointPatchIndexes_.reserve( size );
-    parentPointIndex_.reserve( size );
+    if ( hasNormals() ) { normals_.reserve( size ); }
+    if ( hasBoundaryPointTypes() ) { boundaryPointTypes_.reserve( size ); }
+    if ( hasPointPatchIndexes() ) { pointPatchIndexes_.reserve( size ); }
+    if ( hasParentPointIndex() ) { parentPointIndex_.reserve( size ); }
   }
   void clear() {
     positions_.clear();
@@ -401,6 +446,12 @@ class PCCPointSet3 {
     parentPointIndex_.clear();
     normals_.clear();
   }
+  // Appends pointCount default-initialized points and returns the index of the first one.
+  size_t addPoints( const size_t pointCount ) {
+    const size_t index = getPointCount();
+    resize( index + pointCount );
+    return index;
+  }
   size_t addPoint( const PCCPoint3D& position ) {
     const size_t index = getPointCount();
     resize( index + 1 );
@@ -483,6 +534,8 @@ class PCCPointSet3 {
 
   void removeDuplicate();
   void distanceGeo( const PCCPointSet3& pointcloud, float& distPAB, float& distPBA ) const;
+  // mean squared distance of the points to their nearest point in the point cloud indexed by kdtree
+  void distance( const PCCKdTree& kdtree, float& distP ) const;
   void distanceGeoColor( const PCCPointSet3& pointcloud,
                          float&              distPAB,
                          float&              distPBA,
@@ -516,19 +569,36 @@ class PCCPointSet3 {
   void distance( const PCCPointSet3& pointcloud, float& distP, float& distY, float& distU, float& distV ) const;
   void distance( const PCCPointSet3& pointcloud, float& distP ) const;
   std::vector<uint8_t> computeMd5();
+  std::vector<uint8_t> computeReorderedMd5();
+
+  template <typename T>
+  static void appendColumn( std::vector<T>&       column,
+                            const std::vector<T>& values,
+                            const size_t          pointCount,
+                            const size_t          valueCount ) {
+    column.resize( pointCount );
+    if ( values.size() == valueCount ) {
+      column.insert( column.end(), values.begin(), values.end() );
+    } else {
+      column.resize( pointCount + valueCount );
+    }
+  }
 
-  std::vector<PCCPoint3D>                positions_;
-  std::vector<PCCColor3B>                colors_;
-  std::vector<PCCColor16bit>             colors16bit_;
-  std::vector<uint16_t>                  reflectances_;
-  std::vector<uint16_t>                  boundaryPointTypes_;
-  std::vector<std::pair<size_t, size_t>> pointPatchIndexes_;
-  std::vector<uint64_t>                  parentPointIndex_;
-  std::vector<uint8_t>                   types_;
-  std::vector<PCCNormal3D>               normals_;
-  bool                                   withNormals_;
-  bool                                   withColors_;
-  bool                                   withReflectances_;
+  std::vector<PCCPoint3D>                    positions_;
+  std::vector<PCCColor3B>                    colors_;
+  std::vector<PCCColor16bit>                 colors16bit_;
+  std::vector<uint16_t>                      reflectances_;
+  std::vector<uint16_t>                      boundaryPointTypes_;
+  std::vector<std::pair<uint32_t, uint32_t>> pointPatchIndexes_;
+  std::vector<uint32_t>                      parentPointIndex_;
+  std::vector<uint8_t>                       types_;
+  std::vector<PCCNormal3D>                   normals_;
+  bool                                       withNormals_;
+  bool                                       withColors_;
+  bool                                       withReflectances_;
+  bool                                       withBoundaryPointTypes_;
+  bool                                       withPointPatchIndexes_;
+  bool                                       withParentPointIndex_;
 };
 }  // namespace pcc
 
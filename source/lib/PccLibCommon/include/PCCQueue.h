@@ -0,0 +1,139 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCQueue_h
+#define PCCQueue_h
+
+#include "PCCCommon.h"
+#include <mutex>
+#include <condition_variable>
+
+namespace pcc {
+
+// Blocking FIFO of bounded capacity used to chain the stages of a pipeline
+// running on separate threads. push() waits while the queue is full, pop()
+// waits while it is empty. Once close() has been called, push() drops the
+// element and pop() returns false when the remaining elements are consumed.
+template <typename T>
+class PCCQueue {
+ public:
+  PCCQueue( size_t capacity = 1 ) : capacity_( ( std::max )( capacity, size_t( 1 ) ) ), closed_( false ) {}
+  ~PCCQueue() = default;
+
+  bool push( T&& value ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    notFull_.wait( lock, [&] { return closed_ || queue_.size() < capacity_; } );
+    if ( closed_ ) { return false; }
+    queue_.push( std::move( value ) );
+    notEmpty_.notify_one();
+    return true;
+  }
+  bool pop( T& value ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    notEmpty_.wait( lock, [&] { return closed_ || !queue_.empty(); } );
+    if ( queue_.empty() ) { return false; }
+    value = std::move( queue_.front() );
+    queue_.pop();
+    notFull_.notify_one();
+    return true;
+  }
+  void close() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    closed_ = true;
+    notFull_.notify_all();
+    notEmpty_.notify_all();
+  }
+  size_t size() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return queue_.size();
+  }
+
+ private:
+  size_t                  capacity_;
+  bool                    closed_;
+  std::queue<T>           queue_;
+  std::mutex              mutex_;
+  std::condition_variable notFull_;
+  std::condition_variable notEmpty_;
+};
+
+// Progress of a sequence of pictures written by one thread and read, in order,
+// by another one. The producer waits before writing picture index while
+// capacity pictures are pending; the consumer waits until the picture it needs
+// has been written. After close(), nobody waits anymore and waitFrame()
+// reports whether the picture has actually been written.
+class PCCFrameCounter {
+ public:
+  PCCFrameCounter( size_t capacity = 1 ) :
+      capacity_( ( std::max )( capacity, size_t( 1 ) ) ), produced_( 0 ), consumed_( 0 ), closed_( false ) {}
+  ~PCCFrameCounter() = default;
+
+  void waitSlot( size_t index ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    notFull_.wait( lock, [&] { return closed_ || index < consumed_ + capacity_; } );
+  }
+  void produced( size_t count ) {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    produced_ = ( std::max )( produced_, count );
+    notEmpty_.notify_all();
+  }
+  bool waitFrame( size_t index ) {
+    std::unique_lock<std::mutex> lock( mutex_ );
+    notEmpty_.wait( lock, [&] { return closed_ || index < produced_; } );
+    return index < produced_;
+  }
+  void consumed( size_t count ) {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    consumed_ = ( std::max )( consumed_, count );
+    notFull_.notify_all();
+  }
+  void close() {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    closed_ = true;
+    notFull_.notify_all();
+    notEmpty_.notify_all();
+  }
+
+ private:
+  size_t                  capacity_;
+  size_t                  produced_;
+  size_t                  consumed_;
+  bool                    closed_;
+  std::mutex              mutex_;
+  std::condition_variable notFull_;
+  std::condition_variable notEmpty_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCQueue_h */
@@ -33,6 +33,7 @@
 #pragma once
 
 #include "PCCCommon.h"
+#include <functional>
 #ifndef _WIN32
 #include <cstdlib>
 #endif
@@ -48,6 +49,51 @@ int system( const char* command ) noexcept;
 #else
 static inline int system( const char* command ) { return ::system( command ); }
 #endif
+
+/**
+ * a named pipe (fifo) used instead of an intermediate file to exchange data with a command: exactly one of write_
+ * (data sent to the command) or read_ (data received from the command) is set.
+ */
+struct PCCPipe {
+  std::string                           fileName_;
+  std::function<bool( std::ofstream& )> write_;
+  std::function<bool( std::ifstream& )> read_;
+};
+
+/**
+ * creates named pipes; returns false, without leaving any of them, when the platform or the file system does not
+ * support them.
+ */
+bool createPipes( const std::vector<std::string>& fileNames );
+
+/**
+ * runs command while the data of each pipe is streamed in a dedicated thread. The pipes are unblocked if the command
+ * exits without opening them. A command that closes one of its inputs ends the stream of that pipe and an error is
+ * reported. Returns the command status, or -1 if a transfer failed.
+ */
+int system( const char* command, const std::vector<PCCPipe>& pipes );
+
+/**
+ * read-only view of the content of a file: the file is memory-mapped when the platform supports it and read in
+ * memory otherwise.
+ */
+class PCCMappedFile {
+ public:
+  PCCMappedFile() = default;
+  PCCMappedFile( const PCCMappedFile& ) = delete;
+  PCCMappedFile& operator=( const PCCMappedFile& ) = delete;
+  ~PCCMappedFile() { close(); }
+  bool        open( const std::string& fileName );
+  void        close();
+  const char* data() const { return data_; }
+  size_t      size() const { return size_; }
+
+ private:
+  const char*       data_   = nullptr;
+  size_t            size_   = 0;
+  bool              mapped_ = false;
+  std::vector<char> buffer_;
+};
 }  // namespace pcc
 
 //===========================================================================
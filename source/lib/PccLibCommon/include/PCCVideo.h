@@ -88,6 +88,12 @@ class PCCVideo {
              const size_t         sizeV0,
              const PCCCOLORFORMAT format,
              const size_t         nbyte );
+  bool write( std::ofstream& outfile, const size_t nbyte );
+  bool read( std::ifstream&       infile,
+             const size_t         sizeU0,
+             const size_t         sizeV0,
+             const PCCCOLORFORMAT format,
+             const size_t         nbyte );
 
 #if defined( WIN32 )
   bool _write( const std::string fileName, const size_t nbyte );
@@ -109,13 +115,6 @@ class PCCVideo {
   void upsample( size_t rate );
 
  private:
-  bool write( std::ofstream& outfile, const size_t nbyte );
-  bool read( std::ifstream&       infile,
-             const size_t         sizeU0,
-             const size_t         sizeV0,
-             const PCCCOLORFORMAT format,
-             const size_t         nbyte );
-
   std::vector<PCCImage<T, N> > frames_;
 };
 
@@ -0,0 +1,75 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCVoxelGrid_h
+#define PCCVoxelGrid_h
+
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+#include "PCCNeighborGraph.h"
+
+namespace pcc {
+
+// Sparse grid of the cells of a point cloud: the occupied cells are found through an open addressing hash table of
+// their linear positions ( x + y * w + z * w * w ) and list the indices of their points in increasing order. The
+// points outside of the w * w * w cells of the grid are not stored.
+class PCCVoxelGrid {
+ public:
+  PCCVoxelGrid();
+  PCCVoxelGrid( const PCCPointSet3& pointCloud, const size_t cellSize, const size_t gridWidth );
+  ~PCCVoxelGrid();
+  void init( const PCCPointSet3& pointCloud, const size_t cellSize, const size_t gridWidth );
+  void clear();
+
+  size_t           getCellSize() const { return cellSize_; }
+  size_t           getGridWidth() const { return gridWidth_; }
+  size_t           getCellCount() const { return cells_.size(); }
+  PCCNeighborRange getPoints( const size_t cell ) const { return cells_[cell]; }
+
+  // index of the cell at the given cell position, or g_undefined_index when the cell is empty
+  uint32_t findCell( const PCCVector3<int>& position ) const;
+
+ private:
+  int64_t  getKey( const PCCVector3<int>& position ) const;
+  uint32_t findKey( const int64_t key ) const;
+
+  size_t                cellSize_;
+  size_t                gridWidth_;
+  uint64_t              cellMask_;
+  std::vector<int64_t>  cellKeys_;
+  std::vector<uint32_t> cellIndexes_;
+  PCCNeighborGraph      cells_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCVoxelGrid_h */
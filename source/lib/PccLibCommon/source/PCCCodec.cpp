@@ -80,65 +80,40 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
       const size_t w =
           ( maxSize + static_cast<int>( params.gridSize_ ) - 1 ) / ( static_cast<int>( params.gridSize_ ) );
 
-      // identify boundary cells
-      size_t           pointCount = reconstruct.getPointCount();
-      std::vector<int> cellIndex;
-      cellIndex.resize( w * w * w );
-      std::fill( cellIndex.begin(), cellIndex.end(), -1 );
-      size_t    numBoundaryCells = 0;
-      const int disth            = ( std::max )( static_cast<int>( params.gridSize_ ) / 2, 1 );
-      const int th               = params.gridSize_ * w;
-      for ( size_t n = 0; n < pointCount; ++n ) {
-        if ( reconstruct.getBoundaryPointType( n ) == 1 ) {
-          PCCVector3<int> P = reconstruct[n];
-          if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
-               th <= P[2] + disth ) {
-            continue;
-          }
-          PCCVector3<int> P2 = P / params.gridSize_;
-          PCCVector3<int> Q( P2[0] + ( ( P[0] % params.gridSize_ < params.gridSize_ / 2 ) ? -1 : 0 ),
-                             P2[1] + ( ( P[1] % params.gridSize_ < params.gridSize_ / 2 ) ? -1 : 0 ),
-                             P2[2] + ( ( P[2] % params.gridSize_ < params.gridSize_ / 2 ) ? -1 : 0 ) );
-          for ( int ix = 0; ix < 2; ix++ ) {
-            for ( int iy = 0; iy < 2; iy++ ) {
-              for ( int iz = 0; iz < 2; iz++ ) {
-                int cellId = ( Q[0] + ix ) + ( Q[1] + iy ) * w + ( Q[2] + iz ) * w * w;
-                if ( cellIndex[cellId] == -1 ) {
-                  cellIndex[cellId] = numBoundaryCells;
-                  numBoundaryCells++;
-                }
-              }
+      // statistics of the cells of the grid, gathered from the points not too close to the border of the grid
+      const int          disth = ( std::max )( static_cast<int>( params.gridSize_ ) / 2, 1 );
+      const int          th    = params.gridSize_ * w;
+      const PCCVoxelGrid grid( reconstruct, params.gridSize_, w );
+      const size_t       cellCount = grid.getCellCount();
+      // the grid buffers are local to the call so that several frames can be smoothed concurrently
+      std::vector<PCCVector3<float>> gridCenter( cellCount );
+      std::vector<uint16_t>          gridCount( cellCount, 0 );
+      std::vector<uint32_t>          gridPartition( cellCount );
+      std::vector<uint8_t>           gridDoSmooth( cellCount, 0 );
+#if defined( ENABLE_TBB )
+      tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), cellCount, [&]( const size_t cell ) {
+#else
+      for ( size_t cell = 0; cell < cellCount; cell++ ) {
+#endif
+          for ( const auto j : grid.getPoints( cell ) ) {
+            PCCVector3<int> P = reconstruct[j];
+            if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
+                 th <= P[2] + disth ) {
+              continue;
             }
+            addGridCentroid( reconstruct[j], partition[j] + 1, gridCount, gridCenter, gridPartition, gridDoSmooth,
+                             static_cast<int>( params.gridSize_ ), w, static_cast<int>( cell ) );
           }
-        }
-      }
-      geoSmoothingCenter_.resize( numBoundaryCells );
-      geoSmoothingCount_.resize( numBoundaryCells );
-      geoSmoothingPartition_.resize( numBoundaryCells );
-      geoSmoothingDoSmooth_.resize( numBoundaryCells );
-      int size = static_cast<int>( geoSmoothingCount_.size() );
-      geoSmoothingCount_.resize( 0 );
-      geoSmoothingCount_.resize( size, 0 );
-      for ( int j = 0; j < reconstruct.getPointCount(); j++ ) {
-        PCCPoint3D      point = reconstruct[j];
-        PCCVector3<int> P     = point;
-        if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
-             th <= P[2] + disth ) {
-          continue;
-        }
-        PCCVector3<int> P2     = point / params.gridSize_;
-        int             cellId = P2[0] + P2[1] * w + P2[2] * w * w;
-        if ( cellIndex[cellId] != -1 ) {
-          addGridCentroid( reconstruct[j], partition[j] + 1, geoSmoothingCount_, geoSmoothingCenter_,
-                           geoSmoothingPartition_, geoSmoothingDoSmooth_, static_cast<int>( params.gridSize_ ), w,
-                           cellIndex[cellId] );
-        }
-      }
-      for ( int i = 0; i < geoSmoothingCount_.size(); i++ ) {
-        if ( geoSmoothingCount_[i] != 0U ) { geoSmoothingCenter_[i] /= geoSmoothingCount_[i]; }
+          if ( gridCount[cell] != 0U ) { gridCenter[cell] /= gridCount[cell]; }
+#if defined( ENABLE_TBB )
+        } );
+      } );
+#else
       }
-      smoothPointCloudGrid( reconstruct, partition, params, w, cellIndex );
-      cellIndex.clear();
+#endif
+      smoothPointCloudGrid( reconstruct, partition, params, grid, gridCount, gridCenter, gridDoSmooth );
     } else {
       if ( !params.pbfEnableFlag_ ) { smoothPointCloud( reconstruct, partition, params ); }
     }
@@ -151,16 +126,10 @@ void PCCCodec::smoothPointCloudPostprocess( PCCPointSet3&
 void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
                                const PCCColorTransform             colorTransform,
                                const GeneratePointCloudParameters& params ) {
-  const size_t     gridSize         = params.occupancyPrecision_;
-  int              pcMaxSize        = pow( 2, params.geometryBitDepth3D_ );
-  const size_t     w                = pcMaxSize / gridSize;
-  const size_t     w3               = w * w * w;
-  size_t           pointCount       = reconstruct.getPointCount();
-  size_t           numBoundaryCells = 0;
-  const size_t     disth            = ( std::max )( gridSize / 2, (size_t)1 );
-  std::vector<int> cellIndex;
-  cellIndex.resize( w3 );
-  std::fill( cellIndex.begin(), cellIndex.end(), -1 );
+  const size_t gridSize  = params.occupancyPrecision_;
+  int          pcMaxSize = pow( 2, params.geometryBitDepth3D_ );
+  const size_t w         = pcMaxSize / gridSize;
+  const double mmThresh  = params.thresholdColorVariation_ * 256.0;
   assert( params.flagColorSmoothing_ );
   TRACE_CODEC( "%s \n", "colorSmoothing" );
   TRACE_CODEC( "  geometryBitDepth3D_       = %zu \n", params.geometryBitDepth3D_ );
@@ -169,72 +138,47 @@ void PCCCodec::colorSmoothing( PCCPointSet3&                       reconstruct,
   TRACE_CODEC( "  pcMaxSize = %d \n", pcMaxSize );
   TRACE_CODEC( "  gridSize  = %zu \n", gridSize );
   TRACE_CODEC( "  w         = %zu \n", w );
-  TRACE_CODEC( "  w3        = %zu \n", w3 );
-  for ( size_t n = 0; n < pointCount; ++n ) {
-    if ( reconstruct.getBoundaryPointType( n ) == 1 ) {
-      PCCPoint3D      point = reconstruct[n];
-      PCCVector3<int> P     = point;
-      if ( P[0] < disth || P[1] < disth || P[2] < disth || pcMaxSize <= P[0] + disth || pcMaxSize <= P[1] + disth ||
-           pcMaxSize <= P[2] + disth ) {
-        continue;
-      }
-      PCCVector3<int> P2 = P / gridSize;
-      PCCVector3<int> Q( P2[0] + ( ( P[0] % gridSize < gridSize / 2 ) ? -1 : 0 ),
-                         P2[1] + ( ( P[1] % gridSize < gridSize / 2 ) ? -1 : 0 ),
-                         P2[2] + ( ( P[2] % gridSize < gridSize / 2 ) ? -1 : 0 ) );
-      for ( int ix = 0; ix < 2; ix++ ) {
-        for ( int iy = 0; iy < 2; iy++ ) {
-          for ( int iz = 0; iz < 2; iz++ ) {
-            int cellId = ( Q[0] + ix ) + ( Q[1] + iy ) * w + ( Q[2] + iz ) * w * w;
-            if ( cellIndex[cellId] == -1 ) {
-              cellIndex[cellId] = numBoundaryCells;
-              numBoundaryCells++;
-            }
-          }
-        }
-      }
-    }
-  }
-  colorSmoothingCenter_.resize( numBoundaryCells );
-  colorSmoothingCount_.resize( numBoundaryCells );
-  colorSmoothingPartition_.resize( numBoundaryCells );
-  colorSmoothingDoSmooth_.resize( numBoundaryCells );
-  std::fill( colorSmoothingCenter_.begin(), colorSmoothingCenter_.end(), 0.f );
-  std::fill( colorSmoothingCount_.begin(), colorSmoothingCount_.end(), 0 );
+  TRACE_CODEC( "  w3        = %zu \n", w * w * w );
+  const PCCVoxelGrid grid( reconstruct, gridSize, w );
+  const size_t       cellCount = grid.getCellCount();
+  // the grid buffers are local to the call so that several frames can be smoothed concurrently
   std::pair<size_t, size_t> initPair;
   initPair.first = initPair.second = 0;
-  std::fill( colorSmoothingPartition_.begin(), colorSmoothingPartition_.end(), initPair );
-  std::fill( colorSmoothingDoSmooth_.begin(), colorSmoothingDoSmooth_.end(), false );
-  colorSmoothingLum_.clear();
-  colorSmoothingLum_.resize( numBoundaryCells );
-  for ( int k = 0; k < reconstruct.getPointCount(); k++ ) {
-    PCCPoint3D      point  = reconstruct[k];
-    PCCVector3<int> P2     = reconstruct[k] / gridSize;
-    int             cellId = P2[0] + P2[1] * w + P2[2] * w * w;
-    if ( cellId >= cellIndex.size() ) {
-      TRACE_CODEC( " cellId >  cellIndex.size() <=>  %zu > %zu \n", cellId, cellIndex.size() );
-    } else {
-      if ( cellIndex[cellId] != -1 ) {
+  std::vector<PCCVector3<float>>         colorGridCenter( cellCount, 0.f );
+  std::vector<uint16_t>                  colorGridCount( cellCount, 0 );
+  std::vector<std::pair<size_t, size_t>> colorGridPartition( cellCount, initPair );
+  std::vector<uint8_t>                   colorGridDoSmooth( cellCount, 0 );
+  std::vector<uint8_t>                   colorGridVariation( cellCount, 0 );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), cellCount, [&]( const size_t cell ) {
+#else
+  for ( size_t cell = 0; cell < cellCount; cell++ ) {
+#endif
+      std::vector<uint16_t> colorLum;
+      for ( const auto k : grid.getPoints( cell ) ) {
         PCCVector3D clr                   = reconstruct.getColor16bit( k );
         auto        tilePatchIndexPlusOne = reconstruct.getPointPatchIndex( k );
         tilePatchIndexPlusOne.second      = tilePatchIndexPlusOne.second + 1;
-        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingPartition_, colorSmoothingDoSmooth_, gridSize, colorSmoothingLum_, params,
-                              cellIndex[cellId] );
+        addGridColorCentroid( reconstruct[k], clr, tilePatchIndexPlusOne, colorGridCount, colorGridCenter,
+                              colorGridPartition, colorGridDoSmooth, gridSize, colorLum, params,
+                              static_cast<int>( cell ) );
       }
-    }
+      // the cells whose luma mean and median are too different are not used as centroids
+      if ( colorGridCount[cell] > 1 ) {
+        double meanY             = mean( colorLum, int( colorGridCount[cell] ) );
+        double medianY           = median( colorLum, int( colorGridCount[cell] ) );
+        colorGridVariation[cell] = abs( meanY - medianY ) > mmThresh ? 1 : 0;
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
   }
-  smoothPointCloudColorLC( reconstruct, params, cellIndex );
-  colorSmoothingCenter_.resize( 0 );
-  colorSmoothingCenter_.shrink_to_fit();
-  colorSmoothingCount_.resize( 0 );
-  colorSmoothingCount_.shrink_to_fit();
-  colorSmoothingPartition_.resize( 0 );
-  colorSmoothingPartition_.shrink_to_fit();
-  colorSmoothingDoSmooth_.resize( 0 );
-  colorSmoothingDoSmooth_.shrink_to_fit();
-  colorSmoothingLum_.resize( 0 );
-  colorSmoothingLum_.shrink_to_fit();
+#endif
+  smoothPointCloudColorLC( reconstruct, params, grid, colorGridCount, colorGridCenter, colorGridDoSmooth,
+                           colorGridVariation );
 }
 
 int PCCCodec::getDeltaNeighbors( const PCCImageGeometry& frame,
@@ -326,23 +270,24 @@ void PCCCodec::identifyBoundaryPoints( const std::vector<uint32_t>& occupancyMap
   }
 }
 
-std::vector<PCCPoint3D> PCCCodec::generatePoints( const GeneratePointCloudParameters&  params,
-                                                  PCCFrameContext&                     tile,
-                                                  const std::vector<PCCVideoGeometry>& videoGeometryMultiple,
-                                                  const size_t                         videoFrameIndex,
-                                                  const size_t                         patchIndex,
-                                                  const size_t                         u,
-                                                  const size_t                         v,
-                                                  const size_t                         x,
-                                                  const size_t                         y,
-                                                  const bool                           interpolate,
-                                                  const bool                           filling,
-                                                  const size_t                         minD1,
-                                                  const size_t                         neighbor ) {
-  const auto&             patch  = tile.getPatch( patchIndex );
-  auto&                   frame0 = videoGeometryMultiple[0].getFrame( videoFrameIndex );
-  std::vector<PCCPoint3D> createdPoints;
-  PCCPoint3D              point0;
+void PCCCodec::generatePoints( const GeneratePointCloudParameters&  params,
+                               PCCFrameContext&                     tile,
+                               const std::vector<PCCVideoGeometry>& videoGeometryMultiple,
+                               const size_t                         videoFrameIndex,
+                               const size_t                         patchIndex,
+                               const size_t                         u,
+                               const size_t                         v,
+                               const size_t                         x,
+                               const size_t                         y,
+                               std::vector<PCCPoint3D>&             createdPoints,
+                               const bool                           interpolate,
+                               const bool                           filling,
+                               const size_t                         minD1,
+                               const size_t                         neighbor ) {
+  const auto& patch  = tile.getPatch( patchIndex );
+  auto&       frame0 = videoGeometryMultiple[0].getFrame( videoFrameIndex );
+  PCCPoint3D  point0;
+  createdPoints.clear();
   if ( params.pbfEnableFlag_ ) {
     point0 = patch.generatePoint( u, v, patch.getDepthMap( u, v ) );
   } else {
@@ -434,7 +379,7 @@ std::vector<PCCPoint3D> PCCCodec::generatePoints( const GeneratePointCloudParame
         if ( depthNeighbors[3] > maximumDepth ) { maximumDepth = depthNeighbors[3]; }
       }
     }
-    if ( count == 0 ) { return createdPoints; }
+    if ( count == 0 ) { return; }
     if ( ( x + y ) % 2 == 1 ) {
       depth1 = point0[patch.getNormalAxis()];
       PCCPoint3D interpolateD0( point0 );
@@ -513,9 +458,16 @@ std::vector<PCCPoint3D> PCCCodec::generatePoints( const GeneratePointCloudParame
       createdPoints.push_back( point1 );
     }  // if ( params.mapCountMinus1_ > 0 ) {
   }    // fi (pointLocalReconstruction)
-  return createdPoints;
 }
 
+// Regular point generated by generatePointCloud() before being copied in the reconstructed point cloud
+struct PCCGeneratedPoint {
+  PCCPoint3D position_;
+  uint32_t   patchIndex_;
+  uint8_t    type_;
+  bool       isBoundary_;
+};
+
 void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstruct,
                                    PCCContext&                         context,
                                    size_t                              frameIndex,
@@ -537,6 +489,8 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   uint32_t     patchIndex            = 0;
   const size_t mapCount              = params.mapCountMinus1_ + 1;
   reconstruct.addColors();
+  reconstruct.addBoundaryPointTypes();
+  reconstruct.addPointPatchIndexes();
   printf( "generatePointCloud pbfEnableFlag_ = %d \n", params.pbfEnableFlag_ );
   fflush( stdout );
   TRACE_CODEC( "generatePointCloud pbfEnableFlag_ = %d \n", params.pbfEnableFlag_ );
@@ -601,6 +555,24 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   pointToPixel.resize( 0 );
   reconstruct.clear();
 
+  // The points of the patches are first generated in per-thread buffers, recycled from one frame to the next, and
+  // copied in the reconstructed point cloud once the EOM and the raw points have been counted.
+  static thread_local std::vector<PCCGeneratedPoint> generatedPoints;
+  static thread_local std::vector<PCCPoint3D>        createdPoints;
+
+  // reserve the points of the occupied pixels in each map and the raw points to avoid reallocations
+  size_t reservedPointCount = 0;
+  for ( auto occupancy : occupancyMap ) { reservedPointCount += occupancy != 0U ? mapCount : 0; }
+  if ( params.useAdditionalPointsPatch_ ) {
+    for ( size_t i = 0; i < tile.getNumberOfRawPointsPatches(); i++ ) {
+      reservedPointCount += tile.getRawPointsPatch( i ).getNumberOfRawPoints();
+    }
+  }
+  generatedPoints.clear();
+  generatedPoints.reserve( reservedPointCount );
+  pointToPixel.reserve( reservedPointCount );
+  partition.reserve( partition.size() + reservedPointCount );
+
   TRACE_CODEC( " Frame %zu in generatePointCloud \n", tile.getFrameIndex() );
   TRACE_CODEC( " params.useAdditionalPointsPatch = %d \n", params.useAdditionalPointsPatch_ );
   TRACE_CODEC( " params.enhancedOccupancyMapCode   = %d \n", params.enhancedOccupancyMapCode_ );
@@ -624,7 +596,25 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   if ( !params.pbfEnableFlag_ ) { BPflag.resize( tileWidth * tileHeight, 0 ); }
 
   std::vector<std::vector<PCCPoint3D>> eomPointsPerPatch;
+  std::vector<PCCColor3B>              patchColors;
   eomPointsPerPatch.resize( totalPatchCount );
+  patchColors.resize( totalPatchCount );
+  auto addGeneratedPoint = [&]( const PCCPatch& patch, uint32_t patchIndex, const PCCPoint3D& point, uint8_t type,
+                                bool isBoundary ) {
+    PCCGeneratedPoint generatedPoint;
+    if ( patch.getAxisOfAdditionalPlane() == 0 ) {
+      generatedPoint.position_ = point;
+    } else {
+      PCCVector3D tmp;
+      inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_, point, tmp );
+      generatedPoint.position_ = PCCPoint3D( (int16_t)tmp[0], (int16_t)tmp[1], (int16_t)tmp[2] );
+    }
+    generatedPoint.patchIndex_ = patchIndex;
+    generatedPoint.type_       = type;
+    generatedPoint.isBoundary_ = isBoundary;
+    generatedPoints.push_back( generatedPoint );
+    return generatedPoints.size() - 1;
+  };
   uint32_t   index;
   const bool patchPrecedenceOrderFlag = context.getAtlasSequenceParameterSet( 0 ).getPatchPrecedenceOrderFlag();
   for ( index = 0; index < patches.size(); index++ ) {
@@ -638,7 +628,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
         patchIndex, totalPatchCount, patch.getU0(), patch.getV0(), patch.getSizeU0(), patch.getSizeV0(), patch.getU1(),
         patch.getV1(), patch.getD1(), patch.getSizeU0() * patch.getOccupancyResolution(),
         patch.getSizeV0() * patch.getOccupancyResolution(), patch.getNormalAxis(), patch.getTangentAxis(),
-        patch.getBitangentAxis(), patch.getPatchOrientation(), patch.getProjectionMode(), reconstruct.getPointCount(),
+        patch.getBitangentAxis(), patch.getPatchOrientation(), patch.getProjectionMode(), generatedPoints.size(),
         patch.getAxisOfAdditionalPlane() );
 
     while ( color[0] == color[1] || color[2] == color[1] || color[2] == color[0] ) {
@@ -646,6 +636,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
       color[1] = static_cast<uint8_t>( rand() % 32 ) * 8;
       color[2] = static_cast<uint8_t>( rand() % 32 ) * 8;
     }
+    patchColors[patchIndex] = color;
     for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
       for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
         const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
@@ -671,18 +662,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
               if ( params.enhancedOccupancyMapCode_ ) {
                 // D0
                 PCCPoint3D point0 = patch.generatePoint( u, v, frame0.getValue( 0, xInVideoFrame, yInVideoFrame ) );
-                size_t     pointIndex0;  // = reconstruct.addPoint(point0);
-                if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                  pointIndex0 = reconstruct.addPoint( point0 );
-                } else {
-                  PCCVector3D tmp;
-                  inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
-                                                       point0, tmp );
-                  pointIndex0 = reconstruct.addPoint( tmp );
-                }
-                reconstruct.setPointPatchIndex( pointIndex0, tileIndex, patchIndex );
-                reconstruct.setColor( pointIndex0, color );
-                if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex0, POINT_D0 ); }
+                addGeneratedPoint( patch, patchIndex, point0, POINT_D0, false );
                 partition.push_back( uint32_t( patchIndex ) );
                 pointToPixel.emplace_back( x, y, 0 );
                 uint16_t    eomCode = 0;
@@ -717,18 +697,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
                 PCCPoint3D point1( point0 );
                 if ( eomCode == 0 ) {
                   if ( !params.removeDuplicatePoints_ ) {
-                    size_t pointIndex1;  // = reconstruct.addPoint(point1);
-                    if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                      pointIndex1 = reconstruct.addPoint( point1 );
-                    } else {
-                      PCCVector3D tmp;
-                      inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
-                                                           point1, tmp );
-                      pointIndex1 = reconstruct.addPoint( tmp );
-                    }
-                    reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
-                    reconstruct.setColor( pointIndex1, color );
-                    if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
+                    addGeneratedPoint( patch, patchIndex, point1, POINT_D1, false );
                     partition.push_back( uint32_t( patchIndex ) );
                     pointToPixel.emplace_back( x, y, 1 );
                   }
@@ -749,17 +718,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
                             static_cast<double>( point0[patch.getNormalAxis()] - deltaDCur );
                       }
                       if ( ( eomCode == 1 || i == d1pos ) && ( params.mapCountMinus1_ > 0 ) ) {  // d1
-                        if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                          pointIndex1 = reconstruct.addPoint( point1 );
-                        } else {
-                          PCCVector3D tmp;
-                          inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                               params.geometryBitDepth3D_, point1, tmp );
-                          pointIndex1 = reconstruct.addPoint( tmp );
-                        }
-                        reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
-                        reconstruct.setColor( pointIndex1, color );
-                        if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
+                        pointIndex1 = addGeneratedPoint( patch, patchIndex, point1, POINT_D1, false );
                         partition.push_back( uint32_t( patchIndex ) );
                         pointToPixel.emplace_back( x, y, 1 );
                       } else {
@@ -775,47 +734,35 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
                       addedPointCount++;
                     }
                   }  // for each bit of EOM code
-                  if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_D1 ); }
+                  if ( PCC_SAVE_POINT_TYPE == 1 ) { generatedPoints[pointIndex1].type_ = POINT_D1; }
                   // Without "Identify boundary points" & "1st Extension boundary region" as EOM code is only for
                   // lossless coding now
                 }       // if (eomCode == 0)
               } else {  // not params.enhancedOccupancyMapCode_
-                std::vector<PCCPoint3D> createdPoints;
                 if ( params.pointLocalReconstruction_ ) {
                   auto& mode =
                       context.getPointLocalReconstructionMode( patch.getPointLocalReconstructionMode( u0, v0 ) );
-                  createdPoints = generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u,
-                                                  v, xInVideoFrame, yInVideoFrame, mode.interpolate_, mode.filling_,
-                                                  mode.minD1_, mode.neighbor_ );
+                  generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u, v, xInVideoFrame,
+                                  yInVideoFrame, createdPoints, mode.interpolate_, mode.filling_, mode.minD1_,
+                                  mode.neighbor_ );
                 } else {
-                  createdPoints = generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u,
-                                                  v, xInVideoFrame, yInVideoFrame );
+                  generatePoints( params, tile, videoGeometryMultiple, videoFrameIndex, patchIndex, u, v, xInVideoFrame,
+                                  yInVideoFrame, createdPoints );
                 }
                 if ( !createdPoints.empty() ) {
                   for ( size_t i = 0; i < createdPoints.size(); i++ ) {
                     if ( ( !params.removeDuplicatePoints_ ) ||
                          ( ( i == 0 ) || ( createdPoints[i] != createdPoints[0] ) ) ) {
-                      size_t pointindex = 0;
-                      if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                        pointindex = reconstruct.addPoint( createdPoints[i] );
-                        reconstruct.setPointPatchIndex( pointindex, tileIndex, patchIndex );
-                      } else {
-                        PCCVector3D tmp;
-                        inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                             params.geometryBitDepth3D_, createdPoints[i], tmp );
-                        pointindex = reconstruct.addPoint( tmp );
-                        reconstruct.setPointPatchIndex( pointindex, tileIndex, patchIndex );
-                      }
-                      const size_t pointindex_1 = pointindex;
-                      reconstruct.setColor( pointindex_1, color );
-                      if ( params.pbfEnableFlag_ ) { reconstruct.setBoundaryPointType( pointindex_1, isBoundary ); }
+                      const size_t pointindex_1 =
+                          addGeneratedPoint( patch, patchIndex, createdPoints[i], POINT_UNSET, isBoundary );
                       if ( PCC_SAVE_POINT_TYPE == 1 ) {
+                        auto& type = generatedPoints[pointindex_1].type_;
                         if ( params.singleMapPixelInterleaving_ ) {
                           size_t flag;
                           flag = ( i == 0 ) ? ( x + y ) % 2 : ( i == 1 ) ? ( x + y + 1 ) % 2 : g_intermediateLayerIndex;
-                          reconstruct.setType( pointindex_1, flag == 0 ? POINT_D0 : flag == 1 ? POINT_D1 : POINT_DF );
+                          type = flag == 0 ? POINT_D0 : flag == 1 ? POINT_D1 : POINT_DF;
                         } else {
-                          reconstruct.setType( pointindex_1, i == 0 ? POINT_D0 : i == 1 ? POINT_D1 : POINT_DF );
+                          type = i == 0 ? POINT_D0 : i == 1 ? POINT_D1 : POINT_DF;
                         }
                       }
                       partition.push_back( uint32_t( patchIndex ) );
@@ -840,11 +787,41 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
       }
     }
   }
-  tile.setTotalNumberOfRegularPoints( reconstruct.getPointCount() );
-  printf( "frame %zu, tile %zu: regularPoints %zu\n", frameIndex, tileIndex, reconstruct.getPointCount() );
-  patchIndex                         = index;
-  size_t       totalEOMPointsInFrame = 0;
-  PCCPointSet3 eomSavedPoints;
+
+  // size the reconstructed point cloud once for the regular, the EOM and the raw points
+  const size_t regularPointCount = generatedPoints.size();
+  size_t       filledPointCount  = regularPointCount;
+  if ( params.enhancedOccupancyMapCode_ ) {
+    for ( auto& eomPatch : tile.getEomPatches() ) {
+      for ( auto memberPatch : eomPatch.memberPatches_ ) {
+        size_t memberPatchIdx =
+            ( bDecoder && patchPrecedenceOrderFlag ) ? ( totalPatchCount - memberPatch - 1 ) : memberPatch;
+        filledPointCount += eomPointsPerPatch[memberPatchIdx].size();
+      }
+    }
+  }
+  if ( params.useAdditionalPointsPatch_ ) {
+    for ( size_t i = 0; i < tile.getNumberOfRawPointsPatches(); i++ ) {
+      auto& rawPointsPatch = tile.getRawPointsPatch( i );
+      filledPointCount += ( std::min )( rawPointsPatch.getNumberOfRawPoints(),
+                                        rawPointsPatch.sizeU0_ * rawPointsPatch.occupancyResolution_ *
+                                            rawPointsPatch.sizeV0_ * rawPointsPatch.occupancyResolution_ );
+    }
+  }
+  reconstruct.resize( filledPointCount );
+  for ( size_t i = 0; i < regularPointCount; i++ ) {
+    const auto& generatedPoint = generatedPoints[i];
+    reconstruct[i]             = generatedPoint.position_;
+    reconstruct.setPointPatchIndex( i, tileIndex, generatedPoint.patchIndex_ );
+    reconstruct.setColor( i, patchColors[generatedPoint.patchIndex_] );
+    if ( params.pbfEnableFlag_ ) { reconstruct.setBoundaryPointType( i, generatedPoint.isBoundary_ ); }
+    if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( i, generatedPoint.type_ ); }
+  }
+  filledPointCount = regularPointCount;
+  tile.setTotalNumberOfRegularPoints( regularPointCount );
+  printf( "frame %zu, tile %zu: regularPoints %zu\n", frameIndex, tileIndex, regularPointCount );
+  patchIndex                   = index;
+  size_t totalEOMPointsInFrame = 0;
   if ( params.enhancedOccupancyMapCode_ ) {
     const size_t blockSize     = params.occupancyResolution_ * params.occupancyResolution_;
     size_t       numEOMPatches = tile.getEomPatches().size();
@@ -869,10 +846,10 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
               uBlock * params.occupancyResolution_ + nPixelInCurrentBlockCount % params.occupancyResolution_ + u0Eom;
           size_t vv =
               vBlock * params.occupancyResolution_ + nPixelInCurrentBlockCount / params.occupancyResolution_ + v0Eom;
-          PCCPoint3D point1      = eomPointsPerPatch[memberPatchIdx][pointCount];
-          size_t     pointIndex1 = reconstruct.addPoint( point1 );
+          PCCPoint3D point1       = eomPointsPerPatch[memberPatchIdx][pointCount];
+          size_t     pointIndex1  = filledPointCount++;
+          reconstruct[pointIndex1] = point1;
           reconstruct.setPointPatchIndex( pointIndex1, tileIndex, patchIndex );
-          eomSavedPoints.addPoint( point1 );
 
           // reconstruct.setColor( pointIndex1, color );
           if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( pointIndex1, POINT_EOM ); }
@@ -886,13 +863,13 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
                    eomPatch.eomCount_ );
     }
     tile.setTotalNumberOfEOMPoints( totalEOMPointsInFrame );
-    printf( "frame %zu, tile %zu: regularPoints+eomPoints %zu\n", frameIndex, tileIndex, reconstruct.getPointCount() );
+    printf( "frame %zu, tile %zu: regularPoints+eomPoints %zu\n", frameIndex, tileIndex, filledPointCount );
   } else {
     tile.setTotalNumberOfEOMPoints( 0 );
-    printf( "frame %zu, tile %zu: regularPoints+eomPoints %zu\n", frameIndex, tileIndex, reconstruct.getPointCount() );
+    printf( "frame %zu, tile %zu: regularPoints+eomPoints %zu\n", frameIndex, tileIndex, filledPointCount );
   }
   TRACE_CODEC( " totalEOMPointsInFrame = %zu  \n", totalEOMPointsInFrame );
-  TRACE_CODEC( " point = %zu  \n", reconstruct.getPointCount() );
+  TRACE_CODEC( " point = %zu  \n", filledPointCount );
   if ( params.useAdditionalPointsPatch_ ) {
     auto& frameRawPoint = useRawPointsSeparateVideo
                               ? (const PCCImageGeometry&)context.getVideoRawPointsGeometry()[tile.getFrameIndex()]
@@ -929,14 +906,17 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
         }  // u
       }    // v
       size_t counter = 0;
+      size_t pointIndex = filledPointCount;
+      filledPointCount += ( std::min )( numRawPoints, rawPointsPatch.sizeU_ * rawPointsPatch.sizeV_ );
       for ( size_t v = 0; v < rawPointsPatch.sizeV_; ++v ) {
         for ( size_t u = 0; u < rawPointsPatch.sizeU_; ++u ) {
           if ( counter < numRawPoints ) {
-            const size_t pointIndex = reconstruct.addPoint( rawPoints[counter] );
+            reconstruct[pointIndex] = rawPoints[counter];
             reconstruct.setPointPatchIndex( pointIndex, tileIndex, patchIndex );
             reconstruct.setColor( pointIndex, rawPointsColor );
             partition.push_back( uint32_t( patchIndex ) );
             pointToPixel.emplace_back( u0 + u, v0 + v, 0 );
+            pointIndex++;
             counter++;
           }
         }
@@ -984,32 +964,31 @@ void PCCCodec::addGridCentroid( PCCPoint3D&                     point,
                                 std::vector<uint16_t>&          count,
                                 std::vector<PCCVector3<float>>& centerGrid,
                                 std::vector<uint32_t>&          gpartition,
-                                std::vector<bool>&              doSmooth,
+                                std::vector<uint8_t>&           doSmooth,
                                 uint8_t                         gridSize,
                                 uint16_t                        gridWidth,
                                 int                             cellId ) {
   if ( count[cellId] == 0 ) {
     gpartition[cellId] = patchIdx;
     centerGrid[cellId] = {0., 0., 0.};
-    doSmooth[cellId]   = false;
-  } else if ( !doSmooth[cellId] && gpartition[cellId] != patchIdx ) {
-    doSmooth[cellId] = true;
+    doSmooth[cellId]   = 0;
+  } else if ( doSmooth[cellId] == 0U && gpartition[cellId] != patchIdx ) {
+    doSmooth[cellId] = 1;
   }
   centerGrid[cellId] += PCCVector3<float>( point );
   count[cellId]++;
 }
 
-bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
-                              PCCPointSet3&                   pointCloud,
-                              PCCPoint3D&                     curPoint,
-                              PCCVector3D&                    centroid,
-                              int&                            count,
-                              std::vector<uint16_t>&          gridCount,
-                              std::vector<PCCVector3<float>>& center,
-                              std::vector<bool>&              doSmooth,
-                              uint8_t                         gridSize,
-                              uint16_t                        gridWidth,
-                              std::vector<int>&               cellIndex ) {
+bool PCCCodec::gridFiltering( const std::vector<uint32_t>&          partition,
+                              PCCPointSet3&                         pointCloud,
+                              PCCPoint3D&                           curPoint,
+                              PCCVector3D&                          centroid,
+                              int&                                  count,
+                              const std::vector<uint16_t>&          gridCount,
+                              const std::vector<PCCVector3<float>>& center,
+                              const std::vector<uint8_t>&           doSmooth,
+                              uint8_t                               gridSize,
+                              const PCCVoxelGrid&                   grid ) {
   const uint16_t  gridSizeHalf           = gridSize / 2;
   bool            otherClusterPointCount = false;
   PCCVector3<int> P                      = curPoint;
@@ -1017,13 +996,15 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   PCCVector3<int> P3                     = P - P2 * gridSize;
   PCCVector3<int> S( P2[0] + ( ( P3[0] < gridSizeHalf ) ? -1 : 0 ), P2[1] + ( ( P3[1] < gridSizeHalf ) ? -1 : 0 ),
                      P2[2] + ( ( P3[2] < gridSizeHalf ) ? -1 : 0 ) );
-  int             idx[2][2][2];
+  uint32_t        idx[2][2][2];
+  uint16_t        cnt[2][2][2];
   for ( int dz = 0; dz < 2; dz++ ) {
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
-        int tmp         = ( S[0] + dx ) + ( S[1] + dy ) * gridWidth + ( S[2] + dz ) * gridWidth * gridWidth;
-        idx[dz][dy][dx] = tmp;
-        if ( doSmooth[cellIndex[tmp]] && ( gridCount[cellIndex[tmp]] != 0U ) ) { otherClusterPointCount = true; }
+        const uint32_t cell = grid.findCell( PCCVector3<int>( S[0] + dx, S[1] + dy, S[2] + dz ) );
+        idx[dz][dy][dx]     = cell;
+        cnt[dz][dy][dx]     = cell != g_undefined_index ? gridCount[cell] : 0;
+        if ( cnt[dz][dy][dx] != 0U && doSmooth[cell] != 0U ) { otherClusterPointCount = true; }
       }
     }
   }
@@ -1031,18 +1012,12 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   PCCVector3D     centroid3[2][2][2] = {};
   PCCVector3D     curVector          = P;
   int             gridSize2          = gridSize * 2;
-  int             gridWidth3         = gridWidth * gridWidth * gridWidth;
   PCCVector3<int> S2                 = S * gridSize;
   PCCVector3<int> W                  = ( P - S2 - gridSizeHalf ) * 2 + 1;
   for ( int dz = 0; dz < 2; dz++ ) {
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
-        if ( ( dx == 0 && dy == 0 && dz == 0 ) || ( idx[dz][dy][dx] < gridWidth3 ) ) {
-          auto index            = cellIndex[idx[dz][dy][dx]];
-          centroid3[dz][dy][dx] = gridCount[index] > 0 ? PCCVector3<double>( center[index] ) : curVector;
-        } else {
-          centroid3[dz][dy][dx] = curVector;
-        }
+        centroid3[dz][dy][dx] = cnt[dz][dy][dx] > 0 ? PCCVector3<double>( center[idx[dz][dy][dx]] ) : curVector;
       }
     }
   }
@@ -1054,7 +1029,7 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
       for ( int dx = 0, a = Q[0]; dx < 2; dx++, a = W[0] ) {
         centroid3[dz][dy][dx] *= a * b * c;
         centroid4 += centroid3[dz][dy][dx];
-        count += a * b * c * gridCount[cellIndex[idx[dz][dy][dx]]];
+        count += a * b * c * cnt[dz][dy][dx];
       }
     }
   }
@@ -1064,44 +1039,54 @@ bool PCCCodec::gridFiltering( const std::vector<uint32_t>&    partition,
   return otherClusterPointCount;
 }
 
-void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconstruct,
-                                     const std::vector<uint32_t>&        partition,
-                                     const GeneratePointCloudParameters& params,
-                                     uint16_t                            gridWidth,
-                                     std::vector<int>&                   cellIndex ) {
+void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                         reconstruct,
+                                     const std::vector<uint32_t>&          partition,
+                                     const GeneratePointCloudParameters&   params,
+                                     const PCCVoxelGrid&                   grid,
+                                     const std::vector<uint16_t>&          gridCount,
+                                     const std::vector<PCCVector3<float>>& gridCenter,
+                                     const std::vector<uint8_t>&           gridDoSmooth ) {
   TRACE_CODEC( "%s \n", "smoothPointCloudGrid start" );
+  // each point only reads the cell statistics and updates itself, so the points are smoothed concurrently
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = static_cast<int>( params.gridSize_ );
   const int    disth      = ( std::max )( gridSize / 2, 1 );
-  const int    th         = gridSize * gridWidth;
-  for ( int c = 0; c < pointCount; c++ ) {
-    PCCPoint3D      curPoint = reconstruct[c];
-    PCCVector3<int> P        = curPoint;
-    if ( P[0] < disth || P[1] < disth || P[2] < disth || th <= P[0] + disth || th <= P[1] + disth ||
-         th <= P[2] + disth ) {
-      continue;
-    }
-    PCCVector3D centroid( 0.0 );
-    PCCVector3D curVector              = P;
-    int         count                  = 0;
-    bool        otherClusterPointCount = false;
-    PCCVector3D color( 0, 0, 0 );
-    if ( reconstruct.getBoundaryPointType( c ) == 1 ) {
-      otherClusterPointCount =
-          gridFiltering( partition, reconstruct, curPoint, centroid, count, geoSmoothingCount_, geoSmoothingCenter_,
-                         geoSmoothingDoSmooth_, gridSize, gridWidth, cellIndex );
-    }
-    if ( otherClusterPointCount ) {
-      double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
-      if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
-        centroid = centroid / static_cast<double>( count ) + 0.5;
-        for ( size_t k = 0; k < 3; ++k ) { centroid[k] = double( int64_t( centroid[k] ) ); }
-        reconstruct[c] = centroid;
-        if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
-        reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
+  const int    th         = gridSize * static_cast<int>( grid.getGridWidth() );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t c ) {
+#else
+  for ( size_t c = 0; c < pointCount; c++ ) {
+#endif
+      PCCPoint3D      curPoint = reconstruct[c];
+      PCCVector3<int> P        = curPoint;
+      const bool      inside   = P[0] >= disth && P[1] >= disth && P[2] >= disth && th > P[0] + disth &&
+                                 th > P[1] + disth && th > P[2] + disth;
+      PCCVector3D     centroid( 0.0 );
+      PCCVector3D     curVector              = P;
+      int             count                  = 0;
+      bool            otherClusterPointCount = false;
+      if ( inside && reconstruct.getBoundaryPointType( c ) == 1 ) {
+        otherClusterPointCount = gridFiltering( partition, reconstruct, curPoint, centroid, count, gridCount,
+                                                gridCenter, gridDoSmooth, gridSize, grid );
       }
-    }
+      if ( otherClusterPointCount ) {
+        double dist2 = ( ( curVector * count - centroid ).getNorm2() ) / static_cast<double>( count ) + 0.5;
+        if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
+          centroid = centroid / static_cast<double>( count ) + 0.5;
+          for ( size_t k = 0; k < 3; ++k ) { centroid[k] = double( int64_t( centroid[k] ) ); }
+          reconstruct[c] = centroid;
+          if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
+          reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
   }
+#endif
   TRACE_CODEC( "%s \n", "smoothPointCloudGrid done" );
 }
 
@@ -1173,35 +1158,36 @@ void PCCCodec::addGridColorCentroid( PCCPoint3D&                             poi
                                      std::vector<uint16_t>&                  colorGridCount,
                                      std::vector<PCCVector3<float>>&         colorCenter,
                                      std::vector<std::pair<size_t, size_t>>& colorPartition,
-                                     std::vector<bool>&                      colorDoSmooth,
+                                     std::vector<uint8_t>&                   colorDoSmooth,
                                      uint8_t                                 gridSize,
-                                     std::vector<std::vector<uint16_t>>&     colorLum,
+                                     std::vector<uint16_t>&                  colorLum,
                                      const GeneratePointCloudParameters&     params,
                                      int                                     cellId ) {
   if ( colorGridCount[cellId] == 0 ) {
     colorPartition[cellId] = tilePatchIdx;
     colorCenter[cellId]    = {0., 0., 0.};
-    colorDoSmooth[cellId]  = false;
-  } else if ( !colorDoSmooth[cellId] && colorPartition[cellId] != tilePatchIdx ) {
-    colorDoSmooth[cellId] = true;
+    colorDoSmooth[cellId]  = 0;
+  } else if ( colorDoSmooth[cellId] == 0U && colorPartition[cellId] != tilePatchIdx ) {
+    colorDoSmooth[cellId] = 1;
   }
   colorCenter[cellId] += PCCVector3<float>( color );
   colorGridCount[cellId]++;
-  colorLum[cellId].push_back( uint16_t( color[0] ) );
+  colorLum.push_back( uint16_t( color[0] ) );
 }
 
-bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
-                                   PCCVector3D&                        colorCentroid,
-                                   int&                                colorCount,
-                                   std::vector<uint16_t>&              colorGridCount,
-                                   std::vector<PCCVector3<float>>&     colorCenter,
-                                   std::vector<bool>&                  colorDoSmooth,
-                                   uint8_t                             gridSize,
-                                   PCCVector3D&                        curPosColor,
-                                   const GeneratePointCloudParameters& params,
-                                   std::vector<int>&                   cellIndex ) {
-  int             idx[2][2][2];
-  const int       w                      = pow( 2, params.geometryBitDepth3D_ ) / gridSize;
+bool PCCCodec::gridFilteringColor( PCCPoint3D&                           curPos,
+                                   PCCVector3D&                          colorCentroid,
+                                   int&                                  colorCount,
+                                   const std::vector<uint16_t>&          colorGridCount,
+                                   const std::vector<PCCVector3<float>>& colorCenter,
+                                   const std::vector<uint8_t>&           colorDoSmooth,
+                                   const std::vector<uint8_t>&           colorVariation,
+                                   uint8_t                               gridSize,
+                                   PCCVector3D&                          curPosColor,
+                                   const GeneratePointCloudParameters&   params,
+                                   const PCCVoxelGrid&                   grid ) {
+  uint32_t        idx[2][2][2];
+  uint16_t        cnt[2][2][2];
   bool            otherClusterPointCount = false;
   PCCVector3<int> P                      = curPos;
   PCCVector3<int> P2                     = P / gridSize;
@@ -1211,10 +1197,10 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
   for ( int dz = 0; dz < 2; dz++ ) {
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
-        idx[dz][dy][dx] = ( S[0] + dx ) + ( S[1] + dy ) * w + ( S[2] + dz ) * w * w;
-        if ( colorDoSmooth[cellIndex[idx[dz][dy][dx]]] && ( colorGridCount[cellIndex[idx[dz][dy][dx]]] != 0U ) ) {
-          otherClusterPointCount = true;
-        }
+        const uint32_t cell = grid.findCell( PCCVector3<int>( S[0] + dx, S[1] + dy, S[2] + dz ) );
+        idx[dz][dy][dx]     = cell;
+        cnt[dz][dy][dx]     = cell != g_undefined_index ? colorGridCount[cell] : 0;
+        if ( cnt[dz][dy][dx] != 0U && colorDoSmooth[cell] != 0U ) { otherClusterPointCount = true; }
       }
     }
   }
@@ -1223,35 +1209,26 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
   PCCVector3<int> W                       = ( P - S2 - gridSize / 2 ) * 2 + 1;
   PCCVector3D     colorCentroid3[2][2][2] = {};
   const int       gridSize2               = gridSize * 2;
-  const double    mmThresh                = params.thresholdColorVariation_ * 256.0;
   const double    yThresh                 = params.thresholdColorDifference_ * 256.0;
   double          Y0                      = 0;
   for ( int dz = 0; dz < 2; dz++ ) {
     for ( int dy = 0; dy < 2; dy++ ) {
       for ( int dx = 0; dx < 2; dx++ ) {
-        int   index = cellIndex[idx[dz][dy][dx]];
-        auto& dst   = colorCentroid3[dz][dy][dx];
-        if ( colorGridCount[index] > 0 ) {
+        const uint32_t index = idx[dz][dy][dx];
+        auto&          dst   = colorCentroid3[dz][dy][dx];
+        if ( cnt[dz][dy][dx] > 0 ) {
           for ( size_t c = 0; c < 3; c++ ) {
             dst[c] = double( colorCenter[index][c] ) / double( colorGridCount[index] );
           }
           if ( dx == 0 && dy == 0 && dz == 0 ) {
-            if ( colorGridCount[index] > 1 ) {
-              double meanY   = mean( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              double medianY = median( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              if ( abs( meanY - medianY ) > mmThresh ) {
-                colorCentroid = curPosColor;
-                colorCount    = 1;
-                return otherClusterPointCount;
-              }
+            if ( colorVariation[index] != 0U ) {
+              colorCentroid = curPosColor;
+              colorCount    = 1;
+              return otherClusterPointCount;
             }
           } else {
             if ( abs( Y0 - dst[0] ) > yThresh ) { dst = curPosColor; }
-            if ( colorGridCount[index] > 1 ) {
-              double meanY   = mean( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              double medianY = median( colorSmoothingLum_[index], int( colorGridCount[index] ) );
-              if ( abs( meanY - medianY ) > mmThresh ) { dst = curPosColor; }
-            }
+            if ( colorVariation[index] != 0U ) { dst = curPosColor; }
           }
         } else {
           dst = curPosColor;
@@ -1276,44 +1253,59 @@ bool PCCCodec::gridFilteringColor( PCCPoint3D&                         curPos,
   return otherClusterPointCount;
 }
 
-void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                       reconstruct,
-                                        const GeneratePointCloudParameters& params,
-                                        std::vector<int>&                   cellIndex ) {
+void PCCCodec::smoothPointCloudColorLC( PCCPointSet3&                         reconstruct,
+                                        const GeneratePointCloudParameters&   params,
+                                        const PCCVoxelGrid&                   grid,
+                                        const std::vector<uint16_t>&          colorGridCount,
+                                        const std::vector<PCCVector3<float>>& colorGridCenter,
+                                        const std::vector<uint8_t>&           colorGridDoSmooth,
+                                        const std::vector<uint8_t>&           colorGridVariation ) {
+  // each point only reads the cell statistics and updates its own color, so the points are smoothed concurrently
   const size_t pointCount = reconstruct.getPointCount();
   const int    gridSize   = params.occupancyPrecision_;
   const int    disth      = ( std::max )( gridSize / 2, 1 );
-  for ( int i = 0; i < pointCount; i++ ) {
-    PCCPoint3D curPos    = reconstruct[i];
-    int        x         = curPos.x();
-    int        y         = curPos.y();
-    int        z         = curPos.z();
-    int        pcMaxSize = pow( 2, params.geometryBitDepth3D_ );
-    if ( x < disth || y < disth || z < disth || pcMaxSize <= x + disth || pcMaxSize <= y + disth ||
-         pcMaxSize <= z + disth ) {
-      continue;
-    }
-    PCCVector3D colorCentroid( 0.0 );
-    int         colorCount             = 0;
-    bool        otherClusterPointCount = false;
-    PCCVector3D curPosColor            = reconstruct.getColor16bit( i );
-    if ( reconstruct.getBoundaryPointType( i ) == 1 ) {
-      otherClusterPointCount =
-          gridFilteringColor( curPos, colorCentroid, colorCount, colorSmoothingCount_, colorSmoothingCenter_,
-                              colorSmoothingDoSmooth_, gridSize, curPosColor, params, cellIndex );
-    }
-    if ( otherClusterPointCount ) {
-      colorCentroid = ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
-      for ( size_t k = 0; k < 3; ++k ) { colorCentroid[k] = double( int64_t( colorCentroid[k] ) ); }
-      double distToCentroid2 = 0;
-      double Ycent           = colorCentroid[0];
-      double Ycur            = curPosColor[0];
-      distToCentroid2        = abs( Ycent - Ycur ) * 10. / 256.;
-      if ( distToCentroid2 >= params.thresholdColorSmoothing_ ) {
-        PCCColor16bit color16bit = colorCentroid;
-        reconstruct.setColor16bit( i, color16bit );
+  const int    pcMaxSize  = pow( 2, params.geometryBitDepth3D_ );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+#else
+  for ( size_t i = 0; i < pointCount; i++ ) {
+#endif
+      PCCPoint3D  curPos = reconstruct[i];
+      int         x      = curPos.x();
+      int         y      = curPos.y();
+      int         z      = curPos.z();
+      const bool  inside = x >= disth && y >= disth && z >= disth && pcMaxSize > x + disth && pcMaxSize > y + disth &&
+                           pcMaxSize > z + disth;
+      PCCVector3D colorCentroid( 0.0 );
+      int         colorCount             = 0;
+      bool        otherClusterPointCount = false;
+      PCCVector3D curPosColor            = reconstruct.getColor16bit( i );
+      if ( inside && reconstruct.getBoundaryPointType( i ) == 1 ) {
+        otherClusterPointCount =
+            gridFilteringColor( curPos, colorCentroid, colorCount, colorGridCount, colorGridCenter, colorGridDoSmooth,
+                                colorGridVariation, gridSize, curPosColor, params, grid );
       }
-    }
+      if ( otherClusterPointCount ) {
+        colorCentroid =
+            ( colorCentroid + static_cast<double>( colorCount ) / 2.0 ) / static_cast<double>( colorCount );
+        for ( size_t k = 0; k < 3; ++k ) { colorCentroid[k] = double( int64_t( colorCentroid[k] ) ); }
+        double distToCentroid2 = 0;
+        double Ycent           = colorCentroid[0];
+        double Ycur            = curPosColor[0];
+        distToCentroid2        = abs( Ycent - Ycur ) * 10. / 256.;
+        if ( distToCentroid2 >= params.thresholdColorSmoothing_ ) {
+          PCCColor16bit color16bit = colorCentroid;
+          reconstruct.setColor16bit( i, color16bit );
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
   }
+#endif
 }
 
 size_t PCCCodec::colorPointCloud( PCCPointSet3&                       reconstruct,
@@ -2486,9 +2478,10 @@ void PCCCodec::tilePatchApplicationByteString( std::vector<uint8_t>&
     }
   }
 };
-void PCCCodec::atlasBlockToPatchByteString( std::vector<uint8_t>&             stringByte,
-                                            std::vector<std::vector<int64_t>> atlasB2p ) {
+void PCCCodec::atlasBlockToPatchByteString( std::vector<uint8_t>&                    stringByte,
+                                            const std::vector<std::vector<int64_t>>& atlasB2p ) {
   uint8_t b2pVal;
+  stringByte.reserve( stringByte.size() + 2 * atlasB2p.size() * ( atlasB2p.empty() ? 0 : atlasB2p[0].size() ) );
   for ( size_t y = 0; y < atlasB2p.size(); y++ ) {
     for ( size_t x = 0; x < atlasB2p[y].size(); x++ ) {
       b2pVal = ( atlasB2p[y][x] == -1 ) ? 0xFFFF : atlasB2p[y][x];
@@ -2498,10 +2491,12 @@ void PCCCodec::atlasBlockToPatchByteString( std::vector<uint8_t>&             st
   }
 }
 
-void PCCCodec::tileBlockToPatchByteString( std::vector<uint8_t>&                          stringByte,
-                                           size_t                                         tileId,
-                                           std::vector<std::vector<std::vector<int64_t>>> tileB2p ) {
+void PCCCodec::tileBlockToPatchByteString( std::vector<uint8_t>&                                 stringByte,
+                                           size_t                                                tileId,
+                                           const std::vector<std::vector<std::vector<int64_t>>>& tileB2p ) {
   uint8_t b2pVal;
+  stringByte.reserve( stringByte.size() +
+                      2 * tileB2p[tileId].size() * ( tileB2p[tileId].empty() ? 0 : tileB2p[tileId][0].size() ) );
   for ( size_t y = 0; y < tileB2p[tileId].size(); y++ ) {
     for ( size_t x = 0; x < tileB2p[tileId][y].size(); x++ ) {
       b2pVal = ( tileB2p[tileId][y][x] == -1 ) ? 0xFFFF : tileB2p[tileId][y][x];
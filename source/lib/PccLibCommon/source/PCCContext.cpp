@@ -34,7 +34,7 @@
 #include "PCCFrameContext.h"
 #include "PCCVideo.h"
 #include "PCCContext.h"
-#include "MD5.h"
+#include "PCCHash.h"
 
 using namespace pcc;
 
@@ -193,6 +193,7 @@ void PCCAtlasContext::clearVideoFrames() {
   geoWidth_.clear();
   geoHeight_.clear();
   geoAuxFrames_.clear();
+  motionEstimationData_.clear();
 
   // clearing structures for attributes
   for ( size_t attrIdx = 0; attrIdx < attrFrames_.size(); attrIdx++ ) {
@@ -224,35 +225,22 @@ void PCCAtlasContext::clearVideoFrames() {
   attrAuxFrames_.clear();
 }
 
-std::vector<uint8_t> PCCContext::computeMD5( uint8_t* byteString, size_t len ) {
-  MD5                  md5Hash;
-  std::vector<uint8_t> tmp_digest;
-  tmp_digest.resize( 16 );
-  md5Hash.update( byteString, len );
-  md5Hash.finalize( tmp_digest.data() );
-  return tmp_digest;
+std::vector<uint8_t> PCCContext::computeMD5( const uint8_t* byteString, size_t len ) {
+  PCCHashDigest digest;
+  digest.compute( 0, byteString, len );
+  return digest.md5_;
 }
 
-uint16_t PCCContext::computeCRC( uint8_t* byteString, size_t len ) {
-  unsigned int crc    = 0xFFFF;
-  byteString[len]     = 0;
-  byteString[len + 1] = 0;
-  for ( unsigned int bitIdx = 0; bitIdx < ( len + 2 ) * 8; bitIdx++ ) {
-    uint8_t dataByte = byteString[bitIdx >> 3];
-    uint8_t crcMsb   = ( crc >> 15 ) & 1;
-    uint8_t bitVal   = ( dataByte >> ( 7 - bitIdx ) ) & 1;
-    crc              = ( ( ( crc << 1 ) + bitVal ) & 0xFFFF ) ^ ( crcMsb * 0x1021 );
-  }
-  return crc;
-};
+uint16_t PCCContext::computeCRC( const uint8_t* byteString, size_t len ) {
+  PCCCrc16 crc;
+  crc.update( byteString, len );
+  return crc.finalize();
+}
 
-uint32_t PCCContext::computeCheckSum( uint8_t* byteString, size_t len ) {
-  uint32_t checkSum = 0;
-  for ( uint32_t i = 0; i < len; i++ ) {
-    uint8_t xor_mask = ( i & 0xFF ) ^ ( i >> 8 );
-    checkSum         = ( checkSum + ( ( byteString[i] & 0xFF ) ^ xor_mask ) ) & 0xFFFFFFFF;
-  }
-  return checkSum;
+uint32_t PCCContext::computeCheckSum( const uint8_t* byteString, size_t len ) {
+  PCCCheckSum checkSum;
+  checkSum.update( byteString, len );
+  return checkSum.finalize();
 }
 
 void PCCContext::allocOneLayerData() {
@@ -104,3 +104,9 @@ bool PCCGroupOfFrames::write( const std::string& reconstructedDataPath,
   frameNumber += frames_.size();
   return ret;
 }
+
+size_t PCCGroupOfFrames::getMemorySize() const {
+  size_t size = 0;
+  for ( const auto& frame : frames_ ) { size += frame.getMemorySize(); }
+  return size;
+}
@@ -0,0 +1,95 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "MD5.h"
+#include "PCCHash.h"
+
+using namespace pcc;
+
+// tables_[k][b]: register obtained from the byte b followed by k zero bytes
+struct PCCCrc16Tables {
+  PCCCrc16Tables() {
+    for ( uint32_t b = 0; b < 256; b++ ) {
+      uint32_t crc = b << 8;
+      for ( size_t i = 0; i < 8; i++ ) { crc = ( ( crc << 1 ) ^ ( ( crc & 0x8000 ) != 0 ? 0x1021 : 0 ) ) & 0xFFFF; }
+      tables_[0][b] = static_cast<uint16_t>( crc );
+    }
+    for ( size_t k = 1; k < 8; k++ ) {
+      for ( size_t b = 0; b < 256; b++ ) {
+        const uint16_t crc = tables_[k - 1][b];
+        tables_[k][b]      = static_cast<uint16_t>( ( crc << 8 ) ^ tables_[0][crc >> 8] );
+      }
+    }
+  }
+  uint16_t tables_[8][256];
+};
+
+static const PCCCrc16Tables g_crc16Tables;
+
+// 0xFFFF shifted through the 16 zero bits that close the augmented form
+PCCCrc16::PCCCrc16() : crc_( 0x1D0F ) {}
+
+void PCCCrc16::update( const uint8_t* data, size_t size ) {
+  const auto& t   = g_crc16Tables.tables_;
+  uint32_t    crc = crc_;
+  for ( ; size >= 8; size -= 8, data += 8 ) {
+    crc = t[7][data[0] ^ ( crc >> 8 )] ^ t[6][data[1] ^ ( crc & 0xFF )] ^ t[5][data[2]] ^ t[4][data[3]] ^
+          t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+  }
+  for ( ; size > 0; size--, data++ ) { crc = ( ( crc << 8 ) ^ t[0][( crc >> 8 ) ^ *data] ) & 0xFFFF; }
+  crc_ = static_cast<uint16_t>( crc );
+}
+
+void PCCCheckSum::update( const uint8_t* data, size_t size ) {
+  for ( size_t i = 0; i < size; i++, position_++ ) {
+    const uint8_t xorMask = ( position_ & 0xFF ) ^ ( position_ >> 8 );
+    checkSum_ += data[i] ^ xorMask;
+  }
+}
+
+void PCCHashDigest::compute( size_t hashType, const uint8_t* data, size_t size ) {
+  if ( hashType == 0 ) {
+    MD5 md5;
+    md5_.resize( MD5_DIGEST_STRING_LENGTH );
+    md5.update( const_cast<uint8_t*>( data ), static_cast<unsigned>( size ) );
+    md5.finalize( md5_.data() );
+  } else if ( hashType == 1 ) {
+    PCCCrc16 crc;
+    crc.update( data, size );
+    crc_ = crc.finalize();
+  } else if ( hashType == 2 ) {
+    PCCCheckSum checkSum;
+    checkSum.update( data, size );
+    checkSum_ = checkSum.finalize();
+  }
+}
@@ -41,9 +41,21 @@ using namespace pcc;
 
 typedef KDTreeVectorOfVectorsAdaptor<PCCPointSet3, PCCType, float, 3, metric_L2_Simple_2, size_t> KdTreeAdaptor;
 
-PCCKdTree::PCCKdTree() : kdtree_( nullptr ) {}
+static const uint64_t g_emptyVoxelKey = ( std::numeric_limits<uint64_t>::max )();
 
-PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud ) : kdtree_( nullptr ) { init( pointCloud ); }
+static inline uint64_t voxelKey( const PCCPoint3D& point ) {
+  return ( static_cast<uint64_t>( static_cast<uint16_t>( point[0] ) ) << 32 ) |
+         ( static_cast<uint64_t>( static_cast<uint16_t>( point[1] ) ) << 16 ) |
+         static_cast<uint64_t>( static_cast<uint16_t>( point[2] ) );
+}
+
+static inline uint64_t voxelHash( const uint64_t key ) { return ( key * 0x9E3779B97F4A7C15ULL ) >> 20; }
+
+PCCKdTree::PCCKdTree() : kdtree_( nullptr ), voxelMask_( 0 ) {}
+
+PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud, const bool useVoxelIndex ) : kdtree_( nullptr ), voxelMask_( 0 ) {
+  init( pointCloud, useVoxelIndex );
+}
 
 PCCKdTree::~PCCKdTree() { clear(); }
 void PCCKdTree::clear() {
@@ -51,20 +63,96 @@ void PCCKdTree::clear() {
     delete ( static_cast<KdTreeAdaptor*>( kdtree_ ) );
     kdtree_ = nullptr;
   }
+  voxelKeys_.clear();
+  voxelIndexes_.clear();
+  voxelMask_ = 0;
 }
 
-void PCCKdTree::init( const PCCPointSet3& pointCloud ) {
+void PCCKdTree::init( const PCCPointSet3& pointCloud, const bool useVoxelIndex ) {
   clear();
   kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
+  if ( useVoxelIndex ) { buildVoxelIndex( pointCloud ); }
+}
+
+void PCCKdTree::buildVoxelIndex( const PCCPointSet3& pointCloud ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  if ( pointCount == 0 || pointCount >= g_undefined_index ) { return; }
+  size_t tableSize = 16;
+  while ( tableSize < 2 * pointCount ) { tableSize <<= 1; }
+  voxelMask_ = tableSize - 1;
+  voxelKeys_.assign( tableSize, g_emptyVoxelKey );
+  voxelIndexes_.resize( tableSize );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    const uint64_t key  = voxelKey( pointCloud[i] );
+    uint64_t       slot = voxelHash( key ) & voxelMask_;
+    while ( voxelKeys_[slot] != g_emptyVoxelKey && voxelKeys_[slot] != key ) { slot = ( slot + 1 ) & voxelMask_; }
+    if ( voxelKeys_[slot] == key ) {
+      voxelIndexes_[slot] = g_undefined_index;
+    } else {
+      voxelKeys_[slot]    = key;
+      voxelIndexes_[slot] = static_cast<uint32_t>( i );
+    }
+  }
+}
+
+uint32_t PCCKdTree::findVoxel( const PCCPoint3D& point ) const {
+  const uint64_t key  = voxelKey( point );
+  uint64_t       slot = voxelHash( key ) & voxelMask_;
+  while ( voxelKeys_[slot] != g_emptyVoxelKey ) {
+    if ( voxelKeys_[slot] == key ) { return voxelIndexes_[slot]; }
+    slot = ( slot + 1 ) & voxelMask_;
+  }
+  return g_undefined_index;
+}
+
+size_t PCCKdTree::searchPoint( const PCCPoint3D& point,
+                               const size_t      num_results,
+                               size_t*           indices,
+                               double*           dist ) const {
+  // A point that falls in a voxel holding a single point of the cloud is its own nearest neighbor: every other point
+  // is at least one voxel away, so the tree traversal can be skipped.
+  if ( num_results == 1 && !voxelKeys_.empty() ) {
+    const uint32_t index = findVoxel( point );
+    if ( index != g_undefined_index ) {
+      indices[0] = index;
+      dist[0]    = 0.0;
+      return 1;
+    }
+  }
+  return ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->knnSearch( &point[0], num_results, indices, dist );
 }
 
 void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
   if ( num_results != results.size() ) { results.resize( num_results ); }
-  auto retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
-                     ->index->knnSearch( &point[0], num_results, results.indices(), results.dist() );
+  auto retSize = searchPoint( point, num_results, results.indices(), results.dist() );
   assert( retSize == results.size() );
 }
 
+void PCCKdTree::search( const PCCPointSet3& pointCloud,
+                        const size_t        start,
+                        const size_t        end,
+                        const size_t        num_results,
+                        PCCNNBatchResult&   results ) const {
+  results.resize( end - start, num_results );
+  for ( size_t query = 0; query < end - start; ++query ) {
+    results.count( query ) =
+        searchPoint( pointCloud[start + query], num_results, results.indices( query ), results.dist( query ) );
+  }
+}
+
+void PCCKdTree::search( const PCCPointSet3&        pointCloud,
+                        const std::vector<size_t>& pointIndices,
+                        const size_t               start,
+                        const size_t               end,
+                        const size_t               num_results,
+                        PCCNNBatchResult&          results ) const {
+  results.resize( end - start, num_results );
+  for ( size_t query = 0; query < end - start; ++query ) {
+    results.count( query ) = searchPoint( pointCloud[pointIndices[start + query]], num_results,
+                                          results.indices( query ), results.dist( query ) );
+  }
+}
+
 void PCCKdTree::searchRadius( const PCCPoint3D& point,
                               const size_t      num_results,
                               const double      radius,
@@ -0,0 +1,77 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "PCCMotionEstimationData.h"
+
+using namespace pcc;
+
+bool PCCMotionEstimationData::write( const std::string& occupancyMapFileName,
+                                     const std::string& blockToPatchFileName,
+                                     const std::string& patchInfoFileName ) const {
+  FILE* occupancyFile    = fopen( occupancyMapFileName.c_str(), "wb" );
+  FILE* blockToPatchFile = fopen( blockToPatchFileName.c_str(), "wb" );
+  FILE* patchInfoFile    = fopen( patchInfoFileName.c_str(), "wb" );
+  bool  success          = occupancyFile != nullptr && blockToPatchFile != nullptr && patchInfoFile != nullptr;
+  std::vector<uint32_t> occupancy;
+  std::vector<size_t>   blockToPatch, patchInfo;
+  for ( size_t frameIndex = 0; success && frameIndex < frames_.size(); frameIndex++ ) {
+    const auto& frame = frames_[frameIndex];
+    occupancy.resize( frame.getWidth() * frame.getHeight() );
+    for ( size_t y = 0, i = 0; y < frame.getHeight(); y++ ) {
+      for ( size_t x = 0; x < frame.getWidth(); x++, i++ ) { occupancy[i] = frame.isOccupied( x, y ) ? 1 : 0; }
+    }
+    blockToPatch.assign( frame.getBlockToPatch().begin(), frame.getBlockToPatch().end() );
+    patchInfo.resize( 1 + 8 * frame.getPatches().size() );
+    patchInfo[0] = frame.getPatches().size();
+    size_t* info = patchInfo.data() + 1;
+    for ( const auto& patch : frame.getPatches() ) {
+      *info++ = patch.projectionIndex_;
+      *info++ = patch.u0_;
+      *info++ = patch.v0_;
+      *info++ = patch.sizeU0_;
+      *info++ = patch.sizeV0_;
+      *info++ = patch.d1_;
+      *info++ = patch.u1_;
+      *info++ = patch.v1_;
+    }
+    success = fwrite( blockToPatch.data(), sizeof( size_t ), blockToPatch.size(), blockToPatchFile ) ==
+                  blockToPatch.size() &&
+              fwrite( occupancy.data(), sizeof( uint32_t ), occupancy.size(), occupancyFile ) == occupancy.size() &&
+              fwrite( patchInfo.data(), sizeof( size_t ), patchInfo.size(), patchInfoFile ) == patchInfo.size();
+  }
+  if ( occupancyFile != nullptr ) { fclose( occupancyFile ); }
+  if ( blockToPatchFile != nullptr ) { fclose( blockToPatchFile ); }
+  if ( patchInfoFile != nullptr ) { fclose( patchInfoFile ); }
+  if ( !success ) { printf( "Error: can't write the motion estimation files of %s \n", patchInfoFileName.c_str() ); }
+  return success;
+}
@@ -83,7 +83,9 @@ PCCPatch::PCCPatch() :
     d0Count_( 0 ),
     eomCount_( 0 ),
     eomandD1Count_( 0 ),
-    patchType_( I_INTRA ) {
+    patchType_( I_INTRA ),
+    canvasMaskWidth_( 0 ),
+    canvasMaskHeight_( 0 ) {
   depth_[0].clear();
   depth_[1].clear();
   occupancy_.clear();
@@ -307,33 +309,142 @@ int PCCPatch::patchBlock2CanvasBlock( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvas( std::vector<bool> canvas,
-                                    size_t            canvasStrideBlk,
-                                    size_t            canvasHeightBlk,
-                                    bool              bPrecedence,
-                                    int               safeguard,
-                                    const Tile        tile ) {
-  for ( size_t v0 = 0; v0 < sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
+// Position of the block (uBlk, vBlk) of a patch of size sizeU0 x sizeV0 once oriented, relative to the top left
+// corner of the patch in the canvas.
+static bool getOrientedBlock( const size_t uBlk,
+                              const size_t vBlk,
+                              const size_t sizeU0,
+                              const size_t sizeV0,
+                              const size_t patchOrientation,
+                              size_t&      x,
+                              size_t&      y ) {
+  switch ( patchOrientation ) {
+    case PATCH_ORIENTATION_DEFAULT:
+      x = uBlk;
+      y = vBlk;
+      break;
+    case PATCH_ORIENTATION_ROT90:
+      x = sizeV0 - 1 - vBlk;
+      y = uBlk;
+      break;
+    case PATCH_ORIENTATION_ROT180:
+      x = sizeU0 - 1 - uBlk;
+      y = sizeV0 - 1 - vBlk;
+      break;
+    case PATCH_ORIENTATION_ROT270:
+      x = vBlk;
+      y = sizeU0 - 1 - uBlk;
+      break;
+    case PATCH_ORIENTATION_MIRROR:
+      x = sizeU0 - 1 - uBlk;
+      y = vBlk;
+      break;
+    case PATCH_ORIENTATION_MROT90:
+      x = sizeV0 - 1 - vBlk;
+      y = sizeU0 - 1 - uBlk;
+      break;
+    case PATCH_ORIENTATION_MROT180:
+      x = uBlk;
+      y = sizeV0 - 1 - vBlk;
+      break;
+    case PATCH_ORIENTATION_MROT270:
+      x = vBlk;
+      y = uBlk;
+      break;
+    case PATCH_ORIENTATION_SWAP:  // swapAxis
+      x = vBlk;
+      y = uBlk;
+      break;
+    default: return false; break;
+  }
+  return true;
+}
+
+// Builds the mask of the canvas blocks that must be free to place the patch: the blocks covered by the patch, or by
+// its occupied blocks only when bPrecedence is set, dilated by safeguard blocks. The mask is stored row by row in
+// 64-bit words and is kept until the size, orientation, occupancy or fit parameters of the patch change.
+void PCCPatch::updateCanvasMask( const size_t sizeU0,
+                                 const size_t sizeV0,
+                                 const size_t patchOrientation,
+                                 const bool   bPrecedence,
+                                 const size_t safeguard ) {
+  const std::array<size_t, 5> key = {sizeU0, sizeV0, patchOrientation, size_t( bPrecedence ), safeguard};
+  if ( !canvasMask_.empty() && key == canvasMaskKey_ ) { return; }
+  const bool switched =
+      !( ( patchOrientation == PATCH_ORIENTATION_DEFAULT ) || ( patchOrientation == PATCH_ORIENTATION_ROT180 ) ||
+         ( patchOrientation == PATCH_ORIENTATION_MIRROR ) || ( patchOrientation == PATCH_ORIENTATION_MROT180 ) );
+  canvasMaskKey_     = key;
+  canvasMaskWidth_   = ( switched ? sizeV0 : sizeU0 ) + 2 * safeguard;
+  canvasMaskHeight_  = ( switched ? sizeU0 : sizeV0 ) + 2 * safeguard;
+  const size_t words = ( canvasMaskWidth_ + 63 ) / 64;
+  canvasMask_.assign( words * canvasMaskHeight_, 0 );
+  for ( size_t v = 0; v < sizeV0; ++v ) {
+    for ( size_t u = 0; u < sizeU0; ++u ) {
+      size_t x, y;
+      if ( ( bPrecedence && !occupancy_[u + sizeU0_ * v] ) ||
+           !getOrientedBlock( u, v, sizeU0, sizeV0, patchOrientation, x, y ) ) {
+        continue;
+      }
+      for ( size_t j = y; j <= y + 2 * safeguard; ++j ) {
+        for ( size_t i = x; i <= x + 2 * safeguard; ++i ) {
+          canvasMask_[j * words + i / 64] |= uint64_t( 1 ) << ( i % 64 );
         }
       }
     }
   }
+}
+
+// Equivalent to testing, for each block of the patch and each offset of the safeguard window, that the block lands in
+// the canvas and the tile and, when the block is occupied or bPrecedence is not set, on a free canvas block. The
+// safeguard band around the patch is a rectangle, so the bounds are checked once, and the blocks are then compared
+// 64 at a time with the mask of updateCanvasMask().
+bool PCCPatch::checkFitCanvas( const PCCBlockOccupancy& canvas,
+                               size_t                   canvasStrideBlk,
+                               size_t                   canvasHeightBlk,
+                               bool                     bPrecedence,
+                               int                      safeguard,
+                               const Tile&              tile,
+                               size_t                   u0,
+                               size_t                   v0,
+                               size_t                   sizeU0,
+                               size_t                   sizeV0,
+                               size_t                   patchOrientation ) {
+  if ( sizeU0 == 0 || sizeV0 == 0 || safeguard < 0 ) { return true; }
+  size_t x, y;
+  if ( !getOrientedBlock( 0, 0, sizeU0, sizeV0, patchOrientation, x, y ) ) { return false; }
+  updateCanvasMask( sizeU0, sizeV0, patchOrientation, bPrecedence, safeguard );
+  const int64_t minX = int64_t( u0 ) - safeguard;
+  const int64_t minY = int64_t( v0 ) - safeguard;
+  const int64_t maxX = minX + int64_t( canvasMaskWidth_ ) - 1;
+  const int64_t maxY = minY + int64_t( canvasMaskHeight_ ) - 1;
+  if ( minX < 0 || minY < 0 || maxX >= int64_t( canvasStrideBlk ) || maxY >= int64_t( canvasHeightBlk ) ) {
+    return false;
+  }
+  if ( tile.minU != -1 && ( minX < tile.minU || minY < tile.minV || maxX > tile.maxU || maxY > tile.maxV ) ) {
+    return false;
+  }
+  const size_t words = ( canvasMaskWidth_ + 63 ) / 64;
+  for ( size_t j = 0; j < canvasMaskHeight_; ++j ) {
+    const size_t    pos  = ( minY + j ) * canvasStrideBlk + minX;
+    const uint64_t* mask = canvasMask_.data() + j * words;
+    for ( size_t i = 0; i < words; ++i ) {
+      const size_t count = ( std::min )( canvasMaskWidth_ - 64 * i, size_t( 64 ) );
+      if ( canvas.getBits( pos + 64 * i, count ) & mask[i] ) { return false; }
+    }
+  }
   return true;
 }
 
+bool PCCPatch::checkFitPatchCanvas( const PCCBlockOccupancy& canvas,
+                                    size_t                   canvasStrideBlk,
+                                    size_t                   canvasHeightBlk,
+                                    bool                     bPrecedence,
+                                    int                      safeguard,
+                                    const Tile               tile ) {
+  return checkFitCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard, tile, u0_, v0_, sizeU0_,
+                         sizeV0_, patchOrientation_ );
+}
+
 bool PCCPatch::smallerRefFirst( const PCCPatch& rhs ) {
   if ( bestMatchIdx_ == -1 && rhs.getBestMatchIdx() == -1 ) {
     return gt( rhs );
@@ -664,31 +775,14 @@ int PCCPatch::patchBlock2CanvasBlockForGPA( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                          size_t            canvasStrideBlk,
-                                          size_t            canvasHeightBlk,
-                                          bool              bPrecedence,
-                                          int               safeguard ) {
-  for ( size_t v0 = 0; v0 < curGPAPatchData_.sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < curGPAPatchData_.sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlockForGPA( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
-      }
-    }
-  }
-
-  return true;
+bool PCCPatch::checkFitPatchCanvasForGPA( const PCCBlockOccupancy& canvas,
+                                          size_t                   canvasStrideBlk,
+                                          size_t                   canvasHeightBlk,
+                                          bool                     bPrecedence,
+                                          int                      safeguard ) {
+  return checkFitCanvas( canvas, canvasStrideBlk, canvasHeightBlk, bPrecedence, safeguard, Tile(),
+                         curGPAPatchData_.u0_, curGPAPatchData_.v0_, curGPAPatchData_.sizeU0_,
+                         curGPAPatchData_.sizeV0_, curGPAPatchData_.patchOrientation_ );
 }
 
 void PCCPatch::allocOneLayerData() {
@@ -36,7 +36,11 @@
 #include "PCCMath.h"
 #include "KDTreeVectorOfVectorsAdaptor.h"
 #include "PCCKdTree.h"
+#include "PCCSystem.h"
 #include <numeric>
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
 
 using namespace pcc;
 
@@ -108,7 +112,7 @@ void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
   distY = 0.F;
   distU = 0.F;
   distV = 0.F;
-  PCCKdTree   kdtree( pointcloud );
+  PCCKdTree   kdtree( pointcloud, true );
   PCCNNResult result;
 
   for ( size_t i = 0; i < positions_.size(); ++i ) {
@@ -130,8 +134,12 @@ void PCCPointSet3::distance( const PCCPointSet3& pointcloud,
 }
 
 void PCCPointSet3::distance( const PCCPointSet3& pointcloud, float& distP ) const {
+  PCCKdTree kdtree( pointcloud, true );
+  distance( kdtree, distP );
+}
+
+void PCCPointSet3::distance( const PCCKdTree& kdtree, float& distP ) const {
   distP = 0.F;
-  PCCKdTree   kdtree( pointcloud );
   PCCNNResult result;
   for ( const auto& position : positions_ ) {
     kdtree.search( position, 1, result );
@@ -220,15 +228,80 @@ void PCCPointSet3::removeDuplicate( PCCPointSet3& newPointcloud, size_t dropDupl
 using UInt = unsigned int;
 #include "MD5.h"
 std::vector<uint8_t> PCCPointSet3::computeChecksum( bool reorderPoints ) {
-  if ( reorderPoints ) {
-    PCCPointSet3 reorderPointCloud;
-    if ( withColors_ ) { reorderPointCloud.hasColors(); }
-    if ( withReflectances_ ) { reorderPointCloud.addReflectances(); }
-    reorder( reorderPointCloud, true );
-    return reorderPointCloud.computeMd5();
-  }
+  if ( reorderPoints ) { return computeReorderedMd5(); }
   return computeMd5();
 }
+
+// Md5 of the point cloud built by reorder( newPointcloud, true ), computed without building it: the positions
+// sorted in x, y, z order, without duplicates and followed by their average colors when the points have colors, then
+// null reflectances when the points have reflectances. The columns are hashed through a small buffer.
+std::vector<uint8_t> PCCPointSet3::computeReorderedMd5() {
+  const size_t                               pointCount = positions_.size();
+  const size_t                               bufferSize = 4096;
+  std::vector<std::pair<uint64_t, uint32_t>> keys( pointCount );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    uint64_t key = 0;
+    for ( size_t k = 0; k < 3; ++k ) {
+      key = ( key << 16 ) | static_cast<uint16_t>( static_cast<uint16_t>( positions_[i][k] ) ^ 0x8000 );
+    }
+    keys[i] = std::make_pair( key, static_cast<uint32_t>( i ) );
+  }
+  std::sort( keys.begin(), keys.end() );
+  MD5  md5;
+  auto update = [&]( std::vector<uint8_t>& buffer, const bool flush ) {
+    if ( flush || buffer.size() >= bufferSize ) {
+      md5.update( buffer.data(), buffer.size() );
+      buffer.clear();
+    }
+  };
+  std::vector<uint8_t> buffer;
+  buffer.reserve( bufferSize + sizeof( PCCPoint3D ) );
+  size_t reorderedCount = 0;
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    if ( withColors_ && i > 0 && keys[i].first == keys[i - 1].first ) { continue; }
+    const auto& position = positions_[keys[i].second];
+    buffer.insert( buffer.end(), reinterpret_cast<const uint8_t*>( &position ),
+                   reinterpret_cast<const uint8_t*>( &position ) + sizeof( PCCPoint3D ) );
+    update( buffer, false );
+    reorderedCount++;
+  }
+  update( buffer, true );
+  if ( withColors_ ) {
+    for ( size_t i = 0; i < pointCount; ) {
+      // the duplicates of a point follow it in the sorted list
+      size_t r = 0;
+      size_t g = 0;
+      size_t b = 0;
+      size_t n = 0;
+      for ( const uint64_t key = keys[i].first; i < pointCount && keys[i].first == key; ++i, ++n ) {
+        const auto& color = colors_[keys[i].second];
+        r += color[0];
+        g += color[1];
+        b += color[2];
+      }
+      PCCColor3B average;
+      average[0] = r / n;
+      average[1] = g / n;
+      average[2] = b / n;
+      buffer.insert( buffer.end(), reinterpret_cast<const uint8_t*>( &average ),
+                     reinterpret_cast<const uint8_t*>( &average ) + sizeof( PCCColor3B ) );
+      update( buffer, false );
+    }
+    update( buffer, true );
+  }
+  if ( withReflectances_ ) {
+    buffer.assign( bufferSize, 0 );
+    for ( size_t size = reorderedCount * sizeof( uint16_t ); size > 0; ) {
+      const size_t length = ( std::min )( size, bufferSize );
+      md5.update( buffer.data(), length );
+      size -= length;
+    }
+  }
+  std::vector<uint8_t> digest;
+  digest.resize( MD5_DIGEST_STRING_LENGTH );
+  md5.finalize( digest.data() );
+  return digest;
+}
 std::vector<uint8_t> PCCPointSet3::computeMd5() {
   std::vector<uint8_t> digest;
   MD5                  md5;
@@ -356,8 +429,36 @@ bool PCCPointSet3::isRawPointsBboxEmpty( std::vector<size_t> rawPoints, PCCBox3D
   return true;
 }
 
+static inline char* formatInteger( char* str, int value ) {
+  if ( value < 0 ) {
+    *str++ = '-';
+    value  = -value;
+  }
+  char  digits[16];
+  char* end = digits;
+  do {
+    *end++ = char( '0' + value % 10 );
+    value /= 10;
+  } while ( value != 0 );
+  while ( end != digits ) { *str++ = *--end; }
+  return str;
+}
+
+template <typename T>
+static inline T readBinary( const char* data ) {
+  T value;
+  memcpy( &value, data, sizeof( T ) );
+  return value;
+}
+
+template <typename T>
+static inline char* writeBinary( char* data, const T value ) {
+  memcpy( data, &value, sizeof( T ) );
+  return data + sizeof( T );
+}
+
 bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
-  std::ofstream fout( fileName, std::ofstream::out );
+  std::ofstream fout( fileName, std::ofstream::binary | std::ofstream::out );
   if ( !fout.is_open() ) { return false; }
   const size_t pointCount = getPointCount();
   fout << "ply" << std::endl;
@@ -407,63 +508,92 @@ bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
   fout << "element face 0" << std::endl;
   fout << "property list uint8 int32 vertex_index" << std::endl;
   fout << "end_header" << std::endl;
+
+  // The points are formatted in a buffer written in blocks to limit the number of stream operations.
+  const size_t      MAX_BUFFER_SIZE = 1 << 20;
+  std::vector<char> buffer( MAX_BUFFER_SIZE );
+  char*             str = buffer.data();
   if ( asAscii ) {
-    fout << std::setprecision( std::numeric_limits<double>::max_digits10 );
+    // Each line is shorter than 256 characters: 3 positions, 3 normals printed with max_digits10 digits, 3 colors,
+    // reflectance and type.
+    const size_t MAX_LINE_SIZE = 256;
     for ( size_t i = 0; i < pointCount; ++i ) {
+      if ( str + MAX_LINE_SIZE > buffer.data() + MAX_BUFFER_SIZE ) {
+        fout.write( buffer.data(), str - buffer.data() );
+        str = buffer.data();
+      }
       const PCCPoint3D& position = ( *this )[i];
-      fout << position.x() << " " << position.y() << " " << position.z();
+      str                        = formatInteger( str, position.x() );
+      *str++                     = ' ';
+      str                        = formatInteger( str, position.y() );
+      *str++                     = ' ';
+      str                        = formatInteger( str, position.z() );
       if ( hasNormals() ) {
         const PCCNormal3D& normal = getNormals()[i];
-        fout << " " << static_cast<float>( normal[0] ) << " " << static_cast<float>( normal[1] ) << " "
-             << static_cast<float>( normal[2] );
+        for ( size_t c = 0; c < 3; c++ ) {
+          str += snprintf( str, MAX_LINE_SIZE / 8, " %.*g", std::numeric_limits<double>::max_digits10,
+                           static_cast<float>( normal[c] ) );
+        }
       }
       if ( hasColors() ) {
         const PCCColor3B& color = getColor( i );
-        fout << " " << static_cast<int>( color[0] ) << " " << static_cast<int>( color[1] ) << " "
-             << static_cast<int>( color[2] );
+        for ( size_t c = 0; c < 3; c++ ) {
+          *str++ = ' ';
+          str    = formatInteger( str, static_cast<int>( color[c] ) );
+        }
       }
-      if ( hasReflectances() ) { fout << " " << static_cast<int>( getReflectance( i ) ); }
-      if ( PCC_SAVE_POINT_TYPE != 0u ) { fout << " " << static_cast<int>( types_[i] ); }
-      fout << std::endl;
+      if ( hasReflectances() ) {
+        *str++ = ' ';
+        str    = formatInteger( str, static_cast<int>( getReflectance( i ) ) );
+      }
+      if ( PCC_SAVE_POINT_TYPE != 0u ) {
+        *str++ = ' ';
+        str    = formatInteger( str, static_cast<int>( types_[i] ) );
+      }
+      *str++ = '\n';
     }
   } else {
-    fout.clear();
-    fout.close();
-    fout.open( fileName, std::ofstream::binary | std::ofstream::out | std::ofstream::app );
+    const size_t recordSize = 3 * sizeof( float ) + ( hasNormals() ? 3 * sizeof( float ) : 0 ) +
+                              ( hasColors() ? 3 * sizeof( uint8_t ) : 0 ) +
+                              ( hasReflectances() ? sizeof( uint16_t ) : 0 ) +
+                              ( PCC_SAVE_POINT_TYPE != 0u ? sizeof( uint8_t ) : 0 );
     for ( size_t i = 0; i < pointCount; ++i ) {
+      if ( str + recordSize > buffer.data() + MAX_BUFFER_SIZE ) {
+        fout.write( buffer.data(), str - buffer.data() );
+        str = buffer.data();
+      }
       const PCCPoint3D& position = ( *this )[i];
-      // fout.write( reinterpret_cast<const char* const>( &position ), sizeof( PCCType ) * 3 );
-      float value[3];
-      value[0] = position[0];
-      value[1] = position[1];
-      value[2] = position[2];
-      fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
+      str                        = writeBinary<float>( str, position[0] );
+      str                        = writeBinary<float>( str, position[1] );
+      str                        = writeBinary<float>( str, position[2] );
       if ( hasNormals() ) {
         const PCCNormal3D& normal = getNormals()[i];
-        value[0]                  = normal[0];
-        value[1]                  = normal[1];
-        value[2]                  = normal[2];
-        fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
+        str                       = writeBinary<float>( str, static_cast<float>( normal[0] ) );
+        str                       = writeBinary<float>( str, static_cast<float>( normal[1] ) );
+        str                       = writeBinary<float>( str, static_cast<float>( normal[2] ) );
       }
       if ( hasColors() ) {
         const PCCColor3B& color = getColor( i );
-        fout.write( reinterpret_cast<const char*>( &color ), sizeof( uint8_t ) * 3 );
-      }
-      if ( hasReflectances() ) {
-        const uint16_t& reflectance = getReflectance( i );
-        fout.write( reinterpret_cast<const char*>( &reflectance ), sizeof( uint16_t ) );
-      }
-      if ( PCC_SAVE_POINT_TYPE != 0u ) {
-        fout.write( reinterpret_cast<const char* const>( &types_[i] ), sizeof( uint8_t ) );
+        *str++                  = static_cast<char>( color[0] );
+        *str++                  = static_cast<char>( color[1] );
+        *str++                  = static_cast<char>( color[2] );
       }
+      if ( hasReflectances() ) { str = writeBinary<uint16_t>( str, getReflectance( i ) ); }
+      if ( PCC_SAVE_POINT_TYPE != 0u ) { *str++ = static_cast<char>( types_[i] ); }
     }
   }
+  fout.write( buffer.data(), str - buffer.data() );
   fout.close();
-  return true;
+  return !fout.fail();
 }
+
 bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
-  std::ifstream ifs( fileName, std::ifstream::in );
-  if ( !ifs.is_open() ) { return false; }
+  PCCMappedFile file;
+  if ( !file.open( fileName ) ) { return false; }
+  if ( file.size() == 0 ) {
+    std::cout << "Error: empty file!" << std::endl;
+    return false;
+  }
   enum AttributeType {
     ATTRIBUTE_TYPE_FLOAT64 = 0,
     ATTRIBUTE_TYPE_FLOAT32 = 1,
@@ -480,6 +610,7 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
     std::string   name;
     AttributeType type;
     size_t        byteCount;
+    size_t        offset;
   };
 
   std::vector<AttributeInfo> attributesInfo;
@@ -488,8 +619,19 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   char                     tmp[MAX_BUFFER_SIZE];
   const char*              sep = " \t\r";
   std::vector<std::string> tokens;
+  const char*              cursor = file.data();
+  const char*              end    = file.data() + file.size();
+
+  // Copies the next line of the file in tmp.
+  auto getLine = [&]() {
+    const char* eol    = static_cast<const char*>( memchr( cursor, '\n', end - cursor ) );
+    size_t      length = ( std::min )( size_t( ( eol != nullptr ? eol : end ) - cursor ), MAX_BUFFER_SIZE - 1 );
+    memcpy( tmp, cursor, length );
+    tmp[length] = '\0';
+    cursor      = eol != nullptr ? eol + 1 : end;
+  };
 
-  ifs.getline( tmp, MAX_BUFFER_SIZE );
+  getLine();
   getTokens( tmp, sep, tokens );
   if ( tokens.empty() || tokens[0] != "ply" ) {
     std::cout << "Error: corrupted file!" << std::endl;
@@ -498,13 +640,14 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   bool   isAscii          = false;
   double version          = 1.0;
   size_t pointCount       = 0;
+  size_t recordSize       = 0;
   bool   isVertexProperty = true;
   while ( true ) {
-    if ( ifs.eof() ) {
+    if ( cursor >= end ) {
       std::cout << "Error: corrupted header!" << std::endl;
       return false;
     }
-    ifs.getline( tmp, MAX_BUFFER_SIZE );
+    getLine();
     getTokens( tmp, sep, tokens );
     if ( tokens.empty() || tokens[0] == "comment" ) { continue; }
     if ( tokens[0] == "format" ) {
@@ -535,6 +678,8 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
       attributesInfo.resize( attributeIndex + 1 );
       AttributeInfo& attributeInfo = attributesInfo[attributeIndex];
       attributeInfo.name           = propertyName;
+      attributeInfo.byteCount      = 0;
+      attributeInfo.offset         = recordSize;
       if ( propertyType == "double" || propertyType == "float64" ) {
         attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT64;
         attributeInfo.byteCount = 8;
@@ -566,6 +711,7 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
         attributeInfo.type      = ATTRIBUTE_TYPE_INT8;
         attributeInfo.byteCount = 1;
       }
+      recordSize += attributeInfo.byteCount;
     } else if ( tokens[0] == "end_header" ) {
       break;
     }
@@ -623,132 +769,98 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   withNormals_      = indexNX != g_undefined_index && indexNY != g_undefined_index && indexNZ != g_undefined_index;
   resize( pointCount );
   if ( isAscii ) {
-    size_t pointCounter = 0;
-    while ( !ifs.eof() && pointCounter < pointCount ) {
-      ifs.getline( tmp, MAX_BUFFER_SIZE );
-      getTokens( tmp, sep, tokens );
-      if ( tokens.empty() ) { continue; }
-      if ( tokens.size() < attributeCount ) { return false; }
+    std::vector<double> values( attributeCount );
+    size_t              pointCounter = 0;
+    while ( cursor < end && pointCounter < pointCount ) {
+      getLine();
+      size_t tokenCount = 0;
+      char*  str        = tmp;
+      while ( true ) {
+        str += strspn( str, sep );
+        if ( *str == '\0' ) { break; }
+        char* next = str + strcspn( str, sep );
+        if ( tokenCount < attributeCount ) { values[tokenCount] = atof( str ); }
+        tokenCount++;
+        str = next;
+      }
+      if ( tokenCount == 0 ) { continue; }
+      if ( tokenCount < attributeCount ) { return false; }
       auto& position = positions_[pointCounter];
-      position[0]    = atof( tokens[indexX].c_str() );
-      position[1]    = atof( tokens[indexY].c_str() );
-      position[2]    = atof( tokens[indexZ].c_str() );
+      position[0]    = values[indexX];
+      position[1]    = values[indexY];
+      position[2]    = values[indexZ];
       if ( hasColors() ) {
         auto& color = colors_[pointCounter];
-        color[0]    = atoi( tokens[indexR].c_str() );
-        color[1]    = atoi( tokens[indexG].c_str() );
-        color[2]    = atoi( tokens[indexB].c_str() );
+        color[0]    = static_cast<int>( values[indexR] );
+        color[1]    = static_cast<int>( values[indexG] );
+        color[2]    = static_cast<int>( values[indexB] );
+      }
+      if ( hasReflectances() ) {
+        reflectances_[pointCounter] = uint16_t( static_cast<int>( values[indexReflectance] ) );
       }
-      if ( hasReflectances() ) { reflectances_[pointCounter] = uint16_t( atoi( tokens[indexReflectance].c_str() ) ); }
       ++pointCounter;
     }
   } else {
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, MAX_BUFFER_SIZE );
-    char* str       = strstr( tmp, "end_header" );
-    str             = strstr( str, "\n" );
-    int headerCount = str - tmp + 1;
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, headerCount );
-    for ( size_t pointCounter = 0; pointCounter < pointCount && !ifs.eof(); ++pointCounter ) {
-      auto& position = positions_[pointCounter];
-      for ( size_t a = 0; a < attributeCount && !ifs.eof(); ++a ) {
-        const auto& attributeInfo = attributesInfo[a];
-        if ( a == indexX ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( uint16_t ) );
-            position[0] = x;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( float ) );
-            position[0] = x;
-          } else {
-            double x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( double ) );
-            position[0] = x;
-          }
-        } else if ( a == indexY ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( uint16_t ) );
-            position[1] = y;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( float ) );
-            position[1] = y;
-          } else {
-            double y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( double ) );
-            position[1] = y;
-          }
-        } else if ( a == indexZ ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( uint16_t ) );
-            position[2] = z;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( float ) );
-            position[2] = z;
-          } else {
-            double z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( double ) );
-            position[2] = z;
-          }
-        } else if ( a == indexR && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[0] ), sizeof( uint8_t ) );
-        } else if ( a == indexG && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[1] ), sizeof( uint8_t ) );
-        } else if ( a == indexB && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[2] ), sizeof( uint8_t ) );
-        } else if ( a == indexNX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( float ) );
-            normals_[pointCounter][0] = nx;
-          } else {
-            double nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( double ) );
-            normals_[pointCounter][0] = nx;
-          }
-        } else if ( a == indexNY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( float ) );
-            normals_[pointCounter][1] = ny;
-          } else {
-            double ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( double ) );
-            normals_[pointCounter][1] = ny;
-          }
-        } else if ( a == indexNZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( float ) );
-            normals_[pointCounter][2] = nz;
-          } else {
-            double nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( double ) );
-            normals_[pointCounter][2] = nz;
-          }
-        } else if ( a == indexReflectance && attributeInfo.byteCount <= 2 ) {
-          if ( indexReflectance == 1 ) {
-            uint8_t reflectance;
-            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint8_t ) );
-            reflectances_[pointCounter] = reflectance;
-          } else {
-            auto& reflectance = reflectances_[pointCounter];
-            ifs.read( reinterpret_cast<char*>( reflectance ), sizeof( uint16_t ) );
-          }
-        } else {
-          char buffer[128];
-          ifs.read( buffer, attributeInfo.byteCount );
+    // The records are decoded in place from the mapped file; a truncated file only fills the complete records.
+    const char*  data        = cursor;
+    const size_t recordCount = recordSize == 0 ? 0 : ( std::min )( pointCount, size_t( end - cursor ) / recordSize );
+    auto readCoordinate      = [&]( const char* value, const AttributeInfo& attributeInfo ) {
+      if ( attributeInfo.byteCount == 2 ) { return PCCType( readBinary<uint16_t>( value ) ); }
+      if ( attributeInfo.byteCount == 4 ) { return PCCType( readBinary<float>( value ) ); }
+      return PCCType( readBinary<double>( value ) );
+    };
+    auto readNormal = [&]( const char* value, const AttributeInfo& attributeInfo ) {
+      return attributeInfo.byteCount == 4 ? double( readBinary<float>( value ) ) : readBinary<double>( value );
+    };
+    auto readColor = [&]( const char* value, const AttributeInfo& attributeInfo ) {
+      return attributeInfo.type == ATTRIBUTE_TYPE_INT8 ? static_cast<uint8_t>( readBinary<int8_t>( value ) )
+                                                       : readBinary<uint8_t>( value );
+    };
+    const bool isFloatPosition = indexX == 0 && indexY == 1 && indexZ == 2 && attributesInfo[0].byteCount == 4 &&
+                                 attributesInfo[1].byteCount == 4 && attributesInfo[2].byteCount == 4;
+    if ( isFloatPosition && attributeCount == 3 ) {
+      // x y z
+      for ( size_t i = 0; i < recordCount; ++i, data += recordSize ) {
+        auto& position = positions_[i];
+        position[0]    = PCCType( readBinary<float>( data ) );
+        position[1]    = PCCType( readBinary<float>( data + 4 ) );
+        position[2]    = PCCType( readBinary<float>( data + 8 ) );
+      }
+    } else if ( isFloatPosition && attributeCount == 6 && indexR == 3 && indexG == 4 && indexB == 5 ) {
+      // x y z red green blue
+      for ( size_t i = 0; i < recordCount; ++i, data += recordSize ) {
+        auto& position = positions_[i];
+        auto& color    = colors_[i];
+        position[0]    = PCCType( readBinary<float>( data ) );
+        position[1]    = PCCType( readBinary<float>( data + 4 ) );
+        position[2]    = PCCType( readBinary<float>( data + 8 ) );
+        color[0]       = readColor( data + 12, attributesInfo[3] );
+        color[1]       = readColor( data + 13, attributesInfo[4] );
+        color[2]       = readColor( data + 14, attributesInfo[5] );
+      }
+    } else {
+      for ( size_t i = 0; i < recordCount; ++i, data += recordSize ) {
+        auto& position = positions_[i];
+        position[0]    = readCoordinate( data + attributesInfo[indexX].offset, attributesInfo[indexX] );
+        position[1]    = readCoordinate( data + attributesInfo[indexY].offset, attributesInfo[indexY] );
+        position[2]    = readCoordinate( data + attributesInfo[indexZ].offset, attributesInfo[indexZ] );
+        if ( hasColors() ) {
+          auto& color = colors_[i];
+          color[0]    = readColor( data + attributesInfo[indexR].offset, attributesInfo[indexR] );
+          color[1]    = readColor( data + attributesInfo[indexG].offset, attributesInfo[indexG] );
+          color[2]    = readColor( data + attributesInfo[indexB].offset, attributesInfo[indexB] );
+        }
+        if ( hasNormals() ) {
+          auto& normal = normals_[i];
+          normal[0]    = readNormal( data + attributesInfo[indexNX].offset, attributesInfo[indexNX] );
+          normal[1]    = readNormal( data + attributesInfo[indexNY].offset, attributesInfo[indexNY] );
+          normal[2]    = readNormal( data + attributesInfo[indexNZ].offset, attributesInfo[indexNZ] );
+        }
+        if ( hasReflectances() ) {
+          const auto& attributeInfo = attributesInfo[indexReflectance];
+          reflectances_[i]          = attributeInfo.byteCount == 1
+                                          ? uint16_t( readBinary<uint8_t>( data + attributeInfo.offset ) )
+                                          : readBinary<uint16_t>( data + attributeInfo.offset );
         }
       }
     }
@@ -804,6 +916,94 @@ void PCCPointSet3::convertYUVToRGB() {  // BT709
   }
 }
 
+// The color transfers process the points by batches of nearest neighbor queries, in parallel in the task arena of
+// the caller, each batch reusing its own results and color buffers.
+static const size_t g_colorTransferBatchSize = 256;
+
+// Calls fct( start, end ) for the batches of the points [0, pointCount).
+template <typename Function>
+static void forEachColorTransferBatch( const size_t pointCount, const Function& fct ) {
+  const size_t batchCount = ( pointCount + g_colorTransferBatchSize - 1 ) / g_colorTransferBatchSize;
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
+#else
+  for ( size_t batch = 0; batch < batchCount; batch++ ) {
+#endif
+    const size_t start = batch * g_colorTransferBatchSize;
+    fct( start, ( std::min )( start + g_colorTransferBatchSize, pointCount ) );
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+}
+
+// Searches in kdtree the num_results nearest neighbors of the points of pointCloud, or of the points of pointCloud
+// listed in pointIndices, and calls fct( start, end, result ) for each batch of queries.
+template <typename Function>
+static void searchColorTransferBatches( const PCCKdTree&           kdtree,
+                                        const PCCPointSet3&        pointCloud,
+                                        const std::vector<size_t>* pointIndices,
+                                        const size_t               num_results,
+                                        const Function&            fct ) {
+  const size_t pointCount = pointIndices != nullptr ? pointIndices->size() : pointCloud.getPointCount();
+  forEachColorTransferBatch( pointCount, [&]( const size_t start, const size_t end ) {
+    PCCNNBatchResult result;
+    if ( pointIndices != nullptr ) {
+      kdtree.search( pointCloud, *pointIndices, start, end, num_results, result );
+    } else {
+      kdtree.search( pointCloud, start, end, num_results, result );
+    }
+    fct( start, end, result );
+  } );
+}
+
+// Searches in kdtreeTarget the num_results nearest target points of the points of pointCloud, then gathers in
+// pointCloud order the candidates makeCandidate( index, dist, indexInTarget ) of the neighbors accepted by
+// isCandidate( index, dist, indexInTarget ): the candidates of the target point indexInTarget are
+// candidates[candidateStart[indexInTarget]..candidateEnd[indexInTarget]).
+template <typename Candidate, typename IsCandidate, typename MakeCandidate>
+static void gatherColorTransferCandidates( const PCCKdTree&        kdtreeTarget,
+                                           const size_t            pointCountTarget,
+                                           const PCCPointSet3&     pointCloud,
+                                           const size_t            num_results,
+                                           const IsCandidate&      isCandidate,
+                                           const MakeCandidate&    makeCandidate,
+                                           std::vector<Candidate>& candidates,
+                                           std::vector<size_t>&    candidateStart,
+                                           std::vector<size_t>&    candidateEnd ) {
+  const size_t                  pointCount = pointCloud.getPointCount();
+  std::vector<PCCNNBatchResult> results( ( pointCount + g_colorTransferBatchSize - 1 ) / g_colorTransferBatchSize );
+  searchColorTransferBatches( kdtreeTarget, pointCloud, nullptr, num_results,
+                              [&]( const size_t start, const size_t, PCCNNBatchResult& result ) {
+                                std::swap( results[start / g_colorTransferBatchSize], result );
+                              } );
+  candidateStart.assign( pointCountTarget + 1, 0 );
+  for ( size_t index = 0; index < pointCount; ++index ) {
+    const auto&  result = results[index / g_colorTransferBatchSize];
+    const size_t query  = index % g_colorTransferBatchSize;
+    for ( size_t i = 0; i < result.count( query ); ++i ) {
+      if ( isCandidate( index, result.dist( query, i ), result.indices( query, i ) ) ) {
+        candidateStart[result.indices( query, i ) + 1]++;
+      }
+    }
+  }
+  std::partial_sum( candidateStart.begin(), candidateStart.end(), candidateStart.begin() );
+  candidates.resize( candidateStart[pointCountTarget] );
+  candidateEnd.assign( candidateStart.begin(), candidateStart.end() - 1 );
+  for ( size_t index = 0; index < pointCount; ++index ) {
+    const auto&  result = results[index / g_colorTransferBatchSize];
+    const size_t query  = index % g_colorTransferBatchSize;
+    for ( size_t i = 0; i < result.count( query ); ++i ) {
+      const double dist          = result.dist( query, i );
+      const size_t indexInTarget = result.indices( query, i );
+      if ( isCandidate( index, dist, indexInTarget ) ) {
+        candidates[candidateEnd[indexInTarget]++] = makeCandidate( index, dist, indexInTarget );
+      }
+    }
+  }
+}
+
 bool PCCPointSet3::transferColors( PCCPointSet3& target,
                                    const int32_t searchRange,
                                    const bool    losslessAttribute,
@@ -826,8 +1026,12 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeTarget( target, numNeighborsColorTransferBwd == 1 );
+  PCCKdTree kdtreeSource( source, numNeighborsColorTransferFwd == 1 );
+  // a source with fewer points than numNeighborsColorTransferFwd gives all its points as neighbors of each target
+  // point, and a target with fewer points than numNeighborsColorTransferBwd all its points to each source point
+  const size_t numNeighborsFwd = ( std::min )( static_cast<size_t>( numNeighborsColorTransferFwd ), pointCountSource );
+  const size_t numNeighborsBwd = ( std::min )( static_cast<size_t>( numNeighborsColorTransferBwd ), pointCountTarget );
   target.addColors();
   std::vector<PCCColor3B> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -841,35 +1045,30 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor( result.indices( 0 ) );
-        isDone                = true;
+  auto refineColors = [&]( const size_t start, const size_t end, PCCNNBatchResult& result ) {
+    std::vector<PCCVector3D> colors;
+    for ( size_t index = start; index < end; ++index ) {
+      const size_t* indices = result.indices( index - start );
+      const double* dist    = result.dist( index - start );
+      // keep the points that satisfy geometry dist threshold
+      int nNN = static_cast<int>( result.count( index - start ) );
+      while ( nNN > 1 && dist[nNN - 1] > maxGeometryDist2Fwd ) { --nNN; }
+      bool isDone = false;
+      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+        if ( dist[0] < 0.0001 ) {
+          refinedColors1[index] = source.getColor( indices[0] );
+          isDone                = true;
+        }
       }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
       while ( nNN > 0 && !isDone ) {
         if ( nNN == 1 ) {
-          refinedColors1[index] = source.getColor( result.indices( 0 ) );
+          refinedColors1[index] = source.getColor( indices[0] );
           isDone                = true;
         }
         if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
           colors.resize( nNN );
           for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
+            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( indices[i] )[k] ); }
           }
           double maxColorDist2 = std::numeric_limits<double>::min();
           for ( int i = 0; i < nNN; ++i ) {
@@ -883,8 +1082,8 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
             if ( useDistWeightedAverageFwd ) {
               double sumWeights{0.0};
               for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight; }
+                const double weight = 1 / ( dist[i] + distOffsetFwd );
+                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( indices[i] )[k] * weight; }
                 sumWeights += weight;
               }
               refinedColor /= sumWeights;
@@ -893,28 +1092,26 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
                 size_t      excludeCount = 0;
                 sumWeights               = 0.0;
                 for ( int i = 0; i < nNN; ++i ) {
-                  double      dist     = 0.0;
-                  PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
+                  PCCColor3B  tmpColor = source.getColor( indices[i] );
                   PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                  double      dist2 = ( sourceColor - refinedColor ).getNorm2();
+                  if ( dist2 > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
                     excludeCount += 1;
                     continue;
                   }
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                  const double weight = 1 / ( dist[i] + distOffsetFwd );
                   for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    excludeOutlierRefinedColor[k] += source.getColor( indices[i] )[k] * weight;
                   }
                   sumWeights += weight;
                 }
-
                 if ( excludeCount != nNN && excludeCount != 0 ) {
                   refinedColor = excludeOutlierRefinedColor / sumWeights;
                 }
               }
             } else {
               for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( indices[i] )[k]; }
               }
               refinedColor /= nNN;
             }
@@ -928,7 +1125,9 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
         }
       }
     }
-  }
+  };
+  searchColorTransferBatches( kdtreeSource, target, nullptr, numNeighborsFwd, refineColors );
+
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -937,189 +1136,183 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // colorsDists2 is iteratively refined (by removing the farthest points) until
   // the
   // std of remaining colors in it is smaller than a threshold.
-  std::vector<std::vector<DistColor8Bit>> refinedColorsDists2;
-  refinedColorsDists2.resize( pointCountTarget );
-  // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor8Bit{result.dist( i ), color} );
-      }
-    }
-  }
-  // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
-  // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                 // derived in backward
-                                                                 // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
+  // The candidates of the target points are gathered in source order into one array.
+  std::vector<DistColor8Bit> candidates;
+  std::vector<size_t>        candidateStart;
+  std::vector<size_t>        candidateEnd;
+  gatherColorTransferCandidates(
+      kdtreeTarget, pointCountTarget, source, numNeighborsBwd,
+      // keep the points that satisfy geometry dist threshold
+      [&]( const size_t, const double dist, const size_t ) { return dist <= maxGeometryDist2Bwd; },
+      [&]( const size_t index, const double dist, const size_t ) {
+        return DistColor8Bit{dist, source.getColor( index )};
+      },
+      candidates, candidateStart, candidateEnd );
+
+  // sort the candidates according to distance and compute centroid2
+  forEachColorTransferBatch( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    std::vector<PCCVector3D> colors;
+    for ( size_t index = start; index < end; ++index ) {
+      const PCCColor3B color1       = refinedColors1[index];  // refined color derived in forward direction
+      DistColor8Bit*   colorsDists2 = candidates.data() + candidateStart[index];  // set of candidate points
+      size_t           colorCount   = candidateEnd[index] - candidateStart[index];  // derived in backward direction
+      std::sort( colorsDists2, colorsDists2 + colorCount,
+                 []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
+      if ( colorCount == 0 || losslessAttribute ) {
+        target.setColor( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
+            colorCount = 1;
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorCount );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorCount );
+            if ( nNN == 1 ) {
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                      excludeCount += 1;
-                      continue;
-                    }
-                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
+                  for ( size_t i = 0; i < colorCount; ++i ) {
+                    const double weight = 1 / ( sqrt( colorsDists2[i].dist ) + distOffsetBwd );
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( colorsDists2[i].color[k] * weight ); }
                     sumWeights += weight;
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( size_t i = 0; i < colorCount; ++i ) {
+                      const auto& color2 = colorsDists2[i].color;
+                      PCCVector3D sourceColor( color2[0], color2[1], color2[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( colorsDists2[i].dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( color2[k] * weight ); }
+                      sumWeights += weight;
+                    }
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      centroid2 = excludeOutlierCentroid2 / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( size_t i = 0; i < colorCount; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += colorsDists2[i].color[k]; }
+                  }
+                  centroid2 /= colorCount;
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorCount--;
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorCount );
+        double D2 = 0.0;
+        for ( size_t i = 0; i < colorCount; ++i ) {
+          auto color2 = colorsDists2[i].color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint8_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint8_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( size_t i = 0; i < colorCount; ++i ) {
+                  auto color2 = colorsDists2[i].color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor( index,
+                           PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor( index, color1 );
         }
-        target.setColor( index,
-                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1145,8 +1338,12 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeTarget( target, numNeighborsColorTransferBwd == 1 );
+  PCCKdTree kdtreeSource( source, numNeighborsColorTransferFwd == 1 );
+  // a source with fewer points than numNeighborsColorTransferFwd gives all its points as neighbors of each target
+  // point, and a target with fewer points than numNeighborsColorTransferBwd all its points to each source point
+  const size_t numNeighborsFwd = ( std::min )( static_cast<size_t>( numNeighborsColorTransferFwd ), pointCountSource );
+  const size_t numNeighborsBwd = ( std::min )( static_cast<size_t>( numNeighborsColorTransferBwd ), pointCountTarget );
   target.addColors16bit();
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -1156,113 +1353,120 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
   PCCPointSet3 partSource;
   partSource.addColors();
+  partSource.addParentPointIndex();
+
   // ==========================================================================================
   //                                     Forward direction
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
+  std::vector<size_t> boundaryIndices;
   for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      if ( filterType == 1 ) {
-        for ( size_t rI = 0; rI < result.size(); ++rI ) {
-          auto indexInSource = result.indices( rI );
-          auto partIndex2    = partSource.addPoint( source[indexInSource] );
-          partSource.setColor( partIndex2, source.getColor( indexInSource ) );
-          partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
-          partSource.setParentPointIndex( partIndex2, indexInSource );
-        }
-      }
+    refinedColors1[index] = target.getColor16bit( index );
+    if ( target.getBoundaryPointType( index ) == 3 ) { boundaryIndices.push_back( index ); }
+  }
+  // the results are kept when the neighbors of the boundary points make the partial source
+  const size_t boundaryBatchCount =
+      ( boundaryIndices.size() + g_colorTransferBatchSize - 1 ) / g_colorTransferBatchSize;
+  std::vector<PCCNNBatchResult> boundaryResults( filterType == 1 ? boundaryBatchCount : 0 );
+  auto refineColors = [&]( const size_t start, const size_t end, PCCNNBatchResult& result ) {
+    std::vector<PCCVector3D> colors;
+    for ( size_t query = 0; query < end - start; ++query ) {
+      const size_t  index   = boundaryIndices[start + query];
+      const size_t* indices = result.indices( query );
+      const double* dist    = result.dist( query );
       // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.size() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
+      int nNN = static_cast<int>( result.count( query ) );
+      while ( nNN > 1 && dist[nNN - 1] > maxGeometryDist2Fwd ) { --nNN; }
       bool isDone = false;
       if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+        if ( dist[0] < 0.0001 ) {
+          refinedColors1[index] = source.getColor16bit( indices[0] );
           isDone                = true;
         }
       }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
-            refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-            isDone                = true;
+      while ( nNN > 0 && !isDone ) {
+        if ( nNN == 1 ) {
+          refinedColors1[index] = source.getColor16bit( indices[0] );
+          isDone                = true;
+        }
+        if ( !isDone ) {
+          colors.resize( nNN );
+          for ( int i = 0; i < nNN; ++i ) {
+            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( indices[i] )[k] ); }
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+          double maxColorDist2 = std::numeric_limits<double>::min();
+          for ( int i = 0; i < nNN; ++i ) {
+            for ( int j = i + 1; j < nNN; ++j ) {
+              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          }
+          if ( maxColorDist2 <= maxColorDist2Fwd ) {
+            PCCVector3D refinedColor( 0.0 );
+            if ( useDistWeightedAverageFwd ) {
+              double sumWeights{0.0};
+              for ( int i = 0; i < nNN; ++i ) {
+                const double weight = 1 / ( dist[i] + distOffsetFwd );
+                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( indices[i] )[k] * weight; }
+                sumWeights += weight;
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
+              refinedColor /= sumWeights;
+              if ( excludeColorOutlier ) {
+                PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                size_t      excludeCount = 0;
+                sumWeights               = 0.0;
                 for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                  PCCColor16bit tmpColor = source.getColor16bit( indices[i] );
+                  PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                  double        dist2 = ( sourceColor - refinedColor ).getNorm2();
+                  if ( dist2 > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                    excludeCount += 1;
+                    continue;
+                  }
+                  const double weight = 1 / ( dist[i] + distOffsetFwd );
                   for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    excludeOutlierRefinedColor[k] += source.getColor16bit( indices[i] )[k] * weight;
                   }
                   sumWeights += weight;
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( int i = 0; i < nNN; ++i ) {
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    double        dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
-                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                    for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                    }
-                    sumWeights += weight;
-                  }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
-                  }
-                }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                if ( excludeCount != nNN && excludeCount != 0 ) {
+                  refinedColor = excludeOutlierRefinedColor / sumWeights;
                 }
-                refinedColor /= nNN;
-              }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
               }
-              isDone = true;
             } else {
-              --nNN;
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( indices[i] )[k]; }
+              }
+              refinedColor /= nNN;
+            }
+            for ( int k = 0; k < 3; ++k ) {
+              refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
             }
+            isDone = true;
+          } else {
+            --nNN;
           }
         }
       }
     }
+    if ( filterType == 1 ) { std::swap( boundaryResults[start / g_colorTransferBatchSize], result ); }
+  };
+  searchColorTransferBatches( kdtreeSource, target, &boundaryIndices, numNeighborsFwd, refineColors );
+  // the partial source gathers the neighbors of the boundary points in target order
+  for ( auto& result : boundaryResults ) {
+    for ( size_t query = 0; query < result.size(); ++query ) {
+      for ( size_t i = 0; i < result.count( query ); ++i ) {
+        auto indexInSource = result.indices( query, i );
+        auto partIndex2    = partSource.addPoint( source[indexInSource] );
+        partSource.setColor( partIndex2, source.getColor( indexInSource ) );
+        partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
+        partSource.setParentPointIndex( partIndex2, indexInSource );
+      }
+    }
   }
+  boundaryResults.clear();
+
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1271,216 +1475,196 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   // colorsDists2 is iteratively refined (by removing the farthest points) until
   // the
   // std of remaining colors in it is smaller than a threshold.
-  std::vector<std::vector<DistColor>> refinedColorsDists2;
-  if ( filterType == 1 ) {
-    refinedColorsDists2.resize( pointCountTarget );
-    // populate refinedColorsDists2
-    auto sampleSetPointCount = partSource.getPointCount();
-    for ( size_t index = 0; index < sampleSetPointCount; ++index ) {
-      const PCCColor16bit color = partSource.getColor16bit( index );
-      kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
-            refinedColorsDists2[result.indices( i )].push_back( DistColor{
-                result.dist( i ), color, target[result.indices( i )], partSource.getParentPointIndex( index ), index} );
-        }
-      }
-    }
-
-    // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
-  } else {
-    // populate refinedColorsDists2
-    refinedColorsDists2.resize( pointCountTarget );
-    for ( size_t index = 0; index < pointCountSource; ++index ) {
-      const PCCColor16bit color = source.getColor16bit( index );
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-        }
-      }
-    }
-    // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+  // The candidates of the target points are gathered in source order, or in partial source order with filterType 1,
+  // into one array.
+  const PCCPointSet3& candidateSource = filterType == 1 ? partSource : source;
+  // keep the points that satisfy geometry dist threshold and, with filterType 1, have a color close to the target one
+  auto isCandidate = [&]( const size_t index, const double dist, const size_t indexInTarget ) {
+    if ( dist > maxGeometryDist2Bwd ) { return false; }
+    if ( filterType != 1 ) { return true; }
+    const auto& color  = candidateSource.getColor16bit( index );
+    const auto& colorT = target.getColor16bit( indexInTarget );
+    return std::abs( color[0] - colorT[0] ) < 40 && std::abs( color[1] - colorT[1] ) < 40 &&
+           std::abs( color[2] - colorT[2] ) < 40;
+  };
+  auto makeCandidate = [&]( const size_t index, const double dist, const size_t indexInTarget ) {
+    const PCCColor16bit color = candidateSource.getColor16bit( index );
+    return filterType == 1
+               ? DistColor{dist, color, target[indexInTarget], partSource.getParentPointIndex( index ), index}
+               : DistColor{dist, color};
+  };
+  std::vector<DistColor> candidates;
+  std::vector<size_t>    candidateStart;
+  std::vector<size_t>    candidateEnd;
+  gatherColorTransferCandidates( kdtreeTarget, pointCountTarget, candidateSource, numNeighborsBwd, isCandidate,
+                                 makeCandidate, candidates, candidateStart, candidateEnd );
+
+  // sort the candidates according to distance and compute centroid2
+  forEachColorTransferBatch( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    std::vector<PCCVector3D> colors;
+    for ( size_t index = start; index < end; ++index ) {
+      if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) { continue; }
+      // refined color derived in forward direction and set of candidate points derived in backward direction
+      const PCCColor16bit color1       = refinedColors1[index];
+      DistColor*          colorsDists2 = candidates.data() + candidateStart[index];
+      size_t              colorCount   = candidateEnd[index] - candidateStart[index];
+      std::sort( colorsDists2, colorsDists2 + colorCount,
                  []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
-  }
-  // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
-            auto temp = colorsDists2[0];
-            colorsDists2.clear();
-            colorsDists2.push_back( temp );
+      if ( colorCount == 0 || losslessAttribute ) {
+        target.setColor16bit( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
+            colorCount = 1;
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorCount );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorCount );
+            if ( nNN == 1 ) {
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
-                  for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
-                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
+                  for ( size_t i = 0; i < colorCount; ++i ) {
+                    const double weight = 1 / ( sqrt( colorsDists2[i].dist ) + distOffsetBwd );
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( colorsDists2[i].color[k] * weight ); }
                     sumWeights += weight;
                   }
-
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( size_t i = 0; i < colorCount; ++i ) {
+                      const auto& color2 = colorsDists2[i].color;
+                      PCCVector3D sourceColor( color2[0], color2[1], color2[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( colorsDists2[i].dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( color2[k] * weight ); }
+                      sumWeights += weight;
+                    }
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      centroid2 = excludeOutlierCentroid2 / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( size_t i = 0; i < colorCount; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += colorsDists2[i].color[k]; }
+                  }
+                  centroid2 /= colorCount;
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorCount--;
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorCount );
+        double D2 = 0.0;
+        for ( size_t i = 0; i < colorCount; ++i ) {
+          auto color2 = colorsDists2[i].color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint16_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( size_t i = 0; i < colorCount; ++i ) {
+                  auto color2 = colorsDists2[i].color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor16bit(
+              index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor16bit( index, color1 );
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1506,8 +1690,8 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeTarget( target, numNeighborsColorTransferBwd == 1 );
+  PCCKdTree kdtreeSource( source, numNeighborsColorTransferFwd == 1 );
   target.addColors16bit();
   maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
   maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
@@ -1525,6 +1709,7 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
 
   PCCPointSet3 partTarget;
   partTarget.addColors();
+  partTarget.addParentPointIndex();
   if ( filterType == 9 ) {
     for ( size_t index = 0; index < pointCountTarget; ++index ) {
       if ( target.getBoundaryPointType( index ) == 3 ) {
@@ -1536,7 +1721,7 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
     }
   }
 
-  PCCKdTree kdtreePartTarget( partTarget );
+  PCCKdTree kdtreePartTarget( partTarget, numNeighborsColorTransferBwd == 1 );
 
   //////
   std::vector<std::vector<DistColor>> refinedColorsDists2;
@@ -1797,8 +1982,8 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeTarget( target, numNeighborsColorTransferBwd == 1 );
+  PCCKdTree kdtreeSource( source, numNeighborsColorTransferFwd == 1 );
   target.addColors16bit();
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -2103,70 +2288,77 @@ bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
 
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeTarget( target, true );
+  PCCKdTree kdtreeSource( source, true );
   target.addColors();
-  std::vector<PCCColor3B>              refinedColors1;
-  std::vector<std::vector<PCCColor3B>> refinedColors2;
+  std::vector<PCCColor3B> refinedColors1;
   refinedColors1.resize( pointCountTarget );
-  refinedColors2.resize( pointCountTarget );
   const size_t num_results = 1;
-  PCCNNResult  result;
-  //  Find THE closest point in reconstruction to each source point
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], num_results, result );
-    refinedColors1[index] = source.getColor( result.indices( 0 ) );
-  }
-  //  Find points in source that are closest to point in reconstruction
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], num_results, result );
-    refinedColors2[result.indices( 0 )].push_back( color );
-  }
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B               color1  = refinedColors1[index];
-    const std::vector<PCCColor3B>& colors2 = refinedColors2[index];
-    if ( colors2.empty() || losslessAttribute ) {
-      target.setColor( index, color1 );
-    } else {
-      const auto        H = double( colors2.size() );
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      for ( const auto& color2 : colors2 ) {
-        for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += color2[k]; }
-      }
-      centroid2 /= H;
+  //  Find THE closest point in reconstruction to each source point
+  searchColorTransferBatches( kdtreeSource, target, nullptr, num_results,
+                              [&]( const size_t start, const size_t end, PCCNNBatchResult& result ) {
+                                for ( size_t index = start; index < end; ++index ) {
+                                  refinedColors1[index] = source.getColor( result.indices( index - start, 0 ) );
+                                }
+                              } );
+  //  Find points in source that are closest to point in reconstruction: the colors of the source points are gathered
+  //  in source order into one array.
+  std::vector<PCCColor3B> refinedColors2;
+  std::vector<size_t>     colorStart;
+  std::vector<size_t>     colorEnd;
+  gatherColorTransferCandidates(
+      kdtreeTarget, pointCountTarget, source, num_results,
+      []( const size_t, const double, const size_t ) { return true; },
+      [&]( const size_t index, const double, const size_t ) { return source.getColor( index ); }, refinedColors2,
+      colorStart, colorEnd );
+
+  forEachColorTransferBatch( pointCountTarget, [&]( const size_t start, const size_t end ) {
+    for ( size_t index = start; index < end; ++index ) {
+      const PCCColor3B  color1      = refinedColors1[index];
+      const PCCColor3B* colors2     = refinedColors2.data() + colorStart[index];
+      const size_t      colorCount2 = colorEnd[index] - colorStart[index];
+      if ( colorCount2 == 0 || losslessAttribute ) {
+        target.setColor( index, color1 );
+      } else {
+        const auto        H = double( colorCount2 );
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        for ( size_t i = 0; i < colorCount2; ++i ) {
+          for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += colors2[i][k]; }
+        }
+        centroid2 /= H;
 
-      double D2 = 0.0;
-      for ( const auto& color2 : colors2 ) {
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
+        double D2 = 0.0;
+        for ( size_t i = 0; i < colorCount2; ++i ) {
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - colors2[i][k];
+            D2 += d2 * d2;
+          }
         }
-      }
-      //      const double r = double(pointCountTarget) /
-      // double(pointCountSource);
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
+        //      const double r = double(pointCountTarget) /
+        // double(pointCountSource);
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
 
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
 
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          PCCVector3D bestColor( color0 );
+          target.setColor( index,
+                           PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor( index, color1 );
         }
-        PCCVector3D bestColor( color0 );
-        target.setColor( index,
-                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -2178,8 +2370,8 @@ bool PCCPointSet3::transferColorSimple( PCCPointSet3& target, const double bestC
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
   target.addColors();
 
-  PCCKdTree kdtreeSource( source );
-  PCCKdTree kdtreeTarget( target );
+  PCCKdTree kdtreeSource( source, true );
+  PCCKdTree kdtreeTarget( target, true );
 
   std::vector<PCCColor3B>              refinedColors1;
   std::vector<std::vector<PCCColor3B>> refinedColors2;
@@ -2253,29 +2445,34 @@ bool PCCPointSet3::transferColorWeight( PCCPointSet3& target, const double bestC
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
   target.addColors16bit();
-  PCCKdTree    kdtreeSource( source );
-  PCCNNResult  result;
-  const size_t num_results = 5;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], num_results, result );
-    PCCVector3D color16bit( 0.0 );
-    if ( result.size() > 1 && result.dist( 0 ) > 0.0001 ) {
-      double sum = 0;
-      for ( size_t i = 0; i < result.size(); ++i ) {
-        const double w     = 1.0 / pow( result.dist( i ), 2.0 );
-        auto         found = source.getColor16bit( result.indices( i ) );
-        PCCVector3D  scaled;
-        scaled = found;
-        color16bit += scaled * w;
-        sum += w;
+  PCCKdTree kdtreeSource( source );
+  // a source with fewer than 5 points gives all its points as neighbors of each target point
+  const size_t num_results = ( std::min )( size_t( 5 ), pointCountSource );
+  auto weightColors = [&]( const size_t start, const size_t end, PCCNNBatchResult& result ) {
+    for ( size_t index = start; index < end; ++index ) {
+      const size_t  count   = result.count( index - start );
+      const size_t* indices = result.indices( index - start );
+      const double* dist    = result.dist( index - start );
+      PCCVector3D   color16bit( 0.0 );
+      if ( count > 1 && dist[0] > 0.0001 ) {
+        double sum = 0;
+        for ( size_t i = 0; i < count; ++i ) {
+          const double w     = 1.0 / pow( dist[i], 2.0 );
+          auto         found = source.getColor16bit( indices[i] );
+          PCCVector3D  scaled;
+          scaled = found;
+          color16bit += scaled * w;
+          sum += w;
+        }
+        color16bit /= sum;
+      } else {
+        const auto& found = source.getColor16bit( indices[0] );
+        color16bit        = found;
       }
-      color16bit /= sum;
-    } else {
-      const auto& found = source.getColor16bit( result.indices( 0 ) );
-      color16bit        = found;
+      target.getColor16bit( index ) = color16bit;
     }
-    target.getColor16bit( index ) = color16bit;
-  }
+  };
+  searchColorTransferBatches( kdtreeSource, target, nullptr, num_results, weightColors );
   return true;
 }
 
@@ -36,9 +36,20 @@
 #include <windows.h>
 #endif
 
+#include <atomic>
+#include <cerrno>
 #include <chrono>
 #include <memory>
+#include <thread>
 #include "PCCSystem.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 //===========================================================================
 
@@ -105,3 +116,113 @@ int pcc::system( const char* command ) noexcept {
 #endif
 
 //===========================================================================
+
+#ifndef _WIN32
+bool pcc::createPipes( const std::vector<std::string>& fileNames ) {
+  for ( auto& fileName : fileNames ) {
+    removeFile( fileName );
+    if ( mkfifo( fileName.c_str(), 0600 ) != 0 ) {
+      for ( auto& name : fileNames ) { removeFile( name ); }
+      return false;
+    }
+  }
+  return true;
+}
+
+int pcc::system( const char* command, const std::vector<PCCPipe>& pipes ) {
+  std::unique_ptr<std::atomic<bool>[]> opened( new std::atomic<bool>[pipes.size()] );
+  std::unique_ptr<std::atomic<bool>[]> unused( new std::atomic<bool>[pipes.size()] );
+  std::unique_ptr<std::atomic<bool>[]> succeeded( new std::atomic<bool>[pipes.size()] );
+  std::vector<std::thread>             threads;
+  for ( size_t i = 0; i < pipes.size(); i++ ) {
+    opened[i]    = false;
+    unused[i]    = false;
+    succeeded[i] = false;
+    threads.emplace_back( [&, i] {
+      if ( pipes[i].write_ ) {
+        // a command that stops reading must make the writes fail, not raise SIGPIPE for the whole process
+        sigset_t mask;
+        sigemptyset( &mask );
+        sigaddset( &mask, SIGPIPE );
+        pthread_sigmask( SIG_BLOCK, &mask, nullptr );
+        std::ofstream file( pipes[i].fileName_, std::ios::binary );
+        opened[i]    = true;
+        errno        = 0;
+        succeeded[i] = file.good() && pipes[i].write_( file ) && file.flush().good();
+        if ( !succeeded[i] && errno == EPIPE ) {
+          // the command closed its input, or never opened it: the stream ends here and the command status tells if
+          // it was expected
+          if ( !unused[i] ) { std::cout << "Error: the command stopped reading " << pipes[i].fileName_ << std::endl; }
+          succeeded[i] = true;
+        }
+      } else {
+        std::ifstream file( pipes[i].fileName_, std::ios::binary );
+        opened[i]    = true;
+        succeeded[i] = file.good() && pipes[i].read_( file );
+      }
+    } );
+  }
+  int ret = ::system( command );
+
+  // the opening of a pipe blocks until both ends are opened: open the other end of the pipes the command did not use.
+  // This blocking open returns as soon as the thread has opened, or opens, its end of the pipe.
+  for ( size_t i = 0; i < pipes.size(); i++ ) {
+    if ( opened[i] ) { continue; }
+    unused[i] = true;
+    int fd = open( pipes[i].fileName_.c_str(), pipes[i].write_ ? O_RDONLY : O_WRONLY );
+    if ( fd >= 0 ) { close( fd ); }
+  }
+  bool transfered = true;
+  for ( size_t i = 0; i < pipes.size(); i++ ) {
+    threads[i].join();
+    transfered &= succeeded[i];
+  }
+  return ret != 0 ? ret : transfered ? 0 : -1;
+}
+#else
+bool pcc::createPipes( const std::vector<std::string>& fileNames ) { return false; }
+
+int pcc::system( const char* command, const std::vector<PCCPipe>& pipes ) { return -1; }
+#endif
+
+//===========================================================================
+
+bool pcc::PCCMappedFile::open( const std::string& fileName ) {
+  close();
+#ifndef _WIN32
+  int fd = ::open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return false; }
+  struct stat status;
+  if ( fstat( fd, &status ) == 0 && status.st_size > 0 ) {
+    void* data = mmap( nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( data != MAP_FAILED ) {
+      madvise( data, status.st_size, MADV_SEQUENTIAL );
+      data_   = static_cast<const char*>( data );
+      size_   = status.st_size;
+      mapped_ = true;
+    }
+  }
+  ::close( fd );
+  if ( mapped_ ) { return true; }
+#endif
+  std::ifstream file( fileName, std::ios::binary | std::ios::ate );
+  if ( !file.is_open() ) { return false; }
+  buffer_.resize( static_cast<size_t>( file.tellg() ) );
+  file.seekg( 0 );
+  if ( !file.read( buffer_.data(), buffer_.size() ) ) { return false; }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return true;
+}
+
+void pcc::PCCMappedFile::close() {
+#ifndef _WIN32
+  if ( mapped_ ) { munmap( const_cast<char*>( data_ ), size_ ); }
+#endif
+  data_   = nullptr;
+  size_   = 0;
+  mapped_ = false;
+  buffer_.clear();
+}
+
+//===========================================================================
@@ -0,0 +1,118 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+
+#include "PCCPointSet.h"
+#include "PCCVoxelGrid.h"
+
+using namespace pcc;
+
+static const int64_t g_emptyCellKey = -1;
+
+static inline uint64_t cellHash( const int64_t key ) {
+  return ( static_cast<uint64_t>( key ) * 0x9E3779B97F4A7C15ULL ) >> 20;
+}
+
+PCCVoxelGrid::PCCVoxelGrid() : cellSize_( 1 ), gridWidth_( 0 ), cellMask_( 0 ) {}
+
+PCCVoxelGrid::PCCVoxelGrid( const PCCPointSet3& pointCloud, const size_t cellSize, const size_t gridWidth ) :
+    cellSize_( 1 ), gridWidth_( 0 ), cellMask_( 0 ) {
+  init( pointCloud, cellSize, gridWidth );
+}
+
+PCCVoxelGrid::~PCCVoxelGrid() { clear(); }
+
+void PCCVoxelGrid::clear() {
+  cellSize_  = 1;
+  gridWidth_ = 0;
+  cellMask_  = 0;
+  cellKeys_.clear();
+  cellIndexes_.clear();
+  cells_.clear();
+}
+
+void PCCVoxelGrid::init( const PCCPointSet3& pointCloud, const size_t cellSize, const size_t gridWidth ) {
+  clear();
+  cellSize_               = cellSize;
+  gridWidth_              = gridWidth;
+  const size_t pointCount = pointCloud.getPointCount();
+  size_t       tableSize  = 16;
+  while ( tableSize < 2 * pointCount ) { tableSize <<= 1; }
+  cellMask_ = tableSize - 1;
+  cellKeys_.assign( tableSize, g_emptyCellKey );
+  cellIndexes_.resize( tableSize );
+
+  // cell of each point, the cells being numbered in the order of their first point
+  std::vector<uint32_t> pointCells( pointCount, g_undefined_index );
+  std::vector<uint32_t> cellCounts;
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    const PCCVector3<int> position = pointCloud[i] / cellSize_;
+    const int64_t         key      = getKey( position );
+    if ( key == g_emptyCellKey ) { continue; }
+    uint64_t slot = cellHash( key ) & cellMask_;
+    while ( cellKeys_[slot] != g_emptyCellKey && cellKeys_[slot] != key ) { slot = ( slot + 1 ) & cellMask_; }
+    if ( cellKeys_[slot] == g_emptyCellKey ) {
+      cellKeys_[slot]    = key;
+      cellIndexes_[slot] = static_cast<uint32_t>( cellCounts.size() );
+      cellCounts.push_back( 0 );
+    }
+    pointCells[i] = cellIndexes_[slot];
+    cellCounts[pointCells[i]]++;
+  }
+  cells_.resize( cellCounts, false );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    const uint32_t cell = pointCells[i];
+    if ( cell == g_undefined_index ) { continue; }
+    const size_t count                 = cells_.getNeighborCount( cell );
+    cells_.getNeighbors( cell )[count] = static_cast<uint32_t>( i );
+    cells_.setNeighborCount( cell, count + 1 );
+  }
+}
+
+int64_t PCCVoxelGrid::getKey( const PCCVector3<int>& position ) const {
+  const auto    width = static_cast<int64_t>( gridWidth_ );
+  const int64_t key   = position[0] + position[1] * width + position[2] * width * width;
+  return key < 0 || key >= width * width * width ? g_emptyCellKey : key;
+}
+
+uint32_t PCCVoxelGrid::findKey( const int64_t key ) const {
+  if ( key == g_emptyCellKey || cellKeys_.empty() ) { return g_undefined_index; }
+  uint64_t slot = cellHash( key ) & cellMask_;
+  while ( cellKeys_[slot] != g_emptyCellKey ) {
+    if ( cellKeys_[slot] == key ) { return cellIndexes_[slot]; }
+    slot = ( slot + 1 ) & cellMask_;
+  }
+  return g_undefined_index;
+}
+
+uint32_t PCCVoxelGrid::findCell( const PCCVector3<int>& position ) const { return findKey( getKey( position ) ); }
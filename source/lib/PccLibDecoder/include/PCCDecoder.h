@@ -38,6 +38,7 @@
 #include "PCCCodec.h"
 #include "PCCMath.h"
 #include "PCCPatch.h"
+#include <functional>
 
 namespace pcc {
 
@@ -61,6 +62,12 @@ class PCCDecoder : public PCCCodec {
 
   int decode( PCCContext& context, PCCGroupOfFrames& reconstruct, int32_t atlasIndex );
 
+  // Streaming decoding: the frames are reconstructed while the videos are still being decoded and are given to
+  // frameCallback, in order, as soon as their occupancy, geometry and attribute pictures are available.
+  int decode( PCCContext&                                         context,
+              const std::function<void( size_t, PCCPointSet3& )>& frameCallback,
+              int32_t                                             atlasIndex );
+
   void setParameters( const PCCDecoderParameters& params );
   void setReconstructionParameters( const PCCDecoderParameters& params );
   void setPostProcessingSeiParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context, size_t atglIndex );
@@ -75,13 +82,25 @@ class PCCDecoder : public PCCCodec {
   void       setPLRData( PCCFrameContext& tile, PCCPatch& patch, PLRData& plrd, size_t occupancyPackingBlockSize );
   void       setTilePartitionSizeAfti( PCCContext& context );
   size_t     setTileSizeAndLocation( PCCContext& context, size_t frameIndex, AtlasTileHeader& atgh );
-  bool       compareHashSEIMD5( std::vector<uint8_t>& encMD5, std::vector<uint8_t>& decMD5 );
+  bool       compareHashSEIMD5( const std::vector<uint8_t>& encMD5, const std::vector<uint8_t>& decMD5 );
   bool       compareHashSEICrc( uint16_t encCrc, uint16_t decCrc );
   bool       compareHashSEICheckSum( uint32_t encCheckSum, uint32_t decCheckSum );
   void       createHashSEI( PCCContext& context, int frameIndex, SEIDecodedAtlasInformationHash& sei );
   void       createHlsAtlasTileLogFiles( PCCContext& context, int frameIndex );
   void       setConsitantFourCCCode( PCCContext& context, size_t atglIndex );
   PCCCodecId getCodedCodecId( PCCContext& context, const uint8_t codecCodecId, const std::string& videoDecoderPath );
+  std::vector<std::vector<bool>> getAbsoluteT1List( PCCContext& context, int32_t atlasIndex );
+  void                           reconstructFrame( PCCContext&                           context,
+                                                   size_t                                frameIdx,
+                                                   PCCPointSet3&                         reconstruct,
+                                                   std::vector<uint8_t>&                 pcFrameChecksum,
+                                                   std::vector<uint8_t>&                 recFrameChecksum,
+                                                   const std::vector<std::vector<bool>>& absoluteT1List,
+                                                   int32_t                               atlasIndex );
+  void                           traceFrame( PCCContext&                 context,
+                                             size_t                      frameIdx,
+                                             const std::vector<uint8_t>& pcFrameChecksum,
+                                             const std::vector<uint8_t>& recFrameChecksum );
 
   PCCDecoderParameters     params_;
   std::vector<std::string> consitantFourCCCode_;
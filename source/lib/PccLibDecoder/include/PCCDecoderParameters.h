@@ -60,6 +60,11 @@ class PCCDecoderParameters {
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
   bool              keepIntermediateFiles_;
+  bool              streamingDecode_;
+  size_t            streamingFrameCount_;
+  std::string       bitstreamIndexPath_;
+  size_t            startGofIndex_;
+  size_t            gofCount_;
   bool              patchColorSubsampling_;
   size_t            bestColorSearchRange_;
   int               numNeighborsColorTransferFwd_;
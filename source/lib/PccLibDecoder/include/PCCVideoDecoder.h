@@ -35,11 +35,18 @@
 #define PCCVideoDecoder_h
 
 #include "PCCCommon.h"
+#include <functional>
 
 namespace pcc {
 
 template <typename T, size_t N>
 class PCCVideo;
+template <typename T, size_t N>
+class PCCImage;
+template <class T>
+class PCCVirtualVideoDecoder;
+template <class T>
+class PCCVirtualColorConverter;
 class PCCContext;
 class PCCVideoBitstream;
 class PCCLogger;
@@ -65,10 +72,42 @@ class PCCVideoDecoder {
                    const std::string& colorSpaceConversionPath          = "",
                    const size_t       upsamplingFilter                  = 0 );
 
-  void setLogger( PCCLogger& logger ) { logger_ = &logger; }
+  // Streaming decoding: each picture is converted and given to pictureCallback, in output order, as soon as the
+  // video decoder has output it. The picture traces are stored and must be written with getPictureTrace().
+  template <typename T>
+  bool decompress( const std::function<void( PCCImage<T, 3>&, size_t )>& pictureCallback,
+                   const std::string&                                     path,
+                   PCCVideoBitstream&                                     bitstream,
+                   bool                                                   byteStreamVideoCoder,
+                   PCCCodecId                                             codecId,
+                   const std::string&                                     decoderPath,
+                   size_t                                                 outputBitDepth,
+                   const bool                                             keepIntermediateFiles             = false,
+                   const size_t                                           shvcLayerIndex                    = 8,
+                   const std::string&                                     inverseColorSpaceConversionConfig = "",
+                   const std::string&                                     colorSpaceConversionPath          = "",
+                   const size_t                                           upsamplingFilter                  = 0 );
+
+  void               setLogger( PCCLogger& logger ) { logger_ = &logger; }
+  void               setNbThread( size_t nbThread ) { nbThread_ = nbThread; }
+  const std::string& getPictureTrace() { return pictureTrace_; }
 
  private:
-  PCCLogger* logger_ = nullptr;
+  template <typename T>
+  std::shared_ptr<PCCVirtualVideoDecoder<T>> createDecoder( PCCVideoBitstream& bitstream,
+                                                            bool               byteStreamVideoCoder,
+                                                            PCCCodecId         codecId,
+                                                            const size_t       shvcLayerIndex );
+  template <typename T>
+  std::shared_ptr<PCCVirtualColorConverter<T>> createColorConverter( const std::string& conversionPath,
+                                                                     const std::string& inverseConversionConfig,
+                                                                     size_t             outputBitDepth,
+                                                                     const size_t       upsamplingFilter,
+                                                                     std::string&       configInverseColorSpace );
+
+  PCCLogger*  logger_   = nullptr;
+  size_t      nbThread_ = 1;
+  std::string pictureTrace_;
 };
 
 };  // namespace pcc
@@ -37,9 +37,13 @@
 #include "PCCContext.h"
 #include "PCCFrameContext.h"
 #include "PCCPatch.h"
+#include "PCCHash.h"
 #include "PCCVideoDecoder.h"
+#include "PCCVirtualVideoDecoder.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCDecoder.h"
+#include "PCCQueue.h"
+#include <thread>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
@@ -47,6 +51,57 @@
 using namespace pcc;
 using namespace std;
 
+// Video stream decoded in its own thread by the streaming decoder: the pictures are moved into the context video as
+// soon as they are output by the video decoder and released once the frames using them have been reconstructed.
+class PCCStreamingVideo {
+ public:
+  PCCStreamingVideo( const std::string& trace, size_t picturesPerFrame, size_t maxFrames ) :
+      trace_( trace ), picturesPerFrame_( picturesPerFrame ), counter_( picturesPerFrame * maxFrames ) {}
+  ~PCCStreamingVideo() {
+    close();
+    join();
+  }
+
+  template <typename T>
+  void start( PCCVideo<T, 3>& video,
+              size_t          frameCount,
+              const std::function<void( PCCVideoDecoder&, const std::function<void( PCCImage<T, 3>&, size_t )>& )>&
+                  decode ) {
+    video.clear();
+    video.resize( frameCount * picturesPerFrame_ );
+    release_ = [&video]( size_t index ) { video[index].release(); };
+    thread_  = std::thread( [this, &video, decode] {
+      decode( decoder_, [&]( PCCImage<T, 3>& image, size_t index ) {
+        if ( index >= video.getFrameCount() ) { return; }
+        counter_.waitSlot( index );
+        video[index].swap( image );
+        counter_.produced( index + 1 );
+      } );
+      counter_.close();
+    } );
+  }
+  bool waitFrame( size_t frameIndex ) { return counter_.waitFrame( ( frameIndex + 1 ) * picturesPerFrame_ - 1 ); }
+  void releaseFrame( size_t frameIndex ) {
+    for ( size_t i = frameIndex * picturesPerFrame_; i < ( frameIndex + 1 ) * picturesPerFrame_; i++ ) {
+      release_( i );
+    }
+    counter_.consumed( ( frameIndex + 1 ) * picturesPerFrame_ );
+  }
+  void close() { counter_.close(); }
+  void join() {
+    if ( thread_.joinable() ) { thread_.join(); }
+  }
+  std::string getTrace() { return trace_ + decoder_.getPictureTrace(); }
+
+ private:
+  std::string                   trace_;
+  size_t                        picturesPerFrame_;
+  PCCFrameCounter               counter_;
+  PCCVideoDecoder               decoder_;
+  std::function<void( size_t )> release_;
+  std::thread                   thread_;
+};
+
 PCCDecoder::PCCDecoder() {
 #ifdef ENABLE_PAPI_PROFILING
   initPapiProfiler();
@@ -74,6 +129,7 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
 
   PCCVideoDecoder videoDecoder;
   videoDecoder.setLogger( *logger_ );
+  videoDecoder.setNbThread( params_.nbThread_ );
   std::stringstream path;
   auto&             sps              = context.getVps();
   auto&             ai               = sps.getAttributeInformation( atlasIndex );
@@ -280,6 +336,237 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
   }
 
   reconstructs.setFrameCount( frameCount );
+  auto absoluteT1List = getAbsoluteT1List( context, atlasIndex );
+  context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
+  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+       sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
+    context.getVideoRawPointsAttribute().resize( context.size() );
+  }
+  std::vector<std::vector<uint8_t>> pcFrameChecksums( frameCount );
+  std::vector<std::vector<uint8_t>> recFrameChecksums( frameCount );
+  printf( "generate point cloud of %zu frames \n", frameCount );
+  fflush( stdout );
+  // All video have been decoded, the frames are reconstructed concurrently and traced in order
+#if defined( ENABLE_TBB ) && !defined( CODEC_TRACE )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), frameCount, [&]( const size_t frameIdx ) {
+      reconstructFrame( context, frameIdx, reconstructs[frameIdx], pcFrameChecksums[frameIdx],
+                        recFrameChecksums[frameIdx], absoluteT1List, atlasIndex );
+    } );
+  } );
+#else
+  for ( size_t frameIdx = 0; frameIdx < frameCount; frameIdx++ ) {
+    reconstructFrame( context, frameIdx, reconstructs[frameIdx], pcFrameChecksums[frameIdx],
+                      recFrameChecksums[frameIdx], absoluteT1List, atlasIndex );
+  }
+#endif
+  for ( size_t frameIdx = 0; frameIdx < frameCount; frameIdx++ ) {
+    traceFrame( context, frameIdx, pcFrameChecksums[frameIdx], recFrameChecksums[frameIdx] );
+  }
+  return 0;
+}
+
+int PCCDecoder::decode( PCCContext&                                         context,
+                        const std::function<void( size_t, PCCPointSet3& )>& frameCallback,
+                        int32_t                                             atlasIndex ) {
+  auto&      sps            = context.getVps();
+  auto&      ai             = sps.getAttributeInformation( atlasIndex );
+  auto&      oi             = sps.getOccupancyInformation( atlasIndex );
+  auto&      gi             = sps.getGeometryInformation( atlasIndex );
+  auto&      asps           = context.getAtlasSequenceParameterSet( 0 );
+  const bool auxiliaryVideo = asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+                              sps.getAuxiliaryVideoPresentFlag( atlasIndex );
+  const bool attributeVideo = ai.getAttributeCount() > 0;
+  setConsitantFourCCCode( context, 0 );
+  auto occupancyCodecId = getCodedCodecId( context, oi.getOccupancyCodecId(), params_.videoDecoderOccupancyPath_ );
+  auto geometryCodecId  = getCodedCodecId( context, gi.getGeometryCodecId(), params_.videoDecoderGeometryPath_ );
+  auto auxGeometryCodecId =
+      auxiliaryVideo ? getCodedCodecId( context, gi.getAuxiliaryGeometryCodecId(), params_.videoDecoderGeometryPath_ )
+                     : geometryCodecId;
+  auto attributeCodecId =
+      attributeVideo ? getCodedCodecId( context, ai.getAttributeCodecId( 0 ), params_.videoDecoderAttributePath_ )
+                     : geometryCodecId;
+  auto auxAttributeCodecId = attributeVideo && auxiliaryVideo
+                                 ? getCodedCodecId( context, ai.getAuxiliaryAttributeCodecId( 0 ),
+                                                    params_.videoDecoderAttributePath_ )
+                                 : attributeCodecId;
+  // only the application codecs, that run in their own process, decode several videos at the same time
+  bool concurrent = true;
+  for ( auto codecId :
+        {occupancyCodecId, geometryCodecId, auxGeometryCodecId, attributeCodecId, auxAttributeCodecId} ) {
+    concurrent &= PCCVirtualVideoDecoder<uint8_t>::isProcessCodecId( codecId );
+  }
+  if ( !concurrent || params_.patchColorSubsampling_ || ai.getAttributeCount() > 1 ||
+       ( ai.getAttributeCount() == 1 && ai.getAttributeDimensionPartitionsMinus1( 0 ) > 0 ) ) {
+    // the library codecs share global tables and can not decode the videos concurrently, the per-patch color
+    // up-sampling needs the patches of the whole GOF and the attribute partitions share the same videos: these
+    // configurations are decoded GOF by GOF.
+    PCCGroupOfFrames reconstructs;
+    int              ret = decode( context, reconstructs, atlasIndex );
+    if ( ret != 0 ) { return ret; }
+    for ( size_t frameIdx = 0; frameIdx < reconstructs.getFrameCount(); frameIdx++ ) {
+      frameCallback( frameIdx, reconstructs[frameIdx] );
+    }
+    return 0;
+  }
+#if defined( ENABLE_TBB )
+  if ( params_.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( params_.nbThread_ ) ); }
+#endif
+  createPatchFrameDataStructure( context );
+
+  std::stringstream path;
+  size_t            frameCount       = context.size();
+  const size_t      mapCount         = sps.getMapCountMinus1( atlasIndex ) + 1;
+  const bool        multipleStreams  = sps.getMultipleMapStreamsPresentFlag( atlasIndex );
+  int               geometryBitDepth = gi.getGeometry2dBitdepthMinus1() + 1;
+  const size_t      maxFrames        = ( std::max )( params_.streamingFrameCount_, size_t( 1 ) );
+  path << removeFileExtension( params_.compressedStreamPath_ ) << "_dec_GOF" << sps.getV3CParameterSetId() << "_";
+  printf( "=> Streaming video decoder : occupancy = %d geometry = %d maxFrames = %zu \n", (int)occupancyCodecId,
+          (int)geometryCodecId, maxFrames );
+  fflush( stdout );
+
+  // all the videos must be allocated before the decoding threads start
+  context.getVideoGeometryMultiple().resize( multipleStreams ? mapCount : 1 );
+  if ( ai.getAttributeCount() > 0 ) { context.getVideoAttributesMultiple().resize( multipleStreams ? mapCount : 1 ); }
+  std::vector<std::unique_ptr<PCCStreamingVideo>> streams;
+  streams.emplace_back( new PCCStreamingVideo( "Occupancy\nMapIdx = 0, AuxiliaryVideoFlag = 0\n", 1, maxFrames ) );
+  streams.back()->start<uint8_t>(
+      context.getVideoOccupancyMap(), frameCount,
+      [&]( PCCVideoDecoder& decoder, const std::function<void( PCCImageOccupancyMap&, size_t )>& output ) {
+        decoder.decompress<uint8_t>(
+            [&]( PCCImageOccupancyMap& image, size_t index ) {
+              image.convertBitdepth( 8, oi.getOccupancy2DBitdepthMinus1() + 1, oi.getOccupancyMSBAlignFlag() );
+              output( image, index );
+            },
+            path.str(), context.getVideoBitstream( VIDEO_OCCUPANCY ), params_.byteStreamVideoCoderOccupancy_,
+            occupancyCodecId, params_.videoDecoderOccupancyPath_, 8, params_.keepIntermediateFiles_ );
+      } );
+  for ( uint32_t mapIndex = 0; mapIndex < ( multipleStreams ? mapCount : 1 ); mapIndex++ ) {
+    auto* videoBitstream = &context.getVideoBitstream(
+        multipleStreams ? static_cast<PCCVideoType>( VIDEO_GEOMETRY_D0 + mapIndex ) : VIDEO_GEOMETRY );
+    streams.emplace_back( new PCCStreamingVideo( stringFormat( "Geometry\nMapIdx = %d, AuxiliaryVideoFlag = 0\n",
+                                                               static_cast<int>( mapIndex ) ),
+                                                 multipleStreams ? 1 : mapCount, maxFrames ) );
+    streams.back()->start<uint16_t>(
+        context.getVideoGeometryMultiple( mapIndex ), frameCount,
+        [&, videoBitstream]( PCCVideoDecoder&                                         decoder,
+                             const std::function<void( PCCImageGeometry&, size_t )>& output ) {
+          decoder.decompress<uint16_t>(
+              [&]( PCCImageGeometry& image, size_t index ) {
+                image.convertBitdepth( geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1,
+                                       gi.getGeometryMSBAlignFlag() );
+                output( image, index );
+              },
+              path.str(), *videoBitstream, params_.byteStreamVideoCoderGeometry_, geometryCodecId,
+              params_.videoDecoderGeometryPath_, geometryBitDepth, params_.keepIntermediateFiles_,
+              multipleStreams ? 0 : params_.shvcLayerIndex_ );
+        } );
+  }
+  if ( auxiliaryVideo ) {
+    streams.emplace_back( new PCCStreamingVideo( "MapIdx = 0, AuxiliaryVideoFlag = 1\n", 1, maxFrames ) );
+    streams.back()->start<uint16_t>(
+        context.getVideoRawPointsGeometry(), frameCount,
+        [&, auxGeometryCodecId]( PCCVideoDecoder&                                         decoder,
+                                 const std::function<void( PCCImageGeometry&, size_t )>& output ) {
+          decoder.decompress<uint16_t>(
+              [&]( PCCImageGeometry& image, size_t index ) {
+                image.convertBitdepth( geometryBitDepth, gi.getGeometry2dBitdepthMinus1() + 1,
+                                       gi.getGeometryMSBAlignFlag() );
+                output( image, index );
+              },
+              path.str(), context.getVideoBitstream( VIDEO_GEOMETRY_RAW ), params_.byteStreamVideoCoderGeometry_,
+              auxGeometryCodecId, params_.videoDecoderGeometryPath_, geometryBitDepth, params_.keepIntermediateFiles_,
+              params_.shvcLayerIndex_ );
+        } );
+  }
+  if ( ai.getAttributeCount() > 0 ) {
+    int  attributeBitDepth = ai.getAttribute2dBitdepthMinus1( 0 ) + 1;
+    int  attributeTypeId   = ai.getAttributeTypeId( 0 );
+    auto attributeTrace =
+        "Attribute\nAttrIdx = 0, AttrPartIdx = 0, AttrTypeID = %d, MapIdx = %d, AuxiliaryVideoFlag = %d\n";
+    for ( uint32_t mapIndex = 0; mapIndex < ( multipleStreams ? mapCount : 1 ); mapIndex++ ) {
+      auto* videoBitstream = &context.getVideoBitstream(
+          multipleStreams ? static_cast<PCCVideoType>( VIDEO_ATTRIBUTE_T0 + MAX_NUM_ATTR_PARTITIONS * mapIndex )
+                          : VIDEO_ATTRIBUTE );
+      streams.emplace_back( new PCCStreamingVideo(
+          stringFormat( attributeTrace, attributeTypeId, static_cast<int>( mapIndex ), 0 ),
+          multipleStreams ? 1 : mapCount, maxFrames ) );
+      streams.back()->start<uint16_t>(
+          context.getVideoAttributesMultiple( mapIndex ), frameCount,
+          [&, videoBitstream, attributeCodecId, attributeBitDepth](
+              PCCVideoDecoder& decoder, const std::function<void( PCCImage<uint16_t, 3>&, size_t )>& output ) {
+            decoder.decompress<uint16_t>( output, path.str(), *videoBitstream, params_.byteStreamVideoCoderAttribute_,
+                                          attributeCodecId, params_.videoDecoderAttributePath_, attributeBitDepth,
+                                          params_.keepIntermediateFiles_, params_.shvcLayerIndex_,
+                                          params_.inverseColorSpaceConversionConfig_,
+                                          params_.colorSpaceConversionPath_ );
+          } );
+    }
+    if ( auxiliaryVideo ) {
+      streams.emplace_back(
+          new PCCStreamingVideo( stringFormat( attributeTrace, attributeTypeId, 0, 1 ), 1, maxFrames ) );
+      streams.back()->start<uint16_t>(
+          context.getVideoRawPointsAttribute(), frameCount,
+          [&, auxAttributeCodecId, attributeBitDepth](
+              PCCVideoDecoder& decoder, const std::function<void( PCCImage<uint16_t, 3>&, size_t )>& output ) {
+            decoder.decompress<uint16_t>( output, path.str(), context.getVideoBitstream( VIDEO_ATTRIBUTE_RAW ),
+                                          params_.byteStreamVideoCoderAttribute_, auxAttributeCodecId,
+                                          params_.videoDecoderAttributePath_, attributeBitDepth,
+                                          params_.keepIntermediateFiles_, params_.shvcLayerIndex_,
+                                          params_.inverseColorSpaceConversionConfig_,
+                                          params_.colorSpaceConversionPath_ );
+          } );
+    }
+  }
+
+  // reconstruct each frame as soon as all its pictures have been decoded
+  auto absoluteT1List = getAbsoluteT1List( context, atlasIndex );
+  int  ret            = 0;
+  printf( "generate point cloud of %zu frames \n", frameCount );
+  fflush( stdout );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+#endif
+  for ( size_t frameIdx = 0; frameIdx < frameCount && ret == 0; frameIdx++ ) {
+    for ( auto& stream : streams ) {
+      if ( !stream->waitFrame( frameIdx ) ) {
+        printf( "Error: the video stream stopped before frame %zu \n", frameIdx );
+        ret = -1;
+      }
+    }
+    if ( ret != 0 ) { break; }
+    if ( frameIdx == 0 ) {
+      context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
+    }
+    PCCPointSet3         reconstruct;
+    std::vector<uint8_t> pcFrameChecksum;
+    std::vector<uint8_t> recFrameChecksum;
+#if defined( ENABLE_TBB )
+    limited.execute( [&] {
+      reconstructFrame( context, frameIdx, reconstruct, pcFrameChecksum, recFrameChecksum, absoluteT1List, atlasIndex );
+    } );
+#else
+    reconstructFrame( context, frameIdx, reconstruct, pcFrameChecksum, recFrameChecksum, absoluteT1List, atlasIndex );
+#endif
+    traceFrame( context, frameIdx, pcFrameChecksum, recFrameChecksum );
+    frameCallback( frameIdx, reconstruct );
+    for ( auto& stream : streams ) { stream->releaseFrame( frameIdx ); }
+  }
+  for ( auto& stream : streams ) {
+    stream->close();
+    stream->join();
+  }
+  // the picture traces are written in the order of the non-streaming decoder
+  for ( auto& stream : streams ) {
+    TRACE_PICTURE( "%s", stream->getTrace().c_str() );
+  }
+  return ret;
+}
+
+std::vector<std::vector<bool>> PCCDecoder::getAbsoluteT1List( PCCContext& context, int32_t atlasIndex ) {
+  auto& sps = context.getVps();
+  auto& ai  = sps.getAttributeInformation( atlasIndex );
   // recreating the prediction list per attribute (either the attribute is coded absolute, or follows the geometry)
   // see contribution m52529
   std::vector<std::vector<bool>> absoluteT1List;
@@ -297,193 +584,230 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
       }
     }
   }
-  printf( "generate point cloud of %zu frames \n", frameCount );
-  fflush( stdout );
-  for ( size_t frameIdx = 0; frameIdx < frameCount; frameIdx++ ) {
-    // All video have been decoded, start reconsctruction processes
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
-         sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-      for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
-        int attributeDimensionPartitions = ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-        for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimensionPartitions; attrPartitionIndex++ ) {
-          printf( "generateRawPointsAttributefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
-                  attrPartitionIndex );
-          fflush( stdout );
-          generateRawPointsAttributefromVideo( context, frameIdx );
-        }
-      }
-    }  // getAuxiliaryVideoEnabledFlag()
-
-    context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
-    GeneratePointCloudParameters gpcParams;
-    GeneratePointCloudParameters ppSEIParams;
-
-    auto&                 reconstruct = reconstructs[frameIdx];
-    std::vector<uint32_t> partition;
-    // Decode point cloud
-    printf( "call generatePointCloud() \n" );
-    std::vector<size_t> accTilePointCount;
-    accTilePointCount.resize( ai.getAttributeCount(), 0 );
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto atglIndex = context.getAtlasHighLevelSyntax().getAtlasTileLayerIndex( frameIdx, tileIdx );
-      setGeneratePointCloudParameters( gpcParams, context, atglIndex );
-      setPostProcessingSeiParameters( ppSEIParams, context, atglIndex );
-      // std::cout << "Processing frame " << frameIdx << " tile " << tileIdx << std::endl;
-      auto& tile = context[frameIdx].getTile( tileIdx );
-      if ( !ppSEIParams.pbfEnableFlag_ ) {
-        generateOccupancyMap( tile, context.getVideoOccupancyMap().getFrame( tile.getFrameIndex() ),
-                              context.getOccupancyPrecision(), oi.getLossyOccupancyCompressionThreshold(),
-                              asps.getEomPatchEnabledFlag() );
-      }
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 ) {
-        generateTileBlockToPatchFromOccupancyMapVideo(
-            context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
-            size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
+  return absoluteT1List;
+}
 
-      } else {
-        generateBlockToPatchFromOccupancyMapVideo(
-            context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
-            size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
+void PCCDecoder::reconstructFrame( PCCContext&                           context,
+                                   size_t                                frameIdx,
+                                   PCCPointSet3&                         reconstruct,
+                                   std::vector<uint8_t>&                 pcFrameChecksum,
+                                   std::vector<uint8_t>&                 recFrameChecksum,
+                                   const std::vector<std::vector<bool>>& absoluteT1List,
+                                   int32_t                               atlasIndex ) {
+  auto& sps  = context.getVps();
+  auto& ai   = sps.getAttributeInformation( atlasIndex );
+  auto& oi   = sps.getOccupancyInformation( atlasIndex );
+  auto& asps = context.getAtlasSequenceParameterSet( 0 );
+  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+       sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
+    for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
+      int attributeDimensionPartitions = ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+      for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimensionPartitions; attrPartitionIndex++ ) {
+        printf( "generateRawPointsAttributefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
+                attrPartitionIndex );
+        fflush( stdout );
+        generateRawPointsAttributefromVideo( context, frameIdx );
       }
+    }
+  }  // getAuxiliaryVideoEnabledFlag()
+
+  const size_t                              tileCount = context[frameIdx].getNumTilesInAtlasFrame();
+  std::vector<GeneratePointCloudParameters> gpcParams( tileCount );
+  std::vector<GeneratePointCloudParameters> tilePpSEIParams( tileCount );
+  std::vector<PCCPointSet3>                 tileReconstructs( tileCount );
+  std::vector<std::vector<uint32_t>>        tilePartitions( tileCount );
+  bool                                      pbfEnableFlag = false;
+  for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+    auto atglIndex = context.getAtlasHighLevelSyntax().getAtlasTileLayerIndex( frameIdx, tileIdx );
+    setGeneratePointCloudParameters( gpcParams[tileIdx], context, atglIndex );
+    setPostProcessingSeiParameters( tilePpSEIParams[tileIdx], context, atglIndex );
+    pbfEnableFlag |= tilePpSEIParams[tileIdx].pbfEnableFlag_;
+  }
+  auto generateTile = [&]( const size_t tileIdx ) {
+    // std::cout << "Processing frame " << frameIdx << " tile " << tileIdx << std::endl;
+    auto& tile = context[frameIdx].getTile( tileIdx );
+    if ( !tilePpSEIParams[tileIdx].pbfEnableFlag_ ) {
+      generateOccupancyMap( tile, context.getVideoOccupancyMap().getFrame( tile.getFrameIndex() ),
+                            context.getOccupancyPrecision(), oi.getLossyOccupancyCompressionThreshold(),
+                            asps.getEomPatchEnabledFlag() );
+    }
+    if ( tileCount > 1 ) {
+      generateTileBlockToPatchFromOccupancyMapVideo(
+          context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
+          size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
 
-      printf( "call generatePointCloud() \n" );
-      PCCPointSet3 tileReconstrct;
-      generatePointCloud( tileReconstrct, context, frameIdx, tileIdx, gpcParams, partition, true );
-      reconstruct.appendPointSet( tileReconstrct );
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 )
-        context[frameIdx].getTitleFrameContext().appendPointToPixel(
-            context[frameIdx].getTile( tileIdx ).getPointToPixel() );
-      if ( ai.getAttributeCount() > 0 ) {
-        reconstruct.addColors();
-        reconstruct.addColors16bit();
-        for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
-          printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
-          fflush( stdout );
-          size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
-                                                      sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
-                                                      ai.getAttributeCount(), accTilePointCount[attIdx], gpcParams );
-          accTilePointCount[attIdx] = updatedPointCount;
-        }
+    } else {
+      generateBlockToPatchFromOccupancyMapVideo(
+          context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
+          size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
+    }
+    printf( "call generatePointCloud() \n" );
+    generatePointCloud( tileReconstructs[tileIdx], context, frameIdx, tileIdx, gpcParams[tileIdx],
+                        tilePartitions[tileIdx], true );
+  };
+
+  // Decode point cloud: the tiles are generated concurrently, then appended and colored in tile order. The patch
+  // border filtering updates the frame pictures in place, so the tiles are then generated one after the other.
+  printf( "call generatePointCloud() \n" );
+#if defined( ENABLE_TBB ) && !defined( CODEC_TRACE )
+  if ( tileCount > 1 && !pbfEnableFlag ) {
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] { tbb::parallel_for( size_t( 0 ), tileCount, generateTile ); } );
+  } else {
+    for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) { generateTile( tileIdx ); }
+  }
+#else
+  for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) { generateTile( tileIdx ); }
+#endif
+  GeneratePointCloudParameters ppSEIParams;
+  if ( tileCount > 0 ) { ppSEIParams = tilePpSEIParams.back(); }
+  std::vector<uint32_t> partition;
+  std::vector<size_t>   accTilePointCount;
+  accTilePointCount.resize( ai.getAttributeCount(), 0 );
+  for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+    auto& tile = context[frameIdx].getTile( tileIdx );
+    reconstruct.appendPointSet( tileReconstructs[tileIdx] );
+    tileReconstructs[tileIdx].clear();
+    partition.insert( partition.end(), tilePartitions[tileIdx].begin(), tilePartitions[tileIdx].end() );
+    if ( tileCount > 1 ) { context[frameIdx].getTitleFrameContext().appendPointToPixel( tile.getPointToPixel() ); }
+    if ( ai.getAttributeCount() > 0 ) {
+      reconstruct.addColors();
+      reconstruct.addColors16bit();
+      for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
+        printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
+        fflush( stdout );
+        size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
+                                                    sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
+                                                    ai.getAttributeCount(), accTilePointCount[attIdx],
+                                                    gpcParams[tileIdx] );
+        accTilePointCount[attIdx] = updatedPointCount;
       }
-    }  // tile
+    }
+  }  // tile
 
 #ifdef CONFORMANCE_TRACE
-    size_t numProjPoints = 0, numRawPoints = 0, numEomPoints = 0;
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto& tile = context[frameIdx].getTile( tileIdx );
-      numProjPoints += tile.getTotalNumberOfRegularPoints();
-      numEomPoints += tile.getTotalNumberOfEOMPoints();
-      numRawPoints += tile.getTotalNumberOfRawPoints();
-    }  // tile
-    if ( ai.getAttributeCount() == 0 ) {
-      reconstructs[frameIdx].removeColors();
-      reconstructs[frameIdx].removeColors16bit();
+  if ( ai.getAttributeCount() == 0 ) {
+    reconstruct.removeColors();
+    reconstruct.removeColors16bit();
+  } else {
+    bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
+    if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+      reconstruct.convertYUV16ToRGB8();
     } else {
-      bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
-      if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        reconstructs[frameIdx].convertYUV16ToRGB8();
-      } else {
-        reconstructs[frameIdx].copyRGB16ToRGB8();
-      }
+      reconstruct.copyRGB16ToRGB8();
     }
-    TRACE_PCFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    TRACE_PCFRAME( "PointCloudFrameOrderCntVal = %d, NumProjPoints = %zu, NumRawPoints = %zu, NumEomPoints = %zu,",
-                   frameIdx, numProjPoints, numRawPoints, numEomPoints );
-    auto checksumFrame = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_PCFRAME( " MD5 checksum = " );
-    for ( auto& c : checksumFrame ) { TRACE_PCFRAME( "%02x", c ); }
-    TRACE_PCFRAME( "\n" );
+  }
+  pcFrameChecksum = reconstruct.computeChecksum( true );
 #endif
 
-    // Post-Processing
-    TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n", params_.attrTransferFilterType_,
-                 ppSEIParams.pbfEnableFlag_ );
-    if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
-      PCCPointSet3 tempFrameBuffer = reconstruct;
-      if ( ppSEIParams.gridSmoothing_ ) {
-        smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
-      }
-      if ( ai.getAttributeCount() > 0 ) {
-        bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
-        printf( "isAttributes444 = %d Format = %d \n", isAttributes444,
-                context.getVideoAttributesMultiple( 0 ).getColorFormat() );
-        fflush( stdout );
-
-        if ( !ppSEIParams.pbfEnableFlag_ ) {
-          // These are different attribute transfer functions
-          if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
-            TRACE_PATCH( " transferColors16bitBP \n" );
-            tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
-                                                   params_.attrTransferFilterType_,  // filterType
-                                                   int32_t( 0 ),                     // searchRange
-                                                   isAttributes444,                  // losslessAttribute
-                                                   8,                                // numNeighborsColorTransferFwd
-                                                   1,                                // numNeighborsColorTransferBwd
-                                                   true,                             // useDistWeightedAverageFwd
-                                                   true,                             // useDistWeightedAverageBwd
-                                                   true,        // skipAvgIfIdenticalSourcePointPresentFwd
-                                                   false,       // skipAvgIfIdenticalSourcePointPresentBwd
-                                                   4,           // distOffsetFwd
-                                                   4,           // distOffsetBwd
-                                                   1000,        // maxGeometryDist2Fwd
-                                                   1000,        // maxGeometryDist2Bwd
-                                                   1000 * 256,  // maxColorDist2Fwd
-                                                   1000 * 256   // maxColorDist2Bwd
-            );
-          } else if ( params_.attrTransferFilterType_ == 2 ) {
-            TRACE_PATCH( " transferColorWeight \n" );
-            tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
-          } else if ( params_.attrTransferFilterType_ == 3 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
-          } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
-                                                           params_.attrTransferFilterType_,  //  filterType
-                                                           int32_t( 0 ),                     //  searchRange
-                                                           isAttributes444,                  //  losslessAttribute
-                                                           8,           //  numNeighborsColorTransferFwd
-                                                           1,           //  numNeighborsColorTransferBwd
-                                                           true,        //  useDistWeightedAverageFwd
-                                                           true,        //  useDistWeightedAverageBwd
-                                                           true,        //  skipAvgIfIdenticalSourcePointPresentFwd
-                                                           false,       //  skipAvgIfIdenticalSourcePointPresentBwd
-                                                           4,           //  distOffsetFwd
-                                                           4,           //  distOffsetBwd
-                                                           1000,        //  maxGeometryDist2Fwd
-                                                           1000,        //  maxGeometryDist2Bwd
-                                                           1000 * 256,  //  maxColorDist2Fwd
-                                                           1000 * 256   //  maxColorDist2Bwd
-            );
-          }
-        }
-      }  // if ( ai.getAttributeCount() > 0 )
+  // Post-Processing
+  TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n", params_.attrTransferFilterType_,
+               ppSEIParams.pbfEnableFlag_ );
+  if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
+    PCCPointSet3 tempFrameBuffer = reconstruct;
+    if ( ppSEIParams.gridSmoothing_ ) {
+      smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
     }
     if ( ai.getAttributeCount() > 0 ) {
-      if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
-        TRACE_PATCH( " colorSmoothing \n" );
-        colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
-      }
-      if ( context.getVideoAttributesMultiple( 0 ).getColorFormat() !=
-           PCCCOLORFORMAT::RGB444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
-        reconstruct.convertYUV16ToRGB8();
-      } else {  // lossless: copy 16-bit RGB to 8-bit RGB
-        TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
-        reconstruct.copyRGB16ToRGB8();
+      bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
+      printf( "isAttributes444 = %d Format = %d \n", isAttributes444,
+              context.getVideoAttributesMultiple( 0 ).getColorFormat() );
+      fflush( stdout );
+
+      if ( !ppSEIParams.pbfEnableFlag_ ) {
+        // These are different attribute transfer functions
+        if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
+          TRACE_PATCH( " transferColors16bitBP \n" );
+          tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
+                                                 params_.attrTransferFilterType_,  // filterType
+                                                 int32_t( 0 ),                     // searchRange
+                                                 isAttributes444,                  // losslessAttribute
+                                                 8,                                // numNeighborsColorTransferFwd
+                                                 1,                                // numNeighborsColorTransferBwd
+                                                 true,                             // useDistWeightedAverageFwd
+                                                 true,                             // useDistWeightedAverageBwd
+                                                 true,        // skipAvgIfIdenticalSourcePointPresentFwd
+                                                 false,       // skipAvgIfIdenticalSourcePointPresentBwd
+                                                 4,           // distOffsetFwd
+                                                 4,           // distOffsetBwd
+                                                 1000,        // maxGeometryDist2Fwd
+                                                 1000,        // maxGeometryDist2Bwd
+                                                 1000 * 256,  // maxColorDist2Fwd
+                                                 1000 * 256,  // maxColorDist2Bwd
+                                                 false,       // excludeColorOutlier
+                                                 10.0         // thresholdColorOutlierDist
+          );
+        } else if ( params_.attrTransferFilterType_ == 2 ) {
+          TRACE_PATCH( " transferColorWeight \n" );
+          tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
+        } else if ( params_.attrTransferFilterType_ == 3 ) {
+          TRACE_PATCH( " transferColorsFilter3 \n" );
+          tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
+        } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
+          TRACE_PATCH( " transferColorsFilter3 \n" );
+          tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
+                                                         params_.attrTransferFilterType_,  //  filterType
+                                                         int32_t( 0 ),                     //  searchRange
+                                                         isAttributes444,                  //  losslessAttribute
+                                                         8,           //  numNeighborsColorTransferFwd
+                                                         1,           //  numNeighborsColorTransferBwd
+                                                         true,        //  useDistWeightedAverageFwd
+                                                         true,        //  useDistWeightedAverageBwd
+                                                         true,        //  skipAvgIfIdenticalSourcePointPresentFwd
+                                                         false,       //  skipAvgIfIdenticalSourcePointPresentBwd
+                                                         4,           //  distOffsetFwd
+                                                         4,           //  distOffsetBwd
+                                                         1000,        //  maxGeometryDist2Fwd
+                                                         1000,        //  maxGeometryDist2Bwd
+                                                         1000 * 256,  //  maxColorDist2Fwd
+                                                         1000 * 256   //  maxColorDist2Bwd
+          );
+        }
       }
+    }  // if ( ai.getAttributeCount() > 0 )
+  }
+  if ( ai.getAttributeCount() > 0 ) {
+    if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
+      TRACE_PATCH( " colorSmoothing \n" );
+      colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+    }
+    if ( context.getVideoAttributesMultiple( 0 ).getColorFormat() !=
+         PCCCOLORFORMAT::RGB444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+      TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
+      reconstruct.convertYUV16ToRGB8();
+    } else {  // lossless: copy 16-bit RGB to 8-bit RGB
+      TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
+      reconstruct.copyRGB16ToRGB8();
     }
-    /*auto tmp = reconstruct.computeChecksum();
-    TRACE_PCFRAME( " MD5 checksum = " );
-    for ( auto& c : tmp ) { TRACE_PCFRAME( "%02x", c ); }
-    TRACE_PCFRAME( "\n" );*/
-    TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    auto checksum = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_RECFRAME( " MD5 checksum = " );
-    for ( auto& c : checksum ) { TRACE_RECFRAME( "%02x", c ); }
-    TRACE_RECFRAME( "\n" );
   }
-  return 0;
+#ifdef CONFORMANCE_TRACE
+  recFrameChecksum = reconstruct.computeChecksum( true );
+#endif
+}
+
+void PCCDecoder::traceFrame( PCCContext&                 context,
+                             size_t                      frameIdx,
+                             const std::vector<uint8_t>& pcFrameChecksum,
+                             const std::vector<uint8_t>& recFrameChecksum ) {
+#ifdef CONFORMANCE_TRACE
+  size_t numProjPoints = 0, numRawPoints = 0, numEomPoints = 0;
+  for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
+    auto& tile = context[frameIdx].getTile( tileIdx );
+    numProjPoints += tile.getTotalNumberOfRegularPoints();
+    numEomPoints += tile.getTotalNumberOfEOMPoints();
+    numRawPoints += tile.getTotalNumberOfRawPoints();
+  }  // tile
+  TRACE_PCFRAME( "AtlasFrameIndex = %d\n", frameIdx );
+  TRACE_PCFRAME( "PointCloudFrameOrderCntVal = %d, NumProjPoints = %zu, NumRawPoints = %zu, NumEomPoints = %zu,",
+                 frameIdx, numProjPoints, numRawPoints, numEomPoints );
+  TRACE_PCFRAME( " MD5 checksum = " );
+  for ( auto& c : pcFrameChecksum ) { TRACE_PCFRAME( "%02x", c ); }
+  TRACE_PCFRAME( "\n" );
+  TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
+  TRACE_RECFRAME( " MD5 checksum = " );
+  for ( auto& c : recFrameChecksum ) { TRACE_RECFRAME( "%02x", c ); }
+  TRACE_RECFRAME( "\n" );
+#endif
 }
 
 void PCCDecoder::setPointLocalReconstruction( PCCContext& context ) {
@@ -1180,7 +1504,7 @@ void PCCDecoder::createPatchFrameDataStructure( PCCContext& context, size_t atgl
   tile.setTotalNumberOfEOMPoints( totalNumberOfEomPoints );
 }
 
-bool PCCDecoder::compareHashSEIMD5( std::vector<uint8_t>& encMD5, std::vector<uint8_t>& decMD5 ) {
+bool PCCDecoder::compareHashSEIMD5( const std::vector<uint8_t>& encMD5, const std::vector<uint8_t>& decMD5 ) {
   bool equal = true;
   for ( size_t i = 0; i < 16; i++ ) {
     if ( encMD5[i] != decMD5[i] ) {
@@ -1346,79 +1670,94 @@ void PCCDecoder::createHashSEI( PCCContext& context, int frameIndex, SEIDecodedA
   // for tiles
   if ( !seiHashCancelFlag && sei.getDecodedAtlasTilesHashPresentFlag() ||
        sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
-    size_t numTilesInPatchFrame = context[frameIndex].getNumTilesInAtlasFrame();
+    size_t                     numTilesInPatchFrame = context[frameIndex].getNumTilesInAtlasFrame();
+    std::vector<PCCHashDigest> tileHashes( numTilesInPatchFrame );
+    std::vector<PCCHashDigest> tileB2pHashes( numTilesInPatchFrame );
     printf( "**sei** AtlasTilesHash: frame(%d) (#Tiles %zu)", frameIndex, numTilesInPatchFrame );
+    // the tiles are hashed concurrently and compared in tile order
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), numTilesInPatchFrame, [&]( const size_t tileIdx ) {
+#else
     for ( size_t tileIdx = 0; tileIdx < numTilesInPatchFrame; tileIdx++ ) {
-      auto&       tile     = context[frameIndex].getTile( tileIdx );
-      auto&       atlu     = context.getAtlasTileLayer( tile.getAtlIndex() );
-      auto&       ath      = atlu.getHeader();
-      size_t      tileId   = ath.getId();
-      PCCTileType tileType = ath.getType();
-      auto&       afps     = context.getAtlasFrameParameterSet( ath.getAtlasFrameParameterSetId() );
-      auto&       afti     = afps.getAtlasFrameTileInformationRbsp();
-      if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
-        std::vector<uint8_t> atlasTileData;
-        for ( size_t patchIdx = 0; patchIdx < atlu.getDataUnit().getPatchCount(); patchIdx++ ) {
-          tilePatchCommonByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-          tilePatchApplicationByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
+#endif
+        auto&                atlu   = context.getAtlasTileLayer( context[frameIndex].getTile( tileIdx ).getAtlIndex() );
+        size_t               tileId = atlu.getHeader().getId();
+        std::vector<uint8_t> byteString;
+        if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
+          for ( size_t patchIdx = 0; patchIdx < atlu.getDataUnit().getPatchCount(); patchIdx++ ) {
+            tilePatchCommonByteString( byteString, tileId, patchIdx, tilePatchParams );
+            tilePatchApplicationByteString( byteString, tileId, patchIdx, tilePatchParams );
+          }
+          tileHashes[tileIdx].compute( sei.getHashType(), byteString.data(), byteString.size() );
+        }
+        if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
+          byteString.clear();
+          tileBlockToPatchByteString( byteString, tileId, tileB2PPatchParams );
+          tileB2pHashes[tileIdx].compute( sei.getHashType(), byteString.data(), byteString.size() );
         }
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
+    for ( size_t tileIdx = 0; tileIdx < numTilesInPatchFrame; tileIdx++ ) {
+      auto&  tile   = context[frameIndex].getTile( tileIdx );
+      auto&  atlu   = context.getAtlasTileLayer( tile.getAtlIndex() );
+      auto&  ath    = atlu.getHeader();
+      size_t tileId = ath.getId();
+      if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
+        const auto& hash = tileHashes[tileIdx];
         printf( "**sei** TilesPatchHash: frame(%d), tile(tileIdx %zu, tileId %zu)\n", frameIndex, tileIdx, tileId );
         if ( sei.getHashType() == 0 ) {
-          std::vector<uint8_t> encMD5( 16 ), decMD5( 16 );
-          encMD5 = context.computeMD5( atlasTileData.data(), atlasTileData.size() );
+          std::vector<uint8_t> decMD5( 16 );
           TRACE_SEI( " Derived Tile MD5 = " );
           TRACE_SEI( "Tile( id = %d, idx = %d ) MD5: ", tileId, tileIdx );
           for ( int j = 0; j < 16; j++ ) {
             decMD5[j] = sei.getAtlasTilesMd5( tileId, j );
-            TRACE_SEI( "%02x", encMD5[j] );
+            TRACE_SEI( "%02x", hash.md5_[j] );
           }
-          bool equal = compareHashSEIMD5( encMD5, decMD5 );
+          bool equal = compareHashSEIMD5( hash.md5_, decMD5 );
           TRACE_SEI( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 1 ) {
-          uint16_t crc = context.computeCRC( atlasTileData.data(), atlasTileData.size() );
-          // TRACE_SEI( "\n Derived  (CRC): %d ", crc );
+          // TRACE_SEI( "\n Derived  (CRC): %d ", hash.crc_ );
           TRACE_SEI( "Tile( id = %d, idx = %d ) CRC: ", tileId, tileIdx );
-          bool equal = compareHashSEICrc( crc, sei.getAtlasTilesCrc( tileId ) );
+          bool equal = compareHashSEICrc( hash.crc_, sei.getAtlasTilesCrc( tileId ) );
           TRACE_SEI( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 2 ) {
-          uint32_t checkSum = context.computeCheckSum( atlasTileData.data(), atlasTileData.size() );
-          TRACE_SEI( "\n Derived CheckSum: %d ", checkSum );
+          TRACE_SEI( "\n Derived CheckSum: %d ", hash.checkSum_ );
           TRACE_SEI( "Tile( id = %d, idx = %d ) CheckSum: ", tileId, tileIdx );
-          bool equal = compareHashSEICheckSum( checkSum, sei.getAtlasTilesCheckSum( tileId ) );
+          bool equal = compareHashSEICheckSum( hash.checkSum_, sei.getAtlasTilesCheckSum( tileId ) );
           TRACE_SEI( " (%s) \n", equal ? "OK" : "DIFF" );
         }
-        atlasTileData.clear();
       }
       if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
-        std::vector<uint8_t> tileB2PData;
-        tileBlockToPatchByteString( tileB2PData, tileId, tileB2PPatchParams );
+        const auto& hash = tileB2pHashes[tileIdx];
         printf( "\n**sei** TilesBlockToPatchHash: frame(%d), tile(tileIdx %zu, tileId %zu)", frameIndex, tileIdx,
                 tileId );
         if ( sei.getHashType() == 0 ) {
-          std::vector<uint8_t> encMD5( 16 ), decMD5( 16 );
-          encMD5 = context.computeMD5( tileB2PData.data(), tileB2PData.size() );
+          std::vector<uint8_t> decMD5( 16 );
           TRACE_SEI( " Derived Tile B2P MD5 = " );
           TRACE_SEI( "Tile B2P( id = %d, idx = %d ) MD5: ", tileId, tileIdx );
           for ( int j = 0; j < 16; j++ ) {
             decMD5[j] = sei.getAtlasTilesB2pMd5( tileId, j );
-            TRACE_SEI( "%02x", encMD5[j] );
+            TRACE_SEI( "%02x", hash.md5_[j] );
           }
-          bool equal = compareHashSEIMD5( encMD5, decMD5 );
+          bool equal = compareHashSEIMD5( hash.md5_, decMD5 );
           TRACE_SEI( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 1 ) {
-          uint16_t crc = context.computeCRC( tileB2PData.data(), tileB2PData.size() );
-          TRACE_SEI( "\n Derived Tile B2P CRC: %d ", crc );
+          TRACE_SEI( "\n Derived Tile B2P CRC: %d ", hash.crc_ );
           TRACE_SEI( "Tile B2P( id = %d, idx = %d ) CRC: ", tileId, tileIdx );
-          bool equal = compareHashSEICrc( crc, sei.getAtlasTilesB2pCrc( tileId ) );
+          bool equal = compareHashSEICrc( hash.crc_, sei.getAtlasTilesB2pCrc( tileId ) );
           TRACE_SEI( " (%s) \n", equal ? "OK" : "DIFF" );
         } else if ( sei.getHashType() == 2 ) {
-          uint32_t checkSum = context.computeCheckSum( tileB2PData.data(), tileB2PData.size() );
-          TRACE_SEI( "\n Derived Tile B2P CheckSum: %d ", checkSum );
+          TRACE_SEI( "\n Derived Tile B2P CheckSum: %d ", hash.checkSum_ );
           TRACE_SEI( "Tile( id = %d, idx = %d ) CheckSum: ", tileId, tileIdx );
-          bool equal = compareHashSEICheckSum( checkSum, sei.getAtlasTilesB2pCheckSum( tileId ) );
+          bool equal = compareHashSEICheckSum( hash.checkSum_, sei.getAtlasTilesB2pCheckSum( tileId ) );
           TRACE_SEI( " (%s) \n", equal ? "OK" : "DIFF" );
         }
-        tileB2PData.clear();
       }
       TRACE_SEI( "\n" );
     }  // tileIdx
@@ -50,6 +50,11 @@ PCCDecoderParameters::PCCDecoderParameters() {
   byteStreamVideoCoderAttribute_     = true;
   nbThread_                          = 1;
   keepIntermediateFiles_             = false;
+  streamingDecode_                   = false;
+  streamingFrameCount_               = 2;
+  bitstreamIndexPath_                = {};
+  startGofIndex_                     = 0;
+  gofCount_                          = 0;
   pixelDeinterleavingType_           = -1;
   pointLocalReconstructionType_      = -1;
   reconstructEomType_                = -1;
@@ -73,6 +78,11 @@ void PCCDecoderParameters::print() {
   std::cout << "\t colorTransform                      " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                            " << nbThread_ << std::endl;
   std::cout << "\t keepIntermediateFiles               " << keepIntermediateFiles_ << std::endl;
+  std::cout << "\t streamingDecode                     " << streamingDecode_ << std::endl;
+  std::cout << "\t streamingFrameCount                 " << streamingFrameCount_ << std::endl;
+  std::cout << "\t bitstreamIndexPath                  " << bitstreamIndexPath_ << std::endl;
+  std::cout << "\t startGofIndex                       " << startGofIndex_ << std::endl;
+  std::cout << "\t gofCount                            " << gofCount_ << std::endl;
   std::cout << "\t video encoding" << std::endl;
   std::cout << "\t   colorSpaceConversionPath          " << colorSpaceConversionPath_ << std::endl;
   std::cout << "\t   videoDecoderOccupancyPath         " << videoDecoderOccupancyPath_ << std::endl;
@@ -57,24 +57,10 @@ PCCVideoDecoder::PCCVideoDecoder()  = default;
 PCCVideoDecoder::~PCCVideoDecoder() = default;
 
 template <typename T>
-bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
-                                  PCCContext&        contexts,
-                                  const std::string& path,
-                                  PCCVideoBitstream& bitstream,
-                                  bool               byteStreamVideoCoder,
-                                  PCCCodecId         codecId,
-                                  const std::string& decoderPath,
-                                  size_t             outputBitDepth,
-                                  const bool         keepIntermediateFiles,
-                                  const size_t       shvcLayerIndex,
-                                  const bool         patchColorSubsampling,
-                                  const std::string& inverseColorSpaceConversionConfig,
-                                  const std::string& colorSpaceConversionPath,
-                                  const size_t       upsamplingFilter ) {
-  const std::string type        = bitstream.getExtension();
-  const std::string fileName    = path + type;
-  const std::string binFileName = fileName + ".bin";
-
+std::shared_ptr<PCCVirtualVideoDecoder<T>> PCCVideoDecoder::createDecoder( PCCVideoBitstream& bitstream,
+                                                                           bool               byteStreamVideoCoder,
+                                                                           PCCCodecId         codecId,
+                                                                           const size_t       shvcLayerIndex ) {
   printf( "byteStreamVideoCoder = %d codecId = %d \n", byteStreamVideoCoder, codecId );
   fflush( stdout );
   if ( byteStreamVideoCoder ) {
@@ -107,6 +93,52 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
     shmDecoder->setLayerIndex( shvcLayerIndex );
   }
 #endif
+  return decoder;
+}
+
+template <typename T>
+std::shared_ptr<PCCVirtualColorConverter<T>> PCCVideoDecoder::createColorConverter(
+    const std::string& conversionPath,
+    const std::string& inverseConversionConfig,
+    size_t             outputBitDepth,
+    const size_t       upsamplingFilter,
+    std::string&       configInverseColorSpace ) {
+  std::shared_ptr<PCCVirtualColorConverter<T>> converter;
+  if ( conversionPath.empty() ) {
+    converter               = std::make_shared<PCCInternalColorConverter<T>>( nbThread_ );
+    configInverseColorSpace = stringFormat( "YUV420ToYUV444_%zu_%zu", outputBitDepth, upsamplingFilter );
+  } else {
+#ifdef USE_HDRTOOLS
+    converter = std::make_shared<PCCHDRToolsLibColorConverter<T>>();
+#else
+    converter = std::make_shared<PCCHDRToolsAppColorConverter<T>>();
+#endif
+    configInverseColorSpace = inverseConversionConfig;
+  }
+  return converter;
+}
+
+template <typename T>
+bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
+                                  PCCContext&        contexts,
+                                  const std::string& path,
+                                  PCCVideoBitstream& bitstream,
+                                  bool               byteStreamVideoCoder,
+                                  PCCCodecId         codecId,
+                                  const std::string& decoderPath,
+                                  size_t             outputBitDepth,
+                                  const bool         keepIntermediateFiles,
+                                  const size_t       shvcLayerIndex,
+                                  const bool         patchColorSubsampling,
+                                  const std::string& inverseColorSpaceConversionConfig,
+                                  const std::string& colorSpaceConversionPath,
+                                  const size_t       upsamplingFilter ) {
+  const std::string type        = bitstream.getExtension();
+  const std::string fileName    = path + type;
+  const std::string binFileName = fileName + ".bin";
+
+  // Decode video
+  auto decoder = createDecoder<T>( bitstream, byteStreamVideoCoder, codecId, shvcLayerIndex );
   decoder->decode( bitstream, video, outputBitDepth, decoderPath, fileName );
   size_t width      = video.getWidth();
   size_t height     = video.getHeight();
@@ -128,19 +160,9 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
   }
 
   // Convert dec video
-  std::shared_ptr<PCCVirtualColorConverter<T>> converter;
-  std::string                                  configInverseColorSpace;
-  if ( colorSpaceConversionPath.empty() ) {
-    converter               = std::make_shared<PCCInternalColorConverter<T>>();
-    configInverseColorSpace = stringFormat( "YUV420ToYUV444_%zu_%zu", outputBitDepth, upsamplingFilter );
-  } else {
-#ifdef USE_HDRTOOLS
-    converter = std::make_shared<PCCHDRToolsLibColorConverter<T>>();
-#else
-    converter = std::make_shared<PCCHDRToolsAppColorConverter<T>>();
-#endif
-    configInverseColorSpace = inverseColorSpaceConversionConfig;
-  }
+  std::string configInverseColorSpace;
+  auto        converter = createColorConverter<T>( colorSpaceConversionPath, inverseColorSpaceConversionConfig,
+                                            outputBitDepth, upsamplingFilter, configInverseColorSpace );
   if ( inverseColorSpaceConversionConfig.empty() || is444 ) {
     if ( is444 ) {
       video.setDeprecatedColorFormat( 0 );
@@ -375,6 +397,87 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
   return true;
 }
 
+template <typename T>
+bool PCCVideoDecoder::decompress( const std::function<void( PCCImage<T, 3>&, size_t )>& pictureCallback,
+                                  const std::string&                                     path,
+                                  PCCVideoBitstream&                                     bitstream,
+                                  bool                                                   byteStreamVideoCoder,
+                                  PCCCodecId                                             codecId,
+                                  const std::string&                                     decoderPath,
+                                  size_t                                                 outputBitDepth,
+                                  const bool                                             keepIntermediateFiles,
+                                  const size_t                                           shvcLayerIndex,
+                                  const std::string& inverseColorSpaceConversionConfig,
+                                  const std::string& colorSpaceConversionPath,
+                                  const size_t       upsamplingFilter ) {
+  const std::string type        = bitstream.getExtension();
+  const std::string fileName    = path + type;
+  const std::string binFileName = fileName + ".bin";
+  std::string       configInverseColorSpace;
+  auto              decoder   = createDecoder<T>( bitstream, byteStreamVideoCoder, codecId, shvcLayerIndex );
+  auto              converter = createColorConverter<T>( colorSpaceConversionPath, inverseColorSpaceConversionConfig,
+                                                outputBitDepth, upsamplingFilter, configInverseColorSpace );
+  if ( keepIntermediateFiles ) { bitstream.write( binFileName ); }
+
+  // The pictures are converted one by one as soon as they are output by the decoder, then released.
+  PCCVideo<T, 3> video;
+  std::ofstream  recFile;
+  std::ofstream  rec16File;
+  size_t         pictureCount = 0;
+  pictureTrace_.clear();
+  auto outputPictures = [&]( size_t lastIndex ) {
+    for ( ; pictureCount <= lastIndex && pictureCount < video.getFrameCount(); pictureCount++ ) {
+      auto& image = video[pictureCount];
+#ifdef CONFORMANCE_TRACE
+      pictureTrace_ += stringFormat( " IdxOutOrderCntVal = %d, ", static_cast<int>( pictureCount ) );
+      pictureTrace_ += stringFormat( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
+      pictureTrace_ += stringFormat( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
+      pictureTrace_ += stringFormat( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
+#endif
+      if ( keepIntermediateFiles ) {
+        if ( !recFile.is_open() ) {
+          recFile.open( video.addFormat( fileName + "_rec", outputBitDepth == 8 ? "8" : "10" ), std::ios::binary );
+        }
+        image.write( recFile, outputBitDepth == 8 ? 1 : 2 );
+      }
+      bool is444 = image.getColorFormat() == PCCCOLORFORMAT::RGB444 ||
+                   image.getColorFormat() == PCCCOLORFORMAT::YUV444;
+      if ( inverseColorSpaceConversionConfig.empty() || is444 ) {
+        if ( is444 ) {
+          image.setDeprecatedColorFormat( 0 );
+        } else {
+          image.setDeprecatedColorFormat( 1 );
+          image.convertYUV420ToYUV444();
+        }
+      } else {
+        PCCVideo<T, 3> picture;
+        picture.resize( 1 );
+        picture[0].swap( image );
+        converter->convert( configInverseColorSpace, picture, colorSpaceConversionPath, fileName + "_rec" );
+        picture[0].swap( image );
+        image.setDeprecatedColorFormat( colorSpaceConversionPath.empty() ? 1 : 2 );
+        if ( keepIntermediateFiles ) {
+          if ( !rec16File.is_open() ) {
+            rec16File.open( video.addFormat( fileName + "_rec", "16" ), std::ios::binary );
+          }
+          image.write( rec16File, 2 );
+        }
+      }
+      pictureCallback( image, pictureCount );
+      image.release();
+    }
+  };
+  decoder->setFrameCallback( outputPictures );
+  decoder->decode( bitstream, video, outputBitDepth, decoderPath, fileName );
+  if ( video.getFrameCount() > 0 ) { outputPictures( video.getFrameCount() - 1 ); }
+  pictureTrace_ += stringFormat( "Width =  %d, Height = %d \n", static_cast<int>( video.getWidth() ),
+                                 static_cast<int>( video.getHeight() ) );
+  printf( "Decoded frame = %zu x %zu %zu bits NumFrames = %zu \n", video.getWidth(), video.getHeight(),
+          outputBitDepth, video.getFrameCount() );
+  fflush( stdout );
+  return true;
+}
+
 template bool pcc::PCCVideoDecoder::decompress<uint8_t>( PCCVideo<uint8_t, 3>& video,
                                                          PCCContext&           contexts,
                                                          const std::string&    path,
@@ -404,3 +507,31 @@ template bool pcc::PCCVideoDecoder::decompress<uint16_t>( PCCVideo<uint16_t, 3>&
                                                           const std::string&     inverseColorSpaceConversionConfig,
                                                           const std::string&     colorSpaceConversionPath,
                                                           const size_t           upsamplingFilter );
+
+template bool pcc::PCCVideoDecoder::decompress<uint8_t>(
+    const std::function<void( PCCImage<uint8_t, 3>&, size_t )>& pictureCallback,
+    const std::string&                                           path,
+    PCCVideoBitstream&                                           bitstream,
+    bool                                                         byteStreamVideoCoder,
+    PCCCodecId                                                   codecId,
+    const std::string&                                           decoderPath,
+    size_t                                                       outputBitDepth,
+    const bool                                                   keepIntermediateFiles,
+    const size_t                                                 shvcLayerIndex,
+    const std::string&                                           inverseColorSpaceConversionConfig,
+    const std::string&                                           colorSpaceConversionPath,
+    const size_t                                                 upsamplingFilter );
+
+template bool pcc::PCCVideoDecoder::decompress<uint16_t>(
+    const std::function<void( PCCImage<uint16_t, 3>&, size_t )>& pictureCallback,
+    const std::string&                                            path,
+    PCCVideoBitstream&                                            bitstream,
+    bool                                                          byteStreamVideoCoder,
+    PCCCodecId                                                    codecId,
+    const std::string&                                            decoderPath,
+    size_t                                                        outputBitDepth,
+    const bool                                                    keepIntermediateFiles,
+    const size_t                                                  shvcLayerIndex,
+    const std::string&                                            inverseColorSpaceConversionConfig,
+    const std::string&                                            colorSpaceConversionPath,
+    const size_t                                                  upsamplingFilter );
@@ -37,7 +37,9 @@
 #include "PCCEncoderParameters.h"
 #include "PCCCodec.h"
 #include "PCCKdTree.h"
+#include "PCCBlockOccupancy.h"
 #include <map>
+#include <functional>
 
 namespace pcc {
 
@@ -65,6 +67,7 @@ typedef pcc::PCCImage<uint16_t, 3> PCCImageAttribute;
 struct PCCPatchSegmenter3Parameters;
 class PCCPatch;
 struct PCCBistreamPosition;
+class PCCVideoEncoder;
 
 struct SparseMatrixCoefficient {
   int32_t _index;
@@ -103,6 +106,13 @@ struct PaddingContext {
   std::vector<double>  _x, _p, _r, _q;
 };
 
+// Encoding of a video stream that does not use the reconstruction of the other streams of its group.
+struct PCCVideoEncodingTask {
+  PCCCodecId                              codecId_;
+  std::string                             trace_;  // picture trace lines written before the encoder ones
+  std::function<void( PCCVideoEncoder& )> compress_;
+};
+
 typedef std::map<size_t, PCCPatch> unionPatch;  // unionPatch ------
                                                 // [TrackIndex, UnionPatch];
 typedef std::pair<size_t, size_t> SubContext;   // SubContext ------ [start,
@@ -241,31 +251,6 @@ class PCCEncoder : public PCCCodec {
                                PCCKdTree&        kdtree,
                                PCCFrameContext&  frame );
 
-  // Push-pull background filling
-  template <typename T>
-  int mean4w( T p1, unsigned char w1, T p2, unsigned char w2, T p3, unsigned char w3, T p4, unsigned char w4 );
-  template <typename T>
-  void pushPullMip( const PCCImage<T, 3>&        image,
-                    PCCImage<T, 3>&              mip,
-                    const std::vector<uint32_t>& occupancyMap,
-                    std::vector<uint32_t>&       mipOccupancyMap );
-  template <typename T>
-  void pushPullFill( PCCImage<T, 3>&              image,
-                     const PCCImage<T, 3>&        mip,
-                     const std::vector<uint32_t>& occupancyMap,
-                     int                          numIters );
-  template <typename T>
-  void dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx = -1 );
-  template <typename T>
-  void dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image );
-  template <typename T>
-  void createCoarseLayer( PCCImage<T, 3>&        image,
-                          PCCImage<T, 3>&        mip,
-                          std::vector<uint32_t>& occupancyMap,
-                          std::vector<uint32_t>& mipOccupancyMap );
-  template <typename T>
-  void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes );
-
   //**placing patches**//
   void packFlexible( PCCFrameContext& tile,
                      int              packingStrategy,
@@ -290,14 +275,14 @@ class PCCEncoder : public PCCCodec {
   size_t packRawPointsPatchSimple( PCCFrameContext& tile, size_t patchStartOffsetX = 0, size_t patchStartOffsetY = 0 );
 
   size_t packRawPointsPatch( PCCFrameContext&   frame,
-                             std::vector<bool>& occupancyMap,
+                             PCCBlockOccupancy& occupancyMap,
                              size_t             width,
                              size_t&            height,
                              size_t             occupancySizeU,
                              size_t             occupancySizeV,
                              size_t             maxOccupancyRow );
   void   packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                      std::vector<bool>& occupancyMap,
+                                      PCCBlockOccupancy& occupancyMap,
                                       size_t             width,
                                       size_t&            height,
                                       size_t             occupancySizeU,
@@ -398,7 +383,7 @@ class PCCEncoder : public PCCCodec {
                                                            size_t&            occupancySizeU,
                                                            size_t&            occupancySizeV,
                                                            const size_t       safeguard,
-                                                           std::vector<bool>& occupancyMap,
+                                                           PCCBlockOccupancy& occupancyMap,
                                                            size_t&            heightGPA,
                                                            size_t&            widthGPA,
                                                            size_t&            maxOccupancyRow );
@@ -411,7 +396,7 @@ class PCCEncoder : public PCCCodec {
                                                  size_t&                      occupancySizeU,
                                                  size_t&                      occupancySizeV,
                                                  const size_t                 safeguard,
-                                                 std::vector<bool>&           occupancyMap,
+                                                 PCCBlockOccupancy&           occupancyMap,
                                                  size_t&                      heightGPA,
                                                  size_t&                      widthGPA,
                                                  size_t&                      maxOccupancyRow );
@@ -442,13 +427,18 @@ class PCCEncoder : public PCCCodec {
   static inline uint64_t mortonAddr( const int32_t x, const int32_t y, const int32_t z );
   uint64_t               mortonAddr( const PCCPoint3D& vec, int depth );
   void                   create3DMotionEstimationFiles( PCCContext& context, const std::string& path );
+  void                   compressVideos( std::vector<PCCVideoEncodingTask>& tasks );
   static void            remove3DMotionEstimationFiles( const std::string& path );
   void                   presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params );
   PCCVector3D            calculateWeightNormal( size_t geometryBitDepth3D, const PCCPointSet3& source );
 
   //**print out**//
-  static void printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV );
-  static void printMapTetris( std::vector<bool> img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
+  template <typename T>
+  static void printMap( const T& img, const size_t sizeU, const size_t sizeV );
+  static void printMapTetris( const PCCBlockOccupancy& img,
+                              const size_t             sizeU,
+                              const size_t             sizeV,
+                              std::vector<int>         horizon );
 
   PCCEncoderParameters params_;
 };
@@ -72,6 +72,9 @@ class PCCEncoderParameters {
   std::string       colorSpaceConversionConfig_;
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
+  bool              pipelinedGofs_;
+  size_t            pipelineMaxMemory_;
+  size_t            videoEncoderInstances_;
   size_t            frameCount_;
   size_t            groupOfFramesSize_;
   std::string       uncompressedDataPath_;
@@ -35,6 +35,7 @@
 #define PCCNormalsGenerator_h
 
 #include "PCCCommon.h"
+#include "PCCNeighborGraph.h"
 
 namespace pcc {
 enum PCCNormalsGeneratorOrientation {
@@ -124,6 +125,15 @@ class PCCNormalsGenerator3 {
                       const PCCNormalsGenerator3Parameters& params );
 
  private:
+  void computeNeighbors( const PCCPointSet3& pointCloud,
+                         const PCCKdTree&    kdtree,
+                         const size_t        nearestNeighborCount,
+                         const double        radius,
+                         PCCNeighborGraph&   neighbors );
+  void orientNormalsSpanningTree( const PCCPointSet3&                   pointCloud,
+                                  const PCCKdTree&                      kdtree,
+                                  const PCCNormalsGenerator3Parameters& params );
+
   std::vector<PCCVector3D>             normals_;
   std::vector<PCCVector3D>             eigenvalues_;
   std::vector<PCCVector3D>             barycenters_;
@@ -0,0 +1,66 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PCCPadding_h
+#define PCCPadding_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+template <typename T, size_t N>
+class PCCImage;
+
+// Attribute background filling: the pixels of image whose occupancyMap value is 0 are filled from the occupied
+// pixels. The rows and planes are processed with tbb::parallel_for, in the task arena of the caller. The functions
+// are instantiated for uint8_t and uint16_t images.
+
+// Push-pull filling: pulls a weighted mipmap of the occupied pixels, then pushes it back into the empty pixels,
+// smoothed by a few iterations per level.
+template <typename T>
+void dilateSmoothedPushPull( const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image );
+
+// Harmonic filling: 5-point laplacian inpainting of the empty pixels, relaxed by Gauss-Seidel iterations from the
+// coarsest layer of a dyadic pyramid to the image.
+template <typename T>
+void dilateHarmonicBackgroundFill( const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image );
+
+// Multigrid harmonic filling: the same inpainting, solved on the image by V-cycles of red-black Gauss-Seidel
+// relaxations until the residual converges. The padded values differ from dilateHarmonicBackgroundFill, whose
+// relaxation may stop before convergence.
+template <typename T>
+void dilateMultigridBackgroundFill( const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image );
+
+}  // namespace pcc
+
+#endif /* PCCPadding_h */
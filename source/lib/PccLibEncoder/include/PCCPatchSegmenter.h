@@ -35,6 +35,7 @@
 #define PCCPatchSegmenter_h
 
 #include "PCCCommon.h"
+#include "PCCNeighborGraph.h"
 #include <set>
 
 namespace pcc {
@@ -138,22 +139,22 @@ class PCCPatchSegmenter3 {
                             const PCCVector3D*          orientations,
                             const size_t                orientationCount,
                             std::vector<size_t>&        partition );
-  void computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                             const PCCKdTree&                  kdtree,
-                             std::vector<std::vector<size_t>>& adj,
-                             const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                 const PCCKdTree&                  kdtree,
-                                 std::vector<std::vector<size_t>>& adj,
-                                 std::vector<std::vector<double>>& adjDist,
-                                 const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
-                                     const PCCKdTree&                    kdtree,
-                                     std::vector<std::vector<uint32_t>>& adj,
-                                     const size_t                        maxNNCount,
-                                     const size_t                        radius );
+  void computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                             const PCCKdTree&    kdtree,
+                             PCCNeighborGraph&   adj,
+                             const size_t        maxNNCount,
+                             const bool          useDistances = false );
+
+  void computeAdjacencyInfoDist( const PCCPointSet3& pointCloud,
+                                 const PCCKdTree&    kdtree,
+                                 PCCNeighborGraph&   adj,
+                                 const size_t        maxNNCount );
+
+  void computeAdjacencyInfoInRadius( const PCCPointSet3& pointCloud,
+                                     const PCCKdTree&    kdtree,
+                                     PCCNeighborGraph&   adj,
+                                     const size_t        maxNNCount,
+                                     const size_t        radius );
 
   bool colorSimilarity( PCCColor3B& colorD1candidate, PCCColor3B& colorD0, uint8_t threshold ) {
     bool bSimilarity = ( std::abs( colorD0[0] - colorD1candidate[0] ) < threshold ) &&
@@ -196,6 +197,7 @@ class PCCPatchSegmenter3 {
   void segmentPatches( const PCCPointSet3&                 points,
                        const size_t                        frameIndex,
                        const PCCKdTree&                    kdtree,
+                       PCCNeighborGraph&                   adj,
                        const PCCPatchSegmenter3Parameters& params,
                        std::vector<size_t>&                partition,
                        std::vector<PCCPatch>&              patches,
@@ -211,6 +213,7 @@ class PCCPatchSegmenter3 {
 
   void refineSegmentation( const PCCPointSet3&         pointCloud,
                            const PCCKdTree&            kdtree,
+                           PCCNeighborGraph&           adj,
                            const PCCNormalsGenerator3& normalsGen,
                            const PCCVector3D*          orientations,
                            const size_t                orientationCount,
@@ -285,7 +288,7 @@ class PCCPatchSegmenter3 {
                                           const double                      minGradient,
                                           const size_t                      minNumHighGradientPoints,
                                           std::vector<size_t>&              partition,
-                                          std::vector<std::vector<size_t>>& adj,
+                                          const PCCNeighborGraph&           adj,
                                           std::vector<std::vector<size_t>>& connectedComponents );
   static void determinePatchOrientation( const size_t         additionalProjectionAxis,
                                          const bool           absoluteD1,
@@ -310,7 +313,7 @@ class PCCPatchSegmenter3 {
                                  const double                      minGradient,
                                  const size_t                      minNumHighGradientPoints,
                                  PCCPatch&                         patch,
-                                 std::vector<std::vector<size_t>>& adj,
+                                 const PCCNeighborGraph&           adj,
                                  std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                  std::vector<bool>&                isRemoved );
 
@@ -83,9 +83,18 @@ class PCCVideoEncoder {
                  const bool         patchColorSubsampling             = false );
 
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
+  void setNbThread( size_t nbThread ) { nbThread_ = nbThread; }
+
+  // When the picture trace is deferred, compress() only stores it and it must be written with getPictureTrace():
+  // this keeps the trace in stream order when several videos are encoded concurrently.
+  void               setDeferPictureTrace( bool defer ) { deferPictureTrace_ = defer; }
+  const std::string& getPictureTrace() { return pictureTrace_; }
 
  private:
-  PCCLogger* logger_ = nullptr;
+  PCCLogger*  logger_            = nullptr;
+  size_t      nbThread_          = 1;
+  bool        deferPictureTrace_ = false;
+  std::string pictureTrace_;
 };
 
 };  // namespace pcc
@@ -38,13 +38,18 @@
 #include "PCCPatch.h"
 #include "PCCPatchSegmenter.h"
 #include "PCCVideoEncoder.h"
+#include "PCCVirtualVideoEncoder.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCEncoderParameters.h"
 #include "PCCKdTree.h"
+#include "PCCHash.h"
 #include "PCCChrono.h"
 #include "PCCEncoder.h"
 #include "PCCEncoderConstant.h"
+#include "PCCPadding.h"
+#include <atomic>
+#include <thread>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
@@ -117,6 +122,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 
   PCCVideoEncoder videoEncoder;
   videoEncoder.setLogger( *logger_ );
+  videoEncoder.setNbThread( params_.nbThread_ );
   size_t            atlasIndex = context.getAtlasIndex();
   const size_t      pointCount = sources[0].getPointCount();
   auto&             sps        = context.getVps();
@@ -172,8 +178,6 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   generateGeometryVideo( sources, context );
 
   // ENCODE GEOMETRY IMAGE
-  TRACE_PICTURE( "Geometry\n" );
-  TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
   if ( params_.use3dmc_ || params_.usePccRDO_ ) { create3DMotionEstimationFiles( context, path.str() ); }
   auto&  gi                      = context.getVps().getGeometryInformation( atlasIndex );
   size_t geometryVideoBitDepth   = gi.getGeometry2dBitdepthMinus1() + 1;
@@ -182,34 +186,38 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   size_t nbyteGeoMP              = ( geometryMPVideoBitDepth <= 8 ) ? 1 : 2;
   size_t internalBitDepth        = params_.videoEncoderInternalBitdepth_;
   if ( params_.rawPointsPatch_ ) { internalBitDepth = geometryVideoBitDepth; }
-  auto&       videoBitstreamD0 = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_GEOMETRY_D0 )
-                                                          : context.createVideoBitstream( VIDEO_GEOMETRY );
-  auto&       videoGeometry    = context.getVideoGeometryMultiple()[0];
+  // the bitstreams are created first: the encodings of a group can run concurrently
+  const auto  geometryTypeD0 = params_.multipleStreams_ ? VIDEO_GEOMETRY_D0 : VIDEO_GEOMETRY;
+  auto&       videoGeometry  = context.getVideoGeometryMultiple()[0];
   std::string geometryConfigFile =
       params_.multipleStreams_
           ? params_.geometry0Config_
           : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.geometryConfig_ ) : params_.geometryConfig_ );
-  videoEncoder.compress( videoGeometry,                             // video
-                         path.str(),                                // path
-                         params_.geometryQP_ + params_.deltaQPD0_,  // QP
-                         videoBitstreamD0,                          // bitstream
-                         geometryConfigFile,                        // config file
-                         params_.videoEncoderGeometryPath_,         // encoder path
-                         params_.videoEncoderGeometryCodecId_,      // Codec id
-                         params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
-                         context,                                   // context
-                         nbyteGeo,                                  // nbyte
-                         false,                                     // use444CodecIo
-                         params_.use3dmc_,                          // use3dmv
-                         params_.usePccRDO_,                        // usePccRDO
-                         params_.shvcLayerIndex_,                   // SHVC layer index
-                         params_.shvcRateX_,                        // SHVC rate X
-                         params_.shvcRateY_,                        // SHVC rate Y
-                         internalBitDepth,                          // internalBitDepth
-                         false,                                     // useConversion
-                         params_.keepIntermediateFiles_ );          // keep intermediate
-  size_t sizeGeometryVideo = videoBitstreamD0.size();
-  std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
+  context.createVideoBitstream( geometryTypeD0 );
+  auto compressGeometryD0 = [&]( PCCVideoEncoder& encoder ) {
+    encoder.compress( videoGeometry,                               // video
+                      path.str(),                                  // path
+                      params_.geometryQP_ + params_.deltaQPD0_,    // QP
+                      context.getVideoBitstream( geometryTypeD0 ),  // bitstream
+                      geometryConfigFile,                          // config file
+                      params_.videoEncoderGeometryPath_,           // encoder path
+                      params_.videoEncoderGeometryCodecId_,        // Codec id
+                      params_.byteStreamVideoCoderGeometry_,       // byteStreamVideoCoder
+                      context,                                     // context
+                      nbyteGeo,                                    // nbyte
+                      false,                                       // use444CodecIo
+                      params_.use3dmc_,                            // use3dmv
+                      params_.usePccRDO_,                          // usePccRDO
+                      params_.shvcLayerIndex_,                     // SHVC layer index
+                      params_.shvcRateX_,                          // SHVC rate X
+                      params_.shvcRateY_,                          // SHVC rate Y
+                      internalBitDepth,                            // internalBitDepth
+                      false,                                       // useConversion
+                      params_.keepIntermediateFiles_ );            // keep intermediate
+  };
+  std::vector<PCCVideoEncodingTask> geometryTasks;
+  geometryTasks.push_back(
+      {params_.videoEncoderGeometryCodecId_, "Geometry\nMapIdx = 0, AuxiliaryVideoFlag = 0\n", compressGeometryD0} );
   if ( params_.multipleStreams_ ) {
     if ( params_.lossyRawPointsPatch_ ) {
       std::cout << "Error: lossyRawPointsPatch has not been implemented for "
@@ -219,7 +227,9 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
       std::exit( -1 );
     }
     if ( !params_.absoluteD1_ ) {
-      // Form differential video geometry1
+      // Form differential video geometry1 from the reconstructed geometry0
+      compressVideos( geometryTasks );
+      geometryTasks.clear();
       for ( size_t f = 0; f < frames.size(); ++f ) {
         auto& frame1 = context.getVideoGeometryMultiple()[1].getFrame( f );
         predictGeometryFrame( frames[f].getTitleFrameContext(), videoGeometry.getFrame( f ), frame1 );
@@ -229,63 +239,73 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
     }
 
     // Compress geometry1
-    TRACE_PICTURE( "Geometry\n" );
-    TRACE_PICTURE( "MapIdx = 1, AuxiliaryVideoFlag = 0\n" );
-    auto& videoGeometryD1  = context.getVideoGeometryMultiple()[1];
-    auto& videoBitstreamD1 = context.createVideoBitstream( VIDEO_GEOMETRY_D1 );
-    videoEncoder.compress( videoGeometryD1,                           // video
-                           path.str(),                                // path
-                           params_.geometryQP_ + params_.deltaQPD1_,  // QP
-                           videoBitstreamD1,                          // bitstream
-                           params_.geometry1Config_,                  // config file
-                           params_.videoEncoderGeometryPath_,         // encoder path
-                           params_.videoEncoderGeometryCodecId_,      // Codec id
-                           params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
-                           context,                                   // context
-                           nbyteGeo,                                  // nbyte
-                           false,                                     // use444CodecIo
-                           params_.use3dmc_,                          // use3dmv
-                           params_.usePccRDO_,                        // usePccRDO
-                           params_.shvcLayerIndex_,                   // SHVC layer index
-                           params_.shvcRateX_,                        // SHVC rate X
-                           params_.shvcRateY_,                        // SHVC rate Y
-                           internalBitDepth,                          // internalBitDepth
-                           false,                                     // useConversion
-                           params_.keepIntermediateFiles_ );          // keep intermediate
-    size_t sizeGeometryVideoD1 = videoBitstreamD1.size();
-    std::cout << "sizeGeometryVideoD1: " << sizeGeometryVideoD1 << std::endl;
-    std::cout << "geometryVideo ->" << ( sizeGeometryVideo + sizeGeometryVideoD1 ) << "=" << sizeGeometryVideo << "+"
-              << sizeGeometryVideoD1 << " B ("
-              << ( ( sizeGeometryVideo + sizeGeometryVideoD1 ) * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)"
-              << std::endl;
+    auto& videoGeometryD1 = context.getVideoGeometryMultiple()[1];
+    context.createVideoBitstream( VIDEO_GEOMETRY_D1 );
+    auto compressGeometryD1 = [&]( PCCVideoEncoder& encoder ) {
+      encoder.compress( videoGeometryD1,                                // video
+                        path.str(),                                     // path
+                        params_.geometryQP_ + params_.deltaQPD1_,       // QP
+                        context.getVideoBitstream( VIDEO_GEOMETRY_D1 ),  // bitstream
+                        params_.geometry1Config_,                       // config file
+                        params_.videoEncoderGeometryPath_,              // encoder path
+                        params_.videoEncoderGeometryCodecId_,           // Codec id
+                        params_.byteStreamVideoCoderGeometry_,          // byteStreamVideoCoder
+                        context,                                        // context
+                        nbyteGeo,                                       // nbyte
+                        false,                                          // use444CodecIo
+                        params_.use3dmc_,                               // use3dmv
+                        params_.usePccRDO_,                             // usePccRDO
+                        params_.shvcLayerIndex_,                        // SHVC layer index
+                        params_.shvcRateX_,                             // SHVC rate X
+                        params_.shvcRateY_,                             // SHVC rate Y
+                        internalBitDepth,                               // internalBitDepth
+                        false,                                          // useConversion
+                        params_.keepIntermediateFiles_ );               // keep intermediate
+    };
+    geometryTasks.push_back(
+        {params_.videoEncoderGeometryCodecId_, "Geometry\nMapIdx = 1, AuxiliaryVideoFlag = 0\n", compressGeometryD1} );
   }
   auto& asps = context.getAtlasSequenceParameterSet( atlasIndex );
   if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
     std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
     placeAuxiliaryPointsTiles( context );
-    auto& videoRawPointsGeometryBitstream = context.createVideoBitstream( VIDEO_GEOMETRY_RAW );
+    context.createVideoBitstream( VIDEO_GEOMETRY_RAW );
     generateRawPointsGeometryVideo( context );
     auto& videoRawPointsGeometry = context.getVideoRawPointsGeometry();
-    videoEncoder.compress( videoRawPointsGeometry,                 // video,
-                           path.str(),                             // path,
-                           params_.auxGeometryQP_,                 // qp,
-                           videoRawPointsGeometryBitstream,        // bitstream,
-                           params_.geometryAuxVideoConfig_,        // encoderConfig,
-                           params_.videoEncoderGeometryPath_,      // encoderPath,
-                           params_.videoEncoderGeometryCodecId_,   // codecId,
-                           params_.byteStreamVideoCoderGeometry_,  // byteStreamVideoCoder,
-                           context,                                // context
-                           nbyteGeoMP,                             // nbyte
-                           false,                                  // use444CodecIo
-                           false,                                  // use3dmv
-                           false,                                  // usePccRDO
-                           params_.shvcLayerIndex_,                // SHVC layer index
-                           params_.shvcRateX_,                     // SHVC rate X
-                           params_.shvcRateY_,                     // SHVC rate Y
-                           internalBitDepth,                       // internalBitDepth
-                           false,                                  // useConversion
-                           params_.keepIntermediateFiles_ );       // keepIntermediateFiles
+    auto  compressRawPointsGeometry = [&]( PCCVideoEncoder& encoder ) {
+      encoder.compress( videoRawPointsGeometry,                          // video,
+                        path.str(),                                      // path,
+                        params_.auxGeometryQP_,                          // qp,
+                        context.getVideoBitstream( VIDEO_GEOMETRY_RAW ),  // bitstream,
+                        params_.geometryAuxVideoConfig_,                 // encoderConfig,
+                        params_.videoEncoderGeometryPath_,               // encoderPath,
+                        params_.videoEncoderGeometryCodecId_,            // codecId,
+                        params_.byteStreamVideoCoderGeometry_,           // byteStreamVideoCoder,
+                        context,                                         // context
+                        nbyteGeoMP,                                      // nbyte
+                        false,                                           // use444CodecIo
+                        false,                                           // use3dmv
+                        false,                                           // usePccRDO
+                        params_.shvcLayerIndex_,                         // SHVC layer index
+                        params_.shvcRateX_,                              // SHVC rate X
+                        params_.shvcRateY_,                              // SHVC rate Y
+                        internalBitDepth,                                // internalBitDepth
+                        false,                                           // useConversion
+                        params_.keepIntermediateFiles_ );                // keepIntermediateFiles
+    };
+    geometryTasks.push_back(
+        {params_.videoEncoderGeometryCodecId_, "MapIdx = 0, AuxiliaryVideoFlag = 1\n", compressRawPointsGeometry} );
+  }
+  compressVideos( geometryTasks );
+  size_t sizeGeometryVideo = context.getVideoBitstream( geometryTypeD0 ).size();
+  std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
+  if ( params_.multipleStreams_ ) {
+    size_t sizeGeometryVideoD1 = context.getVideoBitstream( VIDEO_GEOMETRY_D1 ).size();
+    std::cout << "sizeGeometryVideoD1: " << sizeGeometryVideoD1 << std::endl;
+    std::cout << "geometryVideo ->" << ( sizeGeometryVideo + sizeGeometryVideoD1 ) << "=" << sizeGeometryVideo << "+"
+              << sizeGeometryVideoD1 << " B ("
+              << ( ( sizeGeometryVideo + sizeGeometryVideoD1 ) * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)"
+              << std::endl;
   }
   // Tile summary
   printf( "****TileInfo***Summary******************\n" );
@@ -339,7 +359,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
     const size_t mapCount = params_.mapCountMinus1_ + 1;
     // GENERATE ATTRIBUTE
     generateAttributeVideo( sources, reconstructs, context, params_ );
-    if ( params_.attributeBGFill_ < 3 ) {
+    if ( params_.attributeBGFill_ < 3 || params_.attributeBGFill_ == 4 ) {
       // ATTRIBUTE IMAGE PADDING
 #if defined( ENABLE_TBB )
       tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
@@ -364,17 +384,26 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                 for ( int mapIdx = 0; mapIdx < mapCount; mapIdx++ ) {
                   size_t videoFrameIdx  = params_.multipleStreams_ ? f : ( f * mapCount + mapIdx );
                   auto&  videoAttribute = context.getVideoAttributesMultiple()[params_.multipleStreams_ ? mapIdx : 0];
-                  dilateSmoothedPushPull( frames[f].getTitleFrameContext(), videoAttribute.getFrame( videoFrameIdx ) );
+                  dilateSmoothedPushPull( frames[f].getTitleFrameContext().getOccupancyMap(),
+                                          videoAttribute.getFrame( videoFrameIdx ) );
                 }
                 break;
               case 2:
                 for ( int mapIdx = 0; mapIdx < mapCount; mapIdx++ ) {
                   size_t videoFrameIdx  = params_.multipleStreams_ ? f : ( f * mapCount + mapIdx );
                   auto&  videoAttribute = context.getVideoAttributesMultiple()[params_.multipleStreams_ ? mapIdx : 0];
-                  dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(),
+                  dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext().getOccupancyMap(),
                                                 videoAttribute.getFrame( videoFrameIdx ) );
                 }
                 break;
+              case 4:
+                for ( int mapIdx = 0; mapIdx < mapCount; mapIdx++ ) {
+                  size_t videoFrameIdx  = params_.multipleStreams_ ? f : ( f * mapCount + mapIdx );
+                  auto&  videoAttribute = context.getVideoAttributesMultiple()[params_.multipleStreams_ ? mapIdx : 0];
+                  dilateMultigridBackgroundFill( frames[f].getTitleFrameContext().getOccupancyMap(),
+                                                 videoAttribute.getFrame( videoFrameIdx ) );
+                }
+                break;
               default: std::cout << "Warning: no attribute padding applied!" << std::endl;
             }  // switch
             if ( mapCount > 1 && !params_.multipleStreams_ && params_.groupDilation_ ) {
@@ -405,8 +434,9 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
             auto& frame = context.getVideoAttributesMultiple()[0].getFrame( f );
             switch ( params_.attributeBGFill_ ) {
               case 0: dilate( frames[f].getTitleFrameContext(), frame ); break;
-              case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext(), frame ); break;
-              case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(), frame ); break;
+              case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext().getOccupancyMap(), frame ); break;
+              case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext().getOccupancyMap(), frame ); break;
+              case 4: dilateMultigridBackgroundFill( frames[f].getTitleFrameContext().getOccupancyMap(), frame ); break;
               default: std::cout << "Warning: no attribute padding applied!" << std::endl;
             }
           }
@@ -423,131 +453,165 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 #endif
     }
     // ENCODE ATTRIBUTE IMAGE
-    TRACE_PICTURE( "Attribute\n" );
     std::cout << "attribute video " << std::endl;
-    auto&        videoBitstream = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_ATTRIBUTE_T0 )
-                                                           : context.createVideoBitstream( VIDEO_ATTRIBUTE );
-    const size_t nbyteAtt       = 1;
-    int attrPartitionIndex      = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
-    int attrTypeId              = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
-                   attrPartitionIndex, attrTypeId );
+    const auto   attributeTypeT0 = params_.multipleStreams_ ? VIDEO_ATTRIBUTE_T0 : VIDEO_ATTRIBUTE;
+    const size_t nbyteAtt        = 1;
+    int attrPartitionIndex       = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
+    int attrTypeId               = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
     auto encoderConfig0 = params_.multipleStreams_
                               ? ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
                                                                : params_.attribute0Config_ )
                               : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
                                                                : params_.attributeConfig_ );
-    videoEncoder.compress( context.getVideoAttributesMultiple()[0],         // video,
-                           path.str(),                                      // path
-                           params_.attributeQP_ + params_.deltaQPT0_,       // qp
-                           videoBitstream,                                  // bitstream
-                           encoderConfig0,                                  // encoderConfig
-                           params_.videoEncoderAttributePath_,              // encoderPath
-                           params_.videoEncoderAttributeCodecId_,           // codecId
-                           params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
-                           context,                                         // context
-                           nbyteAtt,                                        // nbyte
-                           params_.attributeVideo444_,                      // use444CodecIo
-                           params_.use3dmc_,                                // use3dmv
-                           params_.usePccRDO_,                              // usePccRDO
-                           params_.shvcLayerIndex_,                         // SHVC layer index
-                           params_.shvcRateX_,                              // SHVC rate X
-                           params_.shvcRateY_,                              // SHVC rate Y
-                           params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
-                           !params_.rawPointsPatch_,                        // useConversion
-                           params_.keepIntermediateFiles_,                  // keepIntermediateFiles
-                           params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
-                           params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
-                           params_.colorSpaceConversionPath_ );             // colorSpaceConversionPath
-
-    auto sizeAttributeVideo = videoBitstream.size();
-    std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
-              << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
+    context.createVideoBitstream( attributeTypeT0 );
+    auto compressAttributeT0 = [&]( PCCVideoEncoder& encoder ) {
+      encoder.compress( context.getVideoAttributesMultiple()[0],         // video,
+                        path.str(),                                      // path
+                        params_.attributeQP_ + params_.deltaQPT0_,       // qp
+                        context.getVideoBitstream( attributeTypeT0 ),    // bitstream
+                        encoderConfig0,                                  // encoderConfig
+                        params_.videoEncoderAttributePath_,              // encoderPath
+                        params_.videoEncoderAttributeCodecId_,           // codecId
+                        params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
+                        context,                                         // context
+                        nbyteAtt,                                        // nbyte
+                        params_.attributeVideo444_,                      // use444CodecIo
+                        params_.use3dmc_,                                // use3dmv
+                        params_.usePccRDO_,                              // usePccRDO
+                        params_.shvcLayerIndex_,                         // SHVC layer index
+                        params_.shvcRateX_,                              // SHVC rate X
+                        params_.shvcRateY_,                              // SHVC rate Y
+                        params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
+                        !params_.rawPointsPatch_,                        // useConversion
+                        params_.keepIntermediateFiles_,                  // keepIntermediateFiles
+                        params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
+                        params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
+                        params_.colorSpaceConversionPath_ );             // colorSpaceConversionPath
+    };
+    std::vector<PCCVideoEncodingTask> attributeTasks;
+    attributeTasks.push_back(
+        {params_.videoEncoderAttributeCodecId_,
+         stringFormat( "Attribute\nMapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, "
+                       "AttrTypeID = %d\n",
+                       attrPartitionIndex, attrTypeId ),
+         compressAttributeT0} );
 
     if ( params_.multipleStreams_ ) {
-      // Form differential video attribute1
+      // Form differential video attribute1 from the reconstructed attribute0
       if ( !params_.absoluteT1_ ) {
-        for ( size_t f = 0; f < frames.size(); ++f ) {
-          auto& frame0 = context.getVideoAttributesMultiple()[0].getFrame( f );
-          auto& frame1 = context.getVideoAttributesMultiple()[1].getFrame( f );
-          predictAttributeFrame( frames[f].getTitleFrameContext(), frame0, frame1 );
-          switch ( params_.attributeBGFill_ ) {
-            case 0: dilate( frames[f].getTitleFrameContext(), frame1 ); break;
-            case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext(), frame1 ); break;
-            case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(), frame1 ); break;
-            default: std::cout << "Warning: no attribute padding applied!" << std::endl;
+        compressVideos( attributeTasks );
+        attributeTasks.clear();
+        // the padding kernels of each frame run within nbThread threads
+#if defined( ENABLE_TBB )
+        tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+        limited.execute( [&] {
+#endif
+          for ( size_t f = 0; f < frames.size(); ++f ) {
+            auto& frame0       = context.getVideoAttributesMultiple()[0].getFrame( f );
+            auto& frame1       = context.getVideoAttributesMultiple()[1].getFrame( f );
+            auto& occupancyMap = frames[f].getTitleFrameContext().getOccupancyMap();
+            predictAttributeFrame( frames[f].getTitleFrameContext(), frame0, frame1 );
+            switch ( params_.attributeBGFill_ ) {
+              case 0: dilate( frames[f].getTitleFrameContext(), frame1 ); break;
+              case 1: dilateSmoothedPushPull( occupancyMap, frame1 ); break;
+              case 2: dilateHarmonicBackgroundFill( occupancyMap, frame1 ); break;
+              case 4: dilateMultigridBackgroundFill( occupancyMap, frame1 ); break;
+              default: std::cout << "Warning: no attribute padding applied!" << std::endl;
+            }
           }
-        }
+#if defined( ENABLE_TBB )
+        } );
+#endif
         std::cout << "attribute prediction done " << std::endl;
       }
 
       // compress attribute1
-      TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 1, AuxiliaryVideoFlag = 0\n",
-                     attrPartitionIndex, attrTypeId );
-      auto& videoBitstreamT1 = context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 );
-      auto  encoderConfig1 =
+      context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 );
+      auto encoderConfig1 =
           params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ ) : params_.attribute1Config_;
-      videoEncoder.compress( context.getVideoAttributesMultiple()[1],         // video,
-                             path.str(),                                      // path
-                             params_.attributeQP_ + params_.deltaQPT1_,       // qp
-                             videoBitstreamT1,                                // bitstream
-                             encoderConfig1,                                  // encoderConfig
-                             params_.videoEncoderAttributePath_,              // encoderPath
-                             params_.videoEncoderAttributeCodecId_,           // codecId
-                             params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
-                             context,                                         // context
-                             nbyteAtt,                                        // nbyte
-                             params_.attributeVideo444_,                      // use444CodecIo
-                             params_.use3dmc_,                                // use3dmv
-                             params_.usePccRDO_,                              // usePccRDO
-                             params_.shvcLayerIndex_,                         // SHVC layer index
-                             params_.shvcRateX_,                              // SHVC rate X
-                             params_.shvcRateY_,                              // SHVC rate Y
-                             params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
-                             !params_.rawPointsPatch_,                        // useConversion
-                             params_.keepIntermediateFiles_,                  // keepIntermediateFiles
-                             params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
-                             params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );             // keepIntermediateFiles
-      size_t sizeAttributeVideoT1 = videoBitstreamT1.size();
+      auto compressAttributeT1 = [&]( PCCVideoEncoder& encoder ) {
+        encoder.compress( context.getVideoAttributesMultiple()[1],         // video,
+                          path.str(),                                      // path
+                          params_.attributeQP_ + params_.deltaQPT1_,       // qp
+                          context.getVideoBitstream( VIDEO_ATTRIBUTE_T1 ),  // bitstream
+                          encoderConfig1,                                  // encoderConfig
+                          params_.videoEncoderAttributePath_,              // encoderPath
+                          params_.videoEncoderAttributeCodecId_,           // codecId
+                          params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
+                          context,                                         // context
+                          nbyteAtt,                                        // nbyte
+                          params_.attributeVideo444_,                      // use444CodecIo
+                          params_.use3dmc_,                                // use3dmv
+                          params_.usePccRDO_,                              // usePccRDO
+                          params_.shvcLayerIndex_,                         // SHVC layer index
+                          params_.shvcRateX_,                              // SHVC rate X
+                          params_.shvcRateY_,                              // SHVC rate Y
+                          params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
+                          !params_.rawPointsPatch_,                        // useConversion
+                          params_.keepIntermediateFiles_,                  // keepIntermediateFiles
+                          params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
+                          params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
+                          params_.colorSpaceConversionPath_ );             // keepIntermediateFiles
+      };
+      attributeTasks.push_back(
+          {params_.videoEncoderAttributeCodecId_,
+           stringFormat( "Attribute\nAttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, "
+                         "MapIdx = 1, AuxiliaryVideoFlag = 0\n",
+                         attrPartitionIndex, attrTypeId ),
+           compressAttributeT1} );
+    }
+
+    const bool rawPointsAttributeVideo = asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag();
+    if ( rawPointsAttributeVideo ) {
+      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
+      context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW );
+      generateRawPointsAttributeVideo( context );
+      auto&        videoRawPointsAttribute = context.getVideoRawPointsAttribute();
+      const size_t nByteAttMP              = 1;
+      auto         compressRawPointsAttribute = [&]( PCCVideoEncoder& encoder ) {
+        encoder.compress( videoRawPointsAttribute,                          // video,
+                          path.str(),                                       // path
+                          params_.auxAttributeQP_,                          // qp
+                          context.getVideoBitstream( VIDEO_ATTRIBUTE_RAW ),  // bitstream
+                          params_.attributeAuxVideoConfig_,                 // encoderConfig
+                          params_.videoEncoderAttributePath_,               // encoderPath
+                          params_.videoEncoderAttributeCodecId_,            // codecId
+                          params_.byteStreamVideoCoderAttribute_,           // byteStreamVideoCoder
+                          context,                                          // context
+                          nByteAttMP,                                       // nbyte
+                          params_.attributeVideo444_,                       // use444CodecIo
+                          false,                                            // use3dmv
+                          false,                                            // usePccRDO
+                          params_.shvcLayerIndex_,                          // SHVC layer index
+                          params_.shvcRateX_,                               // SHVC rate X
+                          params_.shvcRateY_,                               // SHVC rate Y
+                          10,                                               // internalBitDepth
+                          !params_.rawPointsPatch_,                         // useConversion
+                          params_.keepIntermediateFiles_,                   // keepIntermediateFiles
+                          params_.colorSpaceConversionConfig_,              // colorSpaceConversionConfig
+                          params_.inverseColorSpaceConversionConfig_,       // inverseColorSpaceConversionConfig
+                          params_.colorSpaceConversionPath_ );              // colorSpaceConversionPath
+      };
+      attributeTasks.push_back(
+          {params_.videoEncoderAttributeCodecId_,
+           stringFormat( "Attribute\nAttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, "
+                         "MapIdx = 0, AuxiliaryVideoFlag = 1\n",
+                         attrPartitionIndex, attrTypeId ),
+           compressRawPointsAttribute} );
+    }
+    compressVideos( attributeTasks );
+
+    auto sizeAttributeVideo = context.getVideoBitstream( attributeTypeT0 ).size();
+    std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
+              << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
+    if ( params_.multipleStreams_ ) {
+      size_t sizeAttributeVideoT1 = context.getVideoBitstream( VIDEO_ATTRIBUTE_T1 ).size();
       std::cout << "attribute video ->" << ( sizeAttributeVideo + sizeAttributeVideoT1 ) << "=" << sizeAttributeVideo
                 << "+" << sizeAttributeVideoT1 << " B ("
                 << ( ( sizeAttributeVideo + sizeAttributeVideoT1 ) * 8.0 ) / ( 2 * frames.size() * pointCount )
                 << " bpp)" << std::endl;
     }
-
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-      TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
-                     attrPartitionIndex, attrTypeId );
-      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
-      auto& videoBitstreamMP = context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW );
-      generateRawPointsAttributeVideo( context );
-      auto&        videoRawPointsAttribute = context.getVideoRawPointsAttribute();
-      const size_t nByteAttMP              = 1;
-      videoEncoder.compress( videoRawPointsAttribute,                     // video,
-                             path.str(),                                  // path
-                             params_.auxAttributeQP_,                     // qp
-                             videoBitstreamMP,                            // bitstream
-                             params_.attributeAuxVideoConfig_,            // encoderConfig
-                             params_.videoEncoderAttributePath_,          // encoderPath
-                             params_.videoEncoderAttributeCodecId_,       // codecId
-                             params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
-                             context,                                     // context
-                             nByteAttMP,                                  // nbyte
-                             params_.attributeVideo444_,                  // use444CodecIo
-                             false,                                       // use3dmv
-                             false,                                       // usePccRDO
-                             params_.shvcLayerIndex_,                     // SHVC layer index
-                             params_.shvcRateX_,                          // SHVC rate X
-                             params_.shvcRateY_,                          // SHVC rate Y
-                             10,                                          // internalBitDepth
-                             !params_.rawPointsPatch_,                    // useConversion
-                             params_.keepIntermediateFiles_,              // keepIntermediateFiles
-                             params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
-                             params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
+    if ( rawPointsAttributeVideo ) {
       printf( "generateRawPointsAttributefromVideo \n" );
       for ( size_t fi = 0; fi < context.size(); fi++ ) { generateRawPointsAttributefromVideo( context, fi ); }
     }
@@ -628,95 +692,103 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 #endif
   std::cout << "Post Processing Point Clouds" << std::endl;
   bool isAttributes444 = static_cast<int>( params_.rawPointsPatch_ ) == 1;
-  for ( size_t frameIdx = 0; frameIdx < sources.getFrameCount(); frameIdx++ ) {
-    GeneratePointCloudParameters ppSEIParams;
-    setPostProcessingSeiParameters( ppSEIParams, context );
-    auto& reconstruct = reconstructs[frameIdx];
-    auto& partition   = partitions[frameIdx];
-    printf(
-        "Post-Processing: attributeTransfer_ = %zu flagGeometrySmoothing_ = %d flagColorSmoothing_ = %d pbfEnableFlag "
-        "= %d \n",
-        params_.attrTransferFilterType_, ppSEIParams.flagGeometrySmoothing_, ppSEIParams.flagColorSmoothing_,
-        params_.pbfEnableFlag_ );
-    TRACE_PATCH(
-        "Post-Processing: attributeTransfer_ = %zu flagGeometrySmoothing_ = %d flagColorSmoothing_ = %d pbfEnableFlag "
-        "= %d \n",
-        params_.attrTransferFilterType_, ppSEIParams.flagGeometrySmoothing_, ppSEIParams.flagColorSmoothing_,
-        params_.pbfEnableFlag_ );
-
-    if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
-      PCCPointSet3 tempFrameBuffer = reconstruct;
-      if ( ppSEIParams.gridSmoothing_ ) {
-        smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
+  // the frames are post-processed one after the other, the attribute transfers running within nbThread threads
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+#endif
+    for ( size_t frameIdx = 0; frameIdx < sources.getFrameCount(); frameIdx++ ) {
+      GeneratePointCloudParameters ppSEIParams;
+      setPostProcessingSeiParameters( ppSEIParams, context );
+      auto& reconstruct = reconstructs[frameIdx];
+      auto& partition   = partitions[frameIdx];
+      printf(
+          "Post-Processing: attributeTransfer_ = %zu flagGeometrySmoothing_ = %d flagColorSmoothing_ = %d "
+          "pbfEnableFlag = %d \n",
+          params_.attrTransferFilterType_, ppSEIParams.flagGeometrySmoothing_, ppSEIParams.flagColorSmoothing_,
+          params_.pbfEnableFlag_ );
+      TRACE_PATCH(
+          "Post-Processing: attributeTransfer_ = %zu flagGeometrySmoothing_ = %d flagColorSmoothing_ = %d "
+          "pbfEnableFlag = %d \n",
+          params_.attrTransferFilterType_, ppSEIParams.flagGeometrySmoothing_, ppSEIParams.flagColorSmoothing_,
+          params_.pbfEnableFlag_ );
+
+      if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
+        PCCPointSet3 tempFrameBuffer = reconstruct;
+        if ( ppSEIParams.gridSmoothing_ ) {
+          smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
+        }
+        if ( ai.getAttributeCount() > 0 ) {
+          if ( !ppSEIParams.pbfEnableFlag_ ) {
+            // These are different attribute transfer functions
+            if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
+              TRACE_PATCH( " transferColors16bitBP \n" );
+              tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
+                                                     params_.attrTransferFilterType_,  // filterType
+                                                     int32_t( 0 ),                     // searchRange
+                                                     isAttributes444,                  // losslessAttribute
+                                                     8,                                // numNeighborsColorTransferFwd
+                                                     1,                                // numNeighborsColorTransferBwd
+                                                     true,                             // useDistWeightedAverageFwd
+                                                     true,                             // useDistWeightedAverageBwd
+                                                     true,          // skipAvgIfIdenticalSourcePointPresentFwd
+                                                     false,         // skipAvgIfIdenticalSourcePointPresentBwd
+                                                     4,             // distOffsetFwd
+                                                     4,             // distOffsetBwd
+                                                     1000,          // maxGeometryDist2Fwd
+                                                     1000,          // maxGeometryDist2Bwd
+                                                     1000 * 256,    // maxColorDist2Fwd
+                                                     1000 * 256 );  // maxColorDist2Bwd
+            } else if ( params_.attrTransferFilterType_ == 2 ) {
+              TRACE_PATCH( " transferColorWeight \n" );
+              tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
+            } else if ( params_.attrTransferFilterType_ == 3 ) {
+              TRACE_PATCH( " transferColorsFilter3 \n" );
+              tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
+            } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
+              TRACE_PATCH( " transferColorsFilter3 \n" );
+              tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
+                                                             params_.attrTransferFilterType_,  //  filterType
+                                                             int32_t( 0 ),                     //  searchRange
+                                                             isAttributes444,                  //  losslessAttribute
+                                                             8,             //  numNeighborsColorTransferFwd
+                                                             1,             //  numNeighborsColorTransferBwd
+                                                             true,          //  useDistWeightedAverageFwd
+                                                             true,          //  useDistWeightedAverageBwd
+                                                             true,          //  skipAvgIfIdenticalSourcePointPresentFwd
+                                                             false,         //  skipAvgIfIdenticalSourcePointPresentBwd
+                                                             4,             //  distOffsetFwd
+                                                             4,             //  distOffsetBwd
+                                                             1000,          //  maxGeometryDist2Fwd
+                                                             1000,          //  maxGeometryDist2Bwd
+                                                             1000 * 256,    //  maxColorDist2Fwd
+                                                             1000 * 256 );  //  maxColorDist2Bwd
+            }
+          }
+        }  // if ( ai.getAttributeCount() > 0 )
       }
       if ( ai.getAttributeCount() > 0 ) {
-        if ( !ppSEIParams.pbfEnableFlag_ ) {
-          // These are different attribute transfer functions
-          if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
-            TRACE_PATCH( " transferColors16bitBP \n" );
-            tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
-                                                   params_.attrTransferFilterType_,  // filterType
-                                                   int32_t( 0 ),                     // searchRange
-                                                   isAttributes444,                  // losslessAttribute
-                                                   8,                                // numNeighborsColorTransferFwd
-                                                   1,                                // numNeighborsColorTransferBwd
-                                                   true,                             // useDistWeightedAverageFwd
-                                                   true,                             // useDistWeightedAverageBwd
-                                                   true,          // skipAvgIfIdenticalSourcePointPresentFwd
-                                                   false,         // skipAvgIfIdenticalSourcePointPresentBwd
-                                                   4,             // distOffsetFwd
-                                                   4,             // distOffsetBwd
-                                                   1000,          // maxGeometryDist2Fwd
-                                                   1000,          // maxGeometryDist2Bwd
-                                                   1000 * 256,    // maxColorDist2Fwd
-                                                   1000 * 256 );  // maxColorDist2Bwd
-          } else if ( params_.attrTransferFilterType_ == 2 ) {
-            TRACE_PATCH( " transferColorWeight \n" );
-            tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
-          } else if ( params_.attrTransferFilterType_ == 3 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
-          } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
-                                                           params_.attrTransferFilterType_,  //  filterType
-                                                           int32_t( 0 ),                     //  searchRange
-                                                           isAttributes444,                  //  losslessAttribute
-                                                           8,             //  numNeighborsColorTransferFwd
-                                                           1,             //  numNeighborsColorTransferBwd
-                                                           true,          //  useDistWeightedAverageFwd
-                                                           true,          //  useDistWeightedAverageBwd
-                                                           true,          //  skipAvgIfIdenticalSourcePointPresentFwd
-                                                           false,         //  skipAvgIfIdenticalSourcePointPresentBwd
-                                                           4,             //  distOffsetFwd
-                                                           4,             //  distOffsetBwd
-                                                           1000,          //  maxGeometryDist2Fwd
-                                                           1000,          //  maxGeometryDist2Bwd
-                                                           1000 * 256,    //  maxColorDist2Fwd
-                                                           1000 * 256 );  //  maxColorDist2Bwd
-          }
+        if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
+          TRACE_PATCH( " colorSmoothing \n" );
+          colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+        }
+        if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+          TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
+          reconstruct.convertYUV16ToRGB8();
+        } else {  // lossless: copy 16-bit RGB to 8-bit RGB
+          TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
+          reconstruct.copyRGB16ToRGB8();
         }
       }  // if ( ai.getAttributeCount() > 0 )
-    }
-    if ( ai.getAttributeCount() > 0 ) {
-      if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
-        TRACE_PATCH( " colorSmoothing \n" );
-        colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
-      }
-      if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
-        reconstruct.convertYUV16ToRGB8();
-      } else {  // lossless: copy 16-bit RGB to 8-bit RGB
-        TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
-        reconstruct.copyRGB16ToRGB8();
-      }
-    }  // if ( ai.getAttributeCount() > 0 )
-    TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    auto checksum = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_RECFRAME( " MD5 checksum = " );
-    for ( auto& c : checksum ) { TRACE_RECFRAME( "%02x", c ); }
-    TRACE_RECFRAME( "\n" );
-  }  // frame
+      TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
+      auto checksum = reconstructs[frameIdx].computeChecksum( true );
+      TRACE_RECFRAME( " MD5 checksum = " );
+      for ( auto& c : checksum ) { TRACE_RECFRAME( "%02x", c ); }
+      TRACE_RECFRAME( "\n" );
+    }  // frame
+#if defined( ENABLE_TBB )
+  } );
+#endif
   if ( !params_.keepIntermediateFiles_ && ( params_.use3dmc_ || params_.usePccRDO_ ) ) {
     remove3DMotionEstimationFiles( path.str() );
   }
@@ -729,7 +801,8 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   return 0;
 }
 
-void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV ) {
+template <typename T>
+void PCCEncoder::printMap( const T& img, const size_t sizeU, const size_t sizeV ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( size_t v = 0; v < sizeV; ++v ) {
@@ -739,10 +812,10 @@ void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size
   std::cout << std::endl;
 }
 
-void PCCEncoder::printMapTetris( std::vector<bool> img,
-                                 const size_t      sizeU,
-                                 const size_t      sizeV,
-                                 std::vector<int>  horizon ) {
+void PCCEncoder::printMapTetris( const PCCBlockOccupancy& img,
+                                 const size_t             sizeU,
+                                 const size_t             sizeV,
+                                 std::vector<int>         horizon ) {
   std::cout << std::endl;
   std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( int v = 0; v < sizeV; ++v ) {
@@ -1194,7 +1267,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
+    PCCBlockOccupancy occupancyMap;
     size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
     size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
@@ -1309,7 +1382,7 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
   int               numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -1485,7 +1558,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
   width                             = occupancySizeU * params_.occupancyResolution_;
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
@@ -1980,7 +2053,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
       }
       numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-      std::vector<bool> occupancyMap;
+      PCCBlockOccupancy occupancyMap;
       occupancyMap.resize( occupancySizeU * occupancySizeV, false );
       int indNextMatchedPatch = 0;
       // patch loop
@@ -2317,7 +2390,7 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
+    PCCBlockOccupancy occupancyMap;
     size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
     size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
@@ -2378,7 +2451,7 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   int               numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
@@ -2472,7 +2545,7 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
   width                             = occupancySizeU * params_.occupancyResolution_;
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<Tile> tilesNotAvailable;  // set of all tiles occupied by prev ROIs of current ROI
   int               lastOccupiedTileIndex          = -1;
@@ -2599,7 +2672,7 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame,
   width                             = occupancySizeU * params_.occupancyResolution_;
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<Tile> tilesNotAvailable;
@@ -2840,7 +2913,7 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
   width                             = occupancySizeU * params_.occupancyResolution_;
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<Tile> tilesNotAvailable;
   int               numROIs                        = params_.numROIs_;
@@ -3015,7 +3088,7 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
   int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   // loop over ROIs
   bool isCurrent_ROI_empty = true;
@@ -3277,7 +3350,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
   width                             = occupancySizeU * params_.occupancyResolution_;
   height                            = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
@@ -3397,7 +3470,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
 }
 
 void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                              std::vector<bool>& occupancyMap,
+                                              PCCBlockOccupancy& occupancyMap,
                                               size_t             width,
                                               size_t&            height,
                                               size_t             occupancySizeU,
@@ -3473,7 +3546,7 @@ size_t PCCEncoder::packRawPointsPatchSimple( PCCFrameContext& tile,
 }
 
 size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
-                                       std::vector<bool>& occupancyMap,
+                                       PCCBlockOccupancy& occupancyMap,
                                        size_t             width,
                                        size_t&            height,
                                        size_t             occupancySizeU,
@@ -3879,51 +3952,73 @@ void PCCEncoder::remove3DMotionEstimationFiles( const std::string& path ) {
 }
 
 void PCCEncoder::create3DMotionEstimationFiles( PCCContext& context, const std::string& path ) {
-  FILE* occupancyFile    = fopen( ( path + "occupancy.txt" ).c_str(), "wb" );
-  FILE* patchInfoFile    = fopen( ( path + "patchInfo.txt" ).c_str(), "wb" );
-  FILE* blockToPatchFile = fopen( ( path + "blockToPatch.txt" ).c_str(), "wb" );
+  auto& motionEstimationData = context.getMotionEstimationData();
+  motionEstimationData.resize( context.size() );
   for ( size_t frIdx = 0; frIdx < context.size(); ++frIdx ) {
-    auto&        frame              = context.getFrame( frIdx ).getTitleFrameContext();
-    auto&        occupancyMapImage  = context.getVideoOccupancyMap().getFrame( frIdx );
-    auto&        patches            = frame.getPatches();
-    auto&        blockToPatch       = frame.getBlockToPatch();
-    const size_t blockToPatchWidth  = frame.getWidth() / params_.occupancyResolution_;
-    const size_t blockToPatchHeight = frame.getHeight() / params_.occupancyResolution_;
-    fwrite( &blockToPatch[0], sizeof( size_t ), blockToPatchHeight * blockToPatchWidth, blockToPatchFile );
-    uint32_t zeroVal = 0, oneVal = 1;
-    for ( int y = 0; y < frame.getHeight(); y++ ) {
-      for ( int x = 0; x < frame.getWidth(); x++ ) {
-        if ( occupancyMapImage.getValue( 0, x / params_.occupancyPrecision_, y / params_.occupancyPrecision_ ) > 0 ) {
-          fwrite( &oneVal, sizeof( uint32_t ), 1, occupancyFile );
-        } else {
-          fwrite( &zeroVal, sizeof( uint32_t ), 1, occupancyFile );
-        }
-      }
-    }
-    const size_t numPatches = patches.size();
-    fwrite( &numPatches, sizeof( size_t ), 1, patchInfoFile );
-    for ( const auto& patch : patches ) {
-      size_t projectionIndex = patch.getNormalAxis();
-      size_t u0              = patch.getU0();
-      size_t v0              = patch.getV0();
-      size_t sizeU0          = patch.getSizeU0();
-      size_t sizeV0          = patch.getSizeV0();
-      size_t d1              = patch.getD1();
-      size_t u1              = patch.getU1();
-      size_t v1              = patch.getV1();
-      fwrite( &projectionIndex, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &u0, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &v0, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &sizeU0, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &sizeV0, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &d1, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &u1, sizeof( size_t ), 1, patchInfoFile );
-      fwrite( &v1, sizeof( size_t ), 1, patchInfoFile );
-    }
-  }
-  fclose( blockToPatchFile );
-  fclose( occupancyFile );
-  fclose( patchInfoFile );
+    auto& frame             = context.getFrame( frIdx ).getTitleFrameContext();
+    auto& occupancyMapImage = context.getVideoOccupancyMap().getFrame( frIdx );
+    auto& data              = motionEstimationData[frIdx];
+    data.init( frame.getWidth(), frame.getHeight(), params_.occupancyResolution_, params_.occupancyPrecision_ );
+    const size_t occupancyWidth  = ( std::min )( data.getOccupancyWidth(), occupancyMapImage.getWidth() );
+    const size_t occupancyHeight = ( std::min )( data.getOccupancyHeight(), occupancyMapImage.getHeight() );
+    for ( size_t v = 0; v < occupancyHeight; v++ ) {
+      for ( size_t u = 0; u < occupancyWidth; u++ ) {
+        data.setOccupancy( u, v, occupancyMapImage.getValue( 0, u, v ) > 0 );
+      }
+    }
+    auto& blockToPatch = frame.getBlockToPatch();
+    std::copy( blockToPatch.begin(), blockToPatch.begin() + data.getBlockToPatch().size(),
+               data.getBlockToPatch().begin() );
+    for ( const auto& patch : frame.getPatches() ) {
+      PCCMotionEstimationPatch info;
+      info.projectionIndex_ = static_cast<int32_t>( patch.getNormalAxis() );
+      info.u0_              = static_cast<int32_t>( patch.getU0() );
+      info.v0_              = static_cast<int32_t>( patch.getV0() );
+      info.sizeU0_          = static_cast<int32_t>( patch.getSizeU0() );
+      info.sizeV0_          = static_cast<int32_t>( patch.getSizeV0() );
+      info.d1_              = static_cast<int32_t>( patch.getD1() );
+      info.u1_              = static_cast<int32_t>( patch.getU1() );
+      info.v1_              = static_cast<int32_t>( patch.getV1() );
+      data.getPatches().push_back( info );
+    }
+  }
+  motionEstimationData.write( path + "occupancy.txt", path + "blockToPatch.txt", path + "patchInfo.txt" );
+}
+
+void PCCEncoder::compressVideos( std::vector<PCCVideoEncodingTask>& tasks ) {
+  // only the application codecs, that run in their own process, encode several videos at the same time
+  bool concurrent = params_.videoEncoderInstances_ > 1 && tasks.size() > 1;
+  for ( auto& task : tasks ) { concurrent &= PCCVirtualVideoEncoder<uint8_t>::isProcessCodecId( task.codecId_ ); }
+#ifdef USE_HDRTOOLS
+  concurrent &= params_.colorSpaceConversionPath_.empty();
+#endif
+  std::vector<PCCVideoEncoder> encoders( tasks.size() );
+  for ( auto& encoder : encoders ) {
+    encoder.setLogger( *logger_ );
+    encoder.setNbThread( params_.nbThread_ );
+    encoder.setDeferPictureTrace( concurrent );
+  }
+  if ( !concurrent ) {
+    for ( size_t i = 0; i < tasks.size(); i++ ) {
+      TRACE_PICTURE( "%s", tasks[i].trace_.c_str() );
+      tasks[i].compress_( encoders[i] );
+    }
+    return;
+  }
+  std::atomic<size_t>      nextTask( 0 );
+  std::vector<std::thread> threads;
+  for ( size_t i = 0; i < ( std::min )( params_.videoEncoderInstances_, tasks.size() ); i++ ) {
+    threads.emplace_back( [&] {
+      for ( size_t index = nextTask++; index < tasks.size(); index = nextTask++ ) {
+        tasks[index].compress_( encoders[index] );
+      }
+    } );
+  }
+  for ( auto& thread : threads ) { thread.join(); }
+  for ( size_t i = 0; i < tasks.size(); i++ ) {
+    TRACE_PICTURE( "%s", tasks[i].trace_.c_str() );
+    TRACE_PICTURE( "%s", encoders[i].getPictureTrace().c_str() );
+  }
 }
 
 void PCCEncoder::generateIntraImage( PCCAtlasFrameContext& atlasFrame,
@@ -4224,7 +4319,7 @@ void PCCEncoder::generateRawPointsPatch( const PCCPointSet3& source,
       }
     }
   }
-  PCCKdTree           kdtreeRawPoints( pointsToBeProjected );
+  PCCKdTree           kdtreeRawPoints( pointsToBeProjected, true );
   PCCNNResult         result;
   std::vector<size_t> rawPoints;
   rawPoints.resize( 0 );
@@ -4429,7 +4524,7 @@ void PCCEncoder::placeAuxiliaryPointsTiles( PCCContext& context ) {
     for ( size_t tileIdx = 0; tileIdx < numTilesInSeg; tileIdx++ ) {
       for ( size_t frameIdx = firstFrame; frameIdx < lastFrame; frameIdx++ ) {
         auto&             tile = context[frameIdx].getTile( tileIdx );
-        std::vector<bool> auxPointsOccupancyMap;
+        PCCBlockOccupancy auxPointsOccupancyMap;
         size_t            auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
         size_t            auxPointsOccupancySizeV = 1;
         size_t            auxPointsTileHeight     = 0;
@@ -4987,7 +5082,7 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
         tile.getEomPatches().push_back( eomPatch );
         // relocate eomPatches in the tile
         if ( !tile.getUseRawPointsSeparateVideo() ) {
-          std::vector<bool> occupancyMap;
+          PCCBlockOccupancy occupancyMap;
           size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
           size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
           occupancyMap.resize( occupancySizeU * occupancySizeV );
@@ -5009,7 +5104,7 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
       tile.getPatches().clear();
       tile.setWidth( frame.getWidth() );
       tile.setHeight( params_.tilePartitionHeight_ * 64 );
-      std::vector<bool> occupancyMap;
+      PCCBlockOccupancy occupancyMap;
       size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
       size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
       occupancyMap.resize( occupancySizeU * occupancySizeV );
@@ -5426,39 +5521,112 @@ void PCCEncoder::pointLocalReconstructionSearch( PCCContext&
   size_t       nbOfOptimizationMode = context.getPointLocalReconstructionModeNumber();
   const size_t imageWidth           = videoMultiple[0].getWidth();
   const size_t imageHeight          = videoMultiple[0].getHeight();
+
+  // The small patches are searched as a whole and the others block by block: the searches are listed with their patch
+  // index and their block index in the patch, or the block count of the patch for the whole patches.
+  std::vector<std::pair<size_t, size_t>> searches;
   for ( size_t patchIndex = 0; patchIndex < patchCount; ++patchIndex ) {
-    const size_t  patchIndexPlusOne = patchIndex + 1;
-    auto&         patch             = patches[patchIndex];
-    const size_t& patchSize         = patch.getSizeU0() * patch.getSizeV0();
+    auto&        patch     = patches[patchIndex];
+    const size_t patchSize = patch.getSizeU0() * patch.getSizeV0();
     if ( patchSize == 1 || patchSize <= params_.patchSize_ ) {
-      patch.getPointLocalReconstructionLevel()     = 1;
-      auto&                     srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
-      std::vector<PCCPointSet3> reconstruct;
-      std::vector<float>        distance;
-      reconstruct.resize( nbOfOptimizationMode );
-      distance.resize( nbOfOptimizationMode );
-      size_t optimizationIndex    = 0;
-      size_t optimizationIndexMin = 0;
-      for ( size_t i = 0; i < nbOfOptimizationMode; i++ ) {
-        auto& mode = context.getPointLocalReconstructionMode( i );
-        for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
-          for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+      patch.getPointLocalReconstructionLevel() = 1;
+      searches.emplace_back( patchIndex, patchSize );
+    } else {
+      patch.getPointLocalReconstructionLevel() = 0;
+      for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
+        for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
+          patch.setPointLocalReconstructionMode( u0, v0, 0 );
+          const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
+          if ( blockToPatch[blockIndex] == patchIndex + 1 ) {
+            searches.emplace_back( patchIndex, v0 * patch.getSizeU0() + u0 );
+          }
+        }
+      }
+    }
+  }
+
+  // source points of the blocks of the patches searched block by block, in the order of the source patch
+  std::vector<std::vector<PCCPointSet3>> blockSrcPointClouds( patchCount );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), patchCount, [&]( const size_t patchIndex ) {
+#else
+  for ( size_t patchIndex = 0; patchIndex < patchCount; ++patchIndex ) {
+#endif
+      auto& patch = patches[patchIndex];
+      if ( patch.getPointLocalReconstructionLevel() == 0 ) {
+        auto&        srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
+        auto&        blockSrcPointCloud = blockSrcPointClouds[patchIndex];
+        const size_t resolution         = patch.getOccupancyResolution();
+        blockSrcPointCloud.resize( patch.getSizeU0() * patch.getSizeV0() );
+        for ( size_t i = 0; i < srcPointCloudPatch.getPointCount(); i++ ) {
+          const size_t x = srcPointCloudPatch[i][patch.getTangentAxis()];
+          const size_t y = srcPointCloudPatch[i][patch.getBitangentAxis()];
+          if ( x < patch.getU1() || y < patch.getV1() ) { continue; }
+          const size_t u0 = ( x - patch.getU1() ) / resolution;
+          const size_t v0 = ( y - patch.getV1() ) / resolution;
+          if ( u0 < patch.getSizeU0() && v0 < patch.getSizeV0() ) {
+            blockSrcPointCloud[v0 * patch.getSizeU0() + u0].addPoint( srcPointCloudPatch[i] );
+          }
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+
+  // the modes are scored against one source kd-tree per search, the candidate points being generated in one buffer
+#if defined( ENABLE_TBB )
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), searches.size(), [&]( const size_t searchIndex ) {
+#else
+  for ( size_t searchIndex = 0; searchIndex < searches.size(); ++searchIndex ) {
+#endif
+      const size_t        patchIndex        = searches[searchIndex].first;
+      const size_t        patchIndexPlusOne = patchIndex + 1;
+      auto&               patch             = patches[patchIndex];
+      const bool          byPatch           = patch.getPointLocalReconstructionLevel() == 1;
+      const size_t        patchBlockIndex   = searches[searchIndex].second;
+      const size_t        u0Start           = byPatch ? 0 : patchBlockIndex % patch.getSizeU0();
+      const size_t        v0Start           = byPatch ? 0 : patchBlockIndex / patch.getSizeU0();
+      const size_t        u0End             = byPatch ? patch.getSizeU0() : u0Start + 1;
+      const size_t        v0End             = byPatch ? patch.getSizeV0() : v0Start + 1;
+      const PCCPointSet3& srcPointCloud     = byPatch ? frame.getSrcPointCloudByPatch( patch.getOriginalIndex() )
+                                                      : blockSrcPointClouds[patchIndex][patchBlockIndex];
+      PCCKdTree               srcKdtree( srcPointCloud );
+      PCCKdTree               reconstructKdtree;
+      PCCPointSet3            reconstruct;
+      std::vector<PCCPoint3D> createdPoints;
+      float                   distanceMin          = 0.F;
+      size_t                  optimizationIndexMin = 0;
+      for ( size_t optimizationIndex = 0; optimizationIndex < nbOfOptimizationMode; optimizationIndex++ ) {
+        auto& mode = context.getPointLocalReconstructionMode( optimizationIndex );
+        reconstruct.resize( 0 );
+        for ( size_t v0 = v0Start; v0 < v0End; ++v0 ) {
+          for ( size_t u0 = u0Start; u0 < u0End; ++u0 ) {
             const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
-            if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
-              for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
-                const size_t v = v0 * patch.getOccupancyResolution() + v1;
-                for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
-                  const size_t u = u0 * patch.getOccupancyResolution() + u1;
-                  size_t       x;
-                  size_t       y;
-                  const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
-                  if ( !occupancy ) { continue; }
-                  auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
-                                                       mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
-                  if ( !createdPoints.empty() ) {
-                    for ( const auto& createdPoint : createdPoints ) {
-                      reconstruct[optimizationIndex].addPoint( createdPoint );
-                    }
+            if ( blockToPatch[blockIndex] != patchIndexPlusOne ) { continue; }
+            for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
+              const size_t v = v0 * patch.getOccupancyResolution() + v1;
+              for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
+                const size_t u = u0 * patch.getOccupancyResolution() + u1;
+                size_t       x;
+                size_t       y;
+                const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
+                if ( !occupancy ) { continue; }
+                generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y, createdPoints,
+                                mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
+                for ( const auto& createdPoint : createdPoints ) {
+                  if ( byPatch || patch.getAxisOfAdditionalPlane() == 0 ) {
+                    reconstruct.addPoint( createdPoint );
+                  } else {
+                    PCCVector3D tmp;
+                    inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(), params.geometryBitDepth3D_,
+                                                         createdPoint, tmp );
+                    reconstruct.addPoint( tmp );
                   }
                 }
               }
@@ -5467,80 +5635,32 @@ void PCCEncoder::pointLocalReconstructionSearch( PCCContext&
         }
         float distancePSrcRec;
         float distancePRecSrc;
-        srcPointCloudPatch.distanceGeo( reconstruct[optimizationIndex], distancePSrcRec, distancePRecSrc );
-        distance[optimizationIndex] = (std::max)( distancePSrcRec, distancePRecSrc );
-        if ( optimizationIndex == 0 || distance[optimizationIndexMin] > distance[optimizationIndex] ) {
+        if ( srcPointCloud.getPointCount() == 0 || reconstruct.getPointCount() == 0 ) {
+          srcPointCloud.distanceGeo( reconstruct, distancePSrcRec, distancePRecSrc );
+        } else {
+          reconstructKdtree.init( reconstruct );
+          srcPointCloud.distance( reconstructKdtree, distancePSrcRec );
+          reconstruct.distance( srcKdtree, distancePRecSrc );
+        }
+        const float distance = ( std::max )( distancePSrcRec, distancePRecSrc );
+        if ( optimizationIndex == 0 || distanceMin > distance ) {
+          distanceMin          = distance;
           optimizationIndexMin = optimizationIndex;
-          patch.setPointLocalReconstructionMode( optimizationIndexMin );
         }
-        optimizationIndex++;
       }
-    } else {
-      patch.getPointLocalReconstructionLevel() = 0;
-      for ( size_t v0 = 0; v0 < patch.getSizeV0(); ++v0 ) {
-        for ( size_t u0 = 0; u0 < patch.getSizeU0(); ++u0 ) {
-          patch.setPointLocalReconstructionMode( u0, v0, 0 );
-          const size_t blockIndex = patch.patchBlock2CanvasBlock( u0, v0, blockToPatchWidth, blockToPatchHeight );
-          if ( blockToPatch[blockIndex] == patchIndexPlusOne ) {
-            auto&        srcPointCloudPatch = frame.getSrcPointCloudByPatch( patch.getOriginalIndex() );
-            PCCPointSet3 blockSrcPointCloud;
-            const size_t xMin = u0 * patch.getOccupancyResolution() + patch.getU1();
-            const size_t yMin = v0 * patch.getOccupancyResolution() + patch.getV1();
-            for ( size_t i = 0; i < srcPointCloudPatch.getPointCount(); i++ ) {
-              if ( xMin <= srcPointCloudPatch[i][patch.getTangentAxis()] &&
-                   srcPointCloudPatch[i][patch.getTangentAxis()] < xMin + patch.getOccupancyResolution() &&
-                   yMin <= srcPointCloudPatch[i][patch.getBitangentAxis()] &&
-                   srcPointCloudPatch[i][patch.getBitangentAxis()] < yMin + patch.getOccupancyResolution() ) {
-                blockSrcPointCloud.addPoint( srcPointCloudPatch[i] );
-              }
-            }
-            std::vector<PCCPointSet3> reconstruct;
-            std::vector<float>        distance;
-            reconstruct.resize( nbOfOptimizationMode );
-            distance.resize( nbOfOptimizationMode );
-            size_t optimizationIndex    = 0;
-            size_t optimizationIndexMin = 0;
-            for ( size_t i = 0; i < nbOfOptimizationMode; i++ ) {
-              auto& mode = context.getPointLocalReconstructionMode( i );
-              for ( size_t v1 = 0; v1 < patch.getOccupancyResolution(); ++v1 ) {
-                const size_t v = v0 * patch.getOccupancyResolution() + v1;
-                for ( size_t u1 = 0; u1 < patch.getOccupancyResolution(); ++u1 ) {
-                  const size_t u = u0 * patch.getOccupancyResolution() + u1;
-                  size_t       x;
-                  size_t       y;
-                  const bool   occupancy = occupancyMap[patch.patch2Canvas( u, v, imageWidth, imageHeight, x, y )] != 0;
-                  if ( !occupancy ) { continue; }
-                  auto createdPoints = generatePoints( params, frame, videoMultiple, frameIndex, patchIndex, u, v, x, y,
-                                                       mode.interpolate_, mode.filling_, mode.minD1_, mode.neighbor_ );
-                  if ( !createdPoints.empty() ) {
-                    for ( const auto& createdPoint : createdPoints ) {
-                      if ( patch.getAxisOfAdditionalPlane() == 0 ) {
-                        reconstruct[optimizationIndex].addPoint( createdPoint );
-                      } else {
-                        PCCVector3D tmp;
-                        inverseRotatePosition45DegreeOnAxis( patch.getAxisOfAdditionalPlane(),
-                                                             params.geometryBitDepth3D_, createdPoint, tmp );
-                        reconstruct[optimizationIndex].addPoint( tmp );
-                      }
-                    }
-                  }
-                }
-              }
-              float distancePSrcRec;
-              float distancePRecSrc;
-              blockSrcPointCloud.distanceGeo( reconstruct[optimizationIndex], distancePSrcRec, distancePRecSrc );
-              distance[optimizationIndex] = (std::max)( distancePSrcRec, distancePRecSrc );
-              if ( optimizationIndex == 0 || distance[optimizationIndexMin] > distance[optimizationIndex] ) {
-                optimizationIndexMin = optimizationIndex;
-                patch.setPointLocalReconstructionMode( u0, v0, optimizationIndexMin );
-              }
-              optimizationIndex++;
-            }
-          }  // if block is used
+      if ( nbOfOptimizationMode > 0 ) {
+        if ( byPatch ) {
+          patch.setPointLocalReconstructionMode( optimizationIndexMin );
+        } else {
+          patch.setPointLocalReconstructionMode( u0Start, v0Start, optimizationIndexMin );
         }
       }
-    }
-  }  // patch
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
 }
 
 bool PCCEncoder::resizeGeometryVideo( PCCContext& context, PCCCodecId codecId ) {
@@ -5965,7 +6085,7 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
   std::vector<uint32_t> occupancyMapTemp;
   auto&                 occupancyMapOriginal = frame.getOccupancyMap();
   occupancyMapTemp.resize( image.getWidth() * image.getHeight(), 0 );
-  PCCKdTree kdtree( source );
+  PCCKdTree kdtree( source, true );
   // fill in positions that are added to the sequence, because of occupancyMap video coding
   for ( size_t y_OM = 0; y_OM < occupancyMap.getHeight(); ++y_OM ) {
     for ( size_t x_OM = 0; x_OM < occupancyMap.getWidth(); ++x_OM ) {
@@ -6129,467 +6249,6 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
   }
 }
 
-/* harmonic background filling algorithm */
-// interpolate using 5-point laplacian inpainting
-template <typename T>
-void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                miplev = 0;
-
-  // create coarse image by dyadic sampling
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    if ( miplev > 0 ) {
-      createCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
-                         mipOccupancyMapVec[miplev] );
-    } else {
-      createCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
-    }
-
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
-  }
-  miplev++;
-  // push phase: inpaint laplacian
-  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
-    } else {
-      regionFill( image, occupancyMapTemp, mipVec[i] );
-    }
-  }
-}
-
-template <typename T>
-void PCCEncoder::createCoarseLayer( PCCImage<T, 3>&        image,
-                                    PCCImage<T, 3>&        mip,
-                                    std::vector<uint32_t>& occupancyMap,
-                                    std::vector<uint32_t>& mipOccupancyMap ) {
-  int dyadicWidth = 1;
-  while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
-  int dyadicHeight = 1;
-  while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
-  // allocate the mipmap with half the resolution
-  mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
-  int stride    = image.getWidth();
-  int newStride = ( dyadicWidth / 2 );
-  for ( size_t y = 0; y < mip.getHeight(); y++ ) {
-    for ( size_t x = 0; x < mip.getWidth(); x++ ) {
-      double num[3] = { 0.0, 0.0, 0.0 };
-      double den    = 0;
-      for ( size_t i = 0; i < 2; i++ ) {
-        for ( size_t j = 0; j < 2; j++ ) {
-          int row = ( 2 * y + i ) < 0 ? 0 : ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
-          int column = ( 2 * x + j ) < 0 ? 0 : ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
-          if ( occupancyMap[column + stride * row] == 1 ) {
-            den++;
-            for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
-          }
-        }
-      }
-      if ( den > 0 ) {
-        mipOccupancyMap[x + newStride * y] = 1;
-        for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
-      }
-    }
-  }
-}
-
-template <typename T>
-void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
-  int                   stride        = image.getWidth();
-  int                   numElem       = 0;
-  int                   numSparseElem = 0;
-  std::vector<uint32_t> indexing;
-  indexing.resize( occupancyMap.size() );
-  for ( int i = 0; i < occupancyMap.size(); i++ ) {
-    if ( occupancyMap[i] == 0 ) {
-      indexing[i] = numElem;
-      numElem++;
-    }
-  }
-  // create a sparse matrix with the coefficients
-  std::vector<uint32_t> iSparse;
-  std::vector<uint32_t> jSparse;
-  std::vector<double>   valSparse;
-  iSparse.resize( numElem * 5 );
-  jSparse.resize( numElem * 5 );
-  valSparse.resize( numElem * 5 );
-  // create an initial solution using the low-resolution
-  std::vector<double> b[3];
-  b[0].resize( numElem );
-  b[1].resize( numElem );
-  b[2].resize( numElem );
-  // fill in the system
-  int idx       = 0;
-  int idxSparse = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        int count = 0;
-        b[0][idx] = 0;
-        b[1][idx] = 0;
-        b[2][idx] = 0;
-        for ( int i = -1; i < 2; i++ ) {
-          for ( int j = -1; j < 2; j++ ) {
-            if ( ( i == j ) || ( i == -j ) ) { continue; }
-            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
-            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
-            count++;
-            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
-              b[0][idx] += image.getValue( 0, column + j, row + i );
-              b[1][idx] += image.getValue( 1, column + j, row + i );
-              b[2][idx] += image.getValue( 2, column + j, row + i );
-            } else {
-              iSparse[idxSparse]   = idx;
-              jSparse[idxSparse]   = indexing[column + j + stride * ( row + i )];
-              valSparse[idxSparse] = -1;
-              idxSparse++;
-            }
-          }
-        }
-        // now insert the weight of the center pixel
-        iSparse[idxSparse]   = idx;
-        jSparse[idxSparse]   = idx;
-        valSparse[idxSparse] = count;
-        idx++;
-        idxSparse++;
-      }
-    }
-  }
-  numSparseElem = idxSparse;
-  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with initial guess coming from the lower resolution
-  std::vector<double> x[3];
-  x[0].resize( numElem );
-  x[1].resize( numElem );
-  x[2].resize( numElem );
-  if ( imageLowRes.getWidth() == image.getWidth() ) {
-    // low resolution image not provided, let's use for the initialization the mean value of the active pixels
-    double mean[3] = { 0.0, 0.0, 0.0 };
-    idx            = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 1 ) {
-          mean[0] += double( image.getValue( 0, column, row ) );
-          mean[1] += double( image.getValue( 1, column, row ) );
-          mean[2] += double( image.getValue( 2, column, row ) );
-          idx++;
-        }
-      }
-    }
-    mean[0] /= idx;
-    mean[1] /= idx;
-    mean[2] /= idx;
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = mean[0];
-          x[1][idx] = mean[1];
-          x[2][idx] = mean[2];
-          idx++;
-        }
-      }
-    }
-  } else {
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
-          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
-          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
-          idx++;
-        }
-      }
-    }
-  }
-  int    maxIteration = 1024;
-  double maxError     = 0.00001;
-  for ( int cc = 0; cc < 3; cc++ ) {
-    int it = 0;
-    for ( ; it < maxIteration; it++ ) {
-      int    idxSparse = 0;
-      double error     = 0;
-      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
-        // add the b result
-        double val = b[cc][centerIdx];
-        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
-          if ( valSparse[idxSparse] < 0 ) {
-            val += x[cc][jSparse[idxSparse]];
-            idxSparse++;
-          } else {
-            // final value
-            val /= valSparse[idxSparse];
-            // accumulate the error
-            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
-            // update the value
-            x[cc][centerIdx] = val;
-            idxSparse++;
-          }
-        }
-      }
-      error = error / numElem;
-      if ( error < maxError ) { break; }
-    }
-  }
-  // put the value back in the image
-  idx = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        image.setValue( 0, column, row, x[0][idx] );
-        image.setValue( 1, column, row, x[1][idx] );
-        image.setValue( 2, column, row, x[2][idx] );
-        idx++;
-      }
-    }
-  }
-}
-
-/* pull push filling algorithm */
-template <typename T>
-int PCCEncoder::mean4w( T             p1,
-                        unsigned char w1,
-                        T             p2,
-                        unsigned char w2,
-                        T             p3,
-                        unsigned char w3,
-                        T             p4,
-                        unsigned char w4 ) {
-  int result = ( p1 * int( w1 ) + p2 * int( w2 ) + p3 * int( w3 ) + p4 * int( w4 ) ) /
-               ( int( w1 ) + int( w2 ) + int( w3 ) + int( w4 ) );
-  return result;
-}
-
-// Generates a weighted mipmap
-template <typename T>
-void PCCEncoder::pushPullMip( const PCCImage<T, 3>&        image,
-                              PCCImage<T, 3>&              mip,
-                              const std::vector<uint32_t>& occupancyMap,
-                              std::vector<uint32_t>&       mipOccupancyMap ) {
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  unsigned char val1;
-  unsigned char val2;
-  unsigned char val3;
-  unsigned char val4;
-  const size_t  width     = image.getWidth();
-  const size_t  height    = image.getHeight();
-  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
-  const size_t  newHeight = ( ( height + 1 ) >> 1 );
-  // allocate the mipmap with half the resolution
-  mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( newWidth * newHeight, 0 );
-  for ( size_t y = 0; y < newHeight; ++y ) {
-    const size_t yUp = y << 1;
-    for ( size_t x = 0; x < newWidth; ++x ) {
-      const size_t xUp = x << 1;
-      if ( occupancyMap[xUp + width * yUp] == 0 ) {
-        w1 = 0;
-      } else {
-        w1 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
-        w2 = 0;
-      } else {
-        w2 = 255;
-      }
-      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
-        w3 = 0;
-      } else {
-        w3 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
-        w4 = 0;
-      } else {
-        w4 = 255;
-      }
-      if ( w1 + w2 + w3 + w4 > 0 ) {
-        for ( int cc = 0; cc < 3; cc++ ) {
-          val1 = image.getValue( cc, xUp, yUp );
-          if ( xUp + 1 >= width ) {
-            val2 = 0;
-          } else {
-            val2 = image.getValue( cc, xUp + 1, yUp );
-          }
-          if ( yUp + 1 >= height ) {
-            val3 = 0;
-          } else {
-            val3 = image.getValue( cc, xUp, yUp + 1 );
-          }
-          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
-            val4 = 0;
-          } else {
-            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
-          }
-          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
-          mip.setValue( cc, x, y, newVal );
-        }
-        mipOccupancyMap[x + newWidth * y] = 1;
-      }
-    }
-  }
-}
-
-// interpolate using mipmap
-template <typename T>
-void PCCEncoder::pushPullFill( PCCImage<T, 3>&              image,
-                               const PCCImage<T, 3>&        mip,
-                               const std::vector<uint32_t>& occupancyMap,
-                               int                          numIters ) {
-  const size_t width    = mip.getWidth();
-  const size_t height   = mip.getHeight();
-  const size_t widthUp  = image.getWidth();
-  const size_t heightUp = image.getHeight();
-  assert( ( ( widthUp + 1 ) >> 1 ) == width );
-  assert( ( ( heightUp + 1 ) >> 1 ) == height );
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  for ( int yUp = 0; yUp < heightUp; ++yUp ) {
-    int y = yUp >> 1;
-    for ( int xUp = 0; xUp < widthUp; ++xUp ) {
-      int x = xUp >> 1;
-      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
-        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val       = mip.getValue( cc, x, y );
-            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
-            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val        = mip.getValue( cc, x, y );
-            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
-            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val         = mip.getValue( cc, x, y );
-            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
-            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val          = mip.getValue( cc, x, y );
-            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
-            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        }
-      }
-    }
-  }
-  auto tmpImage( image );
-  for ( size_t n = 0; n < numIters; n++ ) {
-    for ( int y = 0; y < heightUp; y++ ) {
-      for ( int x = 0; x < widthUp; x++ ) {
-        if ( occupancyMap[x + widthUp * y] == 0 ) {
-          int x1 = ( x > 0 ) ? x - 1 : x;
-          int y1 = ( y > 0 ) ? y - 1 : y;
-          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
-          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
-          for ( size_t c = 0; c < 3; c++ ) {
-            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
-                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
-                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
-            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
-          }
-        }
-      }
-    }
-    swap( image, tmpImage );
-  }
-}
-
-template <typename T>
-void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                div    = 2;
-  int                                miplev = 0;
-
-  // pull phase create the mipmap
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    div *= 2;
-    if ( miplev > 0 ) {
-      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
-    } else {
-      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
-    }
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
-  }
-  miplev++;
-#if DEBUG_PATCH
-  for ( int k = 0; k < miplev; k++ ) {
-    char buf[100];
-    sprintf( buf, "mip%02i", k );
-    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
-    mipVec[k].write( filename, 1 );
-  }
-#endif
-  // push phase: refill
-  int numIters = 4;
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
-    } else {
-      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
-    }
-    numIters = (std::min)( numIters + 1, 16 );
-  }
-#if DEBUG_PATCH
-  for ( int k = 0; k < miplev; k++ ) {
-    char buf[100];
-    sprintf( buf, "mipfill%02i", k );
-    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
-    mipVec[k].write( filename, 1 );
-  }
-#endif
-}
-
 void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params ) {
   const size_t            pointCount = reconstruct.getPointCount();
   PCCKdTree               kdtree( reconstruct );
@@ -7139,7 +6798,7 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
   size_t            width           = occupancySizeU * params_.occupancyResolution_;
   size_t            height          = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   int               numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& iter : unionPatchTemp ) {
@@ -7245,7 +6904,7 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
   heithGPA                          = occupancySizeV * params_.occupancyResolution_;
   size_t            maxOccupancyRow = 0;
   int               numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
+  PCCBlockOccupancy occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -7556,7 +7215,7 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
     widthGPA                          = occupancySizeU * params_.occupancyResolution_;
     heightGPA                         = occupancySizeV * params_.occupancyResolution_;
     size_t            maxOccupancyRow = 0;
-    std::vector<bool> occupancyMap;
+    PCCBlockOccupancy occupancyMap;
     occupancyMap.resize( occupancySizeU * occupancySizeV, false );
     // !!!packing global matched patch;
     for ( auto& patch : patches ) {
@@ -7655,7 +7314,7 @@ void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&
                                                               size_t&            occupancySizeU,
                                                               size_t&            occupancySizeV,
                                                               const size_t       safeguard,
-                                                              std::vector<bool>& occupancyMap,
+                                                              PCCBlockOccupancy& occupancyMap,
                                                               size_t&            heightGPA,
                                                               size_t&            widthGPA,
                                                               size_t&            maxOccupancyRow ) {
@@ -7743,7 +7402,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                                                            size_t&                      occupancySizeU,
                                                            size_t&                      occupancySizeV,
                                                            const size_t                 safeguard,
-                                                           std::vector<bool>&           occupancyMap,
+                                                           PCCBlockOccupancy&           occupancyMap,
                                                            size_t&                      heightGPA,
                                                            size_t&                      widthGPA,
                                                            size_t&                      maxOccupancyRow ) {
@@ -8727,17 +8386,49 @@ void PCCEncoder::createHashSEI( PCCContext& context, size_t frameIndex, AtlasTil
   // for tiles
   if ( ( sei.getDecodedAtlasTilesHashPresentFlag() || sei.getDecodedAtlasTilesB2pHashPresentFlag() ) &&
        !seiHashCancelFlag ) {
-    sei.allocateAtlasTilesHash( context[frameIndex].getNumTilesInAtlasFrame() );
-    sei.setNumTilesMinus1( context[frameIndex].getNumTilesInAtlasFrame() - 1 );
-    for ( size_t tileIdx = 0; tileIdx < context[frameIndex].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto&  tile         = context[frameIndex].getTile( tileIdx );
-      size_t atlIdx       = tile.getAtlIndex();
-      auto&  tileHeader   = context.getAtlasTileLayerList()[atlIdx].getHeader();
-      auto&  tileDataUnit = context.getAtlasTileLayerList()[atlIdx].getDataUnit();
-      size_t patchCount   = tileDataUnit.getPatchCount() - 1;  // not the last I_END or P_END
-      size_t tileId       = tileHeader.getId();
-      auto&  afps         = context.getAtlasFrameParameterSet( tileHeader.getAtlasFrameParameterSetId() );
-      auto&  afti         = afps.getAtlasFrameTileInformationRbsp();
+    const size_t               tileCount = context[frameIndex].getNumTilesInAtlasFrame();
+    std::vector<PCCHashDigest> tileHashes( tileCount );
+    std::vector<PCCHashDigest> tileB2pHashes( tileCount );
+    sei.allocateAtlasTilesHash( tileCount );
+    sei.setNumTilesMinus1( tileCount - 1 );
+    // the tiles are hashed concurrently and the SEI is filled in tile order
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), tileCount, [&]( const size_t tileIdx ) {
+#else
+    for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+#endif
+        size_t               atlIdx     = context[frameIndex].getTile( tileIdx ).getAtlIndex();
+        auto&                atl        = context.getAtlasTileLayerList()[atlIdx];
+        size_t               patchCount = atl.getDataUnit().getPatchCount() - 1;  // not the last I_END or P_END
+        size_t               tileId     = atl.getHeader().getId();
+        std::vector<uint8_t> byteString;
+        if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
+          for ( size_t patchIdx = 0; patchIdx < patchCount; patchIdx++ ) {
+            tilePatchCommonByteString( byteString, tileId, patchIdx, tilePatchParams );
+            tilePatchApplicationByteString( byteString, tileId, patchIdx, tilePatchParams );
+          }
+          tileHashes[tileIdx].compute( sei.getHashType(), byteString.data(), byteString.size() );
+        }
+        if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
+          byteString.clear();
+          tileBlockToPatchByteString( byteString, tileId, tileB2PPatchParams );
+          tileB2pHashes[tileIdx].compute( sei.getHashType(), byteString.data(), byteString.size() );
+        }
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
+    for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+      auto&  tile       = context[frameIndex].getTile( tileIdx );
+      size_t atlIdx     = tile.getAtlIndex();
+      auto&  tileHeader = context.getAtlasTileLayerList()[atlIdx].getHeader();
+      size_t tileId     = tileHeader.getId();
+      auto&  afps       = context.getAtlasFrameParameterSet( tileHeader.getAtlasFrameParameterSetId() );
+      auto&  afti       = afps.getAtlasFrameTileInformationRbsp();
       sei.setTileId( tileIdx, tileId );
       if ( tileIdx == 0 ) {
         auto& tileInfo = context.getAtlasFrameParameterSet( tileHeader.getAtlasFrameParameterSetId() )
@@ -8748,56 +8439,41 @@ void PCCEncoder::createHashSEI( PCCContext& context, size_t frameIndex, AtlasTil
         sei.setTileIdLenMinus1( tileInfo.getNumTilesInAtlasFrameMinus1() == 0 ? 0 : ( bitCount - 1 ) );
       }
       if ( sei.getDecodedAtlasTilesHashPresentFlag() ) {
-        std::vector<uint8_t> atlasTileData;
-        for ( size_t patchIdx = 0; patchIdx < patchCount; patchIdx++ ) {
-          tilePatchCommonByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-          tilePatchApplicationByteString( atlasTileData, tileId, patchIdx, tilePatchParams );
-        }
+        const auto& hash = tileHashes[tileIdx];
         printf( "**sei** TilesPatchHash: frame(%zu), tile(tileIdx = %zu, tileId  = %zu)\n", frameIndex, tileIdx,
                 tileId );
         if ( sei.getHashType() == 0 ) {
-          std::vector<uint8_t> md5Digest( 16 );
-          md5Digest = context.computeMD5( atlasTileData.data(), atlasTileData.size() );
           TRACE_SEI( "Tile( Id = %zu, Idx = %zu) MD5: ", tileId, tileIdx );
-          for ( auto& e : md5Digest ) TRACE_SEI( "%02x", e );
+          for ( auto& e : hash.md5_ ) TRACE_SEI( "%02x", e );
           TRACE_SEI( "\n" );
-          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesMd5( tileId, j, md5Digest[j] );
+          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesMd5( tileId, j, hash.md5_[j] );
         } else if ( sei.getHashType() == 1 ) {
-          uint16_t crc = context.computeCRC( atlasTileData.data(), atlasTileData.size() );
           TRACE_SEI( "Tile( Id = %zu, Idx = %zu) CRC: ", tileId, tileIdx );
-          TRACE_SEI( " % 02x ", crc );
-          sei.setAtlasTilesCrc( tileId, crc );
+          TRACE_SEI( " % 02x ", hash.crc_ );
+          sei.setAtlasTilesCrc( tileId, hash.crc_ );
         } else if ( sei.getHashType() == 2 ) {
           TRACE_SEI( "Tile( Id = %zu, Idx = %zu) CheckSum: ", tileId, tileIdx );
-          uint32_t checkSum = context.computeCheckSum( atlasTileData.data(), atlasTileData.size() );
-          TRACE_SEI( " % 08x ", checkSum );
-          sei.setAtlasTilesCheckSum( tileId, checkSum );
+          TRACE_SEI( " % 08x ", hash.checkSum_ );
+          sei.setAtlasTilesCheckSum( tileId, hash.checkSum_ );
         }
-        atlasTileData.clear();
       }
       if ( sei.getDecodedAtlasTilesB2pHashPresentFlag() ) {
-        std::vector<uint8_t> tileB2PData;
-        tileBlockToPatchByteString( tileB2PData, tileId, tileB2PPatchParams );
+        const auto& hash = tileB2pHashes[tileIdx];
         printf( "**sei** TilesB2pPatchHash: frame(%zu), tileIdx(%zu)\n", frameIndex, tileIdx );
         if ( sei.getHashType() == 0 ) {
-          std::vector<uint8_t> md5Digest( 16 );
-          md5Digest = context.computeMD5( tileB2PData.data(), tileB2PData.size() );
           TRACE_SEI( "Tile B2P( Id = %zu, Idx = %zu) MD5: ", tileId, tileIdx );
-          for ( auto& e : md5Digest ) TRACE_SEI( "%02x", e );
+          for ( auto& e : hash.md5_ ) TRACE_SEI( "%02x", e );
           TRACE_SEI( "\n" );
-          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesB2pMd5( tileId, j, md5Digest[j] );
+          for ( int j = 0; j < 16; j++ ) sei.setAtlasTilesB2pMd5( tileId, j, hash.md5_[j] );
         } else if ( sei.getHashType() == 1 ) {
           TRACE_SEI( "Tile B2P( Id = %zu, Idx = %zu) CRC: ", tileId, tileIdx );
-          uint16_t crc = context.computeCRC( tileB2PData.data(), tileB2PData.size() );
-          TRACE_SEI( " % 04x ", crc );
-          sei.setAtlasTilesB2pCrc( tileId, crc );
+          TRACE_SEI( " % 04x ", hash.crc_ );
+          sei.setAtlasTilesB2pCrc( tileId, hash.crc_ );
         } else if ( sei.getHashType() == 2 ) {
           TRACE_SEI( "Tile B2P( Id = %zu, Idx = %zu) CheckSum: ", tileId, tileIdx );
-          uint32_t checkSum = context.computeCheckSum( tileB2PData.data(), tileB2PData.size() );
-          TRACE_SEI( " % 08x ", checkSum );
-          sei.setAtlasTilesB2pCheckSum( tileId, checkSum );
+          TRACE_SEI( " % 08x ", hash.checkSum_ );
+          sei.setAtlasTilesB2pCheckSum( tileId, hash.checkSum_ );
         }
-        tileB2PData.clear();
       }
     }
   }
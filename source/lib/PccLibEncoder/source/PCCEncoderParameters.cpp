@@ -135,6 +135,9 @@ PCCEncoderParameters::PCCEncoderParameters() {
   geometryAuxVideoConfig_                  = {};
   attributeAuxVideoConfig_                 = {};
   nbThread_                                = 1;
+  pipelinedGofs_                           = false;
+  pipelineMaxMemory_                       = 0;
+  videoEncoderInstances_                   = 1;
   keepIntermediateFiles_                   = false;
   absoluteD1_                              = false;
   absoluteT1_                              = false;
@@ -335,6 +338,11 @@ void PCCEncoderParameters::print() {
   std::cout << "\t groupOfFramesSize                          " << groupOfFramesSize_ << std::endl;
   std::cout << "\t colorTransform                             " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                                   " << nbThread_ << std::endl;
+  std::cout << "\t pipelinedGofs                              " << pipelinedGofs_ << std::endl;
+  if ( pipelinedGofs_ ) {
+    std::cout << "\t    pipelineMaxMemory                       " << pipelineMaxMemory_ << " MB" << std::endl;
+  }
+  std::cout << "\t videoEncoderInstances                      " << videoEncoderInstances_ << std::endl;
   std::cout << "\t keepIntermediateFiles                      " << keepIntermediateFiles_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
@@ -197,41 +197,9 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
 #endif
   if ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE ) {
     const size_t pointCount = pointCloud.getPointCount();
-    PCCNNResult  nNResult;
     visited_.resize( pointCount );
     std::fill( visited_.begin(), visited_.end(), 0 );
-    PCCNNQuery3 nNQuery  = {PCCPoint3D( 0.0 ),
-                           static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
-                           params.numberOfNearestNeighborsInNormalOrientation_};
-    PCCNNQuery3 nNQuery2 = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
-                            params.numberOfNearestNeighborsInNormalOrientation_};
-    for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
-      if ( visited_[ptIndex] == 0u ) {
-        visited_[ptIndex] = 1;
-        size_t      numberOfNormals;
-        PCCVector3D accumulatedNormals;
-        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
-                      numberOfNormals );
-        if ( numberOfNormals == 0u ) {
-          if ( ptIndex != 0u ) {
-            accumulatedNormals = normals_[ptIndex - 1];
-          } else {
-            accumulatedNormals = ( params.viewPoint_ - pointCloud[ptIndex] );
-          }
-        }
-        if ( normals_[ptIndex] * accumulatedNormals < 0.0 ) { normals_[ptIndex] = -normals_[ptIndex]; }
-        while ( !edges_.empty() ) {
-          PCCWeightedEdge edge = edges_.top();
-          edges_.pop();
-          uint32_t current = edge.end_;
-          if ( visited_[current] == 0u ) {
-            visited_[current] = 1;
-            if ( normals_[edge.start_] * normals_[current] < 0.0 ) { normals_[current] = -normals_[current]; }
-            addNeighbors( current, pointCloud, kdtree, nNQuery, nNResult, accumulatedNormals, numberOfNormals );
-          }
-        }
-      }
-    }
+    orientNormalsSpanningTree( pointCloud, kdtree, params );
     size_t negNormalCount = 0;
     for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
       negNormalCount +=
@@ -518,6 +486,173 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
 #endif
   }
 }
+void PCCNormalsGenerator3::computeNeighbors( const PCCPointSet3& pointCloud,
+                                             const PCCKdTree&    kdtree,
+                                             const size_t        nearestNeighborCount,
+                                             const double        radius,
+                                             PCCNeighborGraph&   neighbors ) {
+  const size_t pointCount = pointCloud.getPointCount();
+  const size_t batchSize  = 256;
+  const size_t batchCount = ( pointCount + batchSize - 1 ) / batchSize;
+  neighbors.resize( pointCount, ( std::min )( nearestNeighborCount, pointCount ), false );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
+#else
+  for ( size_t batch = 0; batch < batchCount; batch++ ) {
+#endif
+      const size_t start = batch * batchSize;
+      const size_t end   = ( std::min )( start + batchSize, pointCount );
+      if ( radius > 32768.0 ) {
+        PCCNNBatchResult result;
+        kdtree.search( pointCloud, start, end, nearestNeighborCount, result );
+        for ( size_t i = start; i < end; ++i ) {
+          std::copy( result.indices( i - start ), result.indices( i - start ) + result.count( i - start ),
+                     neighbors.getNeighbors( i ) );
+          neighbors.setNeighborCount( i, result.count( i - start ) );
+        }
+      } else {
+        PCCNNResult result;
+        for ( size_t i = start; i < end; ++i ) {
+          result.resize( 0 );
+          kdtree.searchRadius( pointCloud[i], nearestNeighborCount, radius, result );
+          std::copy( result.indices(), result.indices() + result.count(), neighbors.getNeighbors( i ) );
+          neighbors.setNeighborCount( i, result.count() );
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+}
+
+void PCCNormalsGenerator3::orientNormalsSpanningTree( const PCCPointSet3&                   pointCloud,
+                                                      const PCCKdTree&                      kdtree,
+                                                      const PCCNormalsGenerator3Parameters& params ) {
+  // The unvisited points are oriented by maximum spanning tree traversals, each one started from the first
+  // unvisited point and going through the neighbors of the points it visits. The points reached by a traversal form
+  // a region: its normals are oriented relatively to its seed, so the regions are traversed concurrently and are
+  // then flipped as a whole, in order, when their seed has to be flipped. A normal orthogonal to the normal of its
+  // parent is never flipped, and neither are the normals of its subtree.
+  const size_t     pointCount = pointCloud.getPointCount();
+  const size_t     nnCount    = params.numberOfNearestNeighborsInNormalOrientation_;
+  const double     radius     = static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_;
+  PCCNeighborGraph seedNeighbors;
+  PCCNeighborGraph radiusNeighbors;
+  computeNeighbors( pointCloud, kdtree, nnCount, ( std::numeric_limits<float>::max )(), seedNeighbors );
+  if ( !( radius > 32768.0 ) ) { computeNeighbors( pointCloud, kdtree, nnCount, radius, radiusNeighbors ); }
+  const PCCNeighborGraph& neighbors = radius > 32768.0 ? seedNeighbors : radiusNeighbors;
+
+  // region 0 holds the points already visited
+  const uint32_t        unassigned = ( std::numeric_limits<uint32_t>::max )();
+  std::vector<uint32_t> regions( pointCount );
+  std::vector<uint32_t> seeds( 1, 0 );
+  std::vector<uint32_t> fifo;
+  for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) { regions[ptIndex] = visited_[ptIndex] ? 0 : unassigned; }
+  for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
+    if ( regions[ptIndex] != unassigned ) { continue; }
+    const auto region = static_cast<uint32_t>( seeds.size() );
+    seeds.push_back( static_cast<uint32_t>( ptIndex ) );
+    regions[ptIndex] = region;
+    fifo.push_back( static_cast<uint32_t>( ptIndex ) );
+    while ( !fifo.empty() ) {
+      const uint32_t current = fifo.back();
+      fifo.pop_back();
+      for ( const auto index : current == ptIndex ? seedNeighbors[current] : neighbors[current] ) {
+        if ( regions[index] == unassigned ) {
+          regions[index] = region;
+          fifo.push_back( index );
+        }
+      }
+    }
+  }
+
+  std::vector<uint8_t> relative( pointCount, 0 );
+  const size_t         regionCount = seeds.size();
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 1 ), regionCount, [&]( const size_t region ) {
+#else
+  for ( size_t region = 1; region < regionCount; region++ ) {
+#endif
+      std::priority_queue<PCCWeightedEdge> edges;
+      auto addEdges = [&]( const uint32_t current, const PCCNeighborRange& range ) {
+        PCCWeightedEdge newEdge;
+        for ( const auto index : range ) {
+          if ( regions[index] == region && visited_[index] == 0u ) {
+            newEdge.weight_ = fabs( normals_[current] * normals_[index] );
+            newEdge.end_    = index;
+            newEdge.start_  = current;
+            edges.push( newEdge );
+          }
+        }
+      };
+      const uint32_t seed = seeds[region];
+      visited_[seed]      = 1;
+      relative[seed]      = 1;
+      addEdges( seed, seedNeighbors[seed] );
+      while ( !edges.empty() ) {
+        PCCWeightedEdge edge = edges.top();
+        edges.pop();
+        uint32_t current = edge.end_;
+        if ( visited_[current] == 0u ) {
+          visited_[current]    = 1;
+          const double product = normals_[edge.start_] * normals_[current];
+          if ( product < 0.0 ) { normals_[current] = -normals_[current]; }
+          relative[current] = relative[edge.start_] != 0u && ( product < 0.0 || product > 0.0 );
+          addEdges( current, neighbors[current] );
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+
+  // orientation of the seeds from the previous regions
+  std::vector<uint8_t> flipped( regionCount, 0 );
+  auto                 orientedNormal = [&]( const size_t index ) {
+    return flipped[regions[index]] != 0u && relative[index] != 0u ? -normals_[index] : normals_[index];
+  };
+  for ( size_t region = 1; region < regionCount; region++ ) {
+    const uint32_t seed            = seeds[region];
+    size_t         numberOfNormals = 0;
+    PCCVector3D    accumulatedNormals( 0.0 );
+    for ( const auto index : seedNeighbors[seed] ) {
+      if ( regions[index] < region ) {
+        accumulatedNormals += orientedNormal( index );
+        ++numberOfNormals;
+      }
+    }
+    if ( numberOfNormals == 0u ) {
+      if ( seed != 0u ) {
+        accumulatedNormals = orientedNormal( seed - 1 );
+      } else {
+        accumulatedNormals = ( params.viewPoint_ - pointCloud[seed] );
+      }
+    }
+    flipped[region] = normals_[seed] * accumulatedNormals < 0.0 ? 1 : 0;
+  }
+#if defined( ENABLE_TBB )
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t ptIndex ) {
+#else
+  for ( size_t ptIndex = 0; ptIndex < pointCount; ptIndex++ ) {
+#endif
+      normals_[ptIndex] = orientedNormal( ptIndex );
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+}
+
 void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
                                          const PCCPointSet3& pointCloud,
                                          const PCCKdTree&    kdtree,
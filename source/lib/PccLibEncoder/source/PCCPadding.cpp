@@ -0,0 +1,761 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCImage.h"
+#include "PCCPadding.h"
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
+
+using namespace pcc;
+
+/* harmonic background filling algorithm */
+template <typename T>
+static void createCoarseLayer( PCCImage<T, 3>&        image,
+                               PCCImage<T, 3>&        mip,
+                               std::vector<uint32_t>& occupancyMap,
+                               std::vector<uint32_t>& mipOccupancyMap ) {
+  int dyadicWidth = 1;
+  while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
+  int dyadicHeight = 1;
+  while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
+  // allocate the mipmap with half the resolution
+  mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
+  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
+  int stride    = image.getWidth();
+  int newStride = ( dyadicWidth / 2 );
+  // the rows of the mipmap are independent
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), size_t( mip.getHeight() ), [&]( const size_t y ) {
+#else
+  for ( size_t y = 0; y < mip.getHeight(); y++ ) {
+#endif
+    for ( size_t x = 0; x < mip.getWidth(); x++ ) {
+      double num[3] = { 0.0, 0.0, 0.0 };
+      double den    = 0;
+      for ( size_t i = 0; i < 2; i++ ) {
+        for ( size_t j = 0; j < 2; j++ ) {
+          int row    = ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
+          int column = ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
+          if ( occupancyMap[column + stride * row] == 1 ) {
+            den++;
+            for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
+          }
+        }
+      }
+      if ( den > 0 ) {
+        mipOccupancyMap[x + newStride * y] = 1;
+        for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
+      }
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+}
+
+template <typename T>
+static void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
+  int                   stride  = image.getWidth();
+  int                   numElem = 0;
+  std::vector<uint32_t> indexing;
+  indexing.resize( occupancyMap.size() );
+  for ( int i = 0; i < occupancyMap.size(); i++ ) {
+    if ( occupancyMap[i] == 0 ) {
+      indexing[i] = numElem;
+      numElem++;
+    }
+  }
+  // create the sparse matrix with the coefficients: each empty pixel has up to 4 empty neighbors, of coefficient -1,
+  // and the weight of the center pixel
+  std::vector<uint32_t> neighbors;
+  std::vector<uint8_t>  neighborCount;
+  std::vector<double>   centerWeight;
+  neighbors.resize( numElem * 4 );
+  neighborCount.resize( numElem, 0 );
+  centerWeight.resize( numElem );
+  // create an initial solution using the low-resolution
+  std::vector<double> b[3];
+  b[0].resize( numElem );
+  b[1].resize( numElem );
+  b[2].resize( numElem );
+  // fill in the system
+  int idx = 0;
+  for ( int row = 0; row < image.getHeight(); row++ ) {
+    for ( int column = 0; column < image.getWidth(); column++ ) {
+      if ( occupancyMap[column + stride * row] == 0 ) {
+        int count = 0;
+        b[0][idx] = 0;
+        b[1][idx] = 0;
+        b[2][idx] = 0;
+        for ( int i = -1; i < 2; i++ ) {
+          for ( int j = -1; j < 2; j++ ) {
+            if ( ( i == j ) || ( i == -j ) ) { continue; }
+            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
+            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
+            count++;
+            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
+              b[0][idx] += image.getValue( 0, column + j, row + i );
+              b[1][idx] += image.getValue( 1, column + j, row + i );
+              b[2][idx] += image.getValue( 2, column + j, row + i );
+            } else {
+              neighbors[4 * idx + neighborCount[idx]++] = indexing[column + j + stride * ( row + i )];
+            }
+          }
+        }
+        // now insert the weight of the center pixel
+        centerWeight[idx] = count;
+        idx++;
+      }
+    }
+  }
+  const int numEquations = idx;
+  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with initial guess coming from the lower resolution
+  std::vector<double> x[3];
+  x[0].resize( numElem );
+  x[1].resize( numElem );
+  x[2].resize( numElem );
+  if ( imageLowRes.getWidth() == image.getWidth() ) {
+    // low resolution image not provided, let's use for the initialization the mean value of the active pixels
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    idx            = 0;
+    for ( int row = 0; row < image.getHeight(); row++ ) {
+      for ( int column = 0; column < image.getWidth(); column++ ) {
+        if ( occupancyMap[column + stride * row] == 1 ) {
+          mean[0] += double( image.getValue( 0, column, row ) );
+          mean[1] += double( image.getValue( 1, column, row ) );
+          mean[2] += double( image.getValue( 2, column, row ) );
+          idx++;
+        }
+      }
+    }
+    mean[0] /= idx;
+    mean[1] /= idx;
+    mean[2] /= idx;
+    idx = 0;
+    for ( int row = 0; row < image.getHeight(); row++ ) {
+      for ( int column = 0; column < image.getWidth(); column++ ) {
+        if ( occupancyMap[column + stride * row] == 0 ) {
+          x[0][idx] = mean[0];
+          x[1][idx] = mean[1];
+          x[2][idx] = mean[2];
+          idx++;
+        }
+      }
+    }
+  } else {
+    idx = 0;
+    for ( int row = 0; row < image.getHeight(); row++ ) {
+      for ( int column = 0; column < image.getWidth(); column++ ) {
+        if ( occupancyMap[column + stride * row] == 0 ) {
+          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
+          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
+          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
+          idx++;
+        }
+      }
+    }
+  }
+  int    maxIteration = 1024;
+  double maxError     = 0.00001;
+  // the three planes are relaxed independently
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), size_t( 3 ), [&]( const size_t cc ) {
+#else
+  for ( size_t cc = 0; cc < 3; cc++ ) {
+#endif
+    for ( int it = 0; it < maxIteration; it++ ) {
+      double error = 0;
+      for ( int centerIdx = 0; centerIdx < numEquations; centerIdx++ ) {
+        // add the b result
+        double          val   = b[cc][centerIdx];
+        const uint32_t* index = neighbors.data() + 4 * centerIdx;
+        for ( int i = 0; i < neighborCount[centerIdx]; i++ ) { val += x[cc][index[i]]; }
+        // final value
+        val /= centerWeight[centerIdx];
+        // accumulate the error
+        error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
+        // update the value
+        x[cc][centerIdx] = val;
+      }
+      error = error / numElem;
+      if ( error < maxError ) { break; }
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+  // put the value back in the image
+  idx = 0;
+  for ( int row = 0; row < image.getHeight(); row++ ) {
+    for ( int column = 0; column < image.getWidth(); column++ ) {
+      if ( occupancyMap[column + stride * row] == 0 ) {
+        image.setValue( 0, column, row, x[0][idx] );
+        image.setValue( 1, column, row, x[1][idx] );
+        image.setValue( 2, column, row, x[2][idx] );
+        idx++;
+      }
+    }
+  }
+}
+
+// interpolate using 5-point laplacian inpainting
+template <typename T>
+void pcc::dilateHarmonicBackgroundFill( const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image ) {
+  auto                               occupancyMapTemp = occupancyMap;
+  int                                i                = 0;
+  std::vector<PCCImage<T, 3>>        mipVec;
+  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  int                                miplev = 0;
+
+  // create coarse image by dyadic sampling
+  while ( true ) {
+    mipVec.resize( mipVec.size() + 1 );
+    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    if ( miplev > 0 ) {
+      createCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
+                         mipOccupancyMapVec[miplev] );
+    } else {
+      createCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+    }
+
+    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+    ++miplev;
+  }
+  miplev++;
+  // push phase: inpaint laplacian
+  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
+  for ( i = miplev - 1; i >= 0; --i ) {
+    if ( i > 0 ) {
+      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
+    } else {
+      regionFill( image, occupancyMapTemp, mipVec[i] );
+    }
+  }
+}
+
+/* multigrid harmonic background filling algorithm */
+// Level of the multigrid hierarchy: a cell is fixed if one of the pixels it covers is occupied
+struct MultigridLevel {
+  size_t                width;
+  size_t                height;
+  std::vector<uint32_t> occupancyMap;
+};
+
+// Red-black Gauss-Seidel relaxation of the 5-point laplacian of the empty cells: the cells of one color only depend
+// on the cells of the other color, so the rows are relaxed in parallel
+static void relaxMultigridLevel( const MultigridLevel&      level,
+                                 const std::vector<double>& rhs,
+                                 std::vector<double>&       solution,
+                                 const size_t               sweepCount ) {
+  const size_t width  = level.width;
+  const size_t height = level.height;
+  for ( size_t sweep = 0; sweep < sweepCount; sweep++ ) {
+    for ( size_t color = 0; color < 2; color++ ) {
+#if defined( ENABLE_TBB )
+      tbb::parallel_for( size_t( 0 ), height, [&]( const size_t row ) {
+#else
+      for ( size_t row = 0; row < height; row++ ) {
+#endif
+        for ( size_t column = ( row + color ) & 1; column < width; column += 2 ) {
+          const size_t pos = row * width + column;
+          if ( level.occupancyMap[pos] == 1 ) { continue; }
+          double sum   = rhs[pos];
+          size_t count = 0;
+          if ( column > 0 ) {
+            sum += solution[pos - 1];
+            count++;
+          }
+          if ( column + 1 < width ) {
+            sum += solution[pos + 1];
+            count++;
+          }
+          if ( row > 0 ) {
+            sum += solution[pos - width];
+            count++;
+          }
+          if ( row + 1 < height ) {
+            sum += solution[pos + width];
+            count++;
+          }
+          if ( count > 0 ) { solution[pos] = sum / count; }
+        }
+#if defined( ENABLE_TBB )
+      } );
+#else
+      }
+#endif
+    }
+  }
+}
+
+// Computes the residual of the empty cells and returns its squared norm
+static double computeMultigridResidual( const MultigridLevel&      level,
+                                        const std::vector<double>& rhs,
+                                        const std::vector<double>& solution,
+                                        std::vector<double>&       residual ) {
+  const size_t        width  = level.width;
+  const size_t        height = level.height;
+  std::vector<double> rowError( height, 0.0 );
+  residual.assign( width * height, 0.0 );
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), height, [&]( const size_t row ) {
+#else
+  for ( size_t row = 0; row < height; row++ ) {
+#endif
+    for ( size_t column = 0; column < width; column++ ) {
+      const size_t pos = row * width + column;
+      if ( level.occupancyMap[pos] == 1 ) { continue; }
+      double value = rhs[pos];
+      if ( column > 0 ) { value += solution[pos - 1] - solution[pos]; }
+      if ( column + 1 < width ) { value += solution[pos + 1] - solution[pos]; }
+      if ( row > 0 ) { value += solution[pos - width] - solution[pos]; }
+      if ( row + 1 < height ) { value += solution[pos + width] - solution[pos]; }
+      residual[pos] = value;
+      rowError[row] += value * value;
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+  // the rows are summed in order to get the same result with any number of threads
+  double error = 0;
+  for ( const auto value : rowError ) { error += value; }
+  return error;
+}
+
+// Solves the correction of the residual on the coarser levels, then relaxes the level
+static void multigridCycle( const std::vector<MultigridLevel>& levels,
+                            const size_t                       levelIndex,
+                            std::vector<std::vector<double>>&  rhs,
+                            std::vector<std::vector<double>>&  solution,
+                            std::vector<std::vector<double>>&  residual ) {
+  const auto& level = levels[levelIndex];
+  if ( levelIndex + 1 == levels.size() ) {
+    relaxMultigridLevel( level, rhs[levelIndex], solution[levelIndex], 4 * ( level.width + level.height ) );
+    return;
+  }
+  relaxMultigridLevel( level, rhs[levelIndex], solution[levelIndex], 2 );
+  computeMultigridResidual( level, rhs[levelIndex], solution[levelIndex], residual[levelIndex] );
+  // restriction: the right-hand side of a coarse cell is the sum of the residuals of the pixels it covers
+  const auto& coarse    = levels[levelIndex + 1];
+  auto&       coarseRhs = rhs[levelIndex + 1];
+  coarseRhs.assign( coarse.width * coarse.height, 0.0 );
+  solution[levelIndex + 1].assign( coarse.width * coarse.height, 0.0 );
+  for ( size_t row = 0; row < level.height; row++ ) {
+    for ( size_t column = 0; column < level.width; column++ ) {
+      coarseRhs[( row / 2 ) * coarse.width + column / 2] += residual[levelIndex][row * level.width + column];
+    }
+  }
+  multigridCycle( levels, levelIndex + 1, rhs, solution, residual );
+  // prolongation: bilinear interpolation of the correction between the centers of the coarse cells
+  const auto& correction = solution[levelIndex + 1];
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), level.height, [&]( const size_t row ) {
+#else
+  for ( size_t row = 0; row < level.height; row++ ) {
+#endif
+    const size_t y0 = row / 2;
+    const size_t y1 = ( row & 1 ) ? ( std::min )( y0 + 1, coarse.height - 1 ) : ( y0 > 0 ? y0 - 1 : 0 );
+    for ( size_t column = 0; column < level.width; column++ ) {
+      const size_t pos = row * level.width + column;
+      if ( level.occupancyMap[pos] == 1 ) { continue; }
+      const size_t x0 = column / 2;
+      const size_t x1 = ( column & 1 ) ? ( std::min )( x0 + 1, coarse.width - 1 ) : ( x0 > 0 ? x0 - 1 : 0 );
+      solution[levelIndex][pos] +=
+          ( 9.0 * correction[y0 * coarse.width + x0] + 3.0 * correction[y0 * coarse.width + x1] +
+            3.0 * correction[y1 * coarse.width + x0] + correction[y1 * coarse.width + x1] ) /
+          16.0;
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+  relaxMultigridLevel( level, rhs[levelIndex], solution[levelIndex], 2 );
+}
+
+// interpolate using 5-point laplacian inpainting, solved by multigrid V-cycles
+template <typename T>
+void pcc::dilateMultigridBackgroundFill( const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image ) {
+  const size_t width      = image.getWidth();
+  const size_t height     = image.getHeight();
+  size_t       emptyCount = 0;
+  for ( const auto value : occupancyMap ) { emptyCount += value == 0 ? 1 : 0; }
+  if ( emptyCount == 0 || emptyCount == width * height ) { return; }
+  // create the coarse levels until a level is fully fixed or a few cells wide
+  std::vector<MultigridLevel> levels( 1 );
+  levels[0] = { width, height, occupancyMap };
+  while ( levels.back().width > 4 || levels.back().height > 4 ) {
+    const auto&    level = levels.back();
+    MultigridLevel coarse{ ( level.width + 1 ) / 2, ( level.height + 1 ) / 2, {} };
+    coarse.occupancyMap.assign( coarse.width * coarse.height, 0 );
+    for ( size_t row = 0; row < level.height; row++ ) {
+      for ( size_t column = 0; column < level.width; column++ ) {
+        coarse.occupancyMap[( row / 2 ) * coarse.width + column / 2] |= level.occupancyMap[row * level.width + column];
+      }
+    }
+    const bool fixed =
+        std::find( coarse.occupancyMap.begin(), coarse.occupancyMap.end(), 0 ) == coarse.occupancyMap.end();
+    if ( fixed ) { break; }
+    levels.push_back( std::move( coarse ) );
+  }
+  const int    maxCycle = 64;
+  const double maxError = 0.00001;
+  // the three planes are solved independently
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), size_t( 3 ), [&]( const size_t cc ) {
+#else
+  for ( size_t cc = 0; cc < 3; cc++ ) {
+#endif
+    std::vector<std::vector<double>> rhs( levels.size() );
+    std::vector<std::vector<double>> solution( levels.size() );
+    std::vector<std::vector<double>> residual( levels.size() );
+    // the occupied pixels are the boundary conditions and the empty ones start from their mean value
+    double mean = 0;
+    solution[0].resize( width * height );
+    rhs[0].assign( width * height, 0.0 );
+    for ( size_t row = 0; row < height; row++ ) {
+      for ( size_t column = 0; column < width; column++ ) {
+        solution[0][row * width + column] = image.getValue( cc, column, row );
+        if ( occupancyMap[row * width + column] == 1 ) { mean += solution[0][row * width + column]; }
+      }
+    }
+    mean /= double( width * height - emptyCount );
+    for ( size_t pos = 0; pos < width * height; pos++ ) {
+      if ( occupancyMap[pos] == 0 ) { solution[0][pos] = mean; }
+    }
+    for ( int cycle = 0; cycle < maxCycle; cycle++ ) {
+      multigridCycle( levels, 0, rhs, solution, residual );
+      const double error = computeMultigridResidual( levels[0], rhs[0], solution[0], residual[0] ) / emptyCount;
+      if ( error < maxError ) { break; }
+    }
+    // put the value back in the image
+    for ( size_t row = 0; row < height; row++ ) {
+      for ( size_t column = 0; column < width; column++ ) {
+        if ( occupancyMap[row * width + column] == 0 ) {
+          image.setValue( cc, column, row, static_cast<T>( solution[0][row * width + column] ) );
+        }
+      }
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+}
+
+/* pull push filling algorithm */
+template <typename T>
+static int mean4w( T             p1,
+                   unsigned char w1,
+                   T             p2,
+                   unsigned char w2,
+                   T             p3,
+                   unsigned char w3,
+                   T             p4,
+                   unsigned char w4 ) {
+  int result = ( p1 * int( w1 ) + p2 * int( w2 ) + p3 * int( w3 ) + p4 * int( w4 ) ) /
+               ( int( w1 ) + int( w2 ) + int( w3 ) + int( w4 ) );
+  return result;
+}
+
+// Generates a weighted mipmap
+template <typename T>
+static void pushPullMip( const PCCImage<T, 3>&        image,
+                         PCCImage<T, 3>&              mip,
+                         const std::vector<uint32_t>& occupancyMap,
+                         std::vector<uint32_t>&       mipOccupancyMap ) {
+  const size_t width     = image.getWidth();
+  const size_t height    = image.getHeight();
+  const size_t newWidth  = ( ( width + 1 ) >> 1 );
+  const size_t newHeight = ( ( height + 1 ) >> 1 );
+  // allocate the mipmap with half the resolution
+  mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
+  mipOccupancyMap.resize( newWidth * newHeight, 0 );
+  // the rows of the mipmap are independent
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), newHeight, [&]( const size_t y ) {
+#else
+  for ( size_t y = 0; y < newHeight; ++y ) {
+#endif
+    unsigned char w1;
+    unsigned char w2;
+    unsigned char w3;
+    unsigned char w4;
+    unsigned char val1;
+    unsigned char val2;
+    unsigned char val3;
+    unsigned char val4;
+    const size_t  yUp = y << 1;
+    for ( size_t x = 0; x < newWidth; ++x ) {
+      const size_t xUp = x << 1;
+      if ( occupancyMap[xUp + width * yUp] == 0 ) {
+        w1 = 0;
+      } else {
+        w1 = 255;
+      }
+      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
+        w2 = 0;
+      } else {
+        w2 = 255;
+      }
+      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
+        w3 = 0;
+      } else {
+        w3 = 255;
+      }
+      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
+        w4 = 0;
+      } else {
+        w4 = 255;
+      }
+      if ( w1 + w2 + w3 + w4 > 0 ) {
+        for ( int cc = 0; cc < 3; cc++ ) {
+          val1 = image.getValue( cc, xUp, yUp );
+          if ( xUp + 1 >= width ) {
+            val2 = 0;
+          } else {
+            val2 = image.getValue( cc, xUp + 1, yUp );
+          }
+          if ( yUp + 1 >= height ) {
+            val3 = 0;
+          } else {
+            val3 = image.getValue( cc, xUp, yUp + 1 );
+          }
+          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
+            val4 = 0;
+          } else {
+            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
+          }
+          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
+          mip.setValue( cc, x, y, newVal );
+        }
+        mipOccupancyMap[x + newWidth * y] = 1;
+      }
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+}
+
+// interpolate using mipmap
+template <typename T>
+static void pushPullFill( PCCImage<T, 3>&              image,
+                          const PCCImage<T, 3>&        mip,
+                          const std::vector<uint32_t>& occupancyMap,
+                          int                          numIters ) {
+  const size_t width    = mip.getWidth();
+  const size_t height   = mip.getHeight();
+  const size_t widthUp  = image.getWidth();
+  const size_t heightUp = image.getHeight();
+  assert( ( ( widthUp + 1 ) >> 1 ) == width );
+  assert( ( ( heightUp + 1 ) >> 1 ) == height );
+  // the rows are processed by pairs, as the two rows of a pair share the chroma samples of a 4:2:0 image
+  const size_t rowPairCount = ( heightUp + 1 ) >> 1;
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), rowPairCount, [&]( const size_t y ) {
+#else
+  for ( size_t y = 0; y < rowPairCount; ++y ) {
+#endif
+    unsigned char w1;
+    unsigned char w2;
+    unsigned char w3;
+    unsigned char w4;
+    for ( int yUp = 2 * y; yUp < ( std::min )( 2 * y + 2, heightUp ); ++yUp ) {
+      for ( int xUp = 0; xUp < widthUp; ++xUp ) {
+        int x = xUp >> 1;
+        if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
+          if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
+            w1 = 144;
+            w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+            w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+            w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+            for ( int cc = 0; cc < 3; cc++ ) {
+              T val       = mip.getValue( cc, x, y );
+              T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
+              T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
+              T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
+              T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
+              image.setValue( cc, xUp, yUp, newVal );
+            }
+          } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
+            w1 = 144;
+            w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+            w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+            w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+            for ( int cc = 0; cc < 3; cc++ ) {
+              T val        = mip.getValue( cc, x, y );
+              T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
+              T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
+              T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
+              T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
+              image.setValue( cc, xUp, yUp, newVal );
+            }
+          } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
+            w1 = 144;
+            w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+            w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+            w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+            for ( int cc = 0; cc < 3; cc++ ) {
+              T val         = mip.getValue( cc, x, y );
+              T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
+              T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
+              T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
+              T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
+              image.setValue( cc, xUp, yUp, newVal );
+            }
+          } else {
+            w1 = 144;
+            w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+            w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+            w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+            for ( int cc = 0; cc < 3; cc++ ) {
+              T val      = mip.getValue( cc, x, y );
+              T valRight = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
+              T valDown  = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
+              T valDownRight =
+                  ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
+              T newVal = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
+              image.setValue( cc, xUp, yUp, newVal );
+            }
+          }
+        }
+      }
+    }
+#if defined( ENABLE_TBB )
+  } );
+#else
+  }
+#endif
+  // each smoothing iteration reads image and writes tmpImage, so the row pairs are independent
+  auto tmpImage( image );
+  for ( size_t n = 0; n < numIters; n++ ) {
+#if defined( ENABLE_TBB )
+    tbb::parallel_for( size_t( 0 ), rowPairCount, [&]( const size_t rowPair ) {
+#else
+    for ( size_t rowPair = 0; rowPair < rowPairCount; rowPair++ ) {
+#endif
+      for ( int y = 2 * rowPair; y < ( std::min )( 2 * rowPair + 2, heightUp ); y++ ) {
+        for ( int x = 0; x < widthUp; x++ ) {
+          if ( occupancyMap[x + widthUp * y] == 0 ) {
+            int x1 = ( x > 0 ) ? x - 1 : x;
+            int y1 = ( y > 0 ) ? y - 1 : y;
+            int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
+            int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
+            for ( size_t c = 0; c < 3; c++ ) {
+              int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
+                        image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
+                        image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
+              tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
+            }
+          }
+        }
+      }
+#if defined( ENABLE_TBB )
+    } );
+#else
+    }
+#endif
+    std::swap( image, tmpImage );
+  }
+}
+
+template <typename T>
+void pcc::dilateSmoothedPushPull( const std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& image ) {
+  auto                               occupancyMapTemp = occupancyMap;
+  int                                i                = 0;
+  std::vector<PCCImage<T, 3>>        mipVec;
+  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  int                                div    = 2;
+  int                                miplev = 0;
+
+  // pull phase create the mipmap
+  while ( true ) {
+    mipVec.resize( mipVec.size() + 1 );
+    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    div *= 2;
+    if ( miplev > 0 ) {
+      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
+    } else {
+      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+    }
+    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+    ++miplev;
+  }
+  miplev++;
+#if DEBUG_PATCH
+  for ( int k = 0; k < miplev; k++ ) {
+    char buf[100];
+    sprintf( buf, "mip%02i", k );
+    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
+    mipVec[k].write( filename, 1 );
+  }
+#endif
+  // push phase: refill
+  int numIters = 4;
+  for ( i = miplev - 1; i >= 0; --i ) {
+    if ( i > 0 ) {
+      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
+    } else {
+      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
+    }
+    numIters = (std::min)( numIters + 1, 16 );
+  }
+#if DEBUG_PATCH
+  for ( int k = 0; k < miplev; k++ ) {
+    char buf[100];
+    sprintf( buf, "mipfill%02i", k );
+    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
+    mipVec[k].write( filename, 1 );
+  }
+#endif
+}
+
+template void pcc::dilateSmoothedPushPull<uint8_t>( const std::vector<uint32_t>& occupancyMap,
+                                                    PCCImage<uint8_t, 3>&        image );
+template void pcc::dilateSmoothedPushPull<uint16_t>( const std::vector<uint32_t>& occupancyMap,
+                                                     PCCImage<uint16_t, 3>&       image );
+template void pcc::dilateHarmonicBackgroundFill<uint8_t>( const std::vector<uint32_t>& occupancyMap,
+                                                          PCCImage<uint8_t, 3>&        image );
+template void pcc::dilateHarmonicBackgroundFill<uint16_t>( const std::vector<uint32_t>& occupancyMap,
+                                                           PCCImage<uint16_t, 3>&       image );
+template void pcc::dilateMultigridBackgroundFill<uint8_t>( const std::vector<uint32_t>& occupancyMap,
+                                                           PCCImage<uint8_t, 3>&        image );
+template void pcc::dilateMultigridBackgroundFill<uint16_t>( const std::vector<uint32_t>& occupancyMap,
+                                                            PCCImage<uint16_t, 3>&       image );
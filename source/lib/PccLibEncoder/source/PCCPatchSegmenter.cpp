@@ -87,6 +87,7 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
   }
   std::cout << "  Computing normals for original point cloud... ";
   PCCKdTree            kdtree( geometryVox );
+  PCCNeighborGraph     adj;
   PCCNNResult          result;
   PCCNormalsGenerator3 normalsGen;
   auto                 normalsOrientation = static_cast<PCCNormalsGeneratorOrientation>( params.normalOrientation_ );
@@ -125,12 +126,18 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
                                  params.searchRadiusRefineSegmentation_, partition );
   } else {
     std::cout << "  Refining segmentation... ";
-    refineSegmentation( geometryVox, kdtree, normalsGen, orientations, orientationCount,
+    refineSegmentation( geometryVox, kdtree, adj, normalsGen, orientations, orientationCount,
                         params.maxNNCountRefineSegmentation_, params.lambdaRefineSegmentation_,
                         params.iterationCountRefineSegmentation_, partition );
   }
   std::cout << "[done]" << std::endl;
 
+  // the patch segmentation reuses the neighbors of the refinement when it searches the same ones
+  if ( params.gridBasedSegmentation_ || params.gridBasedRefineSegmentation_ ||
+       params.maxNNCountRefineSegmentation_ != params.maxNNCountPatchSegmentation_ ) {
+    adj.clear();
+  }
+
   if ( params.gridBasedSegmentation_ ) {
     std::cout << "  Applying voxels' data to points... ";
     applyVoxelsDataToPoints( geometry.getPointCount(), params.geometryBitDepth3D_,
@@ -144,8 +151,9 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
   std::vector<size_t> resampledPatchPartition;
   std::vector<size_t> rawPoints;
 
-  segmentPatches( geometry, frameIndex, kdtree, params, partition, patches, patchPartition, resampledPatchPartition,
-                  rawPoints, resampled, subPointCloud, distanceSrcRec, normalsGen, orientations, orientationCount );
+  segmentPatches( geometry, frameIndex, kdtree, adj, params, partition, patches, patchPartition,
+                  resampledPatchPartition, rawPoints, resampled, subPointCloud, distanceSrcRec, normalsGen,
+                  orientations, orientationCount );
   std::cout << "[done]" << std::endl;
 }
 
@@ -264,24 +272,39 @@ void PCCPatchSegmenter3::initialSegmentation( const PCCPointSet3&         geomet
 #endif
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                                               const PCCKdTree&                  kdtree,
-                                               std::vector<std::vector<size_t>>& adj,
-                                               const size_t                      maxNNCount ) {
+void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                                               const PCCKdTree&    kdtree,
+                                               PCCNeighborGraph&   adj,
+                                               const size_t        maxNNCount,
+                                               const bool          useDistances ) {
   const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
+  const size_t batchSize  = 256;
+  const size_t batchCount = ( pointCount + batchSize - 1 ) / batchSize;
+  adj.resize( pointCount, ( std::min )( maxNNCount, pointCount ), useDistances );
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  for ( size_t batch = 0; batch < batchCount; batch++ ) {
 #endif
-      PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      const size_t     start = batch * batchSize;
+      const size_t     end   = ( std::min )( start + batchSize, pointCount );
+      PCCNNBatchResult result;
+      kdtree.search( pointCloud, start, end, maxNNCount, result );
+      for ( size_t i = start; i < end; ++i ) {
+        const size_t  query     = i - start;
+        const size_t  count     = result.count( query );
+        const size_t* indices   = result.indices( query );
+        uint32_t*     neighbors = adj.getNeighbors( i );
+        for ( size_t j = 0; j < count; ++j ) { neighbors[j] = static_cast<uint32_t>( indices[j] ); }
+        if ( useDistances ) {
+          const double* dist      = result.dist( query );
+          float*        distances = adj.getDistances( i );
+          for ( size_t j = 0; j < count; ++j ) { distances[j] = static_cast<float>( dist[j] ); }
+        }
+        adj.setNeighborCount( i, count );
+      }
 #if defined( ENABLE_TBB )
       } );
     } );
@@ -290,58 +313,54 @@ void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&
 #endif
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
-                                                       const PCCKdTree&                    kdtree,
-                                                       std::vector<std::vector<uint32_t>>& adj,
-                                                       const size_t                        maxNNCount,
-                                                       const size_t                        radius ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
+void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3& pointCloud,
+                                                       const PCCKdTree&    kdtree,
+                                                       PCCNeighborGraph&   adj,
+                                                       const size_t        maxNNCount,
+                                                       const size_t        radius ) {
+  // the neighbor counts are only known after the searches: the neighbors of each batch are gathered in a batch
+  // buffer and then moved to the rows of the graph.
+  const size_t                       pointCount = pointCloud.getPointCount();
+  const size_t                       batchSize  = 256;
+  const size_t                       batchCount = ( pointCount + batchSize - 1 ) / batchSize;
+  std::vector<uint32_t>              counts( pointCount );
+  std::vector<std::vector<uint32_t>> batchNeighbors( batchCount );
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  for ( size_t batch = 0; batch < batchCount; batch++ ) {
 #endif
-      PCCNNResult result;
-      kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
-      std::vector<uint32_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      const size_t start = batch * batchSize;
+      const size_t end   = ( std::min )( start + batchSize, pointCount );
+      PCCNNResult  result;
+      for ( size_t i = start; i < end; ++i ) {
+        result.resize( 0 );
+        kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
+        counts[i] = static_cast<uint32_t>( result.count() );
+        for ( size_t j = 0; j < result.count(); ++j ) {
+          batchNeighbors[batch].push_back( static_cast<uint32_t>( result.indices( j ) ) );
+        }
+      }
 #if defined( ENABLE_TBB )
-      } );
     } );
+  } );
 #else
   }
 #endif
-}
-
-void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                                   const PCCKdTree&                  kdtree,
-                                                   std::vector<std::vector<size_t>>& adj,
-                                                   std::vector<std::vector<double>>& adjDist,
-                                                   const size_t                      maxNNCount ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
-  adjDist.resize( pointCount );
+  adj.resize( counts, false );
 #if defined( ENABLE_TBB )
-  tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  for ( size_t batch = 0; batch < batchCount; batch++ ) {
 #endif
-      PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors     = adj[i];
-      std::vector<double>& neighborsDist = adjDist[i];
-      neighbors.resize( result.count() );
-      neighborsDist.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) {
-        neighbors[j]     = result.indices( j );
-        neighborsDist[j] = result.dist( j );
-      }
+      const size_t start = batch * batchSize;
+      const size_t end   = ( std::min )( start + batchSize, pointCount );
+      std::copy( batchNeighbors[batch].begin(), batchNeighbors[batch].end(), adj.getNeighbors( start ) );
+      for ( size_t i = start; i < end; ++i ) { adj.setNeighborCount( i, counts[i] ); }
+      std::vector<uint32_t>().swap( batchNeighbors[batch] );
 #if defined( ENABLE_TBB )
     } );
   } );
@@ -350,6 +369,13 @@ void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&
 #endif
 }
 
+void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3& pointCloud,
+                                                   const PCCKdTree&    kdtree,
+                                                   PCCNeighborGraph&   adj,
+                                                   const size_t        maxNNCount ) {
+  computeAdjacencyInfo( pointCloud, kdtree, adj, maxNNCount, true );
+}
+
 void printChunk( const std::vector<std::pair<int, int>>& chunk ) {
   std::vector<std::string> axisName{"x -> ", "y -> ", "z -> "};
   for ( size_t axis = 0; axis < 3; ++axis ) {
@@ -542,6 +568,7 @@ int16_t PCCPatchSegmenter3::getPatchSurfaceThickness( const PCCPointSet3&      p
 void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 points,
                                          const size_t                        frameIndex,
                                          const PCCKdTree&                    kdtree,
+                                         PCCNeighborGraph&                   adj,
                                          const PCCPatchSegmenter3Parameters& params,
                                          std::vector<size_t>&                partition,
                                          std::vector<PCCPatch>&              patches,
@@ -590,7 +617,6 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   const size_t pointCount             = points.getPointCount();
   patchPartition.resize( pointCount, 0 );
   resampledPatchPartition.reserve( pointCount );
-  PCCNNResult             result;
   std::vector<PCCColor3B> frame_pcc_color;
   frame_pcc_color.reserve( pointCount );
   for ( size_t i = 0; i < pointCount; i++ ) { frame_pcc_color.push_back( points.getColor( i ) ); }
@@ -600,23 +626,23 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   size_t numD1Points      = 0;
   size_t numEOMOnlyPoints = 0;
   std::cout << "\n\t Computing adjacency info... ";
-  std::vector<std::vector<size_t>>              adj;
-  std::vector<std::vector<double>>              adjDist;
-  std::vector<bool>                             flagExp;
-  int                                           numROIs;
-  int                                           numChunks;
-  std::vector<PCCPointSet3>                     pointsChunks;
-  std::vector<std::vector<size_t>>              pointsIndexChunks;
-  std::vector<size_t>                           pointCountChunks;
-  std::vector<PCCKdTree>                        kdtreeChunks;
-  std::vector<PCCBox3D>                         boundingBoxChunks;
-  std::vector<std::vector<std::vector<size_t>>> adjChunks;
+  std::vector<bool>                flagExp;
+  int                              numROIs;
+  int                              numChunks;
+  std::vector<PCCPointSet3>        pointsChunks;
+  std::vector<std::vector<size_t>> pointsIndexChunks;
+  std::vector<size_t>              pointCountChunks;
+  std::vector<PCCKdTree>           kdtreeChunks;
+  std::vector<PCCBox3D>            boundingBoxChunks;
+  std::vector<PCCNeighborGraph>    adjChunks;
   if ( patchExpansionEnabled ) {
-    computeAdjacencyInfoDist( points, kdtree, adj, adjDist, maxNNCount );
+    if ( adj.size() != pointCount || !adj.hasDistances() ) {
+      computeAdjacencyInfoDist( points, kdtree, adj, maxNNCount );
+    }
     flagExp.resize( pointCount, false );
   } else {
     if ( !enablePointCloudPartitioning ) {
-      computeAdjacencyInfo( points, kdtree, adj, maxNNCount );
+      if ( adj.size() != pointCount ) { computeAdjacencyInfo( points, kdtree, adj, maxNNCount ); }
     } else {
       numROIs = static_cast<int>( roiBoundingBoxMinX.size() );
       std::vector<std::vector<size_t>> numCutsPerAxis;  // number of cuts per axis for each ROI
@@ -804,39 +830,63 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   while ( !rawPoints.empty() ) {
     std::vector<std::vector<size_t>> connectedComponents;
     if ( !enablePointCloudPartitioning ) {
-      std::vector<size_t> fifo;
-      fifo.reserve( pointCount );
-      std::vector<bool> flags;
-      flags.resize( pointCount, false );
-      for ( const auto i : rawPoints ) { flags[i] = true; }
-      connectedComponents.reserve( 256 );
+      // a traversal only visits the points of the partition of its seed: the partitions are traversed concurrently
+      // and their connected components are then ordered by seed, rawPoints being sorted, as in a single traversal.
+      std::vector<std::vector<size_t>>              rawPointsPartitions( orientationCount );
+      std::vector<std::vector<std::vector<size_t>>> connectedComponentsPartitions( orientationCount );
+      std::vector<uint8_t>                          flags( pointCount, 0 );
       for ( const auto i : rawPoints ) {
-        if ( flags[i] && rawPointsDistance[i] > maxAllowedDist2RawPointsDetection ) {
-          flags[i]                  = false;
-          const size_t indexCC      = connectedComponents.size();
-          const size_t clusterIndex = partition[i];
-          connectedComponents.resize( indexCC + 1 );
-          std::vector<size_t>& connectedComponent = connectedComponents[indexCC];
-          fifo.push_back( i );
-          connectedComponent.push_back( i );
-          while ( !fifo.empty() ) {
-            const size_t current = fifo.back();
-            fifo.pop_back();
-            for ( const auto n : adj[current] ) {
-              if ( clusterIndex == partition[n] && flags[n] ) {
-                flags[n] = false;
-                fifo.push_back( n );
-                connectedComponent.push_back( n );
+        assert( partition[i] < orientationCount );
+        rawPointsPartitions[partition[i]].push_back( i );
+        flags[i] = 1;
+      }
+#if defined( ENABLE_TBB )
+      tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), orientationCount, [&]( const size_t clusterIndex ) {
+#else
+      for ( size_t clusterIndex = 0; clusterIndex < orientationCount; clusterIndex++ ) {
+#endif
+          auto&               connectedComponentsPartition = connectedComponentsPartitions[clusterIndex];
+          std::vector<size_t> fifo;
+          for ( const auto i : rawPointsPartitions[clusterIndex] ) {
+            if ( flags[i] && rawPointsDistance[i] > maxAllowedDist2RawPointsDetection ) {
+              flags[i]                  = 0;
+              const size_t indexCC      = connectedComponentsPartition.size();
+              connectedComponentsPartition.resize( indexCC + 1 );
+              std::vector<size_t>& connectedComponent = connectedComponentsPartition[indexCC];
+              fifo.push_back( i );
+              connectedComponent.push_back( i );
+              while ( !fifo.empty() ) {
+                const size_t current = fifo.back();
+                fifo.pop_back();
+                for ( const auto n : adj[current] ) {
+                  if ( clusterIndex == partition[n] && flags[n] ) {
+                    flags[n] = 0;
+                    fifo.push_back( n );
+                    connectedComponent.push_back( n );
+                  }
+                }
               }
+              if ( connectedComponent.size() < minPointCountPerCC ) { connectedComponentsPartition.resize( indexCC ); }
             }
           }
-          if ( connectedComponent.size() < minPointCountPerCC ) {
-            connectedComponents.resize( indexCC );
-          } else {
-            std::cout << "\t\t CC " << indexCC << " -> " << connectedComponent.size() << std::endl;
-          }
+#if defined( ENABLE_TBB )
+        } );
+      } );
+#else
+      }
+#endif
+      for ( auto& connectedComponentsPartition : connectedComponentsPartitions ) {
+        for ( auto& connectedComponent : connectedComponentsPartition ) {
+          connectedComponents.push_back( std::move( connectedComponent ) );
         }
       }
+      std::sort( connectedComponents.begin(), connectedComponents.end(),
+                 []( const std::vector<size_t>& a, const std::vector<size_t>& b ) { return a[0] < b[0]; } );
+      for ( size_t indexCC = 0; indexCC < connectedComponents.size(); indexCC++ ) {
+        std::cout << "\t\t CC " << indexCC << " -> " << connectedComponents[indexCC].size() << std::endl;
+      }
 
       std::cout << " # CC " << connectedComponents.size() << std::endl;
     } else {
@@ -907,14 +957,38 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       std::sort( connectedComponents.begin(), connectedComponents.end(),
                  []( const std::vector<size_t>& a, const std::vector<size_t>& b ) { return a.size() >= b.size(); } );
     }
-    for ( auto& connectedComponent : connectedComponents ) {
-      const size_t patchIndex = patches.size();
-      patches.resize( patchIndex + 1 );
-      if ( createSubPointCloud ) { subPointCloud.resize( patchIndex + 1 ); }
-      PCCPatch& patch            = patches[patchIndex];
-      size_t    d0CountPerPatch  = 0;
-      size_t    d1CountPerPatch  = 0;
-      size_t    eomCountPerPatch = 0;
+    // the patches of the connected components are generated concurrently, except with the patch expansion where
+    // the points taken by a patch are not available to the next ones, and then merged in order.
+    struct PatchStatistics {
+      bool   generated_;
+      size_t d0Count_;
+      size_t d1Count_;
+      size_t eomCount_;
+      size_t srcCount_;
+      size_t recCount_;
+      float  distPAB_;
+      float  distPBA_;
+      float  distYAB_;
+      float  distYBA_;
+      float  distUAB_;
+      float  distUBA_;
+      float  distVAB_;
+      float  distVBA_;
+    };
+    const size_t                     firstPatchIndex = patches.size();
+    const size_t                     patchCount      = connectedComponents.size();
+    std::vector<PatchStatistics>     statistics( patchCount, PatchStatistics() );
+    std::vector<PCCPointSet3>        resampledPatches( patchCount );
+    std::vector<std::vector<size_t>> resampledPatchPartitions( patchCount );
+    patches.resize( firstPatchIndex + patchCount );
+    if ( createSubPointCloud ) { subPointCloud.resize( firstPatchIndex + patchCount ); }
+    auto generatePatch = [&]( const size_t index ) {
+      auto&        connectedComponent = connectedComponents[index];
+      const size_t patchIndex         = firstPatchIndex + index;
+      PCCPatch&    patch              = patches[patchIndex];
+      size_t       d0CountPerPatch    = 0;
+      size_t       d1CountPerPatch    = 0;
+      size_t       eomCountPerPatch   = 0;
       patch.setIndex( patchIndex );
       patch.setEOMCount( 0 );
       patch.setPatchType( static_cast<uint8_t>( P_INTRA ) );
@@ -953,7 +1027,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
           if ( u - minU < params.maxPatchSize_ && v - minV < params.maxPatchSize_ ) { tempCC.push_back( i ); }
         }
         connectedComponent = tempCC;
-        if ( connectedComponent.empty() ) { continue; }
+        if ( connectedComponent.empty() ) { return; }
       }
 
       const int16_t projectionDirectionType = -2 * patch.getProjectionMode() + 1;
@@ -963,15 +1037,17 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
         std::vector<size_t> fifoa;
         fifoa.reserve( pointCount );
         for ( const auto i : connectedComponent ) {
-          for ( size_t ac = 0; ac < adj[i].size(); ++ac ) {
-            const size_t n = adj[i][ac];
+          const auto   neighbors = adj[i];
+          const float* distances = adj.getDistances( i );
+          for ( size_t ac = 0; ac < neighbors.size(); ++ac ) {
+            const size_t n = neighbors[ac];
             if ( flagExp[n] ) { continue; }
             if ( ( clusterIndex == partition[n] ) ||  // same plane
                  ( clusterIndex + 3 == partition[n] ) || ( clusterIndex == partition[n] + 3 ) ) {
               continue;
             }
-            const double dist2 = adjDist[i][ac];  // sum of square
-            if ( dist2 <= 2 ) {                   // <-- expansion distance
+            const double dist2 = distances[ac];  // sum of square
+            if ( dist2 <= 2 ) {                  // <-- expansion distance
               fifoa.push_back( n );
               flagExp[n] = true;  // add point
             }
@@ -1196,7 +1272,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       rec.resize( 0 );
       std::vector<size_t> pointCount;
       pointCount.resize( 3 );
-      resampledPointcloud( pointCount, resampled, resampledPatchPartition, patch, patchIndex,
+      resampledPointcloud( pointCount, resampledPatches[index], resampledPatchPartitions[index], patch, patchIndex,
                            params.mapCountMinus1_ > 0, surfaceThickness, EOMFixBitCount, bIsAdditionalProjectionPlane,
                            useEnhancedOccupancyMapCode, geometryBitDepth3D, createSubPointCloud, rec );
 
@@ -1243,20 +1319,22 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
         float distVBA;
         testRec.removeDuplicate();
         testSrc.distanceGeoColor( testRec, distPAB, distPBA, distYAB, distYBA, distUAB, distUBA, distVAB, distVBA );
-        meanPAB += distPAB * testSrc.getPointCount();
-        meanPBA += distPBA * testRec.getPointCount();
-        meanYAB += distYAB * testSrc.getPointCount();
-        meanYBA += distYBA * testRec.getPointCount();
-        meanUAB += distUAB * testSrc.getPointCount();
-        meanUBA += distUBA * testRec.getPointCount();
-        meanVAB += distVAB * testSrc.getPointCount();
-        meanVBA += distVBA * testRec.getPointCount();
-        testSrcNum += testSrc.getPointCount();
-        testRecNum += testRec.getPointCount();
-
-        auto& sub = subPointCloud[subPointCloud.size() - 1];
+        auto& patchStatistics     = statistics[index];
+        patchStatistics.distPAB_  = distPAB;
+        patchStatistics.distPBA_  = distPBA;
+        patchStatistics.distYAB_  = distYAB;
+        patchStatistics.distYBA_  = distYBA;
+        patchStatistics.distUAB_  = distUAB;
+        patchStatistics.distUBA_  = distUBA;
+        patchStatistics.distVAB_  = distVAB;
+        patchStatistics.distVBA_  = distVBA;
+        patchStatistics.srcCount_ = testSrc.getPointCount();
+        patchStatistics.recCount_ = testRec.getPointCount();
+
+        auto& sub = subPointCloud[patchIndex];
         sub.resize( 0 );
-        PCCKdTree kdtreeRec( rec );
+        PCCKdTree   kdtreeRec( rec, true );
+        PCCNNResult result;
         for ( const auto i : connectedComponent ) {
           kdtreeRec.search( points[i], 1, result );
           const double dist2 = result.dist( 0 );
@@ -1279,22 +1357,82 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       patch.setEOMandD1Count( eomCountPerPatch );
       if ( useEnhancedOccupancyMapCode ) { patch.setEOMCount( eomCountPerPatch - d1CountPerPatch ); }
       patch.setD0Count( d0CountPerPatch );
-      numberOfEOM += ( eomCountPerPatch - d1CountPerPatch );
-      numD0Points += d0CountPerPatch;
-      numD1Points += d1CountPerPatch;
-      if ( useEnhancedOccupancyMapCode ) { numEOMOnlyPoints += ( eomCountPerPatch - d1CountPerPatch ); }
+      statistics[index].generated_ = true;
+      statistics[index].d0Count_   = d0CountPerPatch;
+      statistics[index].d1Count_   = d1CountPerPatch;
+      statistics[index].eomCount_  = eomCountPerPatch;
+    };
+#if defined( ENABLE_TBB )
+    if ( !patchExpansionEnabled ) {
+      tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), patchCount, [&]( const size_t index ) { generatePatch( index ); } );
+      } );
+    } else {
+      for ( size_t index = 0; index < patchCount; index++ ) { generatePatch( index ); }
+    }
+#else
+    for ( size_t index = 0; index < patchCount; index++ ) { generatePatch( index ); }
+#endif
+    for ( size_t index = 0; index < patchCount; index++ ) {
+      const auto&  patchStatistics = statistics[index];
+      const size_t patchIndex      = firstPatchIndex + index;
+      const auto&  patch           = patches[patchIndex];
+      resampled.appendPointSet( resampledPatches[index] );
+      resampledPatchPartition.insert( resampledPatchPartition.end(), resampledPatchPartitions[index].begin(),
+                                      resampledPatchPartitions[index].end() );
+      resampledPatches[index] = PCCPointSet3();
+      std::vector<size_t>().swap( resampledPatchPartitions[index] );
+      if ( !patchStatistics.generated_ ) { continue; }
+      if ( createSubPointCloud ) {
+        meanPAB += patchStatistics.distPAB_ * patchStatistics.srcCount_;
+        meanPBA += patchStatistics.distPBA_ * patchStatistics.recCount_;
+        meanYAB += patchStatistics.distYAB_ * patchStatistics.srcCount_;
+        meanYBA += patchStatistics.distYBA_ * patchStatistics.recCount_;
+        meanUAB += patchStatistics.distUAB_ * patchStatistics.srcCount_;
+        meanUBA += patchStatistics.distUBA_ * patchStatistics.recCount_;
+        meanVAB += patchStatistics.distVAB_ * patchStatistics.srcCount_;
+        meanVBA += patchStatistics.distVBA_ * patchStatistics.recCount_;
+        testSrcNum += patchStatistics.srcCount_;
+        testRecNum += patchStatistics.recCount_;
+      }
+      numberOfEOM += ( patchStatistics.eomCount_ - patchStatistics.d1Count_ );
+      numD0Points += patchStatistics.d0Count_;
+      numD1Points += patchStatistics.d1Count_;
+      if ( useEnhancedOccupancyMapCode ) {
+        numEOMOnlyPoints += ( patchStatistics.eomCount_ - patchStatistics.d1Count_ );
+      }
       std::cout << "\t\t Patch " << patchIndex << " ->(d1,u1,v1)=( " << patch.getD1() << " , " << patch.getU1() << " , "
                 << patch.getV1() << " )(dd,du,dv)=( " << patch.getSizeD() << " , " << patch.getSizeU() << " , "
                 << patch.getSizeV() << " ),Normal: " << size_t( patch.getNormalAxis() )
                 << " Direction: " << patch.getProjectionMode() << " EOM: " << patch.getEOMCount() << std::endl;
     }
-    PCCKdTree kdtreeResampled( resampled );
+
+    // raw points detection, as batches of nearest neighbor queries
+    PCCKdTree    kdtreeResampled( resampled, true );
+    const size_t batchSize  = 256;
+    const size_t batchCount = ( pointCount + batchSize - 1 ) / batchSize;
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), batchCount, [&]( const size_t batch ) {
+#else
+    for ( size_t batch = 0; batch < batchCount; batch++ ) {
+#endif
+        const size_t     start = batch * batchSize;
+        const size_t     end   = ( std::min )( start + batchSize, pointCount );
+        PCCNNBatchResult result;
+        kdtreeResampled.search( points, start, end, 1, result );
+        for ( size_t i = start; i < end; ++i ) { rawPointsDistance[i] = result.dist( i - start, 0 ); }
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }
+#endif
     rawPoints.resize( 0 );
     for ( size_t i = 0; i < pointCount; ++i ) {
-      kdtreeResampled.search( points[i], 1, result );
-      const double dist2   = result.dist( 0 );
-      rawPointsDistance[i] = dist2;
-      if ( dist2 > maxAllowedDist2RawPointsSelection ) { rawPoints.push_back( i ); }
+      if ( rawPointsDistance[i] > maxAllowedDist2RawPointsSelection ) { rawPoints.push_back( i ); }
     }
     if ( enablePointCloudPartitioning ) {
       // update rawPointsChunks using rawPoints
@@ -1321,6 +1459,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
 
 void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCloud,
                                              const PCCKdTree&            kdtree,
+                                             PCCNeighborGraph&           adj,
                                              const PCCNormalsGenerator3& normalsGen,
                                              const PCCVector3D*          orientations,
                                              const size_t                orientationCount,
@@ -1329,7 +1468,6 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
                                              const size_t                iterationCount,
                                              std::vector<size_t>&        partition ) {
   assert( orientations );
-  std::vector<std::vector<size_t>> adj;
   computeAdjacencyInfo( pointCloud, kdtree, adj, maxNNCount );
   const size_t                     pointCount = pointCloud.getPointCount();
   const double                     weight     = lambda / maxNNCount;
@@ -1458,10 +1596,10 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   }
 
   // a step for searching adjacents voxels of each voxel within the voxSearchRadius
-  PCCKdTree                          kdtree( gridCenters );
-  const size_t                       voxSearchRadius  = searchRadius >> voxDimShift;
-  const size_t                       maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
-  std::vector<std::vector<uint32_t>> adj( gridCenters.getPointCount() );
+  PCCKdTree        kdtree( gridCenters );
+  const size_t     voxSearchRadius  = searchRadius >> voxDimShift;
+  const size_t     maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
+  PCCNeighborGraph adj;
 
   computeAdjacencyInfoInRadius( gridCenters, kdtree, adj, maxNeighborCount, voxSearchRadius );
 
@@ -1479,7 +1617,7 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
     adjDEV[i].reserve( 128 );
 
     size_t nnPointCount  = 0;
-    auto&  currentAdjOfI = adj[i];
+    auto   currentAdjOfI = adj[i];
     auto   iter          = currentAdjOfI.begin();
     for ( ; iter != currentAdjOfI.end(); ++iter ) {
       // for the 2nd voxel classification [m56635]
@@ -1498,7 +1636,7 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
     weights.push_back( lambda / nnPointCount );
 
     // removing points from the adjacent list if there is more than maxNNCount
-    if ( iter != currentAdjOfI.end() ) { currentAdjOfI.erase( iter + 1, currentAdjOfI.end() ); }
+    if ( iter != currentAdjOfI.end() ) { adj.setNeighborCount( i, iter + 1 - currentAdjOfI.begin() ); }
   }
 
   std::vector<double> scores;
@@ -1515,7 +1653,7 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
 
       std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
 
-      auto& currentAdjOfI = adj[i];
+      const auto currentAdjOfI = adj[i];
       for ( const auto& j : currentAdjOfI ) {
         ScoresVector_t* scoreSmoothOfAdj = attributeOfVox[j]->getScoreSmooth();
         for ( size_t k = 0; k < orientationCount; ++k ) { scoreSmooth[k] += ( *scoreSmoothOfAdj )[k]; }
@@ -1580,7 +1718,7 @@ void PCCPatchSegmenter3::separateHighGradientPoints( const PCCPointSet3&
                                                      const double                      minGradient,
                                                      const size_t                      minNumHighGradientPoints,
                                                      std::vector<size_t>&              partition,
-                                                     std::vector<std::vector<size_t>>& adj,
+                                                     const PCCNeighborGraph&           adj,
                                                      std::vector<std::vector<size_t>>& connectedComponents ) {
   // detect and remove high gradient points
   std::vector<std::vector<size_t>> highGradientConnectedComponents;
@@ -1767,7 +1905,7 @@ void PCCPatchSegmenter3::calculateGradient( const PCCPointSet3&               po
                                             const double                      minGradient,
                                             const size_t                      minNumHighGradientPoints,
                                             PCCPatch&                         patch,
-                                            std::vector<std::vector<size_t>>& adj,
+                                            const PCCNeighborGraph&           adj,
                                             std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                             std::vector<bool>&                isRemoved ) {
   /* for the case that the xyz components of a normal are the same:
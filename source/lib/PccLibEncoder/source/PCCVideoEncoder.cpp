@@ -63,7 +63,7 @@ void PCCVideoEncoder::patchColorSubsmple( PCCVideo<T, 3>&    video,
 
   std::shared_ptr<PCCVirtualColorConverter<T>> converter;
   if ( colorSpaceConversionPath.empty() ) {
-    converter = std::make_shared<PCCInternalColorConverter<T>>();
+    converter = std::make_shared<PCCInternalColorConverter<T>>( nbThread_ );
   } else {
 #ifdef USE_HDRTOOLS
     converter = std::make_shared<PCCHDRToolsLibColorConverter<T>>();
@@ -326,7 +326,7 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   std::shared_ptr<PCCVirtualColorConverter<T>> converter;
   std::string                                  configInverseColorSpace, configColorSpace;
   if ( colorSpaceConversionPath.empty() ) {
-    converter               = std::make_shared<PCCInternalColorConverter<T>>();
+    converter               = std::make_shared<PCCInternalColorConverter<T>>( nbThread_ );
     configInverseColorSpace = stringFormat( "YUV420ToYUV444_%zu_%zu", depth, upsamplingFilter );
     configColorSpace        = stringFormat( "RGB444ToYUV420_%zu_%zu", depth, downsamplingFilter );
   } else {
@@ -372,6 +372,7 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   params.blockToPatchFile_            = blockToPatchFileName;
   params.occupancyMapFile_            = occupancyMapFileName;
   params.patchInfoFile_               = patchInfoFileName;
+  params.motionEstimationData_        = use3dmv ? &contexts.getMotionEstimationData() : nullptr;
   params.cuTransquantBypassFlagForce_ = false;
   params.transquantBypassEnable_      = false;
   params.inputColourSpaceConvert_     = use444CodecIo;
@@ -379,6 +380,7 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   params.shvcLayerIndex_              = shvcLayerIndex;
   params.shvcRateX_                   = shvcRateX;
   params.shvcRateY_                   = shvcRateY;
+  params.usePipes_                    = !keepIntermediateFiles;
   printf( "Encode: video size = %zu x %zu num frames = %zu \n", video.getWidth(), video.getHeight(),
           video.getFrameCount() );
   fflush( stdout );
@@ -386,14 +388,19 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   auto           encoder = PCCVirtualVideoEncoder<T>::create( codecId );
   encoder->encode( video, params, bitstream, videoRec );
 
+  pictureTrace_.clear();
+#ifdef CONFORMANCE_TRACE
   size_t frameIndex = 0;
   for ( auto& image : videoRec ) {
-    TRACE_PICTURE( " IdxOutOrderCntVal = %d, ", frameIndex++ );
-    TRACE_PICTURE( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
-    TRACE_PICTURE( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
-    TRACE_PICTURE( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
+    pictureTrace_ += stringFormat( " IdxOutOrderCntVal = %d, ", static_cast<int>( frameIndex++ ) );
+    pictureTrace_ += stringFormat( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
+    pictureTrace_ += stringFormat( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
+    pictureTrace_ += stringFormat( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
   }
-  TRACE_PICTURE( "Width =  %d, Height = %d \n", videoRec.getWidth(), videoRec.getHeight() );
+  pictureTrace_ += stringFormat( "Width =  %d, Height = %d \n", static_cast<int>( videoRec.getWidth() ),
+                                 static_cast<int>( videoRec.getHeight() ) );
+  if ( !deferPictureTrace_ ) { TRACE_PICTURE( "%s", pictureTrace_.c_str() ); }
+#endif
 
   if ( keepIntermediateFiles ) {
     bitstream.write( binFileName );
@@ -407,7 +414,8 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
       videoRec.convertYUV420ToYUV444();
       videoRec.setDeprecatedColorFormat( 1 );
     }
-    video = videoRec;
+    // the reconstructed frames are no longer needed: hand them over instead of copying them
+    video.swap( videoRec );
   } else {
     if ( keepIntermediateFiles ) { videoRec.write( recYuvFileName, nbyte ); }
     converter->convert( configInverseColorSpace, videoRec, video, colorSpaceConversionPath, fileName + "_rec" );
@@ -50,6 +50,7 @@ class PCCChecksum {
 
   void read( const std::string& compressedStreamPath );
   void write( const std::string& compressedStreamPath );
+  void selectFrames( size_t frameIndex, size_t frameCount );
 
   void computeSource( PCCGroupOfFrames& groupOfFrames );
   void computeReordered( PCCGroupOfFrames& groupOfFrames );
@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 
 #include "PCCPointSet.h"
+#include "PCCKdTree.h"
 #include "PCCMetricsParameters.h"
 
 namespace pcc {
@@ -58,6 +59,9 @@ class QualityMetrics {
 
   void compute( const PCCPointSet3& cloudA, const PCCPointSet3& cloudB );
 
+  // Same as above with a kd-tree of cloudB built by the caller, to be run in the caller's task arena.
+  void compute( const PCCPointSet3& cloudA, const PCCPointSet3& cloudB, const PCCKdTree& kdtreeB );
+
   QualityMetrics operator+( const QualityMetrics& metric ) const;
 
   void print( char code );
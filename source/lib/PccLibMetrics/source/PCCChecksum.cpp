@@ -122,6 +122,13 @@ void PCCChecksum::write( const std::string& compressedStreamPath ) {
   fout.close();
 }
 
+void PCCChecksum::selectFrames( size_t frameIndex, size_t frameCount ) {
+  frameIndex = ( std::min )( frameIndex, checksumsRec_.size() );
+  frameCount = ( std::min )( frameCount, checksumsRec_.size() - frameIndex );
+  checksumsRec_.erase( checksumsRec_.begin() + frameIndex + frameCount, checksumsRec_.end() );
+  checksumsRec_.erase( checksumsRec_.begin(), checksumsRec_.begin() + frameIndex );
+}
+
 bool PCCChecksum::compare( std::vector<std::vector<uint8_t>>& checksumsA,
                            std::vector<std::vector<uint8_t>>& checksumsB ) {
   size_t num   = ( std::min )( checksumsA.size(), checksumsB.size() );
@@ -35,6 +35,9 @@
 #include "PCCPointSet.h"
 #include "PCCKdTree.h"
 #include "PCCMetrics.h"
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
 
 using namespace std;
 using namespace pcc;
@@ -45,49 +48,41 @@ double getPSNR( double dist, double p, double factor = 1.0 ) {
   return psnr;
 }
 
-void convertRGBtoYUVBT709( const PCCColor3B& rgb, std::vector<float>& yuv ) {
-  yuv.resize( 3 );
+void convertRGBtoYUVBT709( const PCCColor3B& rgb, float* yuv ) {
   yuv[0] = float( ( 0.2126 * rgb[0] + 0.7152 * rgb[1] + 0.0722 * rgb[2] ) / 255.0 );
   yuv[1] = float( ( -0.1146 * rgb[0] - 0.3854 * rgb[1] + 0.5000 * rgb[2] ) / 255.0 + 0.5000 );
   yuv[2] = float( ( 0.5000 * rgb[0] - 0.4542 * rgb[1] - 0.0458 * rgb[2] ) / 255.0 + 0.5000 );
 }
 
-QualityMetrics::QualityMetrics() :
-    c2cMse_( 0.0 ),
-    c2cHausdorff_( 0.0 ),
-    c2cPsnr_( 0.0 ),
-    c2cHausdorffPsnr_( 0.0 ),
-    c2pMse_( 0.0 ),
-    c2pHausdorff_( 0.0 ),
-    c2pPsnr_( 0.0 ),
-    c2pHausdorffPsnr_( 0.0 ),
-    psnr_( 0.0 ),
-    reflectanceMse_( 0.0 ),
-    reflectancePsnr_( 0.0 ) {
-  colorMse_[0] = colorMse_[0] = colorMse_[0] = 0.0;
-  colorPsnr_[0] = colorPsnr_[0] = colorPsnr_[0] = 0.0;
-}
-
-void QualityMetrics::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
-
-void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet3& pointcloudB ) {
+// Sums and maxima of the distances of a block of points of cloud A.
+struct QualityMetricsSums {
+  double sseC2c         = 0.0;
+  double sseC2p         = 0.0;
+  double sseColor[3]    = {0.0, 0.0, 0.0};
+  double sseReflectance = 0.0;
   double maxC2c         = ( std::numeric_limits<double>::min )();
   double maxC2p         = ( std::numeric_limits<double>::min )();
-  double sseC2p         = 0;
-  double sseC2c         = 0;
-  double sseReflectance = 0;
-  size_t num            = 0;
-  double sseColor[3]    = {0.0, 0.0, 0.0};
+};
 
-  psnr_ = params_.resolution_;
-
-  PCCKdTree    kdtree( pointcloudB );
-  PCCNNResult  result;
+static void computeBlock( const PCCPointSet3&         pointcloudA,
+                          const PCCPointSet3&         pointcloudB,
+                          const PCCKdTree&            kdtree,
+                          const PCCMetricsParameters& params,
+                          const size_t                startIndex,
+                          const size_t                endIndex,
+                          QualityMetricsSums&         sums ) {
   const size_t num_results_max  = 30;
   const size_t num_results_incr = 5;
-
-  auto& normalsB = pointcloudB.getNormals();
-  for ( size_t indexA = 0; indexA < pointcloudA.getPointCount(); indexA++ ) {
+  const bool   computeC2p       = params.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals();
+  const bool   computeColor     = params.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors();
+  const bool   computeReflectance =
+      params.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances();
+  auto&               normalsB = pointcloudB.getNormals();
+  PCCNNResult         result;
+  std::vector<size_t> sameDistList;
+  result.reserve( num_results_max );
+  sameDistList.reserve( num_results_max );
+  for ( size_t indexA = startIndex; indexA < endIndex; indexA++ ) {
     // For point 'i' in A, find its nearest neighbor in B. store it in 'j'
     size_t num_results = 0;
     do {
@@ -99,8 +94,8 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
     double distProjC2c = result.dist( 0 );
 
     // Build the list of all the points of same distances.
-    std::vector<size_t> sameDistList;
-    if ( params_.computeColor_ || params_.computeC2p_ ) {
+    sameDistList.clear();
+    if ( params.computeColor_ || params.computeC2p_ ) {
       for ( size_t j = 0; j < num_results && ( fabs( result.dist( 0 ) - result.dist( j ) ) < 1e-8 ); j++ ) {
         sameDistList.push_back( result.indices( j ) );
       }
@@ -109,9 +104,9 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
 
     // Compute point-to-plane, normals in B will be used for point-to-plane
     double distProjC2p = 0.0;
-    if ( params_.computeC2p_ && pointcloudB.hasNormals() && pointcloudA.hasNormals() ) {
+    if ( computeC2p ) {
       for ( auto& indexB : sameDistList ) {
-        std::vector<double> errVector( 3 );
+        double errVector[3];
         for ( size_t j = 0; j < 3; j++ ) { errVector[j] = pointcloudA[indexA][j] - pointcloudB[indexB][j]; }
         double dist = pow( errVector[0] * normalsB[indexB][0] + errVector[1] * normalsB[indexB][1] +
                                errVector[2] * normalsB[indexB][2],
@@ -124,13 +119,13 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
     size_t indexB = result.indices( 0 );
     double distColor[3];
     distColor[0] = distColor[1] = distColor[2] = 0.0;
-    if ( params_.computeColor_ && pointcloudA.hasColors() && pointcloudB.hasColors() ) {
-      std::vector<float> yuvA;
-      std::vector<float> yuvB;
-      PCCColor3B         rgb;
+    if ( computeColor ) {
+      float      yuvA[3];
+      float      yuvB[3];
+      PCCColor3B rgb;
       convertRGBtoYUVBT709( pointcloudA.getColor( indexA ), yuvA );
-      if ( params_.neighborsProc_ != 0 ) {
-        switch ( params_.neighborsProc_ ) {
+      if ( params.neighborsProc_ != 0 ) {
+        switch ( params.neighborsProc_ ) {
           case 0: break;
           case 1:  // Average
           case 2:  // Weighted average
@@ -150,7 +145,6 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
             rgb[1] = static_cast<unsigned char>( round( static_cast<double>( g ) / nbdupcumul ) );
             rgb[2] = static_cast<unsigned char>( round( static_cast<double>( b ) / nbdupcumul ) );
             convertRGBtoYUVBT709( rgb, yuvB );
-            for ( size_t i = 0; i < 3; i++ ) { distColor[i] = pow( yuvA[i] - yuvB[i], 2.F ); }
           } break;
           case 3:  // Min
           case 4:  // Max
@@ -161,8 +155,8 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
               convertRGBtoYUVBT709( pointcloudB.getColor( index ), yuvB );
               float dist =
                   pow( yuvA[0] - yuvB[0], 2.F ) + pow( yuvA[1] - yuvB[1], 2.F ) + pow( yuvA[2] - yuvB[2], 2.F );
-              if ( ( ( params_.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
-                   ( ( params_.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
+              if ( ( ( params.neighborsProc_ == 3 ) && ( dist < distBest ) ) ||
+                   ( ( params.neighborsProc_ == 4 ) && ( dist > distBest ) ) ) {
                 distBest  = dist;
                 indexBest = index;
               }
@@ -177,27 +171,90 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
     }
 
     double distReflectance = 0.0;
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
+    if ( computeReflectance ) {
       distReflectance = pow( pointcloudA.getReflectance( indexA ) - pointcloudB.getReflectance( indexB ), 2.F );
     }
-    num++;
 
     // mean square distance
-    if ( params_.computeC2c_ ) {
-      sseC2c += distProjC2c;
-      if ( distProjC2c > maxC2c ) { maxC2c = distProjC2c; }
+    if ( params.computeC2c_ ) {
+      sums.sseC2c += distProjC2c;
+      if ( distProjC2c > sums.maxC2c ) { sums.maxC2c = distProjC2c; }
     }
-    if ( params_.computeC2p_ ) {
-      sseC2p += distProjC2p;
-      if ( distProjC2p > maxC2p ) { maxC2p = distProjC2p; }
-    }
-    if ( params_.computeColor_ ) {
-      for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += distColor[i]; }
+    if ( params.computeC2p_ ) {
+      sums.sseC2p += distProjC2p;
+      if ( distProjC2p > sums.maxC2p ) { sums.maxC2p = distProjC2p; }
     }
-    if ( params_.computeReflectance_ && pointcloudA.hasReflectances() && pointcloudB.hasReflectances() ) {
-      sseReflectance += distReflectance;
+    if ( params.computeColor_ ) {
+      for ( size_t i = 0; i < 3; i++ ) { sums.sseColor[i] += distColor[i]; }
     }
+    if ( computeReflectance ) { sums.sseReflectance += distReflectance; }
+  }
+}
+
+QualityMetrics::QualityMetrics() :
+    c2cMse_( 0.0 ),
+    c2cHausdorff_( 0.0 ),
+    c2cPsnr_( 0.0 ),
+    c2cHausdorffPsnr_( 0.0 ),
+    c2pMse_( 0.0 ),
+    c2pHausdorff_( 0.0 ),
+    c2pPsnr_( 0.0 ),
+    c2pHausdorffPsnr_( 0.0 ),
+    psnr_( 0.0 ),
+    reflectanceMse_( 0.0 ),
+    reflectancePsnr_( 0.0 ) {
+  colorMse_[0] = colorMse_[0] = colorMse_[0] = 0.0;
+  colorPsnr_[0] = colorPsnr_[0] = colorPsnr_[0] = 0.0;
+}
+
+void QualityMetrics::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
+
+void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet3& pointcloudB ) {
+  PCCKdTree kdtree( pointcloudB );
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] { compute( pointcloudA, pointcloudB, kdtree ); } );
+#else
+  compute( pointcloudA, pointcloudB, kdtree );
+#endif
+}
+
+void QualityMetrics::compute( const PCCPointSet3& pointcloudA,
+                              const PCCPointSet3& pointcloudB,
+                              const PCCKdTree&    kdtreeB ) {
+  // The points of A are split in blocks of fixed size whose sums are reduced in block order, so the results do not
+  // depend on the number of threads.
+  const size_t                    blockSize  = 4096;
+  const size_t                    num        = pointcloudA.getPointCount();
+  const size_t                    blockCount = ( num + blockSize - 1 ) / blockSize;
+  std::vector<QualityMetricsSums> blockSums( blockCount );
+#if defined( ENABLE_TBB )
+  tbb::parallel_for( size_t( 0 ), blockCount, [&]( const size_t blockIndex ) {
+#else
+  for ( size_t blockIndex = 0; blockIndex < blockCount; blockIndex++ ) {
+#endif
+    computeBlock( pointcloudA, pointcloudB, kdtreeB, params_, blockIndex * blockSize,
+                  ( std::min )( num, ( blockIndex + 1 ) * blockSize ), blockSums[blockIndex] );
+#if defined( ENABLE_TBB )
+  } );
+#else
   }
+#endif
+  double maxC2c         = ( std::numeric_limits<double>::min )();
+  double maxC2p         = ( std::numeric_limits<double>::min )();
+  double sseC2p         = 0;
+  double sseC2c         = 0;
+  double sseReflectance = 0;
+  double sseColor[3]    = {0.0, 0.0, 0.0};
+  for ( auto& sums : blockSums ) {
+    sseC2c += sums.sseC2c;
+    sseC2p += sums.sseC2p;
+    sseReflectance += sums.sseReflectance;
+    for ( size_t i = 0; i < 3; i++ ) { sseColor[i] += sums.sseColor[i]; }
+    maxC2c = ( std::max )( maxC2c, sums.maxC2c );
+    maxC2p = ( std::max )( maxC2p, sums.maxC2p );
+  }
+  psnr_ = params_.resolution_;
 
   if ( params_.computeC2c_ ) {
     c2cMse_  = sseC2c / num;
@@ -366,9 +423,23 @@ void PCCMetrics::compute( PCCPointSet3& source, PCCPointSet3& reconstruct, const
   QualityMetrics q1;
   QualityMetrics q2;
   q1.setParameters( params_ );
-  q1.compute( source, reconstruct );
   q2.setParameters( params_ );
-  q2.compute( reconstruct, source );
+#if defined( ENABLE_TBB )
+  // Each kd-tree is shared by all the metrics of its direction and both directions are computed concurrently.
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    PCCKdTree kdtreeSource;
+    PCCKdTree kdtreeReconstruct;
+    tbb::parallel_invoke( [&] { kdtreeSource.init( source ); }, [&] { kdtreeReconstruct.init( reconstruct ); } );
+    tbb::parallel_invoke( [&] { q1.compute( source, reconstruct, kdtreeReconstruct ); },
+                          [&] { q2.compute( reconstruct, source, kdtreeSource ); } );
+  } );
+#else
+  PCCKdTree kdtreeSource( source );
+  PCCKdTree kdtreeReconstruct( reconstruct );
+  q1.compute( source, reconstruct, kdtreeReconstruct );
+  q2.compute( reconstruct, source, kdtreeSource );
+#endif
   quality1_.push_back( q1 );
   quality2_.push_back( q2 );
   qualityF_.push_back( q1 + q2 );
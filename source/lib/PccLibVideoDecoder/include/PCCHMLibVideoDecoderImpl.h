@@ -39,6 +39,7 @@
 
 #include "PCCVideo.h"
 #include "PCCVideoBitstream.h"
+#include <functional>
 
 #include <TLibCommon/TComList.h>
 #include <TLibCommon/TComPicYuv.h>
@@ -55,6 +56,7 @@ class PCCHMLibVideoDecoderImpl {
 
   ~PCCHMLibVideoDecoderImpl();
   void decode( PCCVideoBitstream& bitstream, size_t outputBitDepth, PCCVideo<T, 3>& video );
+  void setFrameCallback( const std::function<void( size_t )>& frameCallback ) { frameCallback_ = frameCallback; }
 
  private:
   void               setVideoSize( const pcc_hm::TComSPS* sps );
@@ -69,6 +71,8 @@ class PCCHMLibVideoDecoderImpl {
   int                m_outputWidth;
   int                m_outputHeight;
   bool               m_bRGB2GBR;
+
+  std::function<void( size_t )> frameCallback_;
 };
 
 };  // namespace pcc
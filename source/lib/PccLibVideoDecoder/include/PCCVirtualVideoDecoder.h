@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 #include "PCCVideo.h"
 #include "PCCVideoBitstream.h"
+#include <functional>
 
 namespace pcc {
 
@@ -46,6 +47,8 @@ class PCCVirtualVideoDecoder {
   ~PCCVirtualVideoDecoder() {}
 
   static std::shared_ptr<PCCVirtualVideoDecoder<T>> create( PCCCodecId codecId );
+  // Same as PCCVirtualVideoEncoder<T>::isProcessCodecId() for the decoders.
+  static bool isProcessCodecId( PCCCodecId codecId );
 
   virtual void decode( PCCVideoBitstream& bitstream,
                        PCCVideo<T, 3>&    video,
@@ -53,7 +56,22 @@ class PCCVirtualVideoDecoder {
                        const std::string& decoderPath    = "",
                        const std::string& parameters     = "" ) = 0;
 
- public:
+  // Called with the index of the last picture appended to the output video. Decoders that do not output their
+  // pictures progressively do not call it: the pictures are then signaled by the caller once decode() has returned.
+  void setFrameCallback( const std::function<void( size_t )>& frameCallback ) { frameCallback_ = frameCallback; }
+
+ protected:
+  // Runs the command of an application decoder that writes its reconstructed pictures to reconFile and reads them in
+  // video. When named pipes are supported, each picture is read and signaled as soon as the decoder writes it.
+  bool decodeWithCommand( const std::string&   command,
+                          const std::string&   reconFile,
+                          size_t               width,
+                          size_t               height,
+                          const PCCCOLORFORMAT format,
+                          size_t               nbyte,
+                          PCCVideo<T, 3>&      video );
+
+  std::function<void( size_t )> frameCallback_;
 };
 
 };  // namespace pcc
@@ -51,6 +51,7 @@ void PCCHMLibVideoDecoder<T>::decode( PCCVideoBitstream& bitstream,
                                       const std::string& decoderPath,
                                       const std::string& fileName ) {
   PCCHMLibVideoDecoderImpl<T> decoder;
+  decoder.setFrameCallback( this->frameCallback_ );
   decoder.decode( bitstream, outputBitDepth, video );
 }
 
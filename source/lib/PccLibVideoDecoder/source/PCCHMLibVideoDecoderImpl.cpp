@@ -361,6 +361,7 @@ void PCCHMLibVideoDecoderImpl<T>::xWritePicture( const pcc_hm::TComPicYuv* pic,
              m_outputHeight, pic->getStride( COMPONENT_Y ), m_outputWidth / chromaSubsample,
              m_outputHeight / chromaSubsample, pic->getStride( COMPONENT_Cb ),
              m_internalBitDepths - m_outputBitDepth[0], format, m_bRGB2GBR );
+  if ( frameCallback_ ) { frameCallback_( video.getFrameCount() - 1 ); }
 }
 
 template class pcc::PCCHMLibVideoDecoderImpl<uint8_t>;
@@ -69,13 +69,11 @@ void PCCJMAppVideoDecoder<T>::decode( PCCVideoBitstream& bitstream,
   std::stringstream cmd;
   cmd << decoderPath << " -i " << binFileName << " -o " << reconFile;
   std::cout << cmd.str() << '\n';
-  if ( pcc::system( cmd.str().c_str() ) ) {
+  PCCCOLORFORMAT format = isRGB ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
+  if ( !this->decodeWithCommand( cmd.str(), reconFile, width, height, format, outputBitDepth == 8 ? 1 : 2, video ) ) {
     std::cout << "Error: can't run system command!" << std::endl;
     exit( -1 );
   }
-  PCCCOLORFORMAT format = isRGB ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
-  video.clear();
-  video.read( reconFile, width, height, format, outputBitDepth == 8 ? 1 : 2 );
   printf( "File read size = %zu x %zu frame count = %zu \n", video.getWidth(), video.getHeight(),
           video.getFrameCount() );
 
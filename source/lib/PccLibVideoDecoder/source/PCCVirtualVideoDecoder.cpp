@@ -32,6 +32,7 @@
  */
 
 #include "PCCVirtualVideoDecoder.h"
+#include "PCCSystem.h"
 
 #include "PCCJMAppVideoDecoder.h"
 #include "PCCHMAppVideoDecoder.h"
@@ -82,5 +83,49 @@ std::shared_ptr<PCCVirtualVideoDecoder<T>> PCCVirtualVideoDecoder<T>::create( PC
   return nullptr;
 }
 
+template <typename T>
+bool PCCVirtualVideoDecoder<T>::isProcessCodecId( PCCCodecId codecId ) {
+  switch ( codecId ) {
+#ifdef USE_HMAPP_VIDEO_CODEC
+    case HMAPP: return true;
+#endif
+#ifdef USE_JMAPP_VIDEO_CODEC
+    case JMAPP: return true;
+#endif
+#ifdef USE_SHMAPP_VIDEO_CODEC
+    case SHMAPP: return true;
+#endif
+    default: return false;
+  }
+}
+
+template <typename T>
+bool PCCVirtualVideoDecoder<T>::decodeWithCommand( const std::string&   command,
+                                                   const std::string&   reconFile,
+                                                   size_t               width,
+                                                   size_t               height,
+                                                   const PCCCOLORFORMAT format,
+                                                   size_t               nbyte,
+                                                   PCCVideo<T, 3>&      video ) {
+  video.clear();
+  if ( createPipes( {reconFile} ) ) {
+    std::vector<PCCPipe> pipes( 1 );
+    pipes[0].fileName_ = reconFile;
+    pipes[0].read_     = [&]( std::ifstream& file ) {
+      PCCImage<T, 3> image;
+      while ( image.read( file, width, height, format, nbyte ) ) {
+        video.resize( video.getFrameCount() + 1 );
+        video.getFrames().back().swap( image );
+        if ( frameCallback_ ) { frameCallback_( video.getFrameCount() - 1 ); }
+      }
+      return true;
+    };
+    return pcc::system( command.c_str(), pipes ) == 0;
+  }
+  if ( pcc::system( command.c_str() ) ) { return false; }
+  video.read( reconFile, width, height, format, nbyte );
+  return true;
+}
+
 template class pcc::PCCVirtualVideoDecoder<uint8_t>;
 template class pcc::PCCVirtualVideoDecoder<uint16_t>;
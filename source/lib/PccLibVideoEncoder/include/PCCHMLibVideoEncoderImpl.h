@@ -39,6 +39,7 @@
 #ifdef USE_HMLIB_VIDEO_CODEC
 #include "PCCVideo.h"
 #include "PCCVideoBitstream.h"
+#include "PCCMotionEstimationData.h"
 
 #include <list>
 #include <ostream>
@@ -79,6 +80,7 @@ class PCCHMLibVideoEncoderImpl : public PCCHMLibVideoEncoderCfg {
                PCCVideoBitstream& bitstream,
 
                PCCVideo<T, 3>& videoRec );
+  void setMotionEstimationData( const PCCMotionEstimationData* data ) { motionEstimationData_ = data; }
   // #if PCC_CF_EXT
   // void setLogger( PCCLogger& logger ) { logger_ = &logger; }
   // #endif
@@ -109,6 +111,8 @@ class PCCHMLibVideoEncoderImpl : public PCCHMLibVideoEncoderCfg {
   UInt                  m_totalBytes;
   int                   m_outputWidth;
   int                   m_outputHeight;
+
+  const PCCMotionEstimationData* motionEstimationData_;
 };
 
 }  // namespace pcc
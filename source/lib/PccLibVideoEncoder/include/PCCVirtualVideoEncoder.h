@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 #include "PCCVideo.h"
 #include "PCCVideoBitstream.h"
+#include "PCCMotionEstimationData.h"
 
 namespace pcc {
 
@@ -61,6 +62,10 @@ struct PCCVideoEncoderParameters {
   int32_t     shvcLayerIndex_              = 8;
   int32_t     shvcRateX_                   = 0;
   int32_t     shvcRateY_                   = 0;
+  bool        usePipes_                    = false;
+
+  // content of the motion estimation files, read directly by the encoders linked as libraries
+  const PCCMotionEstimationData* motionEstimationData_ = nullptr;
 };
 
 template <class T>
@@ -72,6 +77,9 @@ class PCCVirtualVideoEncoder {
   static std::shared_ptr<PCCVirtualVideoEncoder<T>> create( PCCCodecId codecId );
   static PCCCodecId                                 getDefaultCodecId();
   static bool                                       checkCodecId( PCCCodecId codecId );
+  // The application codecs run in their own process and several of them can run at the same time; the library
+  // codecs share global tables and must be used by one thread at a time.
+  static bool isProcessCodecId( PCCCodecId codecId );
 
   virtual void encode( PCCVideo<T, 3>&            videoSrc,
                        PCCVideoEncoderParameters& params,
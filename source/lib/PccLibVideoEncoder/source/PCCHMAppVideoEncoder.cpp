@@ -90,15 +90,37 @@ void PCCHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
 
   std::cout << cmd.str() << std::endl;
 
-  videoSrc.write( srcYuvFileName, params.inputBitDepth_ == 8 ? 1 : 2 );
-  if ( pcc::system( cmd.str().c_str() ) ) {
-    std::cout << "Error: can't run system command!" << std::endl;
-    exit( -1 );
-  }
   PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
   videoRec.clear();
-  videoRec.read( recYuvFileName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
-  bitstream.read( binFileName );
+  if ( params.usePipes_ && createPipes( {srcYuvFileName, recYuvFileName, binFileName} ) ) {
+    // the videos and the bitstream are streamed through named pipes while the encoder runs
+    std::vector<PCCPipe> pipes( 3 );
+    pipes[0].fileName_ = srcYuvFileName;
+    pipes[0].write_    = [&]( std::ofstream& file ) {
+      return videoSrc.write( file, params.inputBitDepth_ == 8 ? 1 : 2 );
+    };
+    pipes[1].fileName_ = recYuvFileName;
+    pipes[1].read_     = [&]( std::ifstream& file ) {
+      return videoRec.read( file, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+    };
+    pipes[2].fileName_ = binFileName;
+    pipes[2].read_     = [&]( std::ifstream& file ) {
+      bitstream.vector().assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+      return bitstream.size() > 0;
+    };
+    if ( pcc::system( cmd.str().c_str(), pipes ) ) {
+      std::cout << "Error: can't run system command!" << std::endl;
+      exit( -1 );
+    }
+  } else {
+    videoSrc.write( srcYuvFileName, params.inputBitDepth_ == 8 ? 1 : 2 );
+    if ( pcc::system( cmd.str().c_str() ) ) {
+      std::cout << "Error: can't run system command!" << std::endl;
+      exit( -1 );
+    }
+    videoRec.read( recYuvFileName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+    bitstream.read( binFileName );
+  }
   removeFile( srcYuvFileName );
   removeFile( recYuvFileName );
   removeFile( binFileName );
@@ -94,6 +94,7 @@ void PCCHMLibVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
   std::cout << cmd.str() << std::endl;
 
   PCCHMLibVideoEncoderImpl<T> encoder;
+  encoder.setMotionEstimationData( params.motionEstimationData_ );
   encoder.encode( videoSrc, cmd.str(), bitstream, videoRec );
 }
 
@@ -45,9 +45,10 @@ using namespace pcc_hm;
 
 template <typename T>
 PCCHMLibVideoEncoderImpl<T>::PCCHMLibVideoEncoderImpl() {
-  m_iFrameRcvd     = 0;
-  m_totalBytes     = 0;
-  m_essentialBytes = 0;
+  m_iFrameRcvd          = 0;
+  m_totalBytes          = 0;
+  m_essentialBytes      = 0;
+  motionEstimationData_ = nullptr;
 }
 
 template <typename T>
@@ -94,8 +95,26 @@ Void PCCHMLibVideoEncoderImpl<T>::encode( PCCVideo<T, 3>&    videoSrc,
   videoRec.clear();
 
 #if PCC_ME_EXT
-  if ( m_usePCCExt ) {
-    // Note JR: must be given from the function parameters
+  if ( m_usePCCExt && motionEstimationData_ != nullptr ) {
+    // the patch table is given by the PCC encoder, the other aux info is still read by TEncTop
+    printf( "\nUsing the aux info of the PCC encoder\n" );
+    const auto& data = *motionEstimationData_;
+    memset( g_numPatches, 0, sizeof( long long ) * PCC_ME_EXT_MAX_NUM_FRAMES );
+    for ( Int i = 0; i < PCC_ME_EXT_MAX_NUM_FRAMES && i < (Int)data.getFrameCount(); i++ ) {
+      g_numPatches[i] = data[i].getPatches().size();
+      for ( Int patchIdx = 0; patchIdx < g_numPatches[i]; patchIdx++ ) {
+        const auto& patch              = data[i].getPatches()[patchIdx];
+        g_projectionIndex[i][patchIdx] = patch.projectionIndex_;
+        g_patch2DInfo[i][patchIdx][0]  = patch.u0_;
+        g_patch2DInfo[i][patchIdx][1]  = patch.v0_;
+        g_patch2DInfo[i][patchIdx][2]  = patch.sizeU0_;
+        g_patch2DInfo[i][patchIdx][3]  = patch.sizeV0_;
+        g_patch3DInfo[i][patchIdx][0]  = patch.d1_;
+        g_patch3DInfo[i][patchIdx][1]  = patch.u1_;
+        g_patch3DInfo[i][patchIdx][2]  = patch.v1_;
+      }
+    }
+  } else if ( m_usePCCExt ) {
     printf( "\nReading the aux info files\n" );
     FILE* patchFile = NULL;
     patchFile       = fopen( m_patchInfoFileName.c_str(), "rb" );
@@ -81,6 +81,7 @@ void PCCJMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
   cmd << " -p OutputBitDepthChroma=" << params.outputBitDepth_;
 
   std::cout << cmd.str() << std::endl;
+  // params.usePipes_ is ignored: lencod seeks in its input and reconstruction files, which named pipes don't support
   videoSrc.write( srcYuvFileName, params.inputBitDepth_ == 8 ? 1 : 2 );
   if ( pcc::system( cmd.str().c_str() ) ) {
     std::cout << "Error: can't run system command!" << std::endl;
@@ -99,7 +99,7 @@ bool PCCVTMLibVideoEncoderImpl<T>::encodePrep( bool&           eos,
 
   m_framesToBeEncoded = std::min( m_framesToBeEncoded, (int)videoSrc.getFrameCount() );
   xReadPicture( m_orgPic, videoSrc, m_iFrameRcvd );
-  xReadPicture( m_trueOrgPic, videoSrc, m_iFrameRcvd );
+  m_trueOrgPic->copyFrom( *m_orgPic );
   if ( m_gopBasedTemporalFilterEnabled ) {
     m_temporalFilter.filter( m_orgPic, m_iFrameRcvd );
     m_filteredOrgPic->copyFrom( *m_orgPic );
@@ -106,6 +106,22 @@ bool PCCVirtualVideoEncoder<T>::checkCodecId( PCCCodecId codecId ) {
   return true;
 }
 
+template <typename T>
+bool PCCVirtualVideoEncoder<T>::isProcessCodecId( PCCCodecId codecId ) {
+  switch ( codecId ) {
+#ifdef USE_HMAPP_VIDEO_CODEC
+    case HMAPP: return true;
+#endif
+#ifdef USE_JMAPP_VIDEO_CODEC
+    case JMAPP: return true;
+#endif
+#ifdef USE_SHMAPP_VIDEO_CODEC
+    case SHMAPP: return true;
+#endif
+    default: return false;
+  }
+}
+
 template <typename T>
 std::shared_ptr<PCCVirtualVideoEncoder<T>> PCCVirtualVideoEncoder<T>::create( PCCCodecId codecId ) {
   switch ( codecId ) {